@@ -19,6 +19,7 @@
 #import "RLMSyncTestCase.h"
 #import "RLMTestUtils.h"
 #import "RLMSyncSessionRefreshHandle+ObjectServerTests.h"
+#import "RLMSyncSessionRefreshHandle.hpp"
 #import "RLMSyncUser+ObjectServerTests.h"
 #import "RLMSyncUtil_Private.h"
 #import "RLMRealmConfiguration_Private.h"
@@ -28,6 +29,16 @@
 @interface RLMObjectServerTests : RLMSyncTestCase
 @end
 
+@interface RLMStubRefreshable : NSObject <RLMSyncSessionRefreshable>
+@property (nonatomic, copy) void (^onRefresh)(dispatch_block_t completion);
+@end
+
+@implementation RLMStubRefreshable
+- (void)refreshWithCompletion:(dispatch_block_t)completion {
+    self.onRefresh(completion);
+}
+@end
+
 @implementation RLMObjectServerTests
 
 #pragma mark - Authentication and Tokens
@@ -183,6 +194,145 @@
     XCTAssertTrue(refreshCount > 0);
 }
 
+/// Refreshes which become due together should be performed from one timer wakeup, with a
+/// bounded number of requests in flight at once.
+- (void)testRefreshSchedulerCoalescesAndLimitsConcurrentRefreshes {
+    RLMSyncSessionRefreshScheduler *scheduler = [[RLMSyncSessionRefreshScheduler alloc] initWithMaximumConcurrentRefreshes:2
+                                                                                                        coalescingInterval:5];
+    NSLock *lock = [NSLock new];
+    __block NSUInteger inFlight = 0, maxInFlight = 0, completed = 0;
+    __block NSDate *firstStart = nil, *lastStart = nil;
+    XCTestExpectation *ex = [self expectationWithDescription:@"All refreshes performed"];
+
+    NSMutableArray *refreshables = [NSMutableArray new];
+    for (int i = 0; i < 6; ++i) {
+        RLMStubRefreshable *refreshable = [RLMStubRefreshable new];
+        refreshable.onRefresh = ^(dispatch_block_t completion) {
+            [lock lock];
+            maxInFlight = MAX(maxInFlight, ++inFlight);
+            firstStart = firstStart ?: [NSDate date];
+            lastStart = [NSDate date];
+            [lock unlock];
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.05 * NSEC_PER_SEC)),
+                           dispatch_get_global_queue(0, 0), ^{
+                [lock lock];
+                --inFlight;
+                bool done = ++completed == 6;
+                [lock unlock];
+                completion();
+                if (done) {
+                    [ex fulfill];
+                }
+            });
+        };
+        [refreshables addObject:refreshable];
+        // Spread the due dates over less than the coalescing interval
+        [scheduler scheduleRefresh:refreshable atDate:[NSDate dateWithTimeIntervalSinceNow:0.5 + i * 0.5]];
+    }
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    XCTAssertEqual(maxInFlight, 2U);
+    // All six were started from the first wakeup rather than as each became due
+    XCTAssertLessThan([lastStart timeIntervalSinceDate:firstStart], 1.0);
+}
+
+/// Immediate refreshes for initial token fetches should not wait for scheduled refreshes to finish.
+- (void)testRefreshSchedulerRefreshNowIsNotLimited {
+    RLMSyncSessionRefreshScheduler *scheduler = [[RLMSyncSessionRefreshScheduler alloc] initWithMaximumConcurrentRefreshes:1
+                                                                                                        coalescingInterval:0];
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    XCTestExpectation *scheduledStarted = [self expectationWithDescription:@"Scheduled refresh started"];
+    RLMStubRefreshable *scheduled = [RLMStubRefreshable new];
+    scheduled.onRefresh = ^(dispatch_block_t completion) {
+        [scheduledStarted fulfill];
+        dispatch_async(dispatch_get_global_queue(0, 0), ^{
+            dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+            completion();
+        });
+    };
+    [scheduler scheduleRefresh:scheduled atDate:[NSDate date]];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+
+    XCTestExpectation *immediate = [self expectationWithDescription:@"Immediate refresh performed"];
+    RLMStubRefreshable *initial = [RLMStubRefreshable new];
+    initial.onRefresh = ^(dispatch_block_t completion) {
+        completion();
+        [immediate fulfill];
+    };
+    [scheduler refreshNow:initial];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    dispatch_semaphore_signal(sema);
+}
+
+/// Cancelled refreshes should not be performed.
+- (void)testRefreshSchedulerCancel {
+    RLMSyncSessionRefreshScheduler *scheduler = [[RLMSyncSessionRefreshScheduler alloc] initWithMaximumConcurrentRefreshes:1
+                                                                                                        coalescingInterval:0];
+    RLMStubRefreshable *cancelled = [RLMStubRefreshable new];
+    cancelled.onRefresh = ^(dispatch_block_t completion) {
+        XCTFail(@"Cancelled refresh should not be performed");
+        completion();
+    };
+    RLMStubRefreshable *performed = [RLMStubRefreshable new];
+    XCTestExpectation *ex = [self expectationWithDescription:@"Refresh performed"];
+    performed.onRefresh = ^(dispatch_block_t completion) {
+        completion();
+        [ex fulfill];
+    };
+
+    [scheduler scheduleRefresh:cancelled atDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    [scheduler scheduleRefresh:performed atDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    [scheduler cancelRefresh:cancelled];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+}
+
+#pragma mark - Logging
+
+- (void)testLogMessagesAreWrittenToSinks {
+    RLMSyncManager *manager = [RLMSyncManager sharedManager];
+    RLMSyncMemoryLogSink *memorySink = [[RLMSyncMemoryLogSink alloc] initWithCapacity:1000];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"sync.log"]];
+    [NSFileManager.defaultManager removeItemAtURL:fileURL error:nil];
+    NSError *error;
+    RLMSyncFileLogSink *fileSink = [[RLMSyncFileLogSink alloc] initWithURL:fileURL error:&error];
+    XCTAssertNil(error);
+    __block NSUInteger blockCount = 0;
+    RLMSyncBlockLogSink *blockSink = [[RLMSyncBlockLogSink alloc] initWithBlock:^(__unused RLMSyncLogLevel level,
+                                                                                 __unused NSString *message) {
+        ++blockCount;
+    }];
+    manager.logSinks = @[memorySink, fileSink, blockSink];
+    manager.logLevel = RLMSyncLogLevelDebug;
+
+    NSURL *url = REALM_URL();
+    RLMSyncUser *user = [self logInUserForCredentials:[RLMObjectServerTests basicCredentialsWithName:NSStringFromSelector(_cmd)
+                                                                                            register:YES]
+                                               server:[RLMObjectServerTests authServerURL]];
+    RLMRealm *realm = [self openRealmForURL:url user:user];
+    [self addSyncObjectsToRealm:realm descriptions:@[@"child-1"]];
+    [self waitForUploadsForUser:user url:url];
+
+    [manager flushLogs];
+    manager.logSinks = @[];
+    manager.logLevel = RLMSyncLogLevelInfo;
+
+    XCTAssertGreaterThan(memorySink.messages.count, 0U);
+    XCTAssertEqual(blockCount, memorySink.messages.count);
+    NSString *contents = [NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertGreaterThanOrEqual([contents componentsSeparatedByString:@"\n"].count - 1, memorySink.messages.count);
+
+    [memorySink removeAllMessages];
+    XCTAssertEqual(memorySink.messages.count, 0U);
+}
+
+- (void)testMemoryLogSinkKeepsMostRecentMessages {
+    RLMSyncMemoryLogSink *sink = [[RLMSyncMemoryLogSink alloc] initWithCapacity:2];
+    [sink logMessage:@"a" level:RLMSyncLogLevelInfo];
+    [sink logMessage:@"b" level:RLMSyncLogLevelInfo];
+    [sink logMessage:@"c" level:RLMSyncLogLevelInfo];
+    XCTAssertEqualObjects(sink.messages, (@[@"b", @"c"]));
+}
+
 #pragma mark - Users
 
 /// `[RLMSyncUser all]` should be updated once a user is logged in.
@@ -1117,6 +1267,65 @@
               @(transferred), @(transferrable));
 }
 
+- (void)testCoalescedStreamingUploadNotifier {
+    const NSInteger NUMBER_OF_BIG_OBJECTS = 2;
+    NSURL *url = REALM_URL();
+    // Log in the user.
+    RLMSyncUser *user = [self logInUserForCredentials:[RLMObjectServerTests basicCredentialsWithName:NSStringFromSelector(_cmd)
+                                                                                            register:self.isParent]
+                                               server:[RLMObjectServerTests authServerURL]];
+    __block NSUInteger transferred = 0;
+    __block NSUInteger transferrable = 0;
+    __block NSDate *lastCall = nil;
+    __block BOOL hasBeenFulfilled = NO;
+    const NSTimeInterval minimumInterval = 0.2;
+    // Open the Realm
+    RLMRealm *realm = [self openRealmForURL:url user:user];
+
+    // Register a notifier.
+    RLMSyncSession *session = [user sessionForURL:url];
+    XCTAssertNotNil(session);
+    XCTestExpectation *ex = [self expectationWithDescription:@"coalesced-streaming-upload-expectation"];
+    RLMProgressNotificationToken *token = [session addProgressNotificationForDirection:RLMSyncProgressDirectionUpload
+                                                                                  mode:RLMSyncProgressReportIndefinitely
+                                                                       minimumInterval:minimumInterval
+                                                                      minimumByteDelta:0
+                                                                                 block:^(NSUInteger xfr, NSUInteger xfb) {
+                                                                                     // Calls must be spaced at least
+                                                                                     // the minimum interval apart
+                                                                                     // (allowing for timer leeway).
+                                                                                     NSDate *now = [NSDate date];
+                                                                                     if (lastCall) {
+                                                                                         XCTAssertGreaterThan([now timeIntervalSinceDate:lastCall],
+                                                                                                              minimumInterval * 0.9);
+                                                                                     }
+                                                                                     lastCall = now;
+                                                                                     XCTAssert(xfr >= transferred);
+                                                                                     XCTAssert(xfb >= transferrable);
+                                                                                     transferred = xfr;
+                                                                                     transferrable = xfb;
+                                                                                     if (transferred > 0
+                                                                                         && transferred >= transferrable
+                                                                                         && !hasBeenFulfilled) {
+                                                                                         [ex fulfill];
+                                                                                         hasBeenFulfilled = YES;
+                                                                                     }
+                                                                                 }];
+    // Upload lots of data
+    [realm beginWriteTransaction];
+    for (NSInteger i=0; i<NUMBER_OF_BIG_OBJECTS; i++) {
+        [realm addObject:[HugeSyncObject object]];
+    }
+    [realm commitWriteTransaction];
+    // The final progress update must still be delivered even though it may
+    // arrive within the minimum interval of the previous one
+    [self waitForExpectationsWithTimeout:10.0 handler:nil];
+    [token stop];
+    XCTAssert(transferred >= transferrable,
+              @"Transferred (%@) needs to be greater than or equal to transferrable (%@)",
+              @(transferred), @(transferrable));
+}
+
 #pragma mark - Download Realm
 
 - (void)testDownloadRealm {
@@ -19,15 +19,18 @@
 #import "RLMAccessor.hpp"
 
 #import "RLMArray_Private.hpp"
+#import "RLMCaseInsensitiveIndex_Private.hpp"
 #import "RLMListBase.h"
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMObjectStore.h"
 #import "RLMObject_Private.hpp"
 #import "RLMObservation.hpp"
+#import "RLMOrderedIndex_Private.hpp"
 #import "RLMProperty_Private.h"
 #import "RLMRealm_Private.hpp"
 #import "RLMResults_Private.h"
 #import "RLMSchema_Private.h"
+#import "RLMTextSearch_Private.hpp"
 #import "RLMUtil.hpp"
 #import "results.hpp"
 #import "property.hpp"
@@ -58,10 +61,17 @@ id getBoxed(__unsafe_unretained RLMObjectBase *const obj, NSUInteger index) {
     return ctx.box(obj->_row.get<T>(col));
 }
 
+// Perform a write to the column with `fn`, keeping the column's ordered and
+// composite indexes up to date if it has any
+template<typename Fn>
+void setIndexed(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex, Fn&& fn) {
+    RLMUpdateOrderedIndex(*obj->_info, colIndex, obj->_row.get_index(), fn);
+}
+
 template<typename T>
 void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex, T val) {
     RLMVerifyInWriteTransaction(obj);
-    obj->_row.set(colIndex, val);
+    setIndexed(obj, colIndex, [&] { obj->_row.set(colIndex, val); });
 }
 
 template<typename Fn>
@@ -78,7 +88,9 @@ void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained NSString *const val) {
     RLMVerifyInWriteTransaction(obj);
     translateError([&] {
-        obj->_row.set(colIndex, RLMStringDataWithNSString(val));
+        setIndexed(obj, colIndex, [&] { obj->_row.set(colIndex, RLMStringDataWithNSString(val)); });
+        RLMUpdateFullTextIndex(*obj->_info, colIndex, obj->_row.get_index(), val);
+        RLMUpdateCaseInsensitiveIndex(*obj->_info, colIndex, obj->_row.get_index(), val);
     });
 }
 
@@ -90,12 +102,14 @@ void setNull(realm::Row& row, size_t col) {
 void setValue(__unsafe_unretained RLMObjectBase *const obj,
               NSUInteger colIndex, __unsafe_unretained NSDate *const date) {
     RLMVerifyInWriteTransaction(obj);
-    if (date) {
-        obj->_row.set(colIndex, RLMTimestampForNSDate(date));
-    }
-    else {
-        setNull(obj->_row, colIndex);
-    }
+    setIndexed(obj, colIndex, [&] {
+        if (date) {
+            obj->_row.set(colIndex, RLMTimestampForNSDate(date));
+        }
+        else {
+            setNull(obj->_row, colIndex);
+        }
+    });
 }
 
 void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
@@ -110,7 +124,7 @@ void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained RLMObjectBase *const val) {
     if (!val) {
         RLMVerifyInWriteTransaction(obj);
-        obj->_row.nullify_link(colIndex);
+        setIndexed(obj, colIndex, [&] { obj->_row.nullify_link(colIndex); });
         return;
     }
 
@@ -122,7 +136,7 @@ void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
                             val->_objectSchema.className,
                             obj->_info->propertyForTableColumn(colIndex).objectClassName);
     }
-    obj->_row.set_link(colIndex, val->_row.get_index());
+    setIndexed(obj, colIndex, [&] { obj->_row.set_link(colIndex, val->_row.get_index()); });
 }
 
 // array getter/setter
@@ -155,48 +169,56 @@ void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained NSNumber<RLMInt> *const intObject) {
     RLMVerifyInWriteTransaction(obj);
 
-    if (intObject) {
-        obj->_row.set(colIndex, intObject.longLongValue);
-    }
-    else {
-        setNull(obj->_row, colIndex);
-    }
+    setIndexed(obj, colIndex, [&] {
+        if (intObject) {
+            obj->_row.set(colIndex, intObject.longLongValue);
+        }
+        else {
+            setNull(obj->_row, colIndex);
+        }
+    });
 }
 
 void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained NSNumber<RLMFloat> *const floatObject) {
     RLMVerifyInWriteTransaction(obj);
 
-    if (floatObject) {
-        obj->_row.set(colIndex, floatObject.floatValue);
-    }
-    else {
-        setNull(obj->_row, colIndex);
-    }
+    setIndexed(obj, colIndex, [&] {
+        if (floatObject) {
+            obj->_row.set(colIndex, floatObject.floatValue);
+        }
+        else {
+            setNull(obj->_row, colIndex);
+        }
+    });
 }
 
 void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained NSNumber<RLMDouble> *const doubleObject) {
     RLMVerifyInWriteTransaction(obj);
 
-    if (doubleObject) {
-        obj->_row.set(colIndex, doubleObject.doubleValue);
-    }
-    else {
-        setNull(obj->_row, colIndex);
-    }
+    setIndexed(obj, colIndex, [&] {
+        if (doubleObject) {
+            obj->_row.set(colIndex, doubleObject.doubleValue);
+        }
+        else {
+            setNull(obj->_row, colIndex);
+        }
+    });
 }
 
 void setValue(__unsafe_unretained RLMObjectBase *const obj, NSUInteger colIndex,
               __unsafe_unretained NSNumber<RLMBool> *const boolObject) {
     RLMVerifyInWriteTransaction(obj);
 
-    if (boolObject) {
-        obj->_row.set(colIndex, (bool)boolObject.boolValue);
-    }
-    else {
-        setNull(obj->_row, colIndex);
-    }
+    setIndexed(obj, colIndex, [&] {
+        if (boolObject) {
+            obj->_row.set(colIndex, (bool)boolObject.boolValue);
+        }
+        else {
+            setNull(obj->_row, colIndex);
+        }
+    });
 }
 
 RLMLinkingObjects *getLinkingObjects(__unsafe_unretained RLMObjectBase *const obj,
@@ -214,6 +236,21 @@ void setValue(__unsafe_unretained RLMObjectBase *const, NSUInteger, __unsafe_unr
     @throw RLMException(@"Modifying Mixed properties is not supported");
 }
 
+// Perform a write to the named property with `fn`, sending KVO notifications
+// to any observers of the object
+template<typename Fn>
+void setObserved(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained NSString *const name, Fn&& fn) {
+    if (RLMObservationInfo *info = RLMGetObservationInfo(obj->_observationInfo,
+                                                         obj->_row.get_index(), *obj->_info)) {
+        info->willChange(name);
+        fn();
+        info->didChange(name);
+    }
+    else {
+        fn();
+    }
+}
+
 template<typename Type, typename StorageType=Type>
 id makeGetter(NSUInteger index) {
     return ^(__unsafe_unretained RLMObjectBase *const obj) {
@@ -300,19 +337,10 @@ id makeSetter(__unsafe_unretained RLMProperty *const prop) {
     }
 
     return ^(__unsafe_unretained RLMObjectBase *const obj, ArgType val) {
-        auto set = [&] {
+        setObserved(obj, name, [&] {
             setValue(obj, obj->_info->objectSchema->persisted_properties[index].table_column,
                      static_cast<StorageType>(val));
-        };
-        if (RLMObservationInfo *info = RLMGetObservationInfo(obj->_observationInfo,
-                                                             obj->_row.get_index(), *obj->_info)) {
-            info->willChange(name);
-            set();
-            info->didChange(name);
-        }
-        else {
-            set();
-        }
+        });
     };
 }
 
@@ -531,14 +559,69 @@ void RLMDynamicSet(__unsafe_unretained RLMObjectBase *const obj,
                    __unsafe_unretained RLMProperty *const prop,
                    __unsafe_unretained id const val) {
     REALM_ASSERT_DEBUG(!prop.isPrimary);
+
+    // Properties of primitive types are written directly to the column using
+    // the property's index rather than looking the property up by name. This
+    // bypasses Object::set_property_value(), so the KVO notifications it
+    // would send are sent here in the same way as the generated setters.
+    NSUInteger column = obj->_info->tableColumn(prop);
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSNumber<RLMInt> *>(val)); });
+        case RLMPropertyTypeFloat:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSNumber<RLMFloat> *>(val)); });
+        case RLMPropertyTypeDouble:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSNumber<RLMDouble> *>(val)); });
+        case RLMPropertyTypeBool:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSNumber<RLMBool> *>(val)); });
+        case RLMPropertyTypeString:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSString *>(val)); });
+        case RLMPropertyTypeDate:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSDate *>(val)); });
+        case RLMPropertyTypeData:
+            return setObserved(obj, prop.name, [&] { setValue(obj, column, static_cast<NSData *>(val)); });
+        default:
+            break;
+    }
+
     realm::Object o(obj->_info->realm->_realm, *obj->_info->objectSchema, obj->_row);
     RLMAccessorContext c(obj);
     translateError([&] {
-        o.set_property_value(c, prop.name.UTF8String, val ?: NSNull.null, false);
+        auto set = [&] { o.set_property_value(c, prop.name.UTF8String, val ?: NSNull.null, false); };
+        if (prop.type == RLMPropertyTypeObject) {
+            // Links can be part of a composite index
+            setIndexed(obj, column, set);
+        }
+        else {
+            set();
+        }
     });
 }
 
 id RLMDynamicGet(__unsafe_unretained RLMObjectBase *const obj, __unsafe_unretained RLMProperty *const prop) {
+    // Properties of primitive types are read directly from the column using
+    // the property's index rather than looking the property up by name
+    NSUInteger index = prop.index;
+    bool optional = prop.optional;
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+            return optional ? getBoxed<realm::util::Optional<long long>>(obj, index) : getBoxed<long long>(obj, index);
+        case RLMPropertyTypeFloat:
+            return optional ? getBoxed<realm::util::Optional<float>>(obj, index) : getBoxed<float>(obj, index);
+        case RLMPropertyTypeDouble:
+            return optional ? getBoxed<realm::util::Optional<double>>(obj, index) : getBoxed<double>(obj, index);
+        case RLMPropertyTypeBool:
+            return optional ? getBoxed<realm::util::Optional<bool>>(obj, index) : getBoxed<bool>(obj, index);
+        case RLMPropertyTypeString:
+            return getBoxed<realm::StringData>(obj, index);
+        case RLMPropertyTypeDate:
+            return getBoxed<realm::Timestamp>(obj, index);
+        case RLMPropertyTypeData:
+            return getBoxed<realm::BinaryData>(obj, index);
+        default:
+            break;
+    }
+
     realm::Object o(obj->_realm->_realm, *obj->_info->objectSchema, obj->_row);
     RLMAccessorContext c(obj);
     c.currentProperty = prop;
@@ -355,6 +355,42 @@ NS_ASSUME_NONNULL_BEGIN
                                                          RLMCollectionChange *__nullable changes,
                                                          NSError *__nullable error))block __attribute__((warn_unused_result));
 
+/**
+ Registers a block to be called on the given queue each time the array changes.
+
+ This is identical to `addNotificationBlock:`, except that the block is called
+ on `queue` rather than on the current thread, so that expensive processing of
+ the changes does not need to be performed on the current thread (for example,
+ the main thread). Unlike `addNotificationBlock:`, this method can be called
+ from threads which do not have a run loop, such as those used by dispatch queues.
+
+ The collection is observed on a background thread, and the change information
+ is computed there. The `array` passed to the block belongs to a Realm opened
+ on whichever thread `queue` is running the block on, and may only be used
+ within the block unless it is passed to another thread with an
+ `RLMThreadSafeReference`. That Realm is not cached, and is closed once the
+ block returns unless something retains it. The collection may reflect a
+ newer version of the Realm than the change information if further write
+ transactions were committed before the block was called.
+
+ You must retain the returned token for as long as you want updates to continue
+ to be sent to the block. To stop receiving updates, call `-stop` on the token.
+ Blocks which have already been dispatched to the queue when the token is
+ stopped will not be called.
+
+ @warning This method cannot be called during a write transaction, or when the
+          containing Realm is read-only.
+ @warning This method may only be called on a managed array.
+
+ @param block The block to be called each time the array changes.
+ @param queue The serial queue to call the block on.
+ @return A token which must be held for as long as you want updates to be delivered.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMArray<RLMObjectType> *__nullable array,
+                                                         RLMCollectionChange *__nullable changes,
+                                                         NSError *__nullable error))block
+                                         queue:(dispatch_queue_t)queue __attribute__((warn_unused_result));
+
 #pragma mark - Aggregating Property Values
 
 /**
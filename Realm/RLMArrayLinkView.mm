@@ -26,6 +26,7 @@
 #import "RLMProperty_Private.h"
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 #import "RLMSchema.h"
 #import "RLMThreadSafeReference_Private.hpp"
 #import "RLMUtil.hpp"
@@ -411,9 +412,14 @@ static void RLMInsertObject(RLMArrayLinkView *ar, id object, NSUInteger index) {
 }
 
 - (RLMResults *)objectsWithPredicate:(NSPredicate *)predicate {
+    RLMStatisticsTimer timer;
     auto query = RLMPredicateToQuery(predicate, _objectInfo->rlmObjectSchema, _realm.schema, _realm.group);
+    uint64_t buildNanoseconds = timer.stop();
     auto results = translateErrors([&] { return _backingList.filter(std::move(query)); });
-    return [RLMResults resultsWithObjectInfo:*_objectInfo results:std::move(results)];
+    RLMResults *filtered = [RLMResults resultsWithObjectInfo:*_objectInfo results:std::move(results)];
+    filtered.filterPredicate = predicate;
+    filtered.queryBuildNanoseconds = buildNanoseconds;
+    return filtered;
 }
 
 - (NSUInteger)indexOfObjectWithPredicate:(NSPredicate *)predicate {
@@ -461,6 +467,11 @@ static void RLMInsertObject(RLMArrayLinkView *ar, id object, NSUInteger index) {
     [_realm verifyNotificationsAreSupported];
     return RLMAddNotificationBlock(self, _backingList, block);
 }
+
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMArray *, RLMCollectionChange *, NSError *))block
+                                         queue:(dispatch_queue_t)queue {
+    return RLMAddNotificationBlockOnQueue(self, block, queue);
+}
 #pragma clang diagnostic pop
 
 #pragma mark - Thread Confined Protocol Conformance
@@ -69,6 +69,17 @@ void RLMEnsureArrayObservationInfo(std::unique_ptr<RLMObservationInfo>& info,
 @interface RLMResults () <RLMFastEnumerable>
 + (instancetype)resultsWithObjectInfo:(RLMClassInfo&)info
                               results:(realm::Results)results;
+// Results whose query is over all of the objects in the table, which can be
+// evaluated over ranges of the table's rows in parallel
++ (instancetype)resultsWithObjectInfo:(RLMClassInfo&)info
+                         tableResults:(realm::Results)results;
+
+// The predicate which the results were filtered with, or nil if they have not
+// been filtered, used to explain how their query is evaluated
+@property (nonatomic, strong) NSPredicate *filterPredicate;
+// The time taken to convert the filter predicate to a query, in nanoseconds,
+// which is included in the timing reported to the Realm's slowQueryBlock
+@property (nonatomic) uint64_t queryBuildNanoseconds;
 
 - (void)deleteObjectsFromRealm;
 @end
@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMCaseInsensitiveIndex_Private.hpp"
+
+#import "RLMClassInfo.hpp"
+#import "RLMIndexTables_Private.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
+
+#import "object_store.hpp"
+#import "shared_realm.hpp"
+
+#import <realm/group.hpp>
+#import <realm/link_view.hpp>
+#import <realm/query_engine.hpp>
+#import <realm/query_expression.hpp>
+#import <realm/table.hpp>
+#import <realm/table_view.hpp>
+
+#import <algorithm>
+#import <cstring>
+#import <set>
+#import <unordered_map>
+#import <vector>
+
+using namespace realm;
+
+namespace {
+constexpr size_t s_keyColumn = 0;
+constexpr size_t s_objectsColumn = 1;
+constexpr char s_indexTablePrefix[] = "cin_";
+
+std::string indexTableName(RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return RLMIndexTableName(s_indexTablePrefix, objectSchema, property);
+}
+
+// Fold the value in the same way as case and diacritic insensitive string
+// comparisons, so that values which compare equal have the same key and a
+// value which begins with another begins with its key
+std::string foldedKey(NSString *value) {
+    @autoreleasepool {
+        return [value stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
+                                          locale:nil].UTF8String;
+    }
+}
+
+// Move the object in the given row to the index row for `key`, or remove it
+// from the index if `key` is null
+void setKey(Table& index, Table const& objects, size_t row, StringData key) {
+    if (objects.get_backlink_count(row, index, s_objectsColumn) != 0) {
+        size_t keyRow = objects.get_backlink(row, index, s_objectsColumn, 0);
+        if (!key.is_null() && index.get_string(s_keyColumn, keyRow) == key) {
+            return;
+        }
+        auto links = index.get_linklist(s_objectsColumn, keyRow);
+        links->remove(links->find(row));
+        if (links->is_empty()) {
+            index.move_last_over(keyRow);
+        }
+    }
+    if (key.is_null()) {
+        return;
+    }
+
+    size_t keyRow = index.find_first_string(s_keyColumn, key);
+    if (keyRow == realm::not_found) {
+        keyRow = index.add_empty_row();
+        index.set_string(s_keyColumn, keyRow, key);
+    }
+    index.get_linklist(s_objectsColumn, keyRow)->add(row);
+}
+
+void createIndexTable(Group& group, std::string const& name, Table& objects, size_t column) {
+    TableRef index = group.add_table(name);
+    index->add_column(type_String, "key");
+    index->add_search_index(s_keyColumn);
+    index->add_column_link(type_LinkList, "objects", objects);
+
+    // Gather the objects with each key before writing anything so that each
+    // key's row only has to be found once
+    std::unordered_map<std::string, std::vector<size_t>> objectsForKey;
+    for (size_t row = 0, size = objects.size(); row < size; ++row) {
+        StringData value = objects.get_string(column, row);
+        if (!value.is_null()) {
+            objectsForKey[foldedKey(RLMStringDataToNSString(value))].push_back(row);
+        }
+    }
+
+    size_t keyRow = index->add_empty_row(objectsForKey.size());
+    for (auto& pair : objectsForKey) {
+        index->set_string(s_keyColumn, keyRow, pair.first);
+        auto links = index->get_linklist(s_objectsColumn, keyRow);
+        for (size_t row : pair.second) {
+            links->add(row);
+        }
+        ++keyRow;
+    }
+}
+
+// The changes to the Realm's index tables needed to match its schema
+struct IndexTableChanges {
+    struct Creation {
+        std::string name;
+        RLMObjectSchema *objectSchema;
+        RLMProperty *property;
+    };
+    std::vector<Creation> create;
+    std::vector<std::string> remove;
+
+    bool empty() const { return create.empty() && remove.empty(); }
+};
+
+IndexTableChanges indexTableChanges(RLMRealm *realm) {
+    Group& group = realm.group;
+    IndexTableChanges changes;
+
+    std::set<std::string> expected;
+    for (RLMObjectSchema *objectSchema in realm.schema.objectSchema) {
+        for (RLMProperty *property in objectSchema.properties) {
+            if (!property.caseInsensitiveIndexed) {
+                continue;
+            }
+            auto name = indexTableName(objectSchema, property);
+            if (!group.has_table(name)) {
+                changes.create.push_back({name, objectSchema, property});
+            }
+            else if (!group.get_table(name)->has_search_index(s_keyColumn)) {
+                // Index tables used to be kept sorted by key rather than
+                // having a search index
+                changes.remove.push_back(name);
+                changes.create.push_back({name, objectSchema, property});
+            }
+            expected.insert(std::move(name));
+        }
+    }
+
+    for (size_t i = 0, size = group.size(); i < size; ++i) {
+        std::string name(group.get_table_name(i));
+        if (name.compare(0, strlen(s_indexTablePrefix), s_indexTablePrefix) != 0 || expected.count(name)) {
+            continue;
+        }
+        // Only remove the indexes of classes in this Realm's schema, as the
+        // indexes of other classes may still be used by Realms opened with a
+        // different set of classes
+        auto objectTable = group.get_table(i)->get_link_target(s_objectsColumn);
+        auto objectType = ObjectStore::object_type_for_table_name(objectTable->get_name());
+        if ([realm.schema schemaForClassName:RLMStringDataToNSString(objectType)]) {
+            changes.remove.push_back(std::move(name));
+        }
+    }
+    return changes;
+}
+
+class CaseInsensitiveIndexExpression : public realm::Expression {
+public:
+    CaseInsensitiveIndexExpression(const Table& table, std::string indexName, std::string coverageName,
+                                   std::string key, bool prefix)
+    : m_table(&table), m_index_name(std::move(indexName)), m_coverage_name(std::move(coverageName))
+    , m_key(std::move(key)), m_prefix(prefix)
+    {
+    }
+
+    double init() override
+    {
+        m_rows.clear();
+        m_all = true;
+        Group* group = m_table->get_parent_group();
+        TableRef index = group ? group->get_table(m_index_name) : TableRef();
+        // Objects created without going through the binding, such as by sync,
+        // are not in the index, so it can only be used if it has every object
+        if (!index || !RLMIndexTablesCoverAllRows(*m_table, m_coverage_name)) {
+            return 50.0;
+        }
+
+        std::vector<size_t> keyRows;
+        if (m_prefix) {
+            TableView keys = index->where().begins_with(s_keyColumn, m_key).find_all();
+            for (size_t i = 0; i < keys.size(); ++i) {
+                keyRows.push_back(keys.get_source_ndx(i));
+            }
+        }
+        else {
+            size_t keyRow = index->find_first_string(s_keyColumn, m_key);
+            if (keyRow != realm::not_found) {
+                keyRows.push_back(keyRow);
+            }
+        }
+
+        for (size_t keyRow : keyRows) {
+            auto links = index->get_linklist(s_objectsColumn, keyRow);
+            for (size_t i = 0, size = links->size(); i < size; ++i) {
+                m_rows.push_back(links->get(i).get_index());
+            }
+            // Checking every row is faster than reading the links of a large
+            // part of the table and sorting them
+            if (m_rows.size() > m_table->size() / 4) {
+                m_rows.clear();
+                return 50.0;
+            }
+        }
+
+        m_all = false;
+        std::sort(m_rows.begin(), m_rows.end());
+        return 50.0;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_all) {
+            return start < end ? start : realm::not_found;
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_table = table; }
+    void verify_column() const override { REALM_ASSERT(m_table); }
+    const Table* get_base_table() const override { return m_table; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new CaseInsensitiveIndexExpression(*this));
+    }
+
+private:
+    const Table* m_table;
+    std::string m_index_name;
+    std::string m_coverage_name;
+    std::string m_key;
+    bool m_prefix;
+
+    // Whether every row is a candidate, and is left to the comparison which
+    // this is combined with, rather than only the rows in m_rows
+    bool m_all = true;
+    // The candidate rows, sorted
+    std::vector<size_t> m_rows;
+};
+} // anonymous namespace
+
+realm::Table *RLMCaseInsensitiveIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return group.get_table(indexTableName(objectSchema, property)).get();
+}
+
+bool RLMCaseInsensitiveIndexTablesNeedUpdate(RLMRealm *realm) {
+    return !indexTableChanges(realm).empty();
+}
+
+void RLMUpdateCaseInsensitiveIndexTables(RLMRealm *realm) {
+    auto changes = indexTableChanges(realm);
+    Group& group = realm.group;
+    for (auto& name : changes.remove) {
+        group.remove_table(name);
+    }
+    for (auto& creation : changes.create) {
+        auto& objects = *ObjectStore::table_for_object_type(group, creation.objectSchema.objectName.UTF8String);
+        createIndexTable(group, creation.name, objects,
+                         objects.get_column_index(creation.property.name.UTF8String));
+    }
+}
+
+void RLMUpdateCaseInsensitiveIndexes(RLMClassInfo& info, size_t row) {
+    for (auto& pair : info.caseInsensitiveIndexTables()) {
+        if (!pair.second) {
+            continue;
+        }
+        StringData value = info.table()->get_string(pair.first, row);
+        RLMUpdateCaseInsensitiveIndex(info, pair.first, row, value.is_null() ? nil : RLMStringDataToNSString(value));
+    }
+}
+
+void RLMUpdateCaseInsensitiveIndex(RLMClassInfo& info, size_t column, size_t row, NSString *value) {
+    Table *index = info.caseInsensitiveIndexTable(column);
+    if (!index) {
+        return;
+    }
+    if (!value) {
+        setKey(*index, *info.table(), row, StringData());
+        return;
+    }
+    auto key = foldedKey(value);
+    setKey(*index, *info.table(), row, key);
+}
+
+std::unique_ptr<realm::Expression> RLMMakeCaseInsensitiveIndexExpression(realm::Table& table,
+                                                                         RLMObjectSchema *objectSchema,
+                                                                         RLMProperty *property,
+                                                                         NSString *value, bool prefix) {
+    return std::unique_ptr<Expression>(new CaseInsensitiveIndexExpression(table, indexTableName(objectSchema, property),
+                                                                          RLMIndexCoverageTableName(objectSchema),
+                                                                          foldedKey(value), prefix));
+}
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+#import <memory>
+
+namespace realm {
+    class Expression;
+    class Group;
+    class Table;
+}
+class RLMClassInfo;
+@class RLMObjectSchema, RLMProperty, RLMRealm;
+
+// Case-insensitive indexes are stored in a table for each indexed property
+// which has a row for each distinct key, where a key is a value folded to be
+// case and diacritic insensitive. Each row has the key, which has a search
+// index, and a link list of the objects whose value has that key. Core removes
+// deleted objects from the link lists, so the index only needs to be updated
+// when an object is created or the property is set.
+
+// Get the table storing the case-insensitive index for the property, or
+// nullptr if it has not been created
+realm::Table *RLMCaseInsensitiveIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property);
+
+// Check if RLMUpdateCaseInsensitiveIndexTables() has anything to do
+bool RLMCaseInsensitiveIndexTablesNeedUpdate(RLMRealm *realm);
+
+// Create and populate the tables for any case-insensitive indexed properties
+// in the Realm's schema which do not have one, and remove the tables for
+// properties which are no longer case-insensitive indexed. Must be called
+// within a write transaction.
+void RLMUpdateCaseInsensitiveIndexTables(RLMRealm *realm);
+
+// Update the case-insensitive indexes of all of the properties of the object
+// in the given row after it has been created or updated from a value
+void RLMUpdateCaseInsensitiveIndexes(RLMClassInfo& info, size_t row);
+
+// Update the case-insensitive index of the column, if it has one, after the
+// value in the given row has been set
+void RLMUpdateCaseInsensitiveIndex(RLMClassInfo& info, size_t column, size_t row, NSString *value);
+
+// Create a query expression which matches the rows of `table` whose value for
+// the case-insensitive indexed property is equal to `value`, or begins with it
+// if `prefix` is true, when both are folded to keys. This matches a superset
+// of the rows which a case or diacritic insensitive comparison matches, so it
+// has to be combined with that comparison.
+std::unique_ptr<realm::Expression> RLMMakeCaseInsensitiveIndexExpression(realm::Table& table,
+                                                                         RLMObjectSchema *objectSchema,
+                                                                         RLMProperty *property,
+                                                                         NSString *value, bool prefix);
@@ -18,6 +18,7 @@
 
 #import <Foundation/Foundation.h>
 #import <unordered_map>
+#import <utility>
 #import <vector>
 
 namespace realm {
@@ -83,11 +84,89 @@ public:
     // Get the info for the target of the given property
     RLMClassInfo &linkTargetType(realm::Property const& property);
 
-    void releaseTable() { m_table = nullptr; }
+    // Get the table storing the full-text index for the given table column, or
+    // nullptr if the column does not have a full-text index
+    realm::Table *_Nullable fullTextIndexTable(NSUInteger column) const;
+
+    // Get the full-text indexed table columns paired with their index tables
+    std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> const& fullTextIndexTables() const;
+
+    // Get the table storing the ordered index for the given table column, or
+    // nullptr if the column does not have an ordered index
+    realm::Table *_Nullable orderedIndexTable(NSUInteger column) const;
+
+    // Get the ordered indexed table columns paired with their index tables
+    std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> const& orderedIndexTables() const;
+
+    // Get the table storing the case-insensitive index for the given table
+    // column, or nullptr if the column does not have a case-insensitive index
+    realm::Table *_Nullable caseInsensitiveIndexTable(NSUInteger column) const;
+
+    // Get the case-insensitive indexed table columns paired with their index
+    // tables
+    std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> const& caseInsensitiveIndexTables() const;
+
+    // Get the table columns of each composite index paired with its index
+    // table, which is nullptr if it has not been created
+    std::vector<std::pair<std::vector<NSUInteger>, realm::Table *_Nullable>> const& compositeIndexTables() const;
+
+    // Check if the given table column is part of a composite index whose table
+    // has been created
+    bool hasCompositeIndex(NSUInteger column) const;
+
+    // Get the table recording which objects have been added to the class's
+    // index tables, or nullptr if it has not been created
+    realm::Table *_Nullable indexCoverageTable() const;
+
+    void releaseTable() {
+        m_table = nullptr;
+        releaseIndexTables();
+    }
 
 private:
     mutable realm::Table *_Nullable m_table = nullptr;
     std::vector<RLMClassInfo *> m_linkTargets;
+
+    // Index tables can be created, rebuilt or removed by other RLMRealm
+    // instances, so the ones looked up are only reused while the Realm stays
+    // on the read version they were looked up at. Tables which are missing
+    // are looked up again each time, as they may be created at any version.
+    mutable uint64_t m_indexTablesVersion = 0;
+    void validateIndexTables() const;
+    // The properties to look for index tables of, which is none for Realms
+    // which can't have index tables
+    NSArray<RLMProperty *> *_Nullable indexTableProperties() const;
+    void releaseIndexTables() const {
+        m_fullTextIndexTables.clear();
+        m_fullTextIndexTablesResolved = false;
+        m_orderedIndexTables.clear();
+        m_orderedIndexTablesResolved = false;
+        m_compositeIndexTables.clear();
+        m_compositeIndexTablesResolved = false;
+        m_caseInsensitiveIndexTables.clear();
+        m_caseInsensitiveIndexTablesResolved = false;
+        m_indexCoverageTable = nullptr;
+        m_indexCoverageTableResolved = false;
+    }
+
+    mutable std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> m_fullTextIndexTables;
+    mutable bool m_fullTextIndexTablesResolved = false;
+    void resolveFullTextIndexTables() const;
+
+    mutable std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> m_orderedIndexTables;
+    mutable bool m_orderedIndexTablesResolved = false;
+    void resolveOrderedIndexTables() const;
+
+    mutable std::vector<std::pair<std::vector<NSUInteger>, realm::Table *_Nullable>> m_compositeIndexTables;
+    mutable bool m_compositeIndexTablesResolved = false;
+    void resolveCompositeIndexTables() const;
+
+    mutable std::vector<std::pair<NSUInteger, realm::Table *_Nullable>> m_caseInsensitiveIndexTables;
+    mutable bool m_caseInsensitiveIndexTablesResolved = false;
+    void resolveCaseInsensitiveIndexTables() const;
+
+    mutable realm::Table *_Nullable m_indexCoverageTable = nullptr;
+    mutable bool m_indexCoverageTableResolved = false;
 };
 
 // A per-RLMRealm object schema map which stores RLMClassInfo keyed on the name
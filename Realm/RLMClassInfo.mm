@@ -18,11 +18,15 @@
 
 #import "RLMClassInfo.hpp"
 
+#import "RLMCaseInsensitiveIndex_Private.hpp"
+#import "RLMIndexTables_Private.hpp"
 #import "RLMRealm_Private.hpp"
 #import "RLMObjectSchema_Private.h"
+#import "RLMOrderedIndex_Private.hpp"
 #import "RLMSchema.h"
 #import "RLMProperty_Private.h"
 #import "RLMQueryUtil.hpp"
+#import "RLMTextSearch_Private.hpp"
 #import "RLMUtil.hpp"
 
 #import "object_schema.hpp"
@@ -30,8 +34,11 @@
 #import "schema.hpp"
 #import "shared_realm.hpp"
 
+#import <realm/group_shared.hpp>
 #import <realm/table.hpp>
 
+#import <algorithm>
+
 using namespace realm;
 
 RLMClassInfo::RLMClassInfo(RLMRealm *realm, RLMObjectSchema *rlmObjectSchema,
@@ -83,6 +90,162 @@ RLMClassInfo &RLMClassInfo::linkTargetType(realm::Property const& property) {
     return linkTargetType(&property - &objectSchema->persisted_properties[0]);
 }
 
+void RLMClassInfo::validateIndexTables() const {
+    uint64_t version = 0;
+    auto& sharedRealm = *realm->_realm;
+    if (!sharedRealm.config().read_only()) {
+        version = _impl::RealmFriend::get_shared_group(sharedRealm).get_version_of_current_transaction().version;
+    }
+    if (version != m_indexTablesVersion) {
+        releaseIndexTables();
+        m_indexTablesVersion = version;
+    }
+}
+
+NSArray<RLMProperty *> *RLMClassInfo::indexTableProperties() const {
+    // Synced Realms never have index tables, so none are looked up for them
+    return RLMRealmSupportsIndexTables(realm) ? rlmObjectSchema.properties : nil;
+}
+
+void RLMClassInfo::resolveFullTextIndexTables() const {
+    validateIndexTables();
+    if (m_fullTextIndexTablesResolved) {
+        return;
+    }
+    m_fullTextIndexTables.clear();
+    bool resolved = true;
+    for (RLMProperty *prop in indexTableProperties()) {
+        if (prop.fullTextIndexed) {
+            Table *index = RLMFullTextIndexTable(realm.group, rlmObjectSchema, prop);
+            m_fullTextIndexTables.emplace_back(tableColumn(prop), index);
+            resolved = resolved && index;
+        }
+    }
+    m_fullTextIndexTablesResolved = resolved;
+}
+
+realm::Table *RLMClassInfo::fullTextIndexTable(NSUInteger column) const {
+    for (auto& pair : fullTextIndexTables()) {
+        if (pair.first == column) {
+            return pair.second;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::pair<NSUInteger, realm::Table *>> const& RLMClassInfo::fullTextIndexTables() const {
+    resolveFullTextIndexTables();
+    return m_fullTextIndexTables;
+}
+
+void RLMClassInfo::resolveCaseInsensitiveIndexTables() const {
+    validateIndexTables();
+    if (m_caseInsensitiveIndexTablesResolved) {
+        return;
+    }
+    m_caseInsensitiveIndexTables.clear();
+    bool resolved = true;
+    for (RLMProperty *prop in indexTableProperties()) {
+        if (prop.caseInsensitiveIndexed) {
+            Table *index = RLMCaseInsensitiveIndexTable(realm.group, rlmObjectSchema, prop);
+            m_caseInsensitiveIndexTables.emplace_back(tableColumn(prop), index);
+            resolved = resolved && index;
+        }
+    }
+    m_caseInsensitiveIndexTablesResolved = resolved;
+}
+
+realm::Table *RLMClassInfo::caseInsensitiveIndexTable(NSUInteger column) const {
+    for (auto& pair : caseInsensitiveIndexTables()) {
+        if (pair.first == column) {
+            return pair.second;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::pair<NSUInteger, realm::Table *>> const& RLMClassInfo::caseInsensitiveIndexTables() const {
+    resolveCaseInsensitiveIndexTables();
+    return m_caseInsensitiveIndexTables;
+}
+
+void RLMClassInfo::resolveOrderedIndexTables() const {
+    validateIndexTables();
+    if (m_orderedIndexTablesResolved) {
+        return;
+    }
+    m_orderedIndexTables.clear();
+    bool resolved = true;
+    for (RLMProperty *prop in indexTableProperties()) {
+        if (prop.orderedIndexed) {
+            Table *index = RLMOrderedIndexTable(realm.group, rlmObjectSchema, prop);
+            m_orderedIndexTables.emplace_back(tableColumn(prop), index);
+            resolved = resolved && index;
+        }
+    }
+    m_orderedIndexTablesResolved = resolved;
+}
+
+realm::Table *RLMClassInfo::orderedIndexTable(NSUInteger column) const {
+    for (auto& pair : orderedIndexTables()) {
+        if (pair.first == column) {
+            return pair.second;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::pair<NSUInteger, realm::Table *>> const& RLMClassInfo::orderedIndexTables() const {
+    resolveOrderedIndexTables();
+    return m_orderedIndexTables;
+}
+
+void RLMClassInfo::resolveCompositeIndexTables() const {
+    validateIndexTables();
+    if (m_compositeIndexTablesResolved) {
+        return;
+    }
+    m_compositeIndexTables.clear();
+    bool resolved = true;
+    NSArray *compositeIndexes = RLMRealmSupportsIndexTables(realm) ? rlmObjectSchema.compositeIndexes : nil;
+    for (NSArray<NSString *> *propertyNames in compositeIndexes) {
+        std::vector<NSUInteger> columns;
+        for (NSString *propertyName in propertyNames) {
+            columns.push_back(tableColumn(propertyName));
+        }
+        Table *index = RLMCompositeIndexTable(realm.group, rlmObjectSchema, propertyNames);
+        m_compositeIndexTables.emplace_back(std::move(columns), index);
+        resolved = resolved && index;
+    }
+    m_compositeIndexTablesResolved = resolved;
+}
+
+std::vector<std::pair<std::vector<NSUInteger>, realm::Table *>> const& RLMClassInfo::compositeIndexTables() const {
+    resolveCompositeIndexTables();
+    return m_compositeIndexTables;
+}
+
+bool RLMClassInfo::hasCompositeIndex(NSUInteger column) const {
+    for (auto& pair : compositeIndexTables()) {
+        if (pair.second && std::find(pair.first.begin(), pair.first.end(), column) != pair.first.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+realm::Table *RLMClassInfo::indexCoverageTable() const {
+    validateIndexTables();
+    if (!m_indexCoverageTableResolved) {
+        m_indexCoverageTable = RLMIndexCoverageTable(realm.group, rlmObjectSchema);
+        // Classes without any index tables never have a coverage table
+        m_indexCoverageTableResolved = m_indexCoverageTable
+            || (fullTextIndexTables().empty() && orderedIndexTables().empty()
+                && compositeIndexTables().empty() && caseInsensitiveIndexTables().empty());
+    }
+    return m_indexCoverageTable;
+}
+
 RLMSchemaInfo::impl::iterator RLMSchemaInfo::begin() noexcept { return m_objects.begin(); }
 RLMSchemaInfo::impl::iterator RLMSchemaInfo::end() noexcept { return m_objects.end(); }
 RLMSchemaInfo::impl::const_iterator RLMSchemaInfo::begin() const noexcept { return m_objects.begin(); }
@@ -23,12 +23,22 @@
 #import "RLMObjectStore.h"
 #import "RLMObject_Private.hpp"
 #import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
+#import "RLMRealmConfiguration_Private.h"
+#import "RLMRealmStatistics_Private.hpp"
+#import "RLMThreadSafeReference.h"
+#import "RLMUtil.hpp"
 
 #import "collection_notifications.hpp"
 #import "list.hpp"
 #import "results.hpp"
 
+#import <realm/link_view.hpp>
+#import <realm/query_expression.hpp>
+#import <realm/util/scope_exit.hpp>
 #import <realm/table_view.hpp>
+#import <mutex>
+#import <unordered_set>
 
 static const int RLMEnumerationBufferSize = 16;
 
@@ -173,6 +183,364 @@ NSArray *RLMCollectionValueForKey(id<RLMFastEnumerable> collection, NSString *ke
     return results;
 }
 
+namespace {
+// A key path resolved once to a chain of link columns in core. The values at
+// the end of the chain are read for each row of the collection with core's
+// link-following column expressions, so no accessors are created for the
+// intermediate objects.
+class RLMLinkChain {
+public:
+    // If `includeLastProperty` is true, the final property of the key path
+    // must be a link and is followed like the others, and the chain refers to
+    // the objects it links to rather than to a property of the final object.
+    RLMLinkChain(RLMClassInfo& info, NSString *keyPath, bool includeLastProperty)
+    : m_table(info.table()), m_info(&info) {
+        NSArray<NSString *> *names = [keyPath componentsSeparatedByString:@"."];
+        NSUInteger linkCount = includeLastProperty ? names.count : names.count - 1;
+        for (NSUInteger i = 0; i < names.count; ++i) {
+            RLMProperty *prop = m_info->rlmObjectSchema[names[i]];
+            if (!prop) {
+                @throw RLMException(@"Property '%@' not found in object of type '%@'",
+                                    names[i], m_info->rlmObjectSchema.className);
+            }
+            if (i == linkCount) {
+                m_property = prop;
+                break;
+            }
+            append_link(prop, keyPath);
+        }
+        m_column = make_column();
+    }
+
+    RLMClassInfo& info() const { return *m_info; }
+    RLMProperty *property() const { return m_property; }
+    size_t to_many_link_count() const { return m_toManyLinkCount; }
+
+    // Whether the values at the end of the chain can be read from core
+    // rather than through accessors
+    bool has_column() const { return m_column != nullptr; }
+
+    // Whether the chain ends in a link, so that it reaches objects rather
+    // than values
+    bool reaches_objects() const { return !m_property || m_property.type == RLMPropertyTypeObject; }
+
+    // Evaluate the values of the final property for the row of the
+    // collection's table into `value`
+    void evaluate(size_t row, realm::ValueBase& value) const {
+        m_column->evaluate(row, value);
+    }
+
+    // The rows reached from the row of the collection's table when the chain
+    // ends in a link
+    std::vector<size_t> target_rows(size_t row) const {
+        return m_linkMap.get_links(row);
+    }
+
+    // The values of the final property reached from the row, or the objects
+    // reached if the chain ends in a link
+    NSMutableArray *values(size_t row) const {
+        NSMutableArray *values = [NSMutableArray new];
+        if (reaches_objects()) {
+            RLMClassInfo& targetInfo = m_property ? m_info->linkTargetType(m_property.index) : *m_info;
+            for (size_t target : target_rows(row)) {
+                [values addObject:RLMCreateObjectAccessor(m_info->realm, targetInfo, target)];
+            }
+            return values;
+        }
+
+        auto read = [&](auto value, auto box) {
+            m_column->evaluate(row, value);
+            for (size_t i = 0; i < value.m_values; ++i) {
+                if (value.m_storage.is_null(i)) {
+                    [values addObject:NSNull.null];
+                }
+                else {
+                    [values addObject:box(value.m_storage[i])];
+                }
+            }
+        };
+        switch (m_property.type) {
+            case RLMPropertyTypeInt:
+                read(realm::Value<realm::Int>(), [](int64_t v) { return @(v); });
+                break;
+            case RLMPropertyTypeBool:
+                read(realm::Value<realm::Bool>(), [](bool v) { return @(v); });
+                break;
+            case RLMPropertyTypeFloat:
+                read(realm::Value<realm::Float>(), [](float v) { return @(v); });
+                break;
+            case RLMPropertyTypeDouble:
+                read(realm::Value<realm::Double>(), [](double v) { return @(v); });
+                break;
+            case RLMPropertyTypeString:
+                read(realm::Value<realm::StringData>(), [](realm::StringData v) { return RLMStringDataToNSString(v); });
+                break;
+            case RLMPropertyTypeData:
+                read(realm::Value<realm::BinaryData>(), [](realm::BinaryData v) { return RLMBinaryDataToNSData(v); });
+                break;
+            case RLMPropertyTypeDate:
+                read(realm::Value<realm::Timestamp>(), [](realm::Timestamp v) { return RLMTimestampToNSDate(v); });
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+        return values;
+    }
+
+private:
+    struct Link {
+        RLMPropertyType type;
+        size_t column;
+        // Only set for linking objects, where `column` is in this table
+        realm::Table *origin_table;
+    };
+    realm::Table *m_table;
+    RLMClassInfo *m_info;
+    RLMProperty *m_property = nil;
+    std::vector<Link> m_links;
+    size_t m_toManyLinkCount = 0;
+    std::unique_ptr<realm::Subexpr> m_column;
+    mutable realm::LinkMap m_linkMap;
+
+    void append_link(RLMProperty *prop, NSString *keyPath) {
+        switch (prop.type) {
+            case RLMPropertyTypeObject:
+            case RLMPropertyTypeArray:
+                m_links.push_back({prop.type, m_info->tableColumn(prop), nullptr});
+                m_info = &m_info->linkTargetType(prop.index);
+                break;
+            case RLMPropertyTypeLinkingObjects: {
+                RLMClassInfo& originInfo = m_info->realm->_info[prop.objectClassName];
+                m_links.push_back({prop.type, originInfo.tableColumn(prop.linkOriginPropertyName),
+                                   originInfo.table()});
+                m_info = &originInfo;
+                break;
+            }
+            default:
+                @throw RLMException(@"Property '%@' in key path '%@' is not a link in object of type '%@'",
+                                    prop.name, keyPath, m_info->rlmObjectSchema.className);
+        }
+        m_toManyLinkCount += prop.type != RLMPropertyTypeObject;
+    }
+
+    // Set the first `count` links as the link chain of the next column
+    // expression created from the table
+    void apply_links(size_t count) const {
+        for (size_t i = 0; i < count; ++i) {
+            auto& link = m_links[i];
+            if (link.type == RLMPropertyTypeLinkingObjects) {
+                m_table->backlink(*link.origin_table, link.column);
+            }
+            else {
+                m_table->link(link.column);
+            }
+        }
+    }
+
+    std::unique_ptr<realm::Subexpr> make_column() {
+        if (!m_property) {
+            // The chain ends at the objects its last link reaches
+            auto& last = m_links.back();
+            apply_links(m_links.size() - 1);
+            auto column = last.type == RLMPropertyTypeLinkingObjects
+                        ? m_table->column<realm::Link>(*last.origin_table, last.column)
+                        : m_table->column<realm::Link>(last.column);
+            m_linkMap = column.link_map();
+            return column.clone();
+        }
+
+        // Lists and linking objects at the end of a key path are read
+        // through accessors, as their values are collections
+        switch (m_property.type) {
+            case RLMPropertyTypeInt:
+            case RLMPropertyTypeBool:
+            case RLMPropertyTypeFloat:
+            case RLMPropertyTypeDouble:
+            case RLMPropertyTypeString:
+            case RLMPropertyTypeData:
+            case RLMPropertyTypeDate:
+            case RLMPropertyTypeObject:
+                break;
+            default:
+                return nullptr;
+        }
+
+        apply_links(m_links.size());
+        size_t column = m_info->tableColumn(m_property);
+        switch (m_property.type) {
+            case RLMPropertyTypeInt:    return m_table->column<realm::Int>(column).clone();
+            case RLMPropertyTypeBool:   return m_table->column<realm::Bool>(column).clone();
+            case RLMPropertyTypeFloat:  return m_table->column<realm::Float>(column).clone();
+            case RLMPropertyTypeDouble: return m_table->column<realm::Double>(column).clone();
+            case RLMPropertyTypeString: return m_table->column<realm::String>(column).clone();
+            case RLMPropertyTypeData:   return m_table->column<realm::Binary>(column).clone();
+            case RLMPropertyTypeDate:   return m_table->column<realm::Timestamp>(column).clone();
+            case RLMPropertyTypeObject: {
+                auto links = m_table->column<realm::Link>(column);
+                m_linkMap = links.link_map();
+                return links.clone();
+            }
+            default:
+                REALM_UNREACHABLE();
+        }
+    }
+};
+
+// Sums match the types core uses for Table::sum_*()
+template<typename T> struct RLMSumType { using type = double; };
+template<> struct RLMSumType<int64_t> { using type = int64_t; };
+
+void RLMAddToSum(int64_t& sum, int64_t value) { sum += value; }
+void RLMAddToSum(double& sum, float value) { sum += value; }
+void RLMAddToSum(double& sum, double value) { sum += value; }
+void RLMAddToSum(double&, realm::Timestamp) { }
+
+template<typename Func>
+void RLMForEachRow(id<RLMFastEnumerable> collection, Func&& func) {
+    realm::TableView tv = [collection tableView];
+    for (size_t i = 0, size = tv.size(); i < size; ++i) {
+        if (tv.is_row_attached(i)) {
+            func(tv.get_source_ndx(i));
+        }
+    }
+}
+
+// Whether NSArray's KVC would give a value for the key path which the link
+// chain can't produce directly: either arrays nested more than one level, or
+// collections at the end of the key path
+bool RLMNeedsAccessorsForKeyPath(RLMLinkChain const& chain) {
+    return chain.to_many_link_count() > 1 || !chain.has_column();
+}
+} // anonymous namespace
+
+NSArray *RLMCollectionValueForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath) {
+    if (collection.count == 0) {
+        return @[];
+    }
+
+    RLMClassInfo& info = *collection.objectInfo;
+    RLMLinkChain chain(info, keyPath, false);
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:collection.count];
+    if (RLMNeedsAccessorsForKeyPath(chain)) {
+        RLMRealm *realm = collection.realm;
+        RLMForEachRow(collection, [&](size_t row) {
+            [results addObject:[RLMCreateObjectAccessor(realm, info, row) valueForKeyPath:keyPath] ?: NSNull.null];
+        });
+        return results;
+    }
+
+    // As with NSArray, each object contributes one value, which is an array
+    // of the values reached if the key path has a to-many relationship
+    bool toMany = chain.to_many_link_count() != 0;
+    RLMForEachRow(collection, [&](size_t row) {
+        NSArray *values = chain.values(row);
+        [results addObject:toMany ? values : values.firstObject ?: NSNull.null];
+    });
+    return results;
+}
+
+NSArray *RLMCollectionObjectsForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath, bool distinct) {
+    if (collection.count == 0) {
+        return @[];
+    }
+
+    RLMClassInfo& info = *collection.objectInfo;
+    RLMLinkChain chain(info, keyPath, true);
+    if (chain.to_many_link_count() == 0) {
+        @throw RLMException(@"Key path '%@' must end in a to-many relationship for KVC array collection operators.", keyPath);
+    }
+
+    RLMRealm *realm = collection.realm;
+    if (chain.to_many_link_count() > 1) {
+        // NSArray only flattens the outermost level of arrays
+        NSMutableArray *objects = [NSMutableArray new];
+        RLMForEachRow(collection, [&](size_t row) {
+            for (id value in [RLMCreateObjectAccessor(realm, info, row) valueForKeyPath:keyPath]) {
+                [objects addObject:value];
+            }
+        });
+        return distinct ? [NSOrderedSet orderedSetWithArray:objects].array : objects;
+    }
+
+    std::vector<size_t> rows;
+    std::unordered_set<size_t> seen;
+    RLMForEachRow(collection, [&](size_t row) {
+        for (size_t target : chain.target_rows(row)) {
+            if (!distinct || seen.insert(target).second) {
+                rows.push_back(target);
+            }
+        }
+    });
+
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:rows.size()];
+    for (size_t row : rows) {
+        [objects addObject:RLMCreateObjectAccessor(realm, chain.info(), row)];
+    }
+    return objects;
+}
+
+id RLMCollectionAggregateForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath,
+                                    RLMCollectionAggregate aggregate, NSString *methodName) {
+    RLMLinkChain chain(*collection.objectInfo, keyPath, false);
+    RLMProperty *prop = chain.property();
+
+    auto unsupported = [&] {
+        return RLMException(@"%@ is not supported for %@ property '%@'",
+                            methodName, RLMTypeToString(prop.type), keyPath);
+    };
+
+    // Accumulates the non-null values reached from each row, which core's
+    // column expression reads by following the links
+    auto reduce = [&](auto value) -> id {
+        using T = std::decay_t<decltype(value.m_storage[0])>;
+        realm::util::Optional<T> best;
+        typename RLMSumType<T>::type sum = 0;
+        size_t count = 0;
+        RLMForEachRow(collection, [&](size_t row) {
+            chain.evaluate(row, value);
+            for (size_t i = 0; i < value.m_values; ++i) {
+                if (value.m_storage.is_null(i)) {
+                    continue;
+                }
+                T v = value.m_storage[i];
+                if (!best
+                    || (aggregate == RLMCollectionAggregate::Min && v < *best)
+                    || (aggregate == RLMCollectionAggregate::Max && *best < v)) {
+                    best = v;
+                }
+                RLMAddToSum(sum, v);
+                ++count;
+            }
+        });
+
+        switch (aggregate) {
+            case RLMCollectionAggregate::Min:
+            case RLMCollectionAggregate::Max:
+                return best ? RLMMixedToObjc(realm::Mixed(*best)) : nil;
+            case RLMCollectionAggregate::Sum:
+                return @(sum);
+            case RLMCollectionAggregate::Average:
+                return count ? @(static_cast<double>(sum) / count) : nil;
+        }
+    };
+
+    switch (prop.type) {
+        case RLMPropertyTypeInt:
+            return reduce(realm::Value<realm::Int>());
+        case RLMPropertyTypeFloat:
+            return reduce(realm::Value<realm::Float>());
+        case RLMPropertyTypeDouble:
+            return reduce(realm::Value<realm::Double>());
+        case RLMPropertyTypeDate:
+            if (aggregate != RLMCollectionAggregate::Min && aggregate != RLMCollectionAggregate::Max) {
+                @throw unsupported();
+            }
+            return reduce(realm::Value<realm::Timestamp>());
+        default:
+            @throw unsupported();
+    }
+}
+
 void RLMCollectionSetValueForKey(id<RLMFastEnumerable> collection, NSString *key, id value) {
     realm::TableView tv = [collection tableView];
     if (tv.size() == 0) {
@@ -328,8 +696,22 @@ RLMNotificationToken *RLMAddNotificationBlock(id objcCollection,
     };
 
     auto skip = suppressInitialChange ? std::make_shared<bool>(true) : nullptr;
+    RLMRealm *objcRealm = [objcCollection realm];
+    std::weak_ptr<RLMStatisticsCounters> weakStatistics;
+    if (objcRealm) {
+        RLMGetStatisticsCounters(objcRealm);
+        weakStatistics = objcRealm->_statistics;
+    }
     auto cb = [=, &collection](realm::CollectionChangeSet const& changes,
                                std::exception_ptr err) {
+        RLMStatisticsTimer timer;
+        auto recordNotification = realm::util::make_scope_exit([&]() noexcept {
+            if (auto statistics = weakStatistics.lock()) {
+                RLMStatisticsCounters::increment(statistics->collectionNotifications);
+                RLMStatisticsCounters::increment(statistics->collectionNotificationNanoseconds, timer.stop());
+            }
+        });
+
         if (err) {
             try {
                 rethrow_exception(err);
@@ -359,7 +741,227 @@ RLMNotificationToken *RLMAddNotificationBlock(id objcCollection,
     };
 
     return [[RLMCancellationToken alloc] initWithToken:collection.add_notification_callback(cb)
-                                                 realm:(RLMRealm *)[objcCollection realm]];
+                                                 realm:objcRealm];
+}
+
+// A thread which runs a run loop forever, used to observe collections whose
+// notification blocks are called on a dispatch queue rather than on the
+// thread which registered them
+@interface RLMNotificationWorker : NSObject
++ (instancetype)sharedWorker;
+- (void)performBlock:(dispatch_block_t)block;
+@end
+
+@implementation RLMNotificationWorker {
+    CFRunLoopRef _runLoop;
+}
+
++ (instancetype)sharedWorker {
+    static RLMNotificationWorker *worker;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        worker = [[RLMNotificationWorker alloc] initPrivate];
+    });
+    return worker;
+}
+
+- (instancetype)initPrivate {
+    if (self = [super init]) {
+        dispatch_semaphore_t started = dispatch_semaphore_create(0);
+        NSThread *thread = [[NSThread alloc] initWithTarget:self selector:@selector(run:) object:started];
+        thread.name = @"io.realm.notifications";
+        [thread start];
+        dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    }
+    return self;
+}
+
+- (void)run:(dispatch_semaphore_t)started {
+    _runLoop = CFRunLoopGetCurrent();
+    // The run loop exits immediately if it has no sources, so add one which
+    // never fires to keep it running while nothing is being observed
+    CFRunLoopSourceContext context = {};
+    CFRunLoopSourceRef source = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+    CFRunLoopAddSource(_runLoop, source, kCFRunLoopDefaultMode);
+    CFRelease(source);
+    dispatch_semaphore_signal(started);
+    while (true) {
+        @autoreleasepool {
+            CFRunLoopRun();
+        }
+    }
+}
+
+- (void)performBlock:(dispatch_block_t)block {
+    CFRunLoopPerformBlock(_runLoop, kCFRunLoopDefaultMode, ^{
+        @autoreleasepool {
+            block();
+        }
+    });
+    CFRunLoopWakeUp(_runLoop);
+}
+
+@end
+
+@interface RLMQueueNotificationToken : RLMNotificationToken
+@property (nonatomic, readonly, getter=isStopped) bool stopped;
+- (void)setWorkerToken:(RLMNotificationToken *)token collection:(id)collection;
+@end
+
+@implementation RLMQueueNotificationToken {
+    std::mutex _mutex;
+    bool _stopped;
+    // Only created, used and released on the notification worker thread
+    RLMNotificationToken *_workerToken;
+    id _workerCollection;
+}
+
+- (bool)isStopped {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stopped;
+}
+
+- (void)setWorkerToken:(RLMNotificationToken *)token collection:(id)collection {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_stopped) {
+        [token stop];
+        return;
+    }
+    _workerToken = token;
+    _workerCollection = collection;
+}
+
+- (RLMRealm *)realm {
+    return nil;
+}
+
+- (void)suppressNextNotification {
+}
+
+- (void)stop {
+    RLMNotificationToken *token;
+    id collection;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+        token = _workerToken;
+        collection = _workerCollection;
+        _workerToken = nil;
+        _workerCollection = nil;
+    }
+    if (token) {
+        // The worker's Realm and collection must be released on its thread
+        [RLMNotificationWorker.sharedWorker performBlock:^{
+            [token stop];
+            (void)collection;
+        }];
+    }
+}
+
+- (void)dealloc {
+    [self stop];
+}
+
+@end
+
+RLMNotificationToken *RLMAddNotificationBlockOnQueue(id<RLMThreadConfined> value, dispatch_queue_t queue,
+                                                     void (^errorBlock)(NSError *),
+                                                     RLMNotificationToken *(^observe)(id, RLMQueueDeliverBlock)) {
+    // Unlike RLMAddNotificationBlock() this does not need a run loop on the
+    // current thread, as the value is only observed on the worker thread
+    RLMRealm *realm = value.realm;
+    [realm verifyThread];
+    if (realm.configuration.readOnly) {
+        @throw RLMException(@"Read-only Realms do not change and do not have change notifications");
+    }
+    if (realm.inWriteTransaction) {
+        @throw RLMException(@"Cannot register notification blocks from within write transactions.");
+    }
+
+    RLMRealmConfiguration *configuration = realm.configuration;
+    // Deliveries run on whichever thread the queue happens to be using, so
+    // the Realm they resolve into must not be added to the per-thread cache,
+    // where it would stay open and keep its read version pinned after the
+    // delivery returns
+    RLMRealmConfiguration *deliveryConfiguration = [configuration copy];
+    deliveryConfiguration.cache = false;
+
+    RLMThreadSafeReference *reference = [RLMThreadSafeReference referenceWithThreadConfined:value];
+    RLMQueueNotificationToken *token = [[RLMQueueNotificationToken alloc] init];
+    __weak RLMQueueNotificationToken *weakToken = token;
+
+    auto dispatch = ^(dispatch_block_t delivery) {
+        dispatch_async(queue, ^{
+            RLMQueueNotificationToken *token = weakToken;
+            if (token && !token.stopped) {
+                @autoreleasepool {
+                    delivery();
+                }
+            }
+        });
+    };
+    RLMQueueDeliverBlock deliver = ^(id<RLMThreadConfined> current, void (^delivery)(id)) {
+        if (!current) {
+            dispatch(^{ delivery(nil); });
+            return;
+        }
+        RLMThreadSafeReference *currentReference = [RLMThreadSafeReference referenceWithThreadConfined:current];
+        dispatch(^{
+            NSError *error;
+            RLMRealm *queueRealm = [RLMRealm realmWithConfiguration:deliveryConfiguration error:&error];
+            if (!queueRealm) {
+                errorBlock(error);
+                return;
+            }
+            if (id resolved = [queueRealm resolveThreadSafeReference:currentReference]) {
+                delivery(resolved);
+            }
+        });
+    };
+
+    [RLMNotificationWorker.sharedWorker performBlock:^{
+        RLMQueueNotificationToken *token = weakToken;
+        if (!token || token.stopped) {
+            return;
+        }
+
+        // The worker thread is long-lived and owns a single Realm per
+        // configuration, so using the normal cache here is fine
+        NSError *error;
+        RLMRealm *workerRealm = [RLMRealm realmWithConfiguration:configuration error:&error];
+        if (!workerRealm) {
+            dispatch(^{ errorBlock(error); });
+            return;
+        }
+        id workerValue = [workerRealm resolveThreadSafeReference:reference];
+        if (!workerValue) {
+            // The value (or the object owning it) was deleted before we got here
+            return;
+        }
+
+        // The change set is computed on the background notifier thread and
+        // delivered to this thread; only the handover of the value to the
+        // target queue happens here
+        RLMNotificationToken *workerToken = observe(workerValue, deliver);
+        [token setWorkerToken:workerToken collection:workerValue];
+    }];
+    return token;
+}
+
+RLMNotificationToken *RLMAddNotificationBlockOnQueue(id<RLMThreadConfined> collection,
+                                                     void (^block)(id, RLMCollectionChange *, NSError *),
+                                                     dispatch_queue_t queue) {
+    return RLMAddNotificationBlockOnQueue(collection, queue, ^(NSError *error) {
+        block(nil, nil, error);
+    }, ^(id workerCollection, RLMQueueDeliverBlock deliver) {
+        return [workerCollection addNotificationBlock:^(id current, RLMCollectionChange *change, NSError *error) {
+            if (error) {
+                deliver(nil, ^(id) { block(nil, nil, error); });
+                return;
+            }
+            deliver(current, ^(id resolved) { block(resolved, change, nil); });
+        }];
+    });
 }
 
 // Explicitly instantiate the templated function for the two types we'll use it on
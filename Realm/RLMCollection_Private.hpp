@@ -26,6 +26,7 @@ namespace realm {
     struct NotificationToken;
 }
 class RLMClassInfo;
+@protocol RLMThreadConfined;
 
 @protocol RLMFastEnumerable
 @property (nonatomic, readonly) RLMRealm *realm;
@@ -64,9 +65,49 @@ class RLMClassInfo;
 - (instancetype)initWithChanges:(realm::CollectionChangeSet)indices;
 @end
 
+enum class RLMCollectionAggregate {
+    Min,
+    Max,
+    Sum,
+    Average,
+};
+
+// Evaluate a key path which may traverse links for each object in the
+// collection, following the links with core's link column expressions rather
+// than creating accessor objects for the intermediate objects. As with
+// NSArray, each object contributes one value, which is an array if the key
+// path includes a to-many relationship.
+NSArray *RLMCollectionValueForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath);
+
+// Get the objects at the end of a key path which includes at least one to-many
+// relationship, optionally skipping objects which have already been reached
+NSArray *RLMCollectionObjectsForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath, bool distinct);
+
+// Aggregate the values at the end of a key path which may traverse links
+id RLMCollectionAggregateForKeyPath(id<RLMFastEnumerable> collection, NSString *keyPath,
+                                    RLMCollectionAggregate aggregate, NSString *methodName);
+
 template<typename Collection>
 RLMNotificationToken *RLMAddNotificationBlock(id objcCollection,
                                               Collection& collection,
                                               void (^block)(id, RLMCollectionChange *, NSError *),
                                               bool suppressInitialChange=false);
 
+// Hands `current` (which may be nil) over to the target queue and calls the
+// block there with it resolved in an uncached Realm
+typedef void (^RLMQueueDeliverBlock)(id<RLMThreadConfined> current, void (^)(id resolved));
+
+// Resolve the value on a background thread with a run loop and call `observe`
+// there to register the notification block, which should use the passed
+// deliver block to call the user's block on the given queue
+RLMNotificationToken *RLMAddNotificationBlockOnQueue(id<RLMThreadConfined> value, dispatch_queue_t queue,
+                                                     void (^errorBlock)(NSError *),
+                                                     RLMNotificationToken *(^observe)(id, RLMQueueDeliverBlock));
+
+// Observe the collection on a background thread with a run loop, and call the
+// block on the given queue with the collection resolved in an uncached Realm
+// opened on the thread the queue is running on
+RLMNotificationToken *RLMAddNotificationBlockOnQueue(id<RLMThreadConfined> collection,
+                                                     void (^block)(id, RLMCollectionChange *, NSError *),
+                                                     dispatch_queue_t queue);
+
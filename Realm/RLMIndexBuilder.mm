@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMIndexBuilder_Private.hpp"
+
+#import "RLMRealmConfiguration_Private.hpp"
+#import "RLMRealm_Private.h"
+
+#import "impl/realm_coordinator.hpp"
+#import "object_schema.hpp"
+#import "object_store.hpp"
+#import "property.hpp"
+#import "schema.hpp"
+#import "shared_realm.hpp"
+
+#import <realm/group.hpp>
+#import <realm/table.hpp>
+
+using namespace realm;
+
+std::vector<RLMDeferredSearchIndex> RLMDeferSearchIndexes(Group& group, Schema& schema) {
+    std::vector<RLMDeferredSearchIndex> deferred;
+    for (auto& objectSchema : schema) {
+        ConstTableRef table = ObjectStore::table_for_object_type(group, objectSchema.name);
+        // Building an index for an empty table takes no time
+        if (!table || table->is_empty()) {
+            continue;
+        }
+        for (auto& property : objectSchema.persisted_properties) {
+            if (!property.is_indexed || property.is_primary) {
+                continue;
+            }
+            size_t column = table->get_column_index(property.name);
+            if (column != realm::npos && table->has_search_index(column)) {
+                continue;
+            }
+            property.is_indexed = false;
+            deferred.push_back({objectSchema.name, property.name});
+        }
+    }
+    return deferred;
+}
+
+static dispatch_queue_t indexBuildQueue() {
+    static dispatch_queue_t queue = dispatch_queue_create("io.realm.index-build", DISPATCH_QUEUE_SERIAL);
+    return queue;
+}
+
+void RLMBuildSearchIndexesInBackground(RLMRealmConfiguration *configuration,
+                                       std::vector<RLMDeferredSearchIndex> indexes) {
+    configuration = [configuration copy];
+    auto shared = std::make_shared<std::vector<RLMDeferredSearchIndex>>(std::move(indexes));
+    dispatch_async(indexBuildQueue(), ^{
+        @autoreleasepool {
+            auto& indexes = *shared;
+            auto progress = configuration.indexBuildProgressBlock;
+            size_t built = 0;
+            try {
+                // The file was already checked for compaction when it was
+                // opened on the calling thread
+                Realm::Config config = configuration.config;
+                config.should_compact_on_launch_function = nullptr;
+                auto realm = Realm::get_shared_realm(config);
+
+                // Realms opened after this one are given the schema cached by
+                // the coordinator, which still has the deferred properties
+                // unindexed, so it's updated as each index is built
+                Schema schema = realm->schema();
+                auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+
+                // Build each index in its own write transaction so that other
+                // threads can write between them
+                for (auto& index : indexes) {
+                    realm->begin_transaction();
+                    TableRef table = ObjectStore::table_for_object_type(realm->read_group(), index.objectType);
+                    size_t column = table ? table->get_column_index(index.propertyName) : realm::npos;
+                    // Another Realm may have built it while this one was waiting
+                    if (column != realm::npos && !table->has_search_index(column)) {
+                        table->add_search_index(column);
+                    }
+                    realm->commit_transaction();
+
+                    auto objectSchema = schema.find(index.objectType);
+                    if (objectSchema != schema.end()) {
+                        if (auto property = objectSchema->property_for_name(index.propertyName)) {
+                            property->is_indexed = true;
+                        }
+                    }
+                    if (coordinator) {
+                        coordinator->update_schema(schema, realm->schema_version());
+                    }
+
+                    ++built;
+                    if (progress) {
+                        progress(built, indexes.size(), nil);
+                    }
+                }
+                realm->close();
+            }
+            catch (...) {
+                // The remaining indexes are deferred again the next time the
+                // Realm is opened
+                NSError *error;
+                RLMRealmTranslateException(&error);
+                if (progress) {
+                    progress(built, indexes.size(), error);
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+#import <string>
+#import <vector>
+
+namespace realm {
+    class Group;
+    class Schema;
+}
+@class RLMRealmConfiguration;
+
+// A search index which is built in the background after the Realm is opened
+struct RLMDeferredSearchIndex {
+    std::string objectType;
+    std::string propertyName;
+};
+
+// Remove the search indexes which would have to be built for non-empty tables
+// from the schema, so that opening the Realm does not build them, and return
+// the removed indexes. Primary keys are always indexed while opening.
+std::vector<RLMDeferredSearchIndex> RLMDeferSearchIndexes(realm::Group& group, realm::Schema& schema);
+
+// Build the deferred search indexes on a background queue, one index per
+// write transaction, calling the configuration's indexBuildProgressBlock after
+// each one, or with the error if building one fails. Queries use the index
+// once it has been built.
+void RLMBuildSearchIndexesInBackground(RLMRealmConfiguration *configuration,
+                                       std::vector<RLMDeferredSearchIndex> indexes);
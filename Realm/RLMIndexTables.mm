@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMIndexTables_Private.hpp"
+
+#import "RLMCaseInsensitiveIndex_Private.hpp"
+#import "RLMClassInfo.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMOrderedIndex_Private.hpp"
+#import "RLMRealmConfiguration_Private.h"
+#import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMTextSearch_Private.hpp"
+#import "RLMUtil.hpp"
+
+#import "object_store.hpp"
+#import "shared_realm.hpp"
+
+#import <realm/group.hpp>
+#import <realm/link_view.hpp>
+#import <realm/table.hpp>
+
+using namespace realm;
+
+namespace {
+constexpr char s_coverageTablePrefix[] = "cov_";
+constexpr size_t s_coveredObjectsColumn = 0;
+
+template<typename Fn>
+void forEachLinkTarget(Table const& table, Fn&& fn) {
+    for (size_t col = 0, count = table.get_column_count(); col < count; ++col) {
+        auto type = table.get_column_type(col);
+        if (type == type_Link || type == type_LinkList) {
+            fn(*table.get_link_target(col));
+        }
+    }
+}
+
+// Index tables which link to a class which is not in the Realm's schema. This
+// can only be determined when the schema is the complete schema rather than a
+// subset of the classes in the file.
+std::vector<std::string> orphanedIndexTables(RLMRealm *realm) {
+    std::vector<std::string> orphans;
+    if (realm.configuration.customSchema) {
+        return orphans;
+    }
+
+    Group& group = realm.group;
+    RLMSchema *schema = realm.schema;
+    for (size_t i = 0, count = group.size(); i < count; ++i) {
+        auto name = group.get_table_name(i);
+        if (!RLMIsIndexTableName(name)) {
+            continue;
+        }
+        bool orphaned = false;
+        forEachLinkTarget(*group.get_table(i), [&](Table const& target) {
+            auto objectType = ObjectStore::object_type_for_table_name(target.get_name());
+            if (!objectType.size() || ![schema schemaForClassName:RLMStringDataToNSString(objectType)]) {
+                orphaned = true;
+            }
+        });
+        if (orphaned) {
+            orphans.push_back(name);
+        }
+    }
+    return orphans;
+}
+
+bool hasIndexTables(RLMObjectSchema *objectSchema) {
+    if (objectSchema.compositeIndexes.count) {
+        return true;
+    }
+    for (RLMProperty *property in objectSchema.properties) {
+        if (property.fullTextIndexed || property.orderedIndexed || property.caseInsensitiveIndexed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool coversAllRows(Table const* coverage, Table const& objects) {
+    return coverage && coverage->size() == 1
+        && coverage->get_linklist(s_coveredObjectsColumn, 0)->size() == objects.size();
+}
+
+// The changes to the Realm's coverage tables needed to match its schema
+struct CoverageChanges {
+    // Classes whose index tables have to be rebuilt, as they are missing
+    // some objects or have never been created
+    std::vector<RLMObjectSchema *> rebuild;
+    // Coverage tables of classes which no longer have any index tables
+    std::vector<std::string> remove;
+
+    bool empty() const { return rebuild.empty() && remove.empty(); }
+};
+
+CoverageChanges coverageChanges(RLMRealm *realm) {
+    Group& group = realm.group;
+    CoverageChanges changes;
+    for (RLMObjectSchema *objectSchema in realm.schema.objectSchema) {
+        auto objects = ObjectStore::table_for_object_type(group, objectSchema.objectName.UTF8String);
+        auto name = RLMIndexCoverageTableName(objectSchema);
+        auto coverage = group.get_table(name);
+        if (hasIndexTables(objectSchema)) {
+            if (objects && !coversAllRows(coverage.get(), *objects)) {
+                changes.rebuild.push_back(objectSchema);
+            }
+        }
+        else if (coverage) {
+            changes.remove.push_back(std::move(name));
+        }
+    }
+    return changes;
+}
+
+void createCoverageTable(Group& group, std::string const& name, Table& objects) {
+    TableRef coverage = group.add_table(name);
+    coverage->add_column_link(type_LinkList, "objects", objects);
+    coverage->add_empty_row();
+    auto links = coverage->get_linklist(s_coveredObjectsColumn, 0);
+    for (size_t row = 0, size = objects.size(); row < size; ++row) {
+        links->add(row);
+    }
+}
+
+bool indexTablesNeedUpdate(RLMRealm *realm) {
+    return !orphanedIndexTables(realm).empty()
+        || !coverageChanges(realm).empty()
+        || RLMFullTextIndexTablesNeedUpdate(realm)
+        || RLMOrderedIndexTablesNeedUpdate(realm)
+        || RLMCaseInsensitiveIndexTablesNeedUpdate(realm);
+}
+} // anonymous namespace
+
+bool RLMRealmSupportsIndexTables(RLMRealm *realm) {
+    return !realm->_realm->config().sync_config;
+}
+
+void RLMUpdateIndexTables(RLMRealm *realm) {
+    if (!RLMRealmSupportsIndexTables(realm) || !indexTablesNeedUpdate(realm)) {
+        return;
+    }
+
+    auto& sharedRealm = realm->_realm;
+    sharedRealm->begin_transaction();
+    try {
+        // Another process may have made the changes while we were waiting
+        // for the write lock, so check what's needed again
+        if (!indexTablesNeedUpdate(realm)) {
+            sharedRealm->cancel_transaction();
+            return;
+        }
+
+        Group& group = realm.group;
+        for (auto& name : orphanedIndexTables(realm)) {
+            group.remove_table(name);
+        }
+
+        // Index tables which are missing objects are removed so that the
+        // per-kind updates recreate them from all of the objects
+        auto coverage = coverageChanges(realm);
+        for (auto& name : coverage.remove) {
+            group.remove_table(name);
+        }
+        for (RLMObjectSchema *objectSchema in coverage.rebuild) {
+            RLMRemoveIndexTables(group, *ObjectStore::table_for_object_type(group, objectSchema.objectName.UTF8String));
+        }
+
+        RLMUpdateFullTextIndexTables(realm);
+        RLMUpdateOrderedIndexTables(realm);
+        RLMUpdateCaseInsensitiveIndexTables(realm);
+
+        for (RLMObjectSchema *objectSchema in coverage.rebuild) {
+            createCoverageTable(group, RLMIndexCoverageTableName(objectSchema),
+                                *ObjectStore::table_for_object_type(group, objectSchema.objectName.UTF8String));
+        }
+        sharedRealm->commit_transaction();
+    }
+    catch (...) {
+        if (sharedRealm->is_in_transaction()) {
+            sharedRealm->cancel_transaction();
+        }
+        throw;
+    }
+
+    // Any index tables looked up before the update may have been replaced
+    for (auto& info : realm->_info) {
+        info.second.releaseTable();
+    }
+}
+
+void RLMRemoveIndexTables(Group& group, Table const& objects) {
+    std::vector<std::string> names;
+    for (size_t i = 0, count = group.size(); i < count; ++i) {
+        auto name = group.get_table_name(i);
+        if (!RLMIsIndexTableName(name)) {
+            continue;
+        }
+        bool linksToObjects = false;
+        forEachLinkTarget(*group.get_table(i), [&](Table const& target) {
+            linksToObjects = linksToObjects || &target == &objects;
+        });
+        if (linksToObjects) {
+            names.push_back(name);
+        }
+    }
+    for (auto& name : names) {
+        group.remove_table(name);
+    }
+}
+
+std::string RLMIndexCoverageTableName(RLMObjectSchema *objectSchema) {
+    return RLMIndexTableName(s_coverageTablePrefix, objectSchema, @[]);
+}
+
+realm::Table *RLMIndexCoverageTable(Group& group, RLMObjectSchema *objectSchema) {
+    return group.get_table(RLMIndexCoverageTableName(objectSchema)).get();
+}
+
+bool RLMIndexTablesCoverAllRows(Table const& objects, std::string const& coverageTableName) {
+    Group* group = objects.get_parent_group();
+    return group && coversAllRows(group->get_table(coverageTableName).get(), objects);
+}
+
+void RLMUpdateIndexes(RLMClassInfo& info, size_t row) {
+    RLMUpdateFullTextIndexes(info, row);
+    RLMUpdateOrderedIndexes(info, row);
+    RLMUpdateCaseInsensitiveIndexes(info, row);
+
+    if (Table *coverage = info.indexCoverageTable()) {
+        if (info.table()->get_backlink_count(row, *coverage, s_coveredObjectsColumn) == 0) {
+            coverage->get_linklist(s_coveredObjectsColumn, 0)->add(row);
+        }
+    }
+}
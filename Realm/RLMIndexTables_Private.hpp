@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+#import <string>
+
+namespace realm {
+    class Group;
+    class Table;
+}
+class RLMClassInfo;
+@class RLMObjectSchema, RLMRealm;
+
+// Objects created by something other than this binding, such as sync, are not
+// added to the index tables, so each class with index tables also has a table
+// whose link list holds every object which has been added to them. Queries
+// only use the index tables when that link list holds every object of the
+// class, and opening the Realm rebuilds the index tables when it does not.
+//
+// Changes to existing objects made by something other than this binding can't
+// be detected this way. Synced Realms don't have index tables for this
+// reason (see RLMRealmSupportsIndexTables()), while local Realm files are
+// assumed to only be written to by this binding.
+//
+// The tables are looked up by name by each RLMRealm instance, and looked up
+// again whenever that instance moves to a different version, as another
+// instance may have rebuilt them (see RLMClassInfo).
+
+// Synced Realms are excluded: sync modifies existing objects as well as
+// creating new ones, and the coverage table can only detect the latter, so
+// the index tables would go stale. They are never created for synced Realms,
+// which makes queries and sorts fall back to examining every object.
+bool RLMRealmSupportsIndexTables(RLMRealm *realm);
+
+// Create, populate and remove the hidden tables backing full-text, ordered,
+// composite and case-insensitive indexes so that they match the Realm's
+// schema, rebuild the index tables of classes with objects missing from them,
+// and remove index tables for classes which are no longer in the schema. All
+// changes are made in a single write transaction, which is only
+// begun if anything needs to change. Does nothing for synced Realms.
+void RLMUpdateIndexTables(RLMRealm *realm);
+
+// Remove all of the index tables which link to the given object table. Must
+// be called within a write transaction before the object table is removed, as
+// the index tables would otherwise keep it from being removed.
+void RLMRemoveIndexTables(realm::Group& group, realm::Table const& objects);
+
+// Get the name of the table recording which objects have been added to the
+// class's index tables
+std::string RLMIndexCoverageTableName(RLMObjectSchema *objectSchema);
+
+// Get the table recording which objects have been added to the class's index
+// tables, or nullptr if it has not been created
+realm::Table *RLMIndexCoverageTable(realm::Group& group, RLMObjectSchema *objectSchema);
+
+// Check if every object in `objects` has been added to its class's index
+// tables, where `coverageTableName` is from RLMIndexCoverageTableName()
+bool RLMIndexTablesCoverAllRows(realm::Table const& objects, std::string const& coverageTableName);
+
+// Update all of the index tables of the object in the given row after it has
+// been created or updated from a value, and record that it has been added
+void RLMUpdateIndexes(RLMClassInfo& info, size_t row);
@@ -19,6 +19,7 @@
 #import "RLMMigration_Private.h"
 
 #import "RLMAccessor.h"
+#import "RLMIndexTables_Private.hpp"
 #import "RLMObject_Private.h"
 #import "RLMObject_Private.hpp"
 #import "RLMObjectSchema_Private.hpp"
@@ -167,6 +168,13 @@ using namespace realm;
         return false;
     }
 
+    // The index tables link to the object table, so they have to be removed
+    // first. They're recreated once the migration completes.
+    RLMRemoveIndexTables(_realm.group, *table);
+    for (auto& info : _realm->_info) {
+        info.second.releaseTable();
+    }
+
     if ([_realm.schema schemaForClassName:name]) {
         table->clear();
     }
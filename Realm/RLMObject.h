@@ -276,6 +276,91 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (NSArray<NSString *> *)indexedProperties;
 
+/**
+ Returns an array of property names for string properties which should have a
+ full-text index.
+
+ A full-text index records which objects contain each word in the property's
+ value, which allows querying for objects containing words or word prefixes
+ with a predicate created by `RLMTextSearchPredicate()` without examining
+ every object.
+
+ Words are compared case and diacritic insensitively. The index is updated
+ whenever an object is created or the property is set, which makes these
+ writes slower than for non-indexed properties.
+
+ The index is not created in synced Realms, as changes made by sync are not
+ applied to it, so text searches on synced Realms examine every object.
+
+ @return    An array of property names.
+ */
++ (NSArray<NSString *> *)fullTextIndexedProperties;
+
+/**
+ Returns an array of property names for properties which should have an
+ ordered index.
+
+ An ordered index keeps the objects sorted by the property's value, which
+ allows `<`, `<=`, `>`, `>=` and `BETWEEN` queries on the property to find the
+ matching objects without examining every object, and allows sorting on the
+ property alone to read the objects in the index's order rather than sorting
+ them. Objects with equal values may be sorted in a different order than when
+ sorting without an index.
+
+ Only integer, floating point, `NSDate` and string properties are supported.
+ The index is updated whenever an object is created or the property is set,
+ which makes these writes slower than for non-indexed properties.
+
+ The index is not created in synced Realms, as changes made by sync are not
+ applied to it, so these queries and sorts on synced Realms examine every
+ object.
+
+ @return    An array of property names.
+ */
++ (NSArray<NSString *> *)orderedIndexedProperties;
+
+/**
+ Returns an array of composite indexes, each of which is an array of the names
+ of two or more properties.
+
+ A composite index groups the objects by the values of all but the last of its
+ properties, and keeps each group sorted by the value of the last property.
+ Queries which combine `==` comparisons on the leading properties with `AND`,
+ optionally along with a `==`, `<`, `<=`, `>`, `>=` or `BETWEEN` comparison on
+ the last property, find the matching objects using the index rather than by
+ examining every object. For example, an index on `@[@"userId", @"createdAt"]`
+ is used for the query `userId == %@ AND createdAt > %@`.
+
+ Integer, boolean, `NSDate`, string and object properties can be the leading
+ properties of an index, and integer, boolean, floating point, `NSDate` and
+ string properties can be its last property. A comparison with an object can
+ only use the index if the object's class has a primary key.
+
+ The indexes are not created in synced Realms, as changes made by sync are not
+ applied to them, so these queries on synced Realms examine every object.
+
+ @return    An array of composite indexes.
+ */
++ (NSArray<NSArray<NSString *> *> *)compositeIndexes;
+
+/**
+ Returns an array of property names for string properties which should have a
+ case-insensitive index.
+
+ A case-insensitive index allows `==[c]` and `BEGINSWITH[c]` queries on the
+ property, along with the `[d]` and `[cd]` variants of them, to find the
+ matching objects without examining every object, which a regular index from
+ `+indexedProperties` cannot do. The index is updated whenever an object is
+ created or the property is set, which makes these writes slower than for
+ non-indexed properties.
+
+ The index is not created in synced Realms, as changes made by sync are not
+ applied to it, so these queries on synced Realms examine every object.
+
+ @return    An array of property names.
+ */
++ (NSArray<NSString *> *)caseInsensitiveIndexedProperties;
+
 /**
  Override this method to specify the default values to be used for each property.
 
@@ -483,6 +568,31 @@ typedef void (^RLMObjectChangeBlock)(BOOL deleted,
  */
 - (RLMNotificationToken *)addNotificationBlock:(RLMObjectChangeBlock)block;
 
+/**
+ Registers a block to be called on the given queue each time the object changes.
+
+ This behaves like `-addNotificationBlock:`, except that the calling thread
+ does not need a run loop and the block is called on the given serial queue
+ with the changes resolved in a Realm opened on the thread the queue is
+ running on. That Realm is not cached, and is closed once the block returns
+ unless it is retained by the block.
+
+ `previousValue` is always `nil` for object and array properties, as those
+ values can't be passed between threads, and `value` is read from the object
+ after it has been passed to the queue.
+
+ Blocks which have already been dispatched to the queue when the token is
+ stopped will not be called.
+
+ @warning This method cannot be called during a write transaction, when the
+          containing Realm is read-only, or on an unmanaged object.
+
+ @param block The block to be called whenever a change occurs.
+ @param queue The serial queue to call the block on.
+ @return A token which must be held for as long as you want updates to be delivered.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(RLMObjectChangeBlock)block queue:(dispatch_queue_t)queue;
+
 #pragma mark - Other Instance Methods
 
 /**
@@ -27,6 +27,7 @@
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
 #import "RLMSchema_Private.h"
+#import "RLMThreadSafeReference.h"
 
 #import "collection_notifications.hpp"
 #import "object.hpp"
@@ -183,6 +184,45 @@
     });
 }
 
+- (RLMNotificationToken *)addNotificationBlock:(RLMObjectChangeBlock)block queue:(dispatch_queue_t)queue {
+    if (!_realm) {
+        @throw RLMException(@"Only objects which are managed by a Realm support change notifications");
+    }
+    return RLMAddNotificationBlockOnQueue(self, queue, ^(NSError *error) {
+        block(false, nil, error);
+    }, ^(RLMObject *workerObject, RLMQueueDeliverBlock deliver) {
+        return RLMObjectAddNotificationBlock(workerObject, ^(NSArray<NSString *> *propertyNames,
+                                                            NSArray *oldValues, NSArray *, NSError *error) {
+            if (error) {
+                deliver(nil, ^(id) { block(false, nil, error); });
+            }
+            else if (!propertyNames) {
+                deliver(nil, ^(id) { block(true, nil, nil); });
+            }
+            else {
+                // Old values which are objects or arrays belong to the
+                // worker's Realm and can't be passed to the queue, and new
+                // values are read from the handed-over object instead
+                NSMutableArray *previousValues = oldValues ? [NSMutableArray arrayWithCapacity:oldValues.count] : nil;
+                for (id value in oldValues) {
+                    [previousValues addObject:[value conformsToProtocol:@protocol(RLMThreadConfined)] ? NSNull.null : value];
+                }
+                deliver(workerObject, ^(RLMObject *resolved) {
+                    auto properties = [NSMutableArray arrayWithCapacity:propertyNames.count];
+                    for (NSUInteger i = 0, count = propertyNames.count; i < count; ++i) {
+                        auto prop = [RLMPropertyChange new];
+                        prop.name = propertyNames[i];
+                        prop.previousValue = previousValues ? RLMCoerceToNil(previousValues[i]) : nil;
+                        prop.value = RLMCoerceToNil(resolved[propertyNames[i]]);
+                        [properties addObject:prop];
+                    }
+                    block(false, properties, nil);
+                });
+            }
+        });
+    });
+}
+
 + (NSString *)className {
     return [super className];
 }
@@ -193,6 +233,22 @@
     return @[];
 }
 
++ (NSArray *)fullTextIndexedProperties {
+    return @[];
+}
+
++ (NSArray *)orderedIndexedProperties {
+    return @[];
+}
+
++ (NSArray *)compositeIndexes {
+    return @[];
+}
+
++ (NSArray *)caseInsensitiveIndexedProperties {
+    return @[];
+}
+
 + (NSDictionary *)linkingObjectsProperties {
     return @{};
 }
@@ -27,6 +27,7 @@
 #import "RLMOptionalBase.h"
 #import "RLMProperty_Private.h"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 #import "RLMSchema_Private.h"
 #import "RLMSwiftSupport.h"
 #import "RLMThreadSafeReference_Private.hpp"
@@ -158,6 +159,7 @@ static id validatedObjectForProperty(__unsafe_unretained id const obj,
 id RLMCreateManagedAccessor(Class cls, __unsafe_unretained RLMRealm *realm, RLMClassInfo *info) {
     RLMObjectBase *obj = [[cls alloc] initWithRealm:realm schema:info->rlmObjectSchema];
     obj->_info = info;
+    RLMStatisticsCounters::increment(RLMGetStatisticsCounters(realm).accessors);
     return obj;
 }
 
@@ -467,6 +469,22 @@ Class RLMObjectUtilClass(BOOL isSwift) {
     return [cls indexedProperties];
 }
 
++ (NSArray *)fullTextIndexedPropertiesForClass:(Class)cls {
+    return [cls fullTextIndexedProperties];
+}
+
++ (NSArray *)orderedIndexedPropertiesForClass:(Class)cls {
+    return [cls orderedIndexedProperties];
+}
+
++ (NSArray *)compositeIndexesForClass:(Class)cls {
+    return [cls compositeIndexes];
+}
+
++ (NSArray *)caseInsensitiveIndexedPropertiesForClass:(Class)cls {
+    return [cls caseInsensitiveIndexedProperties];
+}
+
 + (NSDictionary *)linkingObjectsPropertiesForClass:(Class)cls {
     return [cls linkingObjectsProperties];
 }
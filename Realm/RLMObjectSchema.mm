@@ -160,6 +160,93 @@ using namespace realm;
         }
     }
 
+    for (NSString *propertyName in [[objectClass objectUtilClass:isSwift] fullTextIndexedPropertiesForClass:objectClass]) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Full-text indexed property '%@' does not exist on object '%@'", propertyName, className);
+        }
+        if (prop.type != RLMPropertyTypeString) {
+            @throw RLMException(@"Property '%@' cannot be full-text indexed on '%@' because it is not a 'string' property.",
+                                propertyName, className);
+        }
+        prop.fullTextIndexed = YES;
+    }
+
+    for (NSString *propertyName in [[objectClass objectUtilClass:isSwift] orderedIndexedPropertiesForClass:objectClass]) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Ordered indexed property '%@' does not exist on object '%@'", propertyName, className);
+        }
+        switch (prop.type) {
+            case RLMPropertyTypeInt:
+            case RLMPropertyTypeFloat:
+            case RLMPropertyTypeDouble:
+            case RLMPropertyTypeDate:
+            case RLMPropertyTypeString:
+                break;
+            default:
+                @throw RLMException(@"Property '%@' cannot have an ordered index on '%@' because it is a '%@' property. "
+                                    @"Only 'int', 'float', 'double', 'date' and 'string' properties can have an ordered index.",
+                                    propertyName, className, RLMTypeToString(prop.type));
+        }
+        prop.orderedIndexed = YES;
+    }
+
+    NSArray *compositeIndexes = [[objectClass objectUtilClass:isSwift] compositeIndexesForClass:objectClass];
+    for (NSArray<NSString *> *propertyNames in compositeIndexes) {
+        if (propertyNames.count < 2) {
+            @throw RLMException(@"Composite index (%@) on '%@' must have at least two properties.",
+                                [propertyNames componentsJoinedByString:@", "], className);
+        }
+        if ([NSSet setWithArray:propertyNames].count != propertyNames.count) {
+            @throw RLMException(@"Composite index (%@) on '%@' lists a property more than once.",
+                                [propertyNames componentsJoinedByString:@", "], className);
+        }
+        for (NSString *propertyName in propertyNames) {
+            RLMProperty *prop = schema[propertyName];
+            if (!prop) {
+                @throw RLMException(@"Composite indexed property '%@' does not exist on object '%@'", propertyName, className);
+            }
+            bool last = [propertyName isEqualToString:propertyNames.lastObject];
+            switch (prop.type) {
+                case RLMPropertyTypeInt:
+                case RLMPropertyTypeBool:
+                case RLMPropertyTypeDate:
+                case RLMPropertyTypeString:
+                    break;
+                case RLMPropertyTypeFloat:
+                case RLMPropertyTypeDouble:
+                    if (!last) {
+                        @throw RLMException(@"Property '%@' can only be the last property of a composite index on '%@' because it is a '%@' property.",
+                                            propertyName, className, RLMTypeToString(prop.type));
+                    }
+                    break;
+                case RLMPropertyTypeObject:
+                    if (last) {
+                        @throw RLMException(@"Property '%@' cannot be the last property of a composite index on '%@' because it is a '%@' property.",
+                                            propertyName, className, RLMTypeToString(prop.type));
+                    }
+                    break;
+                default:
+                    @throw RLMException(@"Property '%@' cannot be part of a composite index on '%@' because it is a '%@' property.",
+                                        propertyName, className, RLMTypeToString(prop.type));
+            }
+        }
+    }
+    schema.compositeIndexes = compositeIndexes ?: @[];
+
+    for (NSString *propertyName in [[objectClass objectUtilClass:isSwift] caseInsensitiveIndexedPropertiesForClass:objectClass]) {
+        RLMProperty *prop = schema[propertyName];
+        if (!prop) {
+            @throw RLMException(@"Case-insensitive indexed property '%@' does not exist on object '%@'", propertyName, className);
+        }
+        if (prop.type != RLMPropertyTypeString) {
+            @throw RLMException(@"Property '%@' cannot have a case-insensitive index on '%@' because it is not a 'string' property.",
+                                propertyName, className);
+        }
+        prop.caseInsensitiveIndexed = YES;
+    }
+
     for (RLMProperty *prop in schema.properties) {
         if (prop.optional && !RLMPropertyTypeIsNullable(prop.type)) {
             @throw RLMException(@"Property '%@.%@' cannot be made optional because optional '%@' properties are not supported.",
@@ -332,6 +419,7 @@ using namespace realm;
     // call property setter to reset map and primary key
     schema.properties = [[NSArray allocWithZone:zone] initWithArray:_properties copyItems:YES];
     schema.computedProperties = [[NSArray allocWithZone:zone] initWithArray:_computedProperties copyItems:YES];
+    schema.compositeIndexes = _compositeIndexes;
 
     return schema;
 }
@@ -43,6 +43,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readwrite, nullable) RLMProperty *primaryKeyProperty;
 
 @property (nonatomic, copy) NSArray<RLMProperty *> *computedProperties;
+
+// the property names of each composite index
+@property (nonatomic, copy) NSArray<NSArray<NSString *> *> *compositeIndexes;
 @property (nonatomic, readonly) NSArray<RLMProperty *> *swiftGenericProperties;
 
 // returns a cached or new schema for a given object class
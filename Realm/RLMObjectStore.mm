@@ -20,6 +20,7 @@
 
 #import "RLMAccessor.hpp"
 #import "RLMArray_Private.hpp"
+#import "RLMIndexTables_Private.hpp"
 #import "RLMListBase.h"
 #import "RLMObservation.hpp"
 #import "RLMObject_Private.hpp"
@@ -28,6 +29,7 @@
 #import "RLMProperty_Private.h"
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 #import "RLMSchema_Private.h"
 #import "RLMSwiftSupport.h"
 #import "RLMUtil.hpp"
@@ -36,11 +38,17 @@
 #import "results.hpp"
 #import "shared_realm.hpp"
 
+#import <mutex>
 #import <objc/message.h>
 
 using namespace realm;
 
 void RLMRealmCreateAccessors(RLMSchema *schema) {
+    // Realms at different paths can be opened concurrently and may share
+    // object schemas, so accessor class creation needs its own lock
+    static std::mutex& accessorLock = *new std::mutex();
+    std::lock_guard<std::mutex> lock(accessorLock);
+
     const size_t bufferSize = sizeof("RLM:Managed  ") // includes null terminator
                             + std::numeric_limits<unsigned long long>::digits10
                             + realm::Group::max_table_name_length;
@@ -131,6 +139,7 @@ void RLMAddObjectToRealm(__unsafe_unretained RLMObjectBase *const object,
     try {
         realm::Object::create(c, realm->_realm, *info.objectSchema, (id)object,
                               createOrUpdate, &object->_row);
+        RLMUpdateIndexes(info, object->_row.get_index());
     }
     catch (std::exception const& e) {
         @throw RLMException(e);
@@ -168,6 +177,7 @@ RLMObjectBase *RLMCreateObjectInRealmWithValue(RLMRealm *realm, NSString *classN
     try {
         object->_row = realm::Object::create(c, realm->_realm, *info.objectSchema,
                                              (id)value, createOrUpdate).row();
+        RLMUpdateIndexes(info, object->_row.get_index());
     }
     catch (std::exception const& e) {
         @throw RLMException(e);
@@ -218,13 +228,22 @@ RLMResults *RLMGetObjects(__unsafe_unretained RLMRealm *const realm,
     }
 
     if (predicate) {
-        realm::Query query = RLMPredicateToQuery(predicate, info.rlmObjectSchema, realm.schema, realm.group);
-        return [RLMResults resultsWithObjectInfo:info
-                                         results:realm::Results(realm->_realm, std::move(query))];
+        RLMStatisticsTimer timer;
+        bool canEvaluateConcurrently;
+        realm::Query query = RLMPredicateToQuery(predicate, info.rlmObjectSchema, realm.schema, realm.group,
+                                                 &canEvaluateConcurrently);
+        uint64_t buildNanoseconds = timer.stop();
+        realm::Results tableResults(realm->_realm, std::move(query));
+        RLMResults *results = canEvaluateConcurrently
+                            ? [RLMResults resultsWithObjectInfo:info tableResults:std::move(tableResults)]
+                            : [RLMResults resultsWithObjectInfo:info results:std::move(tableResults)];
+        results.filterPredicate = predicate;
+        results.queryBuildNanoseconds = buildNanoseconds;
+        return results;
     }
 
     return [RLMResults resultsWithObjectInfo:info
-                                     results:realm::Results(realm->_realm, *info.table())];
+                                tableResults:realm::Results(realm->_realm, *info.table())];
 }
 
 id RLMGetObject(RLMRealm *realm, NSString *objectClassName, id key) {
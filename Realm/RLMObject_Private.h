@@ -91,6 +91,10 @@ FOUNDATION_EXTERN const NSUInteger RLMDescriptionMaxDepth;
 
 + (nullable NSArray<NSString *> *)ignoredPropertiesForClass:(Class)cls;
 + (nullable NSArray<NSString *> *)indexedPropertiesForClass:(Class)cls;
++ (nullable NSArray<NSString *> *)fullTextIndexedPropertiesForClass:(Class)cls;
++ (nullable NSArray<NSString *> *)orderedIndexedPropertiesForClass:(Class)cls;
++ (nullable NSArray<NSArray<NSString *> *> *)compositeIndexesForClass:(Class)cls;
++ (nullable NSArray<NSString *> *)caseInsensitiveIndexedPropertiesForClass:(Class)cls;
 + (nullable NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *)linkingObjectsPropertiesForClass:(Class)cls;
 
 + (nullable NSArray<NSString *> *)getGenericListPropertyNames:(id)obj;
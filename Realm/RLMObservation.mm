@@ -25,6 +25,7 @@
 #import "RLMObject_Private.hpp"
 #import "RLMProperty_Private.h"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 
 #import <realm/group.hpp>
 
@@ -118,16 +119,24 @@ void RLMObservationInfo::willChange(NSString *key, NSKeyValueChange kind, NSInde
 }
 
 void RLMObservationInfo::didChange(NSString *key, NSKeyValueChange kind, NSIndexSet *indexes) const {
+    // The observers may destroy this info, so retain the Realm up front
+    RLMRealm *realm = objectSchema ? objectSchema->realm : nil;
+    uint64_t notified = 0;
     if (indexes) {
-        forEach([=](__unsafe_unretained auto o) {
+        forEach([&](__unsafe_unretained auto o) {
             [o didChange:kind valuesAtIndexes:indexes forKey:key];
+            ++notified;
         });
     }
     else {
-        forEach([=](__unsafe_unretained auto o) {
+        forEach([&](__unsafe_unretained auto o) {
             [o didChangeValueForKey:key];
+            ++notified;
         });
     }
+    if (realm && notified) {
+        RLMStatisticsCounters::increment(RLMGetStatisticsCounters(realm).kvoNotifications, notified);
+    }
 }
 
 void RLMObservationInfo::prepareForInvalidation() {
@@ -0,0 +1,1162 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMOrderedIndex_Private.hpp"
+
+#import "RLMCollection.h"
+#import "RLMIndexTables_Private.hpp"
+#import "RLMObject_Private.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMProperty_Private.h"
+#import "RLMQueryUtil.hpp"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
+
+#import "object_store.hpp"
+#import "results.hpp"
+#import "shared_realm.hpp"
+
+#import <realm/group.hpp>
+#import <realm/link_view.hpp>
+#import <realm/query_engine.hpp>
+#import <realm/query_expression.hpp>
+#import <realm/table.hpp>
+#import <realm/unicode.hpp>
+
+#import <algorithm>
+#import <cmath>
+#import <numeric>
+#import <set>
+#import <utility>
+#import <vector>
+
+using namespace realm;
+
+namespace {
+constexpr size_t s_ascendingColumn = 0;
+constexpr char s_indexTablePrefix[] = "ord_";
+constexpr char s_compositeIndexTablePrefix[] = "cmp_";
+
+std::string indexTableName(RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return RLMIndexTableName(s_indexTablePrefix, objectSchema, property);
+}
+
+std::string compositeIndexTableName(RLMObjectSchema *objectSchema, NSArray<NSString *> *propertyNames) {
+    return RLMIndexTableName(s_compositeIndexTablePrefix, objectSchema, propertyNames);
+}
+
+// Values are ordered in the same way as core sorts them, with null before
+// everything else, and NaN before all other numbers
+template<typename T>
+bool isNaN(T const&) { return false; }
+bool isNaN(float value) { return std::isnan(value); }
+bool isNaN(double value) { return std::isnan(value); }
+
+template<typename T>
+bool less(T const& a, T const& b) {
+    if (isNaN(a) || isNaN(b)) {
+        return isNaN(a) && !isNaN(b);
+    }
+    return a < b;
+}
+
+bool less(StringData const& a, StringData const& b) {
+    return utf8_compare(a, b);
+}
+
+template<typename T>
+bool less(util::Optional<T> const& a, util::Optional<T> const& b) {
+    if (!a || !b) {
+        return !a && b;
+    }
+    return less(*a, *b);
+}
+
+template<typename T>
+struct Type {
+    using type = T;
+};
+
+// Call `fn` with a Type<T> for the type used to read values of the column
+template<typename Fn>
+auto switchOnColumnType(Table const& table, size_t column, Fn&& fn) {
+    switch (table.get_column_type(column)) {
+        case type_Int:       return fn(Type<int64_t>());
+        case type_Bool:      return fn(Type<bool>());
+        case type_Float:     return fn(Type<float>());
+        case type_Double:    return fn(Type<double>());
+        case type_Timestamp: return fn(Type<Timestamp>());
+        case type_String:    return fn(Type<StringData>());
+        default:             REALM_UNREACHABLE();
+    }
+}
+
+template<typename T>
+util::Optional<T> columnValue(Table const& table, size_t column, size_t row) {
+    if (table.is_null(column, row)) {
+        return util::none;
+    }
+    return table.get<T>(column, row);
+}
+
+// Check if the value is within the range, where a missing bound leaves that
+// side of the range open. Null and NaN are never within a range.
+template<typename T>
+bool inRange(util::Optional<T> const& value,
+             util::Optional<T> const& lower, bool lowerInclusive,
+             util::Optional<T> const& upper, bool upperInclusive) {
+    if (!value || isNaN(*value)) {
+        return false;
+    }
+    if (lower && (lowerInclusive ? less(*value, *lower) : !less(*lower, *value))) {
+        return false;
+    }
+    if (upper && (upperInclusive ? less(*upper, *value) : !less(*value, *upper))) {
+        return false;
+    }
+    return true;
+}
+
+// A link list of objects sorted by their value for a column
+template<typename T>
+class SortedLinkList {
+public:
+    using value_type = T;
+
+    SortedLinkList(LinkViewRef list, Table const& objects, size_t column)
+    : m_list(std::move(list))
+    , m_objects(objects)
+    , m_column(column)
+    {
+    }
+
+    util::Optional<T> value(size_t row) const {
+        return columnValue<T>(m_objects, m_column, row);
+    }
+
+    util::Optional<T> value_at(size_t position) const {
+        return value(row_at(position));
+    }
+
+    size_t row_at(size_t position) const {
+        return m_list->get(position).get_index();
+    }
+
+    size_t size() const {
+        return m_list->size();
+    }
+
+    // The position of the first entry for which `pred` is false, where `pred`
+    // must be true for every entry before that one and false for every entry
+    // after it
+    template<typename Pred>
+    size_t partition_point(Pred&& pred) const {
+        size_t low = 0, high = size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (pred(value_at(mid))) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    size_t lower_bound(util::Optional<T> const& bound) const {
+        return partition_point([&](util::Optional<T> const& v) { return less(v, bound); });
+    }
+
+    size_t upper_bound(util::Optional<T> const& bound) const {
+        return partition_point([&](util::Optional<T> const& v) { return !less(bound, v); });
+    }
+
+    // The positions of the entries within the range, where a missing bound
+    // leaves that side of the range open
+    std::pair<size_t, size_t> range(util::Optional<T> const& lower, bool lowerInclusive,
+                                    util::Optional<T> const& upper, bool upperInclusive) const {
+        // Null and NaN never match a range, and are ordered before all other values
+        size_t begin = lower ? (lowerInclusive ? lower_bound(lower) : upper_bound(lower))
+                             : partition_point([](util::Optional<T> const& v) { return !v || isNaN(*v); });
+        size_t end = upper ? (upperInclusive ? upper_bound(upper) : lower_bound(upper)) : size();
+        return {begin, std::max(begin, end)};
+    }
+
+    // Find the position of the row, returning not_found if it is not there
+    size_t find(size_t row) const {
+        auto v = value(row);
+        for (size_t i = lower_bound(v), end = upper_bound(v); i < end; ++i) {
+            if (row_at(i) == row) {
+                return i;
+            }
+        }
+        // The row's value may have changed since it was inserted, in which
+        // case it has to be found without using its old value, which is no
+        // longer known, so this is much slower
+        return m_list->find(row);
+    }
+
+    bool in_order_at(size_t position) const {
+        auto v = value_at(position);
+        return (position == 0 || !less(v, value_at(position - 1)))
+            && (position + 1 == size() || !less(value_at(position + 1), v));
+    }
+
+    // Insert the row at the position for its current value, returning the position
+    size_t insert(size_t row) {
+        size_t position = upper_bound(value(row));
+        m_list->insert(position, row);
+        return position;
+    }
+
+    void remove_at(size_t position) {
+        m_list->remove(position);
+    }
+
+    // Move the row, which must be in the list, to the position for its
+    // current value if it is not already there
+    void update(size_t row) {
+        size_t position = find(row);
+        // The search for the row can be misled by the row itself being out
+        // of order, so check that it is actually in order
+        if (in_order_at(position)) {
+            return;
+        }
+        remove_at(position);
+        insert(row);
+    }
+
+private:
+    LinkViewRef m_list;
+    Table const& m_objects;
+    size_t m_column;
+};
+
+// The ascending link list of an index
+template<typename T>
+class OrderedIndex {
+public:
+    OrderedIndex(Table& index, Table const& objects, size_t column)
+    : m_index(index)
+    , m_ascending(index.get_linklist(s_ascendingColumn, 0), objects, column)
+    , m_objects(objects)
+    {
+    }
+
+    SortedLinkList<T> const& ascending() const {
+        return m_ascending;
+    }
+
+    bool contains(size_t row) const {
+        return m_objects.get_backlink_count(row, m_index, s_ascendingColumn) != 0;
+    }
+
+    void insert(size_t row) {
+        m_ascending.insert(row);
+    }
+
+    void remove_at(size_t position) {
+        m_ascending.remove_at(position);
+    }
+
+    // Remove the row before its value changes
+    void remove(size_t row) {
+        if (contains(row)) {
+            remove_at(m_ascending.find(row));
+        }
+    }
+
+    // Move the row to the position for its current value if it is not already
+    // there, after its value may have changed without being removed first
+    void update(size_t row) {
+        if (!contains(row)) {
+            insert(row);
+            return;
+        }
+        size_t position = m_ascending.find(row);
+        if (m_ascending.in_order_at(position)) {
+            return;
+        }
+        remove_at(position);
+        insert(row);
+    }
+
+private:
+    Table& m_index;
+    SortedLinkList<T> m_ascending;
+    Table const& m_objects;
+};
+
+void createIndexTable(Group& group, std::string const& name, Table& objects, size_t column) {
+    TableRef index = group.add_table(name);
+    index->add_column_link(type_LinkList, "ascending", objects);
+    index->add_empty_row();
+
+    std::vector<size_t> rows(objects.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    switchOnColumnType(objects, column, [&](auto type) {
+        using T = typename decltype(type)::type;
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            return less(columnValue<T>(objects, column, a), columnValue<T>(objects, column, b));
+        });
+    });
+
+    auto ascending = index->get_linklist(s_ascendingColumn, 0);
+    for (size_t row : rows) {
+        ascending->add(row);
+    }
+}
+
+// Check if the index has every object in it, as objects created without
+// going through the binding, such as by sync, are not added to it
+bool coversAllRows(Table const& index, Table const& objects) {
+    return index.get_linklist(s_ascendingColumn, 0)->size() == objects.size();
+}
+
+// A value of any of the column types which can be part of a composite index.
+// The fields other than the one for the column's type keep their default
+// values, so values can be compared without knowing their type.
+struct IndexValue {
+    bool null = true;
+    // Int and Bool values, and the target row of Link values
+    int64_t int_value = 0;
+    double double_value = 0;
+    Timestamp timestamp_value{0, 0};
+    std::string string_value;
+
+    bool operator==(IndexValue const& other) const {
+        return null == other.null && int_value == other.int_value && double_value == other.double_value
+            && timestamp_value == other.timestamp_value && string_value == other.string_value;
+    }
+    bool operator!=(IndexValue const& other) const {
+        return !(*this == other);
+    }
+    // An arbitrary order used only to group equal values together
+    bool operator<(IndexValue const& other) const {
+        if (null != other.null) {
+            return null;
+        }
+        if (int_value != other.int_value) {
+            return int_value < other.int_value;
+        }
+        if (double_value != other.double_value) {
+            return double_value < other.double_value;
+        }
+        if (timestamp_value != other.timestamp_value) {
+            return timestamp_value < other.timestamp_value;
+        }
+        return string_value < other.string_value;
+    }
+};
+
+IndexValue readValue(Table const& table, size_t column, size_t row) {
+    IndexValue value;
+    DataType type = table.get_column_type(column);
+    if (type == type_Link ? table.is_null_link(column, row) : table.is_null(column, row)) {
+        return value;
+    }
+    value.null = false;
+    switch (type) {
+        case type_Int:       value.int_value = table.get_int(column, row); break;
+        case type_Bool:      value.int_value = table.get_bool(column, row); break;
+        case type_Float:     value.double_value = table.get_float(column, row); break;
+        case type_Double:    value.double_value = table.get_double(column, row); break;
+        case type_Timestamp: value.timestamp_value = table.get_timestamp(column, row); break;
+        case type_Link:      value.int_value = table.get_link(column, row); break;
+        case type_String: {
+            StringData str = table.get_string(column, row);
+            value.string_value.assign(str.data(), str.size());
+            break;
+        }
+        default: REALM_UNREACHABLE();
+    }
+    return value;
+}
+
+void writeValue(Table& table, size_t column, size_t row, IndexValue const& value) {
+    if (value.null) {
+        // Rows are added with null in every nullable column
+        return;
+    }
+    switch (table.get_column_type(column)) {
+        case type_Int:       table.set_int(column, row, value.int_value); break;
+        case type_Bool:      table.set_bool(column, row, value.int_value != 0); break;
+        case type_Timestamp: table.set_timestamp(column, row, value.timestamp_value); break;
+        case type_String:    table.set_string(column, row, value.string_value); break;
+        case type_Link:      table.set_link(column, row, value.int_value); break;
+        default:             REALM_UNREACHABLE();
+    }
+}
+
+IndexValue valueFromObject(Table const& table, size_t column, id object) {
+    IndexValue value;
+    if (!object || object == NSNull.null) {
+        return value;
+    }
+    value.null = false;
+    switch (table.get_column_type(column)) {
+        case type_Int:       value.int_value = [object longLongValue]; break;
+        case type_Bool:      value.int_value = [object boolValue]; break;
+        case type_Float:     value.double_value = [object floatValue]; break;
+        case type_Double:    value.double_value = [object doubleValue]; break;
+        case type_Timestamp: value.timestamp_value = RLMTimestampForNSDate(object); break;
+        case type_String: {
+            StringData str = RLMStringDataWithNSString(object);
+            value.string_value.assign(str.data(), str.size());
+            break;
+        }
+        default: REALM_UNREACHABLE();
+    }
+    return value;
+}
+
+template<typename T>
+util::Optional<T> typedValue(IndexValue const& value);
+
+template<>
+util::Optional<int64_t> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return value.int_value;
+}
+
+template<>
+util::Optional<bool> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return value.int_value != 0;
+}
+
+template<>
+util::Optional<float> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return static_cast<float>(value.double_value);
+}
+
+template<>
+util::Optional<double> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return value.double_value;
+}
+
+template<>
+util::Optional<Timestamp> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return value.timestamp_value;
+}
+
+template<>
+util::Optional<StringData> typedValue(IndexValue const& value) {
+    if (value.null) {
+        return util::none;
+    }
+    return StringData(value.string_value);
+}
+
+// The index table of a composite index has a row for each distinct set of
+// values of the index's leading columns, which are stored in the row's first
+// columns, and a link list of the objects with those values sorted by their
+// value for the index's last column
+class CompositeIndex {
+public:
+    CompositeIndex(Table& index, Table const& objects, std::vector<size_t> columns)
+    : m_index(index)
+    , m_objects(objects)
+    , m_columns(std::move(columns))
+    , m_list_column(m_columns.size() - 1)
+    {
+    }
+
+    // The values of the object's leading columns
+    std::vector<IndexValue> prefix(size_t row) const {
+        std::vector<IndexValue> values;
+        values.reserve(m_list_column);
+        for (size_t i = 0; i < m_list_column; ++i) {
+            values.push_back(readValue(m_objects, m_columns[i], row));
+        }
+        return values;
+    }
+
+    // The index row for the objects whose leading columns have the values, or
+    // not_found if there are none
+    size_t find_group(std::vector<IndexValue> const& values) const {
+        Query query = m_index.where();
+        for (size_t i = 0; i < m_list_column; ++i) {
+            auto& value = values[i];
+            bool link = m_index.get_column_type(i) == type_Link;
+            if (value.null) {
+                if (link) {
+                    query.and_query(m_index.column<Link>(i).is_null());
+                }
+                else {
+                    query.equal(i, realm::null());
+                }
+                continue;
+            }
+            switch (m_index.get_column_type(i)) {
+                case type_Int:       query.equal(i, value.int_value); break;
+                case type_Bool:      query.equal(i, value.int_value != 0); break;
+                case type_Timestamp: query.equal(i, value.timestamp_value); break;
+                case type_String:    query.equal(i, StringData(value.string_value)); break;
+                case type_Link:      query.links_to(i, m_index.get_link_target(i)->get(value.int_value)); break;
+                default:             REALM_UNREACHABLE();
+            }
+        }
+        return query.find();
+    }
+
+    // The index row whose link list contains the object, or not_found if it
+    // is not in the index
+    size_t group_containing(size_t row) const {
+        if (m_objects.get_backlink_count(row, m_index, m_list_column) == 0) {
+            return realm::not_found;
+        }
+        return m_objects.get_backlink(row, m_index, m_list_column, 0);
+    }
+
+    // Call `fn` with the SortedLinkList for the objects of the index row
+    template<typename Fn>
+    auto with_group(size_t group, Fn&& fn) const {
+        return switchOnColumnType(m_objects, m_columns.back(), [&](auto type) {
+            using T = typename decltype(type)::type;
+            SortedLinkList<T> list(m_index.get_linklist(m_list_column, group), m_objects, m_columns.back());
+            return fn(list);
+        });
+    }
+
+    void insert(size_t row) {
+        auto values = prefix(row);
+        size_t group = find_group(values);
+        if (group == realm::not_found) {
+            group = m_index.add_empty_row();
+            for (size_t i = 0; i < m_list_column; ++i) {
+                writeValue(m_index, i, group, values[i]);
+            }
+        }
+        with_group(group, [&](auto& list) { list.insert(row); });
+    }
+
+    // Remove the row before its value for any of the columns changes
+    void remove(size_t row) {
+        size_t group = group_containing(row);
+        if (group == realm::not_found) {
+            return;
+        }
+        bool empty = with_group(group, [&](auto& list) {
+            list.remove_at(list.find(row));
+            return list.size() == 0;
+        });
+        if (empty) {
+            m_index.move_last_over(group);
+        }
+    }
+
+    // Move the row to the index row and position for its current values, after
+    // they may have changed without it being removed first
+    void update(size_t row) {
+        size_t group = group_containing(row);
+        if (group != realm::not_found) {
+            std::vector<IndexValue> values;
+            for (size_t i = 0; i < m_list_column; ++i) {
+                values.push_back(readValue(m_index, i, group));
+            }
+            if (values == prefix(row)) {
+                with_group(group, [&](auto& list) { list.update(row); });
+                return;
+            }
+            remove(row);
+        }
+        insert(row);
+    }
+
+private:
+    Table& m_index;
+    Table const& m_objects;
+    std::vector<size_t> m_columns;
+    size_t m_list_column;
+};
+
+void createCompositeIndexTable(Group& group, std::string const& name, Table& objects, std::vector<size_t> const& columns) {
+    TableRef index = group.add_table(name);
+    for (size_t i = 0; i + 1 < columns.size(); ++i) {
+        size_t column = columns[i];
+        // Core updates links when the target object moves, and nullifies them
+        // when it is deleted, in the same way as the links of the objects
+        if (objects.get_column_type(column) == type_Link) {
+            index->add_column_link(type_Link, objects.get_column_name(column), *objects.get_link_target(column));
+        }
+        else {
+            index->add_column(objects.get_column_type(column), objects.get_column_name(column),
+                              objects.is_nullable(column));
+        }
+    }
+    if (index->get_column_type(0) != type_Link) {
+        index->add_search_index(0);
+    }
+    index->add_column_link(type_LinkList, "objects", objects);
+
+    // Sort the objects by the values of their leading columns and then by
+    // their value for the last column, so that the objects of each index row
+    // are together and in order
+    CompositeIndex composite(*index, objects, columns);
+    std::vector<std::vector<IndexValue>> prefixes;
+    prefixes.reserve(objects.size());
+    for (size_t row = 0; row < objects.size(); ++row) {
+        prefixes.push_back(composite.prefix(row));
+    }
+    std::vector<size_t> rows(objects.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    size_t last = columns.back();
+    switchOnColumnType(objects, last, [&](auto type) {
+        using T = typename decltype(type)::type;
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            if (prefixes[a] != prefixes[b]) {
+                return prefixes[a] < prefixes[b];
+            }
+            return less(columnValue<T>(objects, last, a), columnValue<T>(objects, last, b));
+        });
+    });
+
+    size_t listColumn = columns.size() - 1;
+    LinkViewRef list;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        size_t row = rows[i];
+        if (i == 0 || prefixes[row] != prefixes[rows[i - 1]]) {
+            size_t groupRow = index->add_empty_row();
+            for (size_t j = 0; j < listColumn; ++j) {
+                writeValue(*index, j, groupRow, prefixes[row][j]);
+            }
+            list = index->get_linklist(listColumn, groupRow);
+        }
+        list->add(row);
+    }
+}
+
+// The changes to the Realm's index tables needed to match its schema
+struct IndexTableChanges {
+    struct Creation {
+        std::string name;
+        RLMObjectSchema *objectSchema;
+        // The indexed properties, of which composite indexes have more than one
+        NSArray<NSString *> *propertyNames;
+    };
+    std::vector<Creation> create;
+    std::vector<std::string> remove;
+
+    bool empty() const { return create.empty() && remove.empty(); }
+};
+
+bool hasPrefix(std::string const& name, const char *prefix) {
+    return name.compare(0, strlen(prefix), prefix) == 0;
+}
+
+IndexTableChanges indexTableChanges(RLMRealm *realm) {
+    Group& group = realm.group;
+    IndexTableChanges changes;
+
+    std::set<std::string> expected;
+    auto expect = [&](std::string name, RLMObjectSchema *objectSchema, NSArray<NSString *> *propertyNames) {
+        if (!group.has_table(name)) {
+            changes.create.push_back({name, objectSchema, propertyNames});
+        }
+        else if (propertyNames.count == 1 && group.get_table(name)->get_column_count() != 1) {
+            // Ordered index tables used to also have a descending link list
+            changes.remove.push_back(name);
+            changes.create.push_back({name, objectSchema, propertyNames});
+        }
+        expected.insert(std::move(name));
+    };
+    for (RLMObjectSchema *objectSchema in realm.schema.objectSchema) {
+        for (RLMProperty *property in objectSchema.properties) {
+            if (property.orderedIndexed) {
+                expect(indexTableName(objectSchema, property), objectSchema, @[property.name]);
+            }
+        }
+        for (NSArray<NSString *> *propertyNames in objectSchema.compositeIndexes) {
+            expect(compositeIndexTableName(objectSchema, propertyNames), objectSchema, propertyNames);
+        }
+    }
+
+    for (size_t i = 0, size = group.size(); i < size; ++i) {
+        std::string name(group.get_table_name(i));
+        if (!(hasPrefix(name, s_indexTablePrefix) || hasPrefix(name, s_compositeIndexTablePrefix)) || expected.count(name)) {
+            continue;
+        }
+        // Only remove the indexes of classes in this Realm's schema, as the
+        // indexes of other classes may still be used by Realms opened with a
+        // different set of classes. The last column of both kinds of index
+        // table links to the objects.
+        auto indexTable = group.get_table(i);
+        auto objectTable = indexTable->get_link_target(indexTable->get_column_count() - 1);
+        auto objectType = ObjectStore::object_type_for_table_name(objectTable->get_name());
+        if ([realm.schema schemaForClassName:RLMStringDataToNSString(objectType)]) {
+            changes.remove.push_back(std::move(name));
+        }
+    }
+    return changes;
+}
+
+template<typename T>
+class OrderedRangeExpression : public realm::Expression {
+public:
+    OrderedRangeExpression(const Table& table, size_t column, std::string indexName,
+                           util::Optional<T> lower, bool lowerInclusive,
+                           util::Optional<T> upper, bool upperInclusive)
+    : m_table(&table), m_column(column), m_index_name(std::move(indexName))
+    , m_lower(std::move(lower)), m_upper(std::move(upper))
+    , m_lower_inclusive(lowerInclusive), m_upper_inclusive(upperInclusive)
+    {
+    }
+
+    double init() override
+    {
+        m_rows.clear();
+        m_scan = true;
+        Group* group = m_table->get_parent_group();
+        TableRef index = group ? group->get_table(m_index_name) : TableRef();
+        if (!index || !coversAllRows(*index, *m_table)) {
+            return 50.0;
+        }
+
+        SortedLinkList<T> ascending(index->get_linklist(s_ascendingColumn, 0), *m_table, m_column);
+        auto range = ascending.range(m_lower, m_lower_inclusive, m_upper, m_upper_inclusive);
+
+        // Reading a large part of the index one link at a time and sorting
+        // the rows is slower than checking every row's value
+        if (range.second - range.first > m_table->size() / 4) {
+            return 50.0;
+        }
+
+        m_scan = false;
+        m_rows.reserve(range.second - range.first);
+        for (size_t i = range.first; i < range.second; ++i) {
+            m_rows.push_back(ascending.row_at(i));
+        }
+        std::sort(m_rows.begin(), m_rows.end());
+        return 50.0;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_scan) {
+            for (size_t row = start; row < end; ++row) {
+                if (inRange(columnValue<T>(*m_table, m_column, row),
+                            m_lower, m_lower_inclusive, m_upper, m_upper_inclusive)) {
+                    return row;
+                }
+            }
+            return realm::not_found;
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_table = table; }
+    void verify_column() const override { REALM_ASSERT(m_table); }
+    const Table* get_base_table() const override { return m_table; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new OrderedRangeExpression(*this));
+    }
+
+private:
+    const Table* m_table;
+    size_t m_column;
+    std::string m_index_name;
+    util::Optional<T> m_lower;
+    util::Optional<T> m_upper;
+    bool m_lower_inclusive;
+    bool m_upper_inclusive;
+
+    // Whether each row's value is checked rather than looked up in m_rows
+    bool m_scan = true;
+    // The matching rows, sorted
+    std::vector<size_t> m_rows;
+};
+
+// Matches the rows whose values for the leading columns of a composite index
+// are equal to the prefix and whose value for the last column is within the
+// range. Links are matched by the primary key of the target object rather
+// than its row, as the row can change between creating the query and running
+// it.
+class CompositeIndexExpression : public realm::Expression {
+public:
+    CompositeIndexExpression(const Table& table, std::vector<size_t> columns, std::string indexName,
+                             std::string coverageName, std::vector<IndexValue> prefix,
+                             std::vector<std::string> primaryKeys,
+                             IndexValue lower, bool lowerInclusive, IndexValue upper, bool upperInclusive)
+    : m_table(&table), m_columns(std::move(columns)), m_index_name(std::move(indexName))
+    , m_coverage_name(std::move(coverageName)), m_prefix(std::move(prefix)), m_primary_keys(std::move(primaryKeys))
+    , m_lower(std::move(lower)), m_upper(std::move(upper))
+    , m_lower_inclusive(lowerInclusive), m_upper_inclusive(upperInclusive)
+    {
+    }
+
+    double init() override
+    {
+        m_rows.clear();
+        m_scan = false;
+
+        m_values = m_prefix;
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            if (m_primary_keys[i].empty()) {
+                continue;
+            }
+            size_t target = find_link_target(i);
+            if (target == realm::not_found) {
+                // Nothing links to an object which does not exist
+                return 50.0;
+            }
+            m_values[i] = IndexValue();
+            m_values[i].null = false;
+            m_values[i].int_value = target;
+        }
+
+        Group* group = m_table->get_parent_group();
+        TableRef index = group ? group->get_table(m_index_name) : TableRef();
+        // Objects created without going through the binding, such as by sync,
+        // are not in the index, so it can only be used if it has every object
+        if (!index || !RLMIndexTablesCoverAllRows(*m_table, m_coverage_name)) {
+            m_scan = true;
+            return 50.0;
+        }
+
+        CompositeIndex composite(*index, *m_table, m_columns);
+        size_t found = composite.find_group(m_values);
+        if (found == realm::not_found) {
+            return 50.0;
+        }
+        composite.with_group(found, [&](auto& list) {
+            using T = typename std::decay_t<decltype(list)>::value_type;
+            auto range = std::make_pair(size_t(0), list.size());
+            if (!m_lower.null || !m_upper.null) {
+                range = list.range(typedValue<T>(m_lower), m_lower_inclusive,
+                                   typedValue<T>(m_upper), m_upper_inclusive);
+            }
+            m_rows.reserve(range.second - range.first);
+            for (size_t i = range.first; i < range.second; ++i) {
+                m_rows.push_back(list.row_at(i));
+            }
+        });
+        std::sort(m_rows.begin(), m_rows.end());
+        return 50.0;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_scan) {
+            for (size_t row = start; row < end; ++row) {
+                if (matches(row)) {
+                    return row;
+                }
+            }
+            return realm::not_found;
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_table = table; }
+    void verify_column() const override { REALM_ASSERT(m_table); }
+    const Table* get_base_table() const override { return m_table; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new CompositeIndexExpression(*this));
+    }
+
+private:
+    const Table* m_table;
+    std::vector<size_t> m_columns;
+    std::string m_index_name;
+    std::string m_coverage_name;
+    // The values of the leading columns, with the primary key of the target
+    // object in place of the link for the columns with a primary key name
+    std::vector<IndexValue> m_prefix;
+    std::vector<std::string> m_primary_keys;
+    IndexValue m_lower;
+    IndexValue m_upper;
+    bool m_lower_inclusive;
+    bool m_upper_inclusive;
+
+    // The values of the leading columns with links resolved to rows
+    std::vector<IndexValue> m_values;
+    // Whether each row's values are checked rather than looked up in m_rows
+    bool m_scan = false;
+    // The matching rows, sorted
+    std::vector<size_t> m_rows;
+
+    size_t find_link_target(size_t i) const
+    {
+        ConstTableRef target = m_table->get_link_target(m_columns[i]);
+        size_t column = target->get_column_index(m_primary_keys[i]);
+        if (target->get_column_type(column) == type_String) {
+            return target->find_first_string(column, m_prefix[i].string_value);
+        }
+        return target->find_first_int(column, m_prefix[i].int_value);
+    }
+
+    bool matches(size_t row) const
+    {
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            if (readValue(*m_table, m_columns[i], row) != m_values[i]) {
+                return false;
+            }
+        }
+        if (m_lower.null && m_upper.null) {
+            return true;
+        }
+        size_t last = m_columns.back();
+        return switchOnColumnType(*m_table, last, [&](auto type) {
+            using T = typename decltype(type)::type;
+            return inRange(columnValue<T>(*m_table, last, row),
+                           typedValue<T>(m_lower), m_lower_inclusive,
+                           typedValue<T>(m_upper), m_upper_inclusive);
+        });
+    }
+};
+
+template<typename T>
+util::Optional<T> boundValue(id value);
+
+template<>
+util::Optional<int64_t> boundValue(id value) {
+    if (!value) {
+        return util::none;
+    }
+    return (int64_t)[value longLongValue];
+}
+
+template<>
+util::Optional<bool> boundValue(id) {
+    // Booleans do not have ordered indexes
+    REALM_UNREACHABLE();
+}
+
+template<>
+util::Optional<float> boundValue(id value) {
+    if (!value) {
+        return util::none;
+    }
+    return [value floatValue];
+}
+
+template<>
+util::Optional<double> boundValue(id value) {
+    if (!value) {
+        return util::none;
+    }
+    return [value doubleValue];
+}
+
+template<>
+util::Optional<Timestamp> boundValue(id value) {
+    if (!value) {
+        return util::none;
+    }
+    return RLMTimestampForNSDate(value);
+}
+
+template<>
+util::Optional<StringData> boundValue(id) {
+    // Strings do not support range comparisons
+    REALM_UNREACHABLE();
+}
+
+template<typename T>
+OrderedIndex<T> indexForColumn(RLMClassInfo& info, size_t column) {
+    return OrderedIndex<T>(*info.orderedIndexTable(column), *info.table(), column);
+}
+
+// Call `fn` with each composite index of the class which includes the column
+template<typename Fn>
+void forEachCompositeIndex(RLMClassInfo& info, size_t column, Fn&& fn) {
+    for (auto& pair : info.compositeIndexTables()) {
+        if (pair.second && std::find(pair.first.begin(), pair.first.end(), column) != pair.first.end()) {
+            fn(CompositeIndex(*pair.second, *info.table(), std::vector<size_t>(pair.first.begin(), pair.first.end())));
+        }
+    }
+}
+} // anonymous namespace
+
+realm::Table *RLMOrderedIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return group.get_table(indexTableName(objectSchema, property)).get();
+}
+
+realm::Table *RLMCompositeIndexTable(realm::Group& group, RLMObjectSchema *objectSchema,
+                                     NSArray<NSString *> *propertyNames) {
+    return group.get_table(compositeIndexTableName(objectSchema, propertyNames)).get();
+}
+
+bool RLMOrderedIndexTablesNeedUpdate(RLMRealm *realm) {
+    return !indexTableChanges(realm).empty();
+}
+
+void RLMUpdateOrderedIndexTables(RLMRealm *realm) {
+    auto changes = indexTableChanges(realm);
+    Group& group = realm.group;
+    for (auto& name : changes.remove) {
+        group.remove_table(name);
+    }
+    for (auto& creation : changes.create) {
+        auto& objects = *ObjectStore::table_for_object_type(group, creation.objectSchema.objectName.UTF8String);
+        std::vector<size_t> columns;
+        for (NSString *propertyName in creation.propertyNames) {
+            columns.push_back(objects.get_column_index(propertyName.UTF8String));
+        }
+        if (columns.size() == 1) {
+            createIndexTable(group, creation.name, objects, columns[0]);
+        }
+        else {
+            createCompositeIndexTable(group, creation.name, objects, columns);
+        }
+    }
+}
+
+void RLMUpdateOrderedIndexes(RLMClassInfo& info, size_t row) {
+    for (auto& pair : info.orderedIndexTables()) {
+        if (!pair.second) {
+            continue;
+        }
+        switchOnColumnType(*info.table(), pair.first, [&](auto type) {
+            indexForColumn<typename decltype(type)::type>(info, pair.first).update(row);
+        });
+    }
+    for (auto& pair : info.compositeIndexTables()) {
+        if (pair.second) {
+            CompositeIndex(*pair.second, *info.table(), std::vector<size_t>(pair.first.begin(), pair.first.end())).update(row);
+        }
+    }
+}
+
+void RLMRemoveFromOrderedIndex(RLMClassInfo& info, size_t column, size_t row) {
+    if (info.orderedIndexTable(column)) {
+        switchOnColumnType(*info.table(), column, [&](auto type) {
+            indexForColumn<typename decltype(type)::type>(info, column).remove(row);
+        });
+    }
+    forEachCompositeIndex(info, column, [&](CompositeIndex&& index) { index.remove(row); });
+}
+
+void RLMInsertIntoOrderedIndex(RLMClassInfo& info, size_t column, size_t row) {
+    if (info.orderedIndexTable(column)) {
+        switchOnColumnType(*info.table(), column, [&](auto type) {
+            indexForColumn<typename decltype(type)::type>(info, column).insert(row);
+        });
+    }
+    forEachCompositeIndex(info, column, [&](CompositeIndex&& index) { index.insert(row); });
+}
+
+std::unique_ptr<realm::Expression> RLMMakeOrderedRangeExpression(realm::Table& table,
+                                                                 RLMObjectSchema *objectSchema,
+                                                                 RLMProperty *property,
+                                                                 id lower, bool lowerInclusive,
+                                                                 id upper, bool upperInclusive) {
+    size_t column = table.get_column_index(property.name.UTF8String);
+    return switchOnColumnType(table, column, [&](auto type) -> std::unique_ptr<Expression> {
+        using T = typename decltype(type)::type;
+        auto lowerValue = boundValue<T>(lower);
+        auto upperValue = boundValue<T>(upper);
+        return std::unique_ptr<Expression>(new OrderedRangeExpression<T>(table, column,
+                                                                         indexTableName(objectSchema, property),
+                                                                         std::move(lowerValue), lowerInclusive,
+                                                                         std::move(upperValue), upperInclusive));
+    });
+}
+
+std::unique_ptr<realm::Expression> RLMMakeCompositeIndexExpression(realm::Table& table,
+                                                                   RLMObjectSchema *objectSchema,
+                                                                   NSArray<NSString *> *propertyNames,
+                                                                   NSArray *prefix,
+                                                                   id lower, bool lowerInclusive,
+                                                                   id upper, bool upperInclusive) {
+    std::vector<size_t> columns;
+    for (NSString *propertyName in propertyNames) {
+        columns.push_back(table.get_column_index(propertyName.UTF8String));
+    }
+
+    std::vector<IndexValue> values;
+    std::vector<std::string> primaryKeys;
+    for (NSUInteger i = 0; i < prefix.count; ++i) {
+        if (table.get_column_type(columns[i]) != type_Link) {
+            values.push_back(valueFromObject(table, columns[i], prefix[i]));
+            primaryKeys.emplace_back();
+            continue;
+        }
+        RLMObjectBase *object = prefix[i];
+        NSString *primaryKey = object->_objectSchema.primaryKeyProperty.name;
+        auto& target = *table.get_link_target(columns[i]);
+        values.push_back(valueFromObject(target, target.get_column_index(primaryKey.UTF8String),
+                                         [object valueForKey:primaryKey]));
+        primaryKeys.push_back(primaryKey.UTF8String);
+    }
+
+    IndexValue lowerValue = valueFromObject(table, columns.back(), lower);
+    IndexValue upperValue = valueFromObject(table, columns.back(), upper);
+    return std::unique_ptr<Expression>(new CompositeIndexExpression(table, std::move(columns),
+                                                                    compositeIndexTableName(objectSchema, propertyNames),
+                                                                    RLMIndexCoverageTableName(objectSchema),
+                                                                    std::move(values), std::move(primaryKeys),
+                                                                    std::move(lowerValue), lowerInclusive,
+                                                                    std::move(upperValue), upperInclusive));
+}
+
+util::Optional<realm::Results> RLMSortedResultsFromOrderedIndex(RLMClassInfo& info,
+                                                                realm::Results const& results,
+                                                                NSArray<RLMSortDescriptor *> *descriptors) {
+    if (descriptors.count != 1) {
+        return util::none;
+    }
+    auto mode = results.get_mode();
+    if (mode != Results::Mode::Table && mode != Results::Mode::Query) {
+        return util::none;
+    }
+
+    RLMSortDescriptor *descriptor = descriptors.firstObject;
+    RLMProperty *property = info.rlmObjectSchema[descriptor.keyPath];
+    if (!property.orderedIndexed) {
+        return util::none;
+    }
+    Table *index = info.orderedIndexTable(info.tableColumn(property));
+    if (!index || !coversAllRows(*index, *info.table())) {
+        return util::none;
+    }
+
+    Results sorted(info.realm->_realm, index->get_linklist(s_ascendingColumn, 0));
+    if (mode == Results::Mode::Query) {
+        // A query restricted to a link list finds the matching rows in the
+        // order of the link list
+        sorted = sorted.filter(results.get_query());
+    }
+    if (!descriptor.ascending) {
+        // Core's sort is stable, so sorting the ascending order descending
+        // reverses it while keeping objects with equal values in the same
+        // order as when sorting ascending
+        sorted = sorted.sort(RLMSortDescriptorFromDescriptors(info, descriptors));
+    }
+    return sorted;
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMClassInfo.hpp"
+
+#import <realm/util/optional.hpp>
+
+#import <memory>
+
+namespace realm {
+    class Expression;
+    class Group;
+    class Results;
+    class Table;
+}
+@class RLMObjectSchema, RLMProperty, RLMRealm, RLMSortDescriptor;
+
+// Ordered indexes are stored in a table for each indexed property with a
+// single row holding a link list, which links to every object of the class in
+// ascending order of the property's value. Core removes deleted objects from
+// the link list, so the index only needs to be updated when an object is
+// created or the property is set. The index is only used when the link list
+// holds every object of the class, as objects created by something other than
+// this binding are not added to it.
+
+// Composite indexes are stored in a table for each index with a row for each
+// distinct set of values of the index's properties other than the last one.
+// Each row has a column for each of those properties, with links stored as
+// links so that core updates them, and a link list of the objects with those
+// values sorted by the last property.
+
+// Get the table storing the ordered index for the property, or nullptr if it
+// has not been created
+realm::Table *RLMOrderedIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property);
+
+// Get the table storing the composite index of the properties, or nullptr if
+// it has not been created
+realm::Table *RLMCompositeIndexTable(realm::Group& group, RLMObjectSchema *objectSchema,
+                                     NSArray<NSString *> *propertyNames);
+
+// Check if RLMUpdateOrderedIndexTables() has anything to do
+bool RLMOrderedIndexTablesNeedUpdate(RLMRealm *realm);
+
+// Create and populate the tables for any ordered indexed properties and
+// composite indexes in the Realm's schema which do not have one, and remove
+// the tables for indexes which are no longer in the schema. Must be called
+// within a write transaction.
+void RLMUpdateOrderedIndexTables(RLMRealm *realm);
+
+// Update the ordered and composite indexes of the object in the given row
+// after it has been created or updated from a value
+void RLMUpdateOrderedIndexes(RLMClassInfo& info, size_t row);
+
+// Remove the row from the ordered and composite indexes of the column before
+// its value is changed, and insert it at the position for its new value
+// afterwards
+void RLMRemoveFromOrderedIndex(RLMClassInfo& info, size_t column, size_t row);
+void RLMInsertIntoOrderedIndex(RLMClassInfo& info, size_t column, size_t row);
+
+// Update the ordered and composite indexes of the column, if it has any,
+// around setting the value of the given row. `fn` must perform the write.
+template<typename Fn>
+void RLMUpdateOrderedIndex(RLMClassInfo& info, size_t column, size_t row, Fn&& fn) {
+    if (!info.orderedIndexTable(column) && !info.hasCompositeIndex(column)) {
+        fn();
+        return;
+    }
+    RLMRemoveFromOrderedIndex(info, column, row);
+    try {
+        fn();
+    }
+    catch (...) {
+        // The value was not changed, so put the row back where it was
+        RLMInsertIntoOrderedIndex(info, column, row);
+        throw;
+    }
+    RLMInsertIntoOrderedIndex(info, column, row);
+}
+
+// Create a query expression which matches the rows of `table` whose value for
+// the ordered indexed property is within the range. A nil bound leaves that
+// side of the range open.
+std::unique_ptr<realm::Expression> RLMMakeOrderedRangeExpression(realm::Table& table,
+                                                                 RLMObjectSchema *objectSchema,
+                                                                 RLMProperty *property,
+                                                                 id lower, bool lowerInclusive,
+                                                                 id upper, bool upperInclusive);
+
+// Create a query expression which matches the rows of `table` whose values for
+// the composite index's properties other than the last one are equal to the
+// values in `prefix`, and whose value for the last property is within the
+// range. A nil bound leaves that side of the range open, and the last property
+// is not checked if both are nil. Objects in `prefix` must be managed by the
+// table's Realm and have a primary key.
+std::unique_ptr<realm::Expression> RLMMakeCompositeIndexExpression(realm::Table& table,
+                                                                   RLMObjectSchema *objectSchema,
+                                                                   NSArray<NSString *> *propertyNames,
+                                                                   NSArray *prefix,
+                                                                   id lower, bool lowerInclusive,
+                                                                   id upper, bool upperInclusive);
+
+// Get the results sorted by the descriptors by reading them in the order of an
+// ordered index, or none if the sort cannot be performed using an index or the
+// index does not have every object in it. The
+// results must contain every object of the type which matches their query,
+// rather than being restricted to a LinkView or distinct.
+realm::util::Optional<realm::Results> RLMSortedResultsFromOrderedIndex(RLMClassInfo& info,
+                                                                       realm::Results const& results,
+                                                                       NSArray<RLMSortDescriptor *> *descriptors);
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+#import <realm/mixed.hpp>
+#import <realm/util/optional.hpp>
+
+namespace realm {
+    class Query;
+    class Realm;
+    class Table;
+}
+enum class RLMCollectionAggregate;
+
+// Evaluation of queries over ranges of a table's rows on multiple threads.
+//
+// Each thread evaluates a copy of the query handed over into a read
+// transaction of its own on the same version as the calling thread's, which is
+// blocked until all of the partitions have been searched, so every thread sees
+// the same data without sharing any accessors.
+//
+// The Realm must be in a read transaction rather than a write transaction, as
+// uncommitted changes can't be seen by other threads, and must not be
+// read-only. Queries using expression nodes which don't support being handed
+// over (see RLMPredicateToQuery()'s canEvaluateConcurrently) must not be
+// passed in.
+
+// Returns the number of threads to use to evaluate a query over a table with
+// the given number of rows, or 0 if it should be evaluated on the calling
+// thread. `maximumConcurrency` is 0 for one thread per active processor.
+size_t RLMParallelQueryConcurrency(NSUInteger maximumConcurrency, size_t rowCount);
+
+// Count the rows matching the query
+size_t RLMParallelCount(realm::Realm& realm, realm::Query const& query, size_t concurrency);
+
+// Returns whether RLMParallelAggregate() supports the given aggregate for the
+// type of the column. Unsupported aggregates should be computed serially so
+// that the normal error is reported.
+bool RLMCanAggregateInParallel(realm::Table const& table, size_t column, RLMCollectionAggregate aggregate);
+
+// Computes the aggregate over the column's values in the rows matching the
+// query, returning none for min, max and average if there are no non-null
+// values, as realm::Results does
+realm::util::Optional<realm::Mixed> RLMParallelAggregate(realm::Realm& realm, realm::Query const& query, size_t column,
+                                                         RLMCollectionAggregate aggregate, size_t concurrency);
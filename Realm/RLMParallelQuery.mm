@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMParallelQuery.hpp"
+
+#import "RLMCollection_Private.hpp"
+
+#import "shared_realm.hpp"
+
+#import <realm/group_shared.hpp>
+#import <realm/query.hpp>
+#import <realm/table.hpp>
+#import <realm/timestamp.hpp>
+
+#import <algorithm>
+#import <atomic>
+#import <mutex>
+#import <vector>
+
+using namespace realm;
+
+namespace {
+// Tables smaller than this are always searched on the calling thread, as
+// dispatching the work to other threads would take longer than it saves
+constexpr size_t s_minimumParallelRowCount = 100000;
+
+// Core stores columns in B+tree leaves of up to 1000 values, so partitions are
+// a multiple of that size to avoid multiple threads each searching part of the
+// same leaf
+constexpr size_t s_leafSize = 1000;
+
+// The table is split into several partitions per thread, and each thread takes
+// the next unsearched partition whenever it finishes one, so a thread which
+// gets a partition which is cheap to search (e.g. because the first condition
+// rejects every row) picks up work which would otherwise be left to the others
+constexpr size_t s_partitionsPerThread = 8;
+
+// Evaluates a function over each partition of a query's table, returning the
+// results in row order
+//
+// Query, Table and Group accessors are not thread-safe, so the workers can't
+// use the calling thread's. Instead each worker opens its own uncached Realm,
+// begins a read transaction on the same version as the calling thread, and
+// evaluates a copy of the query handed over into that transaction. The calling
+// thread is blocked in its read transaction until all of the workers are done,
+// which keeps that version from being cleaned up.
+template<typename Result, typename Function>
+class PartitionedQuery {
+public:
+    PartitionedQuery(Realm& realm, Query const& query, size_t concurrency, Function& function)
+    : m_function(function)
+    , m_config(realm.config())
+    , m_rowCount(query.get_table()->size())
+    {
+        size_t targetSize = m_rowCount / (concurrency * s_partitionsPerThread);
+        m_partitionSize = std::max(s_leafSize, (targetSize + s_leafSize - 1) / s_leafSize * s_leafSize);
+        m_partitionCount = (m_rowCount + m_partitionSize - 1) / m_partitionSize;
+        size_t workerCount = std::min(concurrency, m_partitionCount);
+
+        m_config.cache = false;
+        auto& sharedGroup = _impl::RealmFriend::get_shared_group(realm);
+        m_handovers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            m_handovers.push_back(sharedGroup.export_for_handover(query, ConstSourcePayload::Copy));
+        }
+        m_results.resize(m_partitionCount);
+    }
+
+    std::vector<Result> run() {
+        // The calling thread is blocked until the search completes, so the
+        // work is run at its QoS to avoid a priority inversion
+        dispatch_apply_f(m_handovers.size(), dispatch_get_global_queue(qos_class_self(), 0), this, [](void *context, size_t worker) {
+            static_cast<PartitionedQuery *>(context)->work(worker);
+        });
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        return std::move(m_results);
+    }
+
+private:
+    Function& m_function;
+    Realm::Config m_config;
+    size_t m_rowCount;
+    size_t m_partitionSize;
+    size_t m_partitionCount;
+    std::vector<std::unique_ptr<SharedGroup::Handover<Query>>> m_handovers;
+    std::vector<Result> m_results;
+
+    std::atomic<size_t> m_nextPartition{0};
+    std::atomic<bool> m_failed{false};
+    std::mutex m_errorMutex;
+    std::exception_ptr m_error;
+
+    void fail() {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        if (!m_error) {
+            m_error = std::current_exception();
+        }
+        m_failed = true;
+    }
+
+    void work(size_t worker) {
+        SharedRealm realm;
+        std::unique_ptr<Query> query;
+        try {
+            realm = Realm::get_shared_realm(m_config);
+            auto& sharedGroup = _impl::RealmFriend::get_shared_group(*realm);
+            if (sharedGroup.get_transact_stage() != SharedGroup::transact_Ready) {
+                sharedGroup.end_read();
+            }
+            sharedGroup.begin_read(m_handovers[worker]->version);
+            query = sharedGroup.import_from_handover(std::move(m_handovers[worker]));
+        }
+        catch (...) {
+            fail();
+            return;
+        }
+
+        size_t partition;
+        while ((partition = m_nextPartition.fetch_add(1, std::memory_order_relaxed)) < m_partitionCount) {
+            if (m_failed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            size_t begin = partition * m_partitionSize;
+            size_t end = std::min(begin + m_partitionSize, m_rowCount);
+            try {
+                m_results[partition] = m_function(*query, begin, end);
+            }
+            catch (...) {
+                fail();
+            }
+        }
+    }
+};
+
+template<typename Function>
+auto runPartitioned(Realm& realm, Query const& query, size_t concurrency, Function function) {
+    using Result = decltype(function(std::declval<Query&>(), size_t(), size_t()));
+    return PartitionedQuery<Result, Function>(realm, query, concurrency, function).run();
+}
+
+// The functions used to aggregate each column type over a range of rows
+template<typename T> struct ColumnAggregates;
+
+template<> struct ColumnAggregates<int64_t> {
+    using Sum = int64_t;
+    static Sum sum(Query& q, size_t col, size_t begin, size_t end) {
+        return q.sum_int(col, nullptr, begin, end);
+    }
+    static int64_t min(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.minimum_int(col, count, begin, end);
+    }
+    static int64_t max(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.maximum_int(col, count, begin, end);
+    }
+    static double average(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.average_int(col, count, begin, end);
+    }
+};
+
+template<> struct ColumnAggregates<float> {
+    using Sum = double;
+    static Sum sum(Query& q, size_t col, size_t begin, size_t end) {
+        return q.sum_float(col, nullptr, begin, end);
+    }
+    static float min(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.minimum_float(col, count, begin, end);
+    }
+    static float max(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.maximum_float(col, count, begin, end);
+    }
+    static double average(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.average_float(col, count, begin, end);
+    }
+};
+
+template<> struct ColumnAggregates<double> {
+    using Sum = double;
+    static Sum sum(Query& q, size_t col, size_t begin, size_t end) {
+        return q.sum_double(col, nullptr, begin, end);
+    }
+    static double min(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.minimum_double(col, count, begin, end);
+    }
+    static double max(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.maximum_double(col, count, begin, end);
+    }
+    static double average(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        return q.average_double(col, count, begin, end);
+    }
+};
+
+template<> struct ColumnAggregates<Timestamp> {
+    // Timestamp aggregates don't report how many values they found, but
+    // return null if there were none
+    static Timestamp min(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        auto value = q.minimum_timestamp(col, nullptr, begin, end);
+        *count = !value.is_null();
+        return value;
+    }
+    static Timestamp max(Query& q, size_t col, size_t* count, size_t begin, size_t end) {
+        auto value = q.maximum_timestamp(col, nullptr, begin, end);
+        *count = !value.is_null();
+        return value;
+    }
+};
+
+template<typename T>
+util::Optional<Mixed> minMax(Realm& realm, Query const& query, size_t column, bool isMin, size_t concurrency) {
+    using Aggregates = ColumnAggregates<T>;
+    auto partitions = runPartitioned(realm, query, concurrency, [=](Query& q, size_t begin, size_t end) {
+        size_t count = 0;
+        T value = isMin ? Aggregates::min(q, column, &count, begin, end)
+                        : Aggregates::max(q, column, &count, begin, end);
+        return std::make_pair(value, count);
+    });
+
+    util::Optional<T> result;
+    for (auto& partition : partitions) {
+        if (partition.second == 0) {
+            continue;
+        }
+        if (!result || (isMin ? partition.first < *result : *result < partition.first)) {
+            result = partition.first;
+        }
+    }
+    if (!result) {
+        return util::none;
+    }
+    return Mixed(*result);
+}
+
+template<typename T>
+util::Optional<Mixed> sum(Realm& realm, Query const& query, size_t column, size_t concurrency) {
+    using Aggregates = ColumnAggregates<T>;
+    auto partitions = runPartitioned(realm, query, concurrency, [=](Query& q, size_t begin, size_t end) {
+        return Aggregates::sum(q, column, begin, end);
+    });
+
+    typename Aggregates::Sum result = 0;
+    for (auto value : partitions) {
+        result += value;
+    }
+    return Mixed(result);
+}
+
+template<typename T>
+util::Optional<Mixed> average(Realm& realm, Query const& query, size_t column, size_t concurrency) {
+    using Aggregates = ColumnAggregates<T>;
+    auto partitions = runPartitioned(realm, query, concurrency, [=](Query& q, size_t begin, size_t end) {
+        size_t count = 0;
+        double value = Aggregates::average(q, column, &count, begin, end);
+        return std::make_pair(value, count);
+    });
+
+    double total = 0;
+    size_t count = 0;
+    for (auto& partition : partitions) {
+        total += partition.first * partition.second;
+        count += partition.second;
+    }
+    if (count == 0) {
+        return util::none;
+    }
+    return Mixed(total / count);
+}
+
+template<typename T>
+util::Optional<Mixed> computeAggregate(Realm& realm, Query const& query, size_t column,
+                                       RLMCollectionAggregate aggregate, size_t concurrency) {
+    switch (aggregate) {
+        case RLMCollectionAggregate::Min:     return minMax<T>(realm, query, column, true, concurrency);
+        case RLMCollectionAggregate::Max:     return minMax<T>(realm, query, column, false, concurrency);
+        case RLMCollectionAggregate::Sum:     return sum<T>(realm, query, column, concurrency);
+        case RLMCollectionAggregate::Average: return average<T>(realm, query, column, concurrency);
+    }
+    REALM_UNREACHABLE();
+}
+} // anonymous namespace
+
+size_t RLMParallelQueryConcurrency(NSUInteger maximumConcurrency, size_t rowCount) {
+    if (maximumConcurrency == 1 || rowCount < s_minimumParallelRowCount) {
+        return 0;
+    }
+    if (maximumConcurrency == 0) {
+        maximumConcurrency = NSProcessInfo.processInfo.activeProcessorCount;
+    }
+    return maximumConcurrency > 1 ? maximumConcurrency : 0;
+}
+
+size_t RLMParallelCount(Realm& realm, Query const& query, size_t concurrency) {
+    auto partitions = runPartitioned(realm, query, concurrency, [](Query& q, size_t begin, size_t end) {
+        return q.count(begin, end);
+    });
+
+    size_t count = 0;
+    for (auto partitionCount : partitions) {
+        count += partitionCount;
+    }
+    return count;
+}
+
+bool RLMCanAggregateInParallel(Table const& table, size_t column, RLMCollectionAggregate aggregate) {
+    switch (table.get_column_type(column)) {
+        case type_Int:
+        case type_Float:
+        case type_Double:
+            return true;
+        case type_Timestamp:
+            return aggregate == RLMCollectionAggregate::Min || aggregate == RLMCollectionAggregate::Max;
+        default:
+            return false;
+    }
+}
+
+util::Optional<Mixed> RLMParallelAggregate(Realm& realm, Query const& query, size_t column,
+                                           RLMCollectionAggregate aggregate, size_t concurrency) {
+    switch (query.get_table()->get_column_type(column)) {
+        case type_Int:    return computeAggregate<int64_t>(realm, query, column, aggregate, concurrency);
+        case type_Float:  return computeAggregate<float>(realm, query, column, aggregate, concurrency);
+        case type_Double: return computeAggregate<double>(realm, query, column, aggregate, concurrency);
+        case type_Timestamp:
+            REALM_ASSERT(aggregate == RLMCollectionAggregate::Min || aggregate == RLMCollectionAggregate::Max);
+            return minMax<Timestamp>(realm, query, column, aggregate == RLMCollectionAggregate::Min, concurrency);
+        default:
+            REALM_UNREACHABLE();
+    }
+}
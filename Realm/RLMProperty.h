@@ -72,6 +72,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) BOOL indexed;
 
+/**
+ Indicates whether this property has a full-text index.
+
+ @see `+[RLMObject fullTextIndexedProperties]`
+ */
+@property (nonatomic, readonly) BOOL fullTextIndexed;
+
+/**
+ Indicates whether this property has an ordered index.
+
+ @see `+[RLMObject orderedIndexedProperties]`
+ */
+@property (nonatomic, readonly) BOOL orderedIndexed;
+
+/**
+ Indicates whether this property has a case-insensitive index.
+
+ @see `+[RLMObject caseInsensitiveIndexedProperties]`
+ */
+@property (nonatomic, readonly) BOOL caseInsensitiveIndexed;
+
 /**
  For `RLMObject` and `RLMArray` properties, the name of the class of object stored in the property.
  */
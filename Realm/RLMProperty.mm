@@ -512,6 +512,9 @@ static bool rawTypeIsComputedProperty(NSString *rawType) {
     prop->_type = _type;
     prop->_objectClassName = _objectClassName;
     prop->_indexed = _indexed;
+    prop->_fullTextIndexed = _fullTextIndexed;
+    prop->_orderedIndexed = _orderedIndexed;
+    prop->_caseInsensitiveIndexed = _caseInsensitiveIndexed;
     prop->_getterName = _getterName;
     prop->_setterName = _setterName;
     prop->_getterSel = _getterSel;
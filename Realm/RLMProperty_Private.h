@@ -93,6 +93,9 @@ static inline NSString *RLMTypeToString(RLMPropertyType type) {
 @property (nonatomic, readwrite) NSString *name;
 @property (nonatomic, readwrite, assign) RLMPropertyType type;
 @property (nonatomic, readwrite) BOOL indexed;
+@property (nonatomic, readwrite) BOOL fullTextIndexed;
+@property (nonatomic, readwrite) BOOL orderedIndexed;
+@property (nonatomic, readwrite) BOOL caseInsensitiveIndexed;
 @property (nonatomic, readwrite) BOOL optional;
 @property (nonatomic, copy, nullable) NSString *objectClassName;
 
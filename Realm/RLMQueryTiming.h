@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The time taken to evaluate a query on an `RLMResults`, passed to the
+ `slowQueryBlock` of the Realm's configuration.
+
+ Only queries run on the thread which is using the results are timed. When an
+ `RLMResults` has notification blocks, its query is also re-run on a background
+ thread after each write transaction to compute the changes, and those runs are
+ not timed or reported.
+ */
+@interface RLMQueryTiming : NSObject
+
+/// The name of the class which was queried.
+@property (nonatomic, readonly) NSString *className;
+
+/**
+ The format of the predicate which the results were filtered with, or `nil` if
+ the query matched every object of the class or every object in a list.
+ */
+@property (nonatomic, readonly, nullable) NSString *predicateFormat;
+
+/// The time taken to convert the predicate to a query, in seconds.
+@property (nonatomic, readonly) NSTimeInterval buildDuration;
+
+/// The time taken to run the query, in seconds.
+@property (nonatomic, readonly) NSTimeInterval executionDuration;
+
+/**
+ The number of objects of the class when the query was run, which a query that
+ does not use an index examines. Queries on the objects in an `RLMArray` only
+ examine the objects in the array.
+ */
+@property (nonatomic, readonly) NSUInteger searchedObjectCount;
+
+/**
+ The number of objects which matched the query, or `NSNotFound` if the operation
+ which ran the query did not need to find every matching object, such as an
+ aggregate evaluated on several threads.
+ */
+@property (nonatomic, readonly) NSUInteger resultCount;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("RLMQueryTiming cannot be created directly")));
+
+@end
+
+NS_ASSUME_NONNULL_END
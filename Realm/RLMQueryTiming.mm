@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMQueryTiming_Private.hpp"
+
+@implementation RLMQueryTiming
+- (instancetype)initWithClassName:(NSString *)className
+                  predicateFormat:(NSString *)predicateFormat
+                 buildNanoseconds:(uint64_t)buildNanoseconds
+             executionNanoseconds:(uint64_t)executionNanoseconds
+              searchedObjectCount:(size_t)searchedObjectCount
+                      resultCount:(size_t)resultCount {
+    if (self = [super init]) {
+        _className = className;
+        _predicateFormat = predicateFormat;
+        _buildDuration = buildNanoseconds / (double)NSEC_PER_SEC;
+        _executionDuration = executionNanoseconds / (double)NSEC_PER_SEC;
+        _searchedObjectCount = searchedObjectCount;
+        _resultCount = resultCount;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"RLMQueryTiming {\n"
+            @"\tclassName = %@;\n"
+            @"\tpredicateFormat = %@;\n"
+            @"\tbuildDuration = %f;\n"
+            @"\texecutionDuration = %f;\n"
+            @"\tsearchedObjectCount = %zu;\n"
+            @"\tresultCount = %zu;\n"
+            @"}",
+            _className, _predicateFormat, _buildDuration, _executionDuration,
+            (size_t)_searchedObjectCount, (size_t)_resultCount];
+}
+@end
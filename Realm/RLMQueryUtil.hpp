@@ -21,6 +21,7 @@
 #import <vector>
 
 namespace realm {
+    class DistinctDescriptor;
     class Group;
     class Query;
     class SortDescriptor;
@@ -32,11 +33,26 @@ class RLMClassInfo;
 extern NSString * const RLMPropertiesComparisonTypeMismatchException;
 extern NSString * const RLMUnsupportedTypesFoundInPropertyComparisonException;
 
+// If `canEvaluateConcurrently` is non-null, it is set to whether the returned
+// query can be handed over to other threads' read transactions and evaluated
+// on several of them at once
 realm::Query RLMPredicateToQuery(NSPredicate *predicate, RLMObjectSchema *objectSchema,
-                                 RLMSchema *schema, realm::Group &group);
+                                 RLMSchema *schema, realm::Group &group,
+                                 bool *canEvaluateConcurrently = nullptr);
+
+// Describe how the predicate is evaluated: the order in which the conditions
+// of a top-level AND predicate are evaluated, whether each uses an index, and
+// how many objects each condition examines and matches when run over the
+// objects matched by the conditions before it. This runs each condition as a
+// separate query.
+NSString *RLMExplainPredicate(NSPredicate *predicate, RLMObjectSchema *objectSchema,
+                              RLMSchema *schema, realm::Group &group);
 
 // return property - throw for invalid column name
 RLMProperty *RLMValidatedProperty(RLMObjectSchema *objectSchema, NSString *columnName);
 
 // validate the array of RLMSortDescriptors and convert it to a realm::SortDescriptor
 realm::SortDescriptor RLMSortDescriptorFromDescriptors(RLMClassInfo& classInfo, NSArray<RLMSortDescriptor *> *descriptors);
+
+// validate the array of key paths and convert it to a realm::DistinctDescriptor
+realm::DistinctDescriptor RLMDistinctDescriptorFromKeyPaths(RLMClassInfo& classInfo, NSArray<NSString *> *keyPaths);
@@ -19,11 +19,16 @@
 #import "RLMQueryUtil.hpp"
 
 #import "RLMArray.h"
+#import "RLMCaseInsensitiveIndex_Private.hpp"
+#import "RLMIndexTables_Private.hpp"
 #import "RLMObjectSchema_Private.h"
 #import "RLMObject_Private.hpp"
+#import "RLMOrderedIndex_Private.hpp"
 #import "RLMPredicateUtil.hpp"
 #import "RLMProperty_Private.h"
+#import "RLMRegularExpression_Private.hpp"
 #import "RLMSchema.h"
+#import "RLMTextSearch_Private.hpp"
 #import "RLMUtil.hpp"
 
 #import "object_store.hpp"
@@ -31,8 +36,15 @@
 
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
+#include <realm/table_view.hpp>
 #include <realm/util/cf_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
 using namespace realm;
 
 NSString * const RLMPropertiesComparisonTypeMismatchException = @"RLMPropertiesComparisonTypeMismatchException";
@@ -147,6 +159,167 @@ struct FalseExpression : realm::Expression {
 };
 
 
+// The set of values used by ValueInSetExpression. Numbers and timestamps are
+// stored in a sorted array and found by binary search, while strings are
+// stored in a hash set.
+template<typename T>
+class ValueSet {
+public:
+    void add(T value) { m_values.push_back(value); }
+
+    void finalize()
+    {
+        std::sort(m_values.begin(), m_values.end());
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+    }
+
+    bool contains(T value) const { return std::binary_search(m_values.begin(), m_values.end(), value); }
+    std::vector<T> const& values() const { return m_values; }
+
+private:
+    std::vector<T> m_values;
+};
+
+// NaN is not equal to anything, including itself, and would break the
+// ordering of the sorted array, so it is never stored
+template<>
+void ValueSet<float>::add(float value) { if (!std::isnan(value)) m_values.push_back(value); }
+template<>
+void ValueSet<double>::add(double value) { if (!std::isnan(value)) m_values.push_back(value); }
+
+template<>
+class ValueSet<StringData> {
+public:
+    ValueSet() = default;
+    ValueSet(ValueSet const& other) : m_storage(other.m_storage) { finalize(); }
+    ValueSet& operator=(ValueSet const&) = delete;
+
+    void add(StringData value) { m_storage.emplace_back(value.data(), value.size()); }
+
+    // The set refers to the strings in m_storage, so it can only be built
+    // once all of the strings have been added
+    void finalize()
+    {
+        m_values.clear();
+        m_values.reserve(m_storage.size());
+        for (auto& str : m_storage) {
+            m_values.insert(StringData(str));
+        }
+    }
+
+    bool contains(StringData value) const { return m_values.count(value); }
+    std::vector<std::string> const& values() const { return m_storage; }
+
+private:
+    struct Hash {
+        size_t operator()(StringData str) const noexcept
+        {
+            // FNV-1a
+            size_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < str.size(); ++i) {
+                hash = (hash ^ static_cast<unsigned char>(str.data()[i])) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+
+    std::vector<std::string> m_storage;
+    std::unordered_set<StringData, Hash> m_values;
+};
+
+template<typename T> T get_value(const Table& table, size_t column, size_t row);
+template<> int64_t get_value<int64_t>(const Table& table, size_t column, size_t row) { return table.get_int(column, row); }
+template<> float get_value<float>(const Table& table, size_t column, size_t row) { return table.get_float(column, row); }
+template<> double get_value<double>(const Table& table, size_t column, size_t row) { return table.get_double(column, row); }
+template<> Timestamp get_value<Timestamp>(const Table& table, size_t column, size_t row) { return table.get_timestamp(column, row); }
+template<> StringData get_value<StringData>(const Table& table, size_t column, size_t row) { return table.get_string(column, row); }
+
+// Only ints, strings and timestamps can have a search index
+template<typename T> struct CanBeIndexed : std::true_type { };
+template<> struct CanBeIndexed<float> : std::false_type { };
+template<> struct CanBeIndexed<double> : std::false_type { };
+
+// Matches rows where the value in a column is one of a set of values, for
+// "key IN collection". Building an OR of one equality node per value instead
+// would require evaluating every node for each row, which is very slow for
+// large collections. If the column has a search index, the matching rows are
+// looked up in the index when the query is run instead of checking each row.
+template<typename T>
+class ValueInSetExpression : public realm::Expression {
+public:
+    ValueInSetExpression(const Table& table, size_t column, ValueSet<T> values, bool matches_null)
+    : m_table(&table), m_column(column), m_values(std::move(values)), m_matches_null(matches_null)
+    {
+        m_values.finalize();
+    }
+
+    double init() override
+    {
+        m_nullable = m_table->is_nullable(m_column);
+        m_use_index = CanBeIndexed<T>::value && m_table->has_search_index(m_column);
+        if (m_use_index) {
+            find_indexed_rows();
+        }
+        return 50.0;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_use_index) {
+            auto it = std::lower_bound(m_indexed_rows.begin(), m_indexed_rows.end(), start);
+            return it != m_indexed_rows.end() && *it < end ? *it : realm::not_found;
+        }
+
+        for (size_t row = start; row < end; ++row) {
+            if (m_nullable && m_table->is_null(m_column, row)) {
+                if (m_matches_null) {
+                    return row;
+                }
+            }
+            else if (m_values.contains(get_value<T>(*m_table, m_column, row))) {
+                return row;
+            }
+        }
+        return realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_table = table; }
+    void verify_column() const override { REALM_ASSERT(m_column < m_table->get_column_count()); }
+    const Table* get_base_table() const override { return m_table; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new ValueInSetExpression(*this));
+    }
+
+private:
+    const Table* m_table;
+    size_t m_column;
+    ValueSet<T> m_values;
+    bool m_matches_null;
+
+    bool m_nullable = false;
+    bool m_use_index = false;
+    std::vector<size_t> m_indexed_rows;
+
+    void find_indexed_rows()
+    {
+        m_indexed_rows.clear();
+        auto add_matches = [&](Query query) {
+            TableView tv = query.find_all();
+            for (size_t i = 0; i < tv.size(); ++i) {
+                m_indexed_rows.push_back(tv.get_source_ndx(i));
+            }
+        };
+        for (auto& value : m_values.values()) {
+            add_matches(m_table->where().equal(m_column, T(value)));
+        }
+        if (m_matches_null && m_nullable) {
+            add_matches(m_table->where().equal(m_column, realm::null()));
+        }
+        std::sort(m_indexed_rows.begin(), m_indexed_rows.end());
+    }
+};
+
 // Equal and ContainsSubstring are used by QueryBuilder::add_string_constraint as the comparator
 // for performing diacritic-insensitive comparisons.
 
@@ -218,6 +391,23 @@ struct ContainsSubstring {
 };
 
 
+// The operator which gives the same result when the operands are swapped
+NSPredicateOperatorType reversed_operator(NSPredicateOperatorType operatorType)
+{
+    switch (operatorType) {
+        case NSLessThanPredicateOperatorType:
+            return NSGreaterThanPredicateOperatorType;
+        case NSLessThanOrEqualToPredicateOperatorType:
+            return NSGreaterThanOrEqualToPredicateOperatorType;
+        case NSGreaterThanPredicateOperatorType:
+            return NSLessThanPredicateOperatorType;
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+            return NSLessThanOrEqualToPredicateOperatorType;
+        default:
+            return operatorType;
+    }
+}
+
 NSString *operatorName(NSPredicateOperatorType operatorType)
 {
     switch (operatorType) {
@@ -391,6 +581,155 @@ private:
     size_t m_index;
 };
 
+// Operators for the arithmetic functions of NSExpression which core's
+// Operator and UnaryOperator don't have built in. Modulus follows
+// NSExpression in using the floating point remainder.
+struct Modulus {
+    double operator()(double v1, double v2) const { return std::fmod(v1, v2); }
+    static std::string description() { return "%"; }
+    typedef double type;
+};
+
+// Integer results which don't fit in 64 bits saturate at the nearest limit
+// rather than overflowing, as signed overflow is undefined
+template <class T>
+struct Abs {
+    T operator()(T v) const
+    {
+        if (std::is_integral<T>::value && v == std::numeric_limits<T>::min()) {
+            return std::numeric_limits<T>::max();
+        }
+        return v < 0 ? -v : v;
+    }
+    static std::string description() { return "abs"; }
+    typedef T type;
+};
+
+struct SaturatingPlus {
+    Int operator()(Int v1, Int v2) const
+    {
+        Int result;
+        if (__builtin_add_overflow(v1, v2, &result)) {
+            return v2 < 0 ? std::numeric_limits<Int>::min() : std::numeric_limits<Int>::max();
+        }
+        return result;
+    }
+    static std::string description() { return "+"; }
+    typedef Int type;
+};
+
+struct SaturatingMinus {
+    Int operator()(Int v1, Int v2) const
+    {
+        Int result;
+        if (__builtin_sub_overflow(v1, v2, &result)) {
+            return v2 < 0 ? std::numeric_limits<Int>::max() : std::numeric_limits<Int>::min();
+        }
+        return result;
+    }
+    static std::string description() { return "-"; }
+    typedef Int type;
+};
+
+struct SaturatingMul {
+    Int operator()(Int v1, Int v2) const
+    {
+        Int result;
+        if (__builtin_mul_overflow(v1, v2, &result)) {
+            return (v1 < 0) != (v2 < 0) ? std::numeric_limits<Int>::min() : std::numeric_limits<Int>::max();
+        }
+        return result;
+    }
+    static std::string description() { return "*"; }
+    typedef Int type;
+};
+
+// The value of a date column as seconds since 1970, as dates are numbers of
+// seconds when used in arithmetic
+class TimestampSeconds : public Subexpr2<Double> {
+public:
+    TimestampSeconds(std::unique_ptr<Subexpr> column) : m_column(std::move(column)) { }
+
+    std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<Subexpr>(new TimestampSeconds(m_column->clone(patches)));
+    }
+
+    void apply_handover_patch(QueryNodeHandoverPatches& patches, Group& group) override
+    {
+        m_column->apply_handover_patch(patches, group);
+    }
+
+    void set_base_table(const Table* table) override { m_column->set_base_table(table); }
+    void verify_column() const override { m_column->verify_column(); }
+    const Table* get_base_table() const override { return m_column->get_base_table(); }
+
+    void evaluate(size_t index, ValueBase& destination) override
+    {
+        Value<Timestamp> timestamps;
+        m_column->evaluate(index, timestamps);
+
+        Value<Double> seconds;
+        seconds.init(timestamps.m_from_link_list, timestamps.m_values);
+        for (size_t i = 0; i < timestamps.m_values; ++i) {
+            if (timestamps.m_storage.is_null(i)) {
+                seconds.m_storage.set_null(i);
+            }
+            else {
+                Timestamp timestamp = timestamps.m_storage[i];
+                seconds.m_storage.set(i, timestamp.get_seconds() + timestamp.get_nanoseconds() / 1e9);
+            }
+        }
+        destination.import(seconds);
+    }
+
+private:
+    std::unique_ptr<Subexpr> m_column;
+};
+
+// An operand of an arithmetic expression, which is a Subexpr2 of `type`.
+// Arithmetic on integers is performed in 64-bit integers and everything else
+// in doubles, so only a float property on its own has the type float.
+struct ArithmeticOperand {
+    std::unique_ptr<Subexpr> expression;
+    RLMPropertyType type;
+
+    bool is_int() const { return type == RLMPropertyTypeInt; }
+
+    template <typename Func>
+    void visit(Func&& func) const
+    {
+        switch (type) {
+            case RLMPropertyTypeInt:
+                func(static_cast<Subexpr2<Int>&>(*expression));
+                break;
+            case RLMPropertyTypeFloat:
+                func(static_cast<Subexpr2<Float>&>(*expression));
+                break;
+            default:
+                func(static_cast<Subexpr2<Double>&>(*expression));
+                break;
+        }
+    }
+};
+
+// Whether the number holds an integer rather than a floating point value
+bool number_is_integer(NSNumber *number)
+{
+    char type = number.objCType[0];
+    return type != *@encode(float) && type != *@encode(double);
+}
+
+bool is_arithmetic_function_expression(NSExpression *expression)
+{
+    if (expression.expressionType != NSFunctionExpressionType) {
+        return false;
+    }
+    static NSSet *functions = [NSSet setWithObjects:@"add:to:", @"from:subtract:", @"multiply:by:",
+                               @"divide:by:", @"modulus:by:", @"abs:", nil];
+    return [functions containsObject:expression.function];
+}
+
 class CollectionOperation {
 public:
     enum Type {
@@ -501,6 +840,14 @@ private:
     util::Optional<ColumnReference> m_column;
 };
 
+// A condition of a predicate, with how it is evaluated and an estimate of the
+// cost of evaluating it for each object relative to other conditions
+struct PlannedPredicate {
+    NSPredicate *predicate;
+    double cost;
+    NSString *strategy;
+};
+
 class QueryBuilder {
 public:
     QueryBuilder(Query& query, Group& group, RLMSchema *schema)
@@ -508,16 +855,36 @@ public:
 
     void apply_predicate(NSPredicate *predicate, RLMObjectSchema *objectSchema);
 
+    // Record the top-level conditions of the next predicate applied in the
+    // order in which they are added to the query
+    void set_plan(std::vector<PlannedPredicate>* plan) { m_plan = plan; }
+
+    // Whether copies of the query can be evaluated on several threads at once.
+    // Each thread gets a copy handed over into its own read transaction, but
+    // the expression nodes implemented here rather than in core don't patch
+    // their table references when handed over, so queries using them are
+    // evaluated on one thread. Queries following links are too, as they
+    // search the linked tables rather than the partitioned one.
+    bool can_evaluate_concurrently() const { return m_concurrent; }
+
 
     void apply_collection_operator_expression(RLMObjectSchema *desc, NSString *keyPath, id value, NSComparisonPredicate *pred);
     void apply_value_expression(RLMObjectSchema *desc, NSString *keyPath, id value, NSComparisonPredicate *pred);
     void apply_column_expression(RLMObjectSchema *desc, NSString *leftKeyPath, NSString *rightKeyPath, NSComparisonPredicate *predicate);
+    void apply_text_search_expression(RLMObjectSchema *desc, NSString *keyPath, id value);
+    NSArray<NSPredicate *> *apply_composite_index(RLMObjectSchema *objectSchema, NSArray<NSPredicate *> *subpredicates,
+                                                  std::vector<PlannedPredicate>* plan);
+    NSArray<NSPredicate *> *plan_conjunction(RLMObjectSchema *objectSchema, NSArray<NSPredicate *> *subpredicates,
+                                             std::vector<PlannedPredicate>* plan);
+    PlannedPredicate plan_predicate(NSPredicate *predicate, RLMObjectSchema *objectSchema) const;
     void apply_subquery_count_expression(RLMObjectSchema *objectSchema, NSExpression *subqueryExpression,
                                          NSPredicateOperatorType operatorType, NSExpression *right);
     void apply_function_subquery_expression(RLMObjectSchema *objectSchema, NSExpression *functionExpression,
                                             NSPredicateOperatorType operatorType, NSExpression *right);
     void apply_function_expression(RLMObjectSchema *objectSchema, NSExpression *functionExpression,
                                    NSPredicateOperatorType operatorType, NSExpression *right);
+    void apply_arithmetic_expression(RLMObjectSchema *objectSchema, NSComparisonPredicate *predicate);
+    ArithmeticOperand arithmetic_operand(RLMObjectSchema *objectSchema, NSExpression *expression);
 
 
     template <typename A, typename B>
@@ -551,6 +918,22 @@ public:
 
     void add_between_constraint(const ColumnReference& column, id value);
 
+    bool add_ordered_range_constraint(const ColumnReference& column, NSPredicateOperatorType operatorType, id value);
+    bool add_ordered_range_constraint(const ColumnReference& column,
+                                      id lower, bool lowerInclusive,
+                                      id upper, bool upperInclusive);
+
+    bool add_case_insensitive_index_constraint(const ColumnReference& column, NSPredicateOperatorType operatorType,
+                                               NSComparisonPredicateOptions predicateOptions, id value);
+
+    void add_regular_expression_constraint(const ColumnReference& column,
+                                           NSComparisonPredicateOptions predicateOptions, NSString *pattern);
+
+    bool add_value_in_set_constraint(const ColumnReference& column, NSComparisonPredicateOptions predicateOptions,
+                                     NSArray *values);
+    template <typename T, typename Requested>
+    void add_value_in_set_constraint(const ColumnReference& column, NSArray *values);
+
     template<typename T>
     void add_binary_constraint(NSPredicateOperatorType operatorType, const ColumnReference& column, T value);
     void add_binary_constraint(NSPredicateOperatorType operatorType, const ColumnReference& column, id value);
@@ -570,6 +953,8 @@ public:
                                              CollectionOperation collectionOperation, T... values);
 
 
+    bool can_use_composite_index(RLMProperty *property, id value) const;
+
     CollectionOperation collection_operation_from_key_path(RLMObjectSchema *desc, NSString *keyPath);
     ColumnReference column_reference_from_key_path(RLMObjectSchema *objectSchema, NSString *keyPath, bool isAggregate);
 
@@ -577,6 +962,13 @@ private:
     Query& m_query;
     Group& m_group;
     RLMSchema *m_schema;
+    std::vector<PlannedPredicate>* m_plan = nullptr;
+    bool m_concurrent = true;
+
+    void add_custom_expression(std::unique_ptr<Expression> expression) {
+        m_query.and_query(std::move(expression));
+        m_concurrent = false;
+    }
 };
 
 // add a clause for numeric constraints based on operator type
@@ -754,6 +1146,10 @@ void QueryBuilder::add_between_constraint(const ColumnReference& column, id valu
     id from, to;
     validate_and_extract_between_range(value, column.property(), &from, &to);
 
+    if (from && to && add_ordered_range_constraint(column, from, true, to, true)) {
+        return;
+    }
+
     RLMPropertyType type = column.type();
 
     m_query.group();
@@ -762,6 +1158,160 @@ void QueryBuilder::add_between_constraint(const ColumnReference& column, id valu
     m_query.end_group();
 }
 
+// Add a constraint for comparing the column to the value, where the column is
+// the left operand, using the column's ordered index. Returns false without
+// adding anything if the comparison cannot use an ordered index.
+bool QueryBuilder::add_ordered_range_constraint(const ColumnReference& column,
+                                                NSPredicateOperatorType operatorType, id value) {
+    if (!value || value == NSNull.null) {
+        return false;
+    }
+    switch (operatorType) {
+        case NSLessThanPredicateOperatorType:
+            return add_ordered_range_constraint(column, nil, false, value, false);
+        case NSLessThanOrEqualToPredicateOperatorType:
+            return add_ordered_range_constraint(column, nil, false, value, true);
+        case NSGreaterThanPredicateOperatorType:
+            return add_ordered_range_constraint(column, value, false, nil, false);
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+            return add_ordered_range_constraint(column, value, true, nil, false);
+        default:
+            return false;
+    }
+}
+
+// Add a constraint matching the rows whose value for the column is within the
+// range using the column's ordered index, where a nil bound leaves that side
+// of the range open. Returns false without adding anything if the column does
+// not have an ordered index.
+bool QueryBuilder::add_ordered_range_constraint(const ColumnReference& column,
+                                                id lower, bool lowerInclusive,
+                                                id upper, bool upperInclusive) {
+    RLMProperty *property = column.property();
+    if (column.has_links() || !property.orderedIndexed) {
+        return false;
+    }
+    switch (property.type) {
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeDate:
+            break;
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+            // NaN is not ordered relative to other numbers
+            if (std::isnan([lower doubleValue]) || std::isnan([upper doubleValue])) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    Table& table = *m_query.get_table();
+    auto objectType = ObjectStore::object_type_for_table_name(table.get_name());
+    RLMObjectSchema *objectSchema = [m_schema schemaForClassName:RLMStringDataToNSString(objectType)];
+    if (!objectSchema || !RLMOrderedIndexTable(m_group, objectSchema, property)) {
+        return false;
+    }
+
+    add_custom_expression(RLMMakeOrderedRangeExpression(table, objectSchema, property,
+                                                        lower, lowerInclusive, upper, upperInclusive));
+    return true;
+}
+
+// Add a constraint for comparing the column to the value, where the column is
+// the left operand, using the column's case-insensitive index to find the
+// candidate rows. Returns false without adding anything if the comparison
+// cannot use a case-insensitive index.
+bool QueryBuilder::add_case_insensitive_index_constraint(const ColumnReference& column,
+                                                         NSPredicateOperatorType operatorType,
+                                                         NSComparisonPredicateOptions predicateOptions, id value) {
+    RLMProperty *property = column.property();
+    if (column.has_links() || !property.caseInsensitiveIndexed) {
+        return false;
+    }
+    if (!(predicateOptions & (NSCaseInsensitivePredicateOption | NSDiacriticInsensitivePredicateOption))) {
+        return false;
+    }
+    if (operatorType != NSEqualToPredicateOperatorType && operatorType != NSBeginsWithPredicateOperatorType) {
+        return false;
+    }
+    if (![value isKindOfClass:[NSString class]]) {
+        return false;
+    }
+
+    Table& table = *m_query.get_table();
+    auto objectType = ObjectStore::object_type_for_table_name(table.get_name());
+    RLMObjectSchema *objectSchema = [m_schema schemaForClassName:RLMStringDataToNSString(objectType)];
+    if (!objectSchema || !RLMCaseInsensitiveIndexTable(m_group, objectSchema, property)) {
+        return false;
+    }
+
+    // The index finds every row whose folded value matches, which includes
+    // rows that only match when ignoring both case and diacritics, so the
+    // comparison itself is still needed to check the candidates. Grouping
+    // them keeps the pair together when the predicate is negated.
+    m_query.group();
+    add_custom_expression(RLMMakeCaseInsensitiveIndexExpression(table, objectSchema, property, value,
+                                                                operatorType == NSBeginsWithPredicateOperatorType));
+    add_constraint(column.type(), operatorType, predicateOptions, column, value);
+    m_query.end_group();
+    return true;
+}
+
+// Add a constraint for the column, which is the left operand, being matched
+// in its entirety by the regular expression
+void QueryBuilder::add_regular_expression_constraint(const ColumnReference& column,
+                                                     NSComparisonPredicateOptions predicateOptions,
+                                                     NSString *pattern) {
+    RLMPrecondition(!(predicateOptions & NSDiacriticInsensitivePredicateOption),
+                    @"Invalid operator type",
+                    @"Operator 'MATCHES' not supported with diacritic-insensitive modifier.");
+    bool caseInsensitive = predicateOptions & NSCaseInsensitivePredicateOption;
+    NSString *error;
+    auto regex = RLMCompileRegularExpression(pattern, caseInsensitive, &error);
+    if (!regex) {
+        @throw RLMPredicateException(@"Invalid regular expression",
+                                     @"'%@' is not a valid regular expression: %@", pattern, error);
+    }
+
+    bool entirePattern;
+    std::string prefix = RLMRegularExpressionLiteralPrefix(*regex, &entirePattern);
+    if (entirePattern && !caseInsensitive) {
+        // Patterns without any special characters are equality comparisons,
+        // which can use the search index
+        m_query.and_query(column.resolve<String>().equal(StringData(prefix), true));
+        return;
+    }
+
+    RLMProperty *property = column.property();
+    RLMObjectSchema *objectSchema;
+    if (!prefix.empty() && !column.has_links() && property.caseInsensitiveIndexed) {
+        auto objectType = ObjectStore::object_type_for_table_name(m_query.get_table()->get_name());
+        objectSchema = [m_schema schemaForClassName:RLMStringDataToNSString(objectType)];
+        // Objects created without going through the binding aren't in the
+        // index, so it can only seed the matching if it has every object.
+        // The index expression checks this again each time the query runs.
+        if (objectSchema && (!RLMCaseInsensitiveIndexTable(m_group, objectSchema, property)
+                             || !RLMIndexTablesCoverAllRows(*m_query.get_table(),
+                                                            RLMIndexCoverageTableName(objectSchema)))) {
+            objectSchema = nil;
+        }
+    }
+    if (!objectSchema) {
+        add_custom_expression(RLMMakeRegularExpressionExpression(column.resolve<String>().clone(), std::move(regex)));
+        return;
+    }
+
+    // The case-insensitive index finds the rows which begin with the pattern's
+    // literal prefix ignoring case and diacritics, which the automaton then
+    // checks. Grouping them keeps the pair together when negated.
+    m_query.group();
+    add_custom_expression(RLMMakeCaseInsensitiveIndexExpression(*m_query.get_table(), objectSchema, property,
+                                                                @(prefix.c_str()), true));
+    add_custom_expression(RLMMakeRegularExpressionExpression(column.resolve<String>().clone(), std::move(regex)));
+    m_query.end_group();
+}
+
 template<typename T>
 void QueryBuilder::add_binary_constraint(NSPredicateOperatorType operatorType,
                                          const ColumnReference& column,
@@ -1054,6 +1604,9 @@ ColumnReference QueryBuilder::column_reference_from_key_path(RLMObjectSchema *ob
                                      @"Key paths that include an array property must use aggregate operations");
     }
 
+    if (!keyPath.links.empty()) {
+        m_concurrent = false;
+    }
     return ColumnReference(m_query, m_group, m_schema, keyPath.property, std::move(keyPath.links));
 }
 
@@ -1217,6 +1770,80 @@ void QueryBuilder::apply_collection_operator_expression(RLMObjectSchema *desc,
     }
 }
 
+template <typename T, typename Requested>
+void QueryBuilder::add_value_in_set_constraint(const ColumnReference& column, NSArray *values)
+{
+    ValueSet<T> set;
+    bool matchesNull = false;
+    for (id value in values) {
+        if (is_nsnull(value)) {
+            matchesNull = true;
+        }
+        else {
+            set.add(convert<Requested>(value));
+        }
+    }
+    add_custom_expression(std::unique_ptr<Expression>(new ValueInSetExpression<T>(*m_query.get_table(), column.index(),
+                                                                                   std::move(set), matchesNull)));
+}
+
+// Add a single set membership node for "key.path IN collection" if the
+// column and comparison support it, returning false if it should be
+// evaluated as ORed together equality comparisons instead
+bool QueryBuilder::add_value_in_set_constraint(const ColumnReference& column,
+                                               NSComparisonPredicateOptions predicateOptions,
+                                               NSArray *values)
+{
+    // A single value is better handled by core's own equality node
+    if (column.has_links() || values.count < 2) {
+        return false;
+    }
+
+    switch (column.type()) {
+        case RLMPropertyTypeInt:
+            add_value_in_set_constraint<int64_t, Int>(column, values);
+            return true;
+        case RLMPropertyTypeFloat:
+            add_value_in_set_constraint<float, Float>(column, values);
+            return true;
+        case RLMPropertyTypeDouble:
+            add_value_in_set_constraint<double, Double>(column, values);
+            return true;
+        case RLMPropertyTypeDate:
+            add_value_in_set_constraint<Timestamp, Timestamp>(column, values);
+            return true;
+        case RLMPropertyTypeString:
+            // Case and diacritic insensitive comparisons can't use a hash set
+            if (predicateOptions) {
+                return false;
+            }
+            add_value_in_set_constraint<StringData, String>(column, values);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void QueryBuilder::apply_text_search_expression(RLMObjectSchema *desc, NSString *keyPath, id value)
+{
+    ColumnReference column = column_reference_from_key_path(desc, keyPath, false);
+    RLMPrecondition(!column.has_links(), @"Invalid predicate",
+                    @"Text search on '%@' is not supported: text search on key paths that include a link is not supported.",
+                    keyPath);
+    RLMPrecondition(column.property().fullTextIndexed, @"Invalid predicate",
+                    @"Property '%@' on object of type '%@' must be included in '+fullTextIndexedProperties' to be used in a text search.",
+                    keyPath, desc.className);
+    RLMPrecondition(RLMFullTextIndexTable(m_group, desc, column.property()), @"Invalid predicate",
+                    @"The full-text index for property '%@' on object of type '%@' has not been created. "
+                    @"Full-text indexes are created when the Realm is opened without `readOnly`.",
+                    keyPath, desc.className);
+    RLMPrecondition([value isKindOfClass:[NSString class]], @"Invalid value",
+                    @"Text search on property '%@' requires a string of words to search for, but received: %@",
+                    keyPath, value);
+
+    add_custom_expression(RLMMakeTextSearchExpression(*m_query.get_table(), desc, column.property(), value));
+}
+
 void QueryBuilder::apply_value_expression(RLMObjectSchema *desc,
                                           NSString *keyPath, id value,
                                           NSComparisonPredicate *pred)
@@ -1235,21 +1862,49 @@ void QueryBuilder::apply_value_expression(RLMObjectSchema *desc,
         return;
     }
 
-    // turn "key.path IN collection" into ored together ==. "collection IN key.path" is handled elsewhere.
+    // turn "key.path IN collection" into a set membership test or ored
+    // together ==. "collection IN key.path" is handled elsewhere.
     if (pred.predicateOperatorType == NSInPredicateOperatorType) {
-        process_or_group(m_query, value, [&](id item) {
+        RLMPrecondition([value conformsToProtocol:@protocol(NSFastEnumeration)],
+                        @"Invalid value", @"IN clause requires an array of items");
+        NSMutableArray *values = [NSMutableArray new];
+        for (id item in value) {
             id normalized = value_from_constant_expression_or_value(item);
             validate_property_value(column, normalized,
                                     @"Expected object of type %@ in IN clause for property '%@' on object of type '%@', but received: %@", desc, keyPath);
-            add_constraint(column.type(), NSEqualToPredicateOperatorType, pred.options, column, normalized);
-        });
+            [values addObject:normalized ?: NSNull.null];
+        }
+        if (!add_value_in_set_constraint(column, pred.options, values)) {
+            process_or_group(m_query, values, [&](id item) {
+                add_constraint(column.type(), NSEqualToPredicateOperatorType, pred.options, column, item);
+            });
+        }
         return;
     }
 
     validate_property_value(column, value, @"Expected object of type %@ for property '%@' on object of type '%@', but received: %@", desc, keyPath);
     if (pred.leftExpression.expressionType == NSKeyPathExpressionType) {
+        if (add_ordered_range_constraint(column, pred.predicateOperatorType, value)) {
+            return;
+        }
+        if (add_case_insensitive_index_constraint(column, pred.predicateOperatorType, pred.options, value)) {
+            return;
+        }
+        if (pred.predicateOperatorType == NSMatchesPredicateOperatorType && column.type() == RLMPropertyTypeString
+            && [value isKindOfClass:[NSString class]]) {
+            add_regular_expression_constraint(column, pred.options, value);
+            return;
+        }
         add_constraint(column.type(), pred.predicateOperatorType, pred.options, std::move(column), value);
     } else {
+        if (add_ordered_range_constraint(column, reversed_operator(pred.predicateOperatorType), value)) {
+            return;
+        }
+        // Equality is the only supported operator which is symmetric
+        if (pred.predicateOperatorType == NSEqualToPredicateOperatorType
+            && add_case_insensitive_index_constraint(column, pred.predicateOperatorType, pred.options, value)) {
+            return;
+        }
         add_constraint(column.type(), pred.predicateOperatorType, pred.options, value, std::move(column));
     }
 }
@@ -1360,9 +2015,497 @@ void QueryBuilder::apply_function_expression(RLMObjectSchema *objectSchema, NSEx
     }
 }
 
+// Convert an operand of an arithmetic function, which may itself be an
+// arithmetic function, to a core expression
+ArithmeticOperand QueryBuilder::arithmetic_operand(RLMObjectSchema *objectSchema, NSExpression *expression)
+{
+    switch (expression.expressionType) {
+        case NSConstantValueExpressionType: {
+            id value = expression.constantValue;
+            RLMPrecondition(!is_nsnull(value), @"Invalid predicate expression",
+                            @"Arithmetic expressions cannot be used with nil");
+            if (NSDate *date = RLMDynamicCast<NSDate>(value)) {
+                return {std::unique_ptr<Subexpr>(new Value<Double>(date.timeIntervalSince1970)), RLMPropertyTypeDouble};
+            }
+            RLMPrecondition([value isKindOfClass:[NSNumber class]], @"Invalid predicate expression",
+                            @"Arithmetic is only supported on numbers and dates, but received: %@", value);
+            if (number_is_integer(value)) {
+                return {std::unique_ptr<Subexpr>(new Value<Int>([value longLongValue])), RLMPropertyTypeInt};
+            }
+            return {std::unique_ptr<Subexpr>(new Value<Double>([value doubleValue])), RLMPropertyTypeDouble};
+        }
+
+        case NSKeyPathExpressionType: {
+            NSString *keyPath = expression.keyPath;
+            RLMPrecondition(!key_path_contains_collection_operator(keyPath), @"Invalid predicate expression",
+                            @"Arithmetic is not supported on key paths that include collection operators: '%@'", keyPath);
+            ColumnReference column = column_reference_from_key_path(objectSchema, keyPath, false);
+            switch (column.type()) {
+                case RLMPropertyTypeInt:
+                    return {column.resolve<Int>().clone(nullptr), RLMPropertyTypeInt};
+                case RLMPropertyTypeFloat:
+                    return {column.resolve<Float>().clone(nullptr), RLMPropertyTypeFloat};
+                case RLMPropertyTypeDouble:
+                    return {column.resolve<Double>().clone(nullptr), RLMPropertyTypeDouble};
+                case RLMPropertyTypeDate:
+                    return {std::unique_ptr<Subexpr>(new TimestampSeconds(column.resolve<Timestamp>().clone(nullptr))), RLMPropertyTypeDouble};
+                default:
+                    @throw RLMPredicateException(@"Invalid predicate expression",
+                                                 @"Arithmetic is only supported on numeric and date properties, but '%@' is of type %@",
+                                                 keyPath, RLMTypeToString(column.type()));
+            }
+        }
+
+        case NSFunctionExpressionType:
+            break;
+
+        default:
+            @throw RLMPredicateException(@"Invalid predicate expression",
+                                         @"Arithmetic is only supported on key paths, constants and other arithmetic functions");
+    }
+
+    NSString *function = expression.function;
+    RLMPrecondition(is_arithmetic_function_expression(expression), @"Invalid predicate",
+                    @"The '%@' function is not supported.", function);
+    NSArray<NSExpression *> *arguments = expression.arguments;
+
+    if ([function isEqualToString:@"abs:"]) {
+        RLMPrecondition(arguments.count == 1, @"Invalid predicate expression", @"abs: takes one argument");
+        auto operand = arithmetic_operand(objectSchema, arguments[0]);
+        if (operand.is_int()) {
+            return {std::unique_ptr<Subexpr>(new UnaryOperator<Abs<Int>>(std::move(operand.expression))), RLMPropertyTypeInt};
+        }
+        return {std::unique_ptr<Subexpr>(new UnaryOperator<Abs<Double>>(std::move(operand.expression))), RLMPropertyTypeDouble};
+    }
+
+    RLMPrecondition(arguments.count == 2, @"Invalid predicate expression", @"%@ takes two arguments", function);
+    auto left = arithmetic_operand(objectSchema, arguments[0]);
+    auto right = arithmetic_operand(objectSchema, arguments[1]);
+
+    // Division and modulus are always performed in doubles, both to match
+    // NSExpression and because integer division by zero would crash
+    if ([function isEqualToString:@"divide:by:"]) {
+        return {std::unique_ptr<Subexpr>(new Operator<Div<Double>>(std::move(left.expression), std::move(right.expression))), RLMPropertyTypeDouble};
+    }
+    if ([function isEqualToString:@"modulus:by:"]) {
+        return {std::unique_ptr<Subexpr>(new Operator<Modulus>(std::move(left.expression), std::move(right.expression))), RLMPropertyTypeDouble};
+    }
+
+    auto make = [&](auto intOperator, auto doubleOperator) -> ArithmeticOperand {
+        using IntOperator = decltype(intOperator);
+        using DoubleOperator = decltype(doubleOperator);
+        if (left.is_int() && right.is_int()) {
+            return {std::unique_ptr<Subexpr>(new Operator<IntOperator>(std::move(left.expression), std::move(right.expression))), RLMPropertyTypeInt};
+        }
+        return {std::unique_ptr<Subexpr>(new Operator<DoubleOperator>(std::move(left.expression), std::move(right.expression))), RLMPropertyTypeDouble};
+    };
+    if ([function isEqualToString:@"add:to:"]) {
+        return make(SaturatingPlus(), Plus<Double>());
+    }
+    if ([function isEqualToString:@"from:subtract:"]) {
+        return make(SaturatingMinus(), Minus<Double>());
+    }
+    return make(SaturatingMul(), Mul<Double>());
+}
+
+// Compare the results of arithmetic functions of numeric and date properties,
+// such as "price * quantity > 100", using core's column arithmetic so that
+// the values are never read into objects
+void QueryBuilder::apply_arithmetic_expression(RLMObjectSchema *objectSchema, NSComparisonPredicate *predicate)
+{
+    auto lhs = arithmetic_operand(objectSchema, predicate.leftExpression);
+    auto rhs = arithmetic_operand(objectSchema, predicate.rightExpression);
+    RLMPropertyType type = lhs.is_int() && rhs.is_int() ? RLMPropertyTypeInt : RLMPropertyTypeDouble;
+    lhs.visit([&](auto& l) {
+        rhs.visit([&](auto& r) {
+            add_numeric_constraint(type, predicate.predicateOperatorType, l, r);
+        });
+    });
+}
+
+
+// A comparison of a property of the queried object with a constant, with the
+// property as the left operand
+struct PropertyComparison {
+    NSString *propertyName;
+    NSPredicateOperatorType operatorType;
+    id value;
+};
+
+// Get the comparison made by the predicate if it compares a property of the
+// queried object with a constant without any options or modifiers, which are
+// the only comparisons which can use a composite index
+util::Optional<PropertyComparison> property_comparison(NSPredicate *predicate)
+{
+    if (![predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        return util::none;
+    }
+    NSComparisonPredicate *comparison = (NSComparisonPredicate *)predicate;
+    if (comparison.comparisonPredicateModifier != NSDirectPredicateModifier || comparison.options != 0) {
+        return util::none;
+    }
+
+    NSExpression *left = comparison.leftExpression, *right = comparison.rightExpression;
+    NSPredicateOperatorType operatorType = comparison.predicateOperatorType;
+    if (left.expressionType == NSConstantValueExpressionType && right.expressionType == NSKeyPathExpressionType
+        && operatorType != NSBetweenPredicateOperatorType) {
+        std::swap(left, right);
+        operatorType = reversed_operator(operatorType);
+    }
+    if (left.expressionType != NSKeyPathExpressionType || right.expressionType != NSConstantValueExpressionType
+        || [left.keyPath rangeOfString:@"."].location != NSNotFound) {
+        return util::none;
+    }
+
+    switch (operatorType) {
+        case NSEqualToPredicateOperatorType:
+        case NSLessThanPredicateOperatorType:
+        case NSLessThanOrEqualToPredicateOperatorType:
+        case NSGreaterThanPredicateOperatorType:
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+        case NSBetweenPredicateOperatorType:
+            return PropertyComparison{left.keyPath, operatorType, right.constantValue};
+        default:
+            return util::none;
+    }
+}
+
+// Add the subpredicates of nested AND predicates to `flattened` in place of
+// the AND predicates
+void flatten_conjunction(NSArray<NSPredicate *> *subpredicates, NSMutableArray<NSPredicate *> *flattened)
+{
+    for (NSPredicate *predicate in subpredicates) {
+        if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+            NSCompoundPredicate *compound = (NSCompoundPredicate *)predicate;
+            if (compound.compoundPredicateType == NSAndPredicateType && compound.subpredicates.count) {
+                flatten_conjunction(compound.subpredicates, flattened);
+                continue;
+            }
+        }
+        [flattened addObject:predicate];
+    }
+}
+
+// Check if comparing the property with the value can use a composite index.
+// Comparisons with null and NaN, and with objects which are not managed by
+// this Realm or whose class has no primary key are left to the regular query.
+bool QueryBuilder::can_use_composite_index(RLMProperty *property, id value) const
+{
+    if (!value || value == NSNull.null || !RLMIsObjectValidForProperty(value, property)) {
+        return false;
+    }
+    switch (property.type) {
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeDouble:
+            return !std::isnan([value doubleValue]);
+        case RLMPropertyTypeObject: {
+            RLMObjectBase *obj = RLMDynamicCast<RLMObjectBase>(value);
+            RLMProperty *primaryKey = obj->_objectSchema.primaryKeyProperty;
+            return obj->_row.is_attached() && &obj->_realm.group == &m_group
+                && primaryKey && [obj valueForKey:primaryKey.name];
+        }
+        default:
+            return true;
+    }
+}
+
+// Add a constraint using the object type's composite index which covers the
+// most of the conjunction's comparisons, and return the subpredicates which
+// still need to be applied. An index can only be used if every property
+// other than its last one is compared for equality.
+NSArray<NSPredicate *> *QueryBuilder::apply_composite_index(RLMObjectSchema *objectSchema,
+                                                            NSArray<NSPredicate *> *subpredicates,
+                                                            std::vector<PlannedPredicate>* plan)
+{
+    if (!objectSchema.compositeIndexes.count) {
+        return subpredicates;
+    }
+
+    NSMutableArray<NSPredicate *> *predicates = [NSMutableArray new];
+    flatten_conjunction(subpredicates, predicates);
+    std::vector<util::Optional<PropertyComparison>> comparisons;
+    for (NSPredicate *predicate in predicates) {
+        comparisons.push_back(property_comparison(predicate));
+    }
+
+    struct Match {
+        NSArray<NSString *> *propertyNames;
+        NSMutableArray *prefix;
+        id lower, upper;
+        bool lowerInclusive, upperInclusive;
+        // The indexes of the predicates which the index covers
+        NSMutableIndexSet *used;
+    };
+    util::Optional<Match> best;
+
+    for (NSArray<NSString *> *propertyNames in objectSchema.compositeIndexes) {
+        if (!RLMCompositeIndexTable(m_group, objectSchema, propertyNames)) {
+            continue;
+        }
+        Match match{propertyNames, [NSMutableArray new], nil, nil, false, false, [NSMutableIndexSet new]};
+        auto find = [&](RLMProperty *property, NSPredicateOperatorType operatorType) -> NSUInteger {
+            for (size_t i = 0; i < comparisons.size(); ++i) {
+                auto& comparison = comparisons[i];
+                if (comparison && comparison->operatorType == operatorType && ![match.used containsIndex:i]
+                    && [comparison->propertyName isEqualToString:property.name]
+                    && can_use_composite_index(property, comparison->value)) {
+                    return i;
+                }
+            }
+            return NSNotFound;
+        };
+
+        NSUInteger prefixCount = propertyNames.count - 1;
+        for (NSUInteger i = 0; i < prefixCount; ++i) {
+            NSUInteger found = find(objectSchema[propertyNames[i]], NSEqualToPredicateOperatorType);
+            if (found == NSNotFound) {
+                break;
+            }
+            [match.prefix addObject:comparisons[found]->value];
+            [match.used addIndex:found];
+        }
+        if (match.prefix.count != prefixCount) {
+            continue;
+        }
+
+        RLMProperty *last = objectSchema[propertyNames.lastObject];
+        NSUInteger found = find(last, NSEqualToPredicateOperatorType);
+        if (found != NSNotFound) {
+            match.lower = match.upper = comparisons[found]->value;
+            match.lowerInclusive = match.upperInclusive = true;
+            [match.used addIndex:found];
+        }
+        else if (last.type == RLMPropertyTypeInt || last.type == RLMPropertyTypeFloat
+                 || last.type == RLMPropertyTypeDouble || last.type == RLMPropertyTypeDate) {
+            auto addBound = [&](NSPredicateOperatorType operatorType, id __strong& bound, bool& inclusive) {
+                NSUInteger index = find(last, operatorType);
+                if (!bound && index != NSNotFound) {
+                    bound = comparisons[index]->value;
+                    inclusive = operatorType == NSLessThanOrEqualToPredicateOperatorType
+                             || operatorType == NSGreaterThanOrEqualToPredicateOperatorType;
+                    [match.used addIndex:index];
+                }
+            };
+            addBound(NSGreaterThanOrEqualToPredicateOperatorType, match.lower, match.lowerInclusive);
+            addBound(NSGreaterThanPredicateOperatorType, match.lower, match.lowerInclusive);
+            addBound(NSLessThanOrEqualToPredicateOperatorType, match.upper, match.upperInclusive);
+            addBound(NSLessThanPredicateOperatorType, match.upper, match.upperInclusive);
+
+            for (size_t i = 0; i < comparisons.size() && !match.lower && !match.upper; ++i) {
+                auto& comparison = comparisons[i];
+                if (!comparison || comparison->operatorType != NSBetweenPredicateOperatorType
+                    || ![comparison->propertyName isEqualToString:last.name]
+                    || ![comparison->value isKindOfClass:[NSArray class]] || [comparison->value count] != 2) {
+                    continue;
+                }
+                id from = value_from_constant_expression_or_value([comparison->value firstObject]);
+                id to = value_from_constant_expression_or_value([comparison->value lastObject]);
+                if (can_use_composite_index(last, from) && can_use_composite_index(last, to)) {
+                    match.lower = from;
+                    match.upper = to;
+                    match.lowerInclusive = match.upperInclusive = true;
+                    [match.used addIndex:i];
+                }
+            }
+        }
+
+        if (!best || match.used.count > best->used.count) {
+            best = std::move(match);
+        }
+    }
+
+    if (!best) {
+        return subpredicates;
+    }
+    add_custom_expression(RLMMakeCompositeIndexExpression(*m_query.get_table(), objectSchema, best->propertyNames,
+                                                          best->prefix, best->lower, best->lowerInclusive,
+                                                          best->upper, best->upperInclusive));
+    if (plan) {
+        NSString *strategy = [NSString stringWithFormat:@"composite index (%@)",
+                              [best->propertyNames componentsJoinedByString:@", "]];
+        plan->push_back({[NSCompoundPredicate andPredicateWithSubpredicates:[predicates objectsAtIndexes:best->used]],
+                         1, strategy});
+    }
+    [predicates removeObjectsAtIndexes:best->used];
+    return predicates;
+}
+
+// Estimate the cost of evaluating the predicate for each object. Comparisons
+// which can use an index are cheapest, as they find the few matching objects
+// without examining the rest. The cost of examining each object depends on the
+// type of comparison, increases with the number of links which have to be
+// followed to reach the property, and is highest for subqueries and collection
+// operators, which examine every object in a list. IN is evaluated as a single
+// set membership test, so it costs the same as one comparison.
+PlannedPredicate QueryBuilder::plan_predicate(NSPredicate *predicate, RLMObjectSchema *objectSchema) const
+{
+    if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
+        double cost = 0;
+        for (NSPredicate *subp in [(NSCompoundPredicate *)predicate subpredicates]) {
+            cost += plan_predicate(subp, objectSchema).cost;
+        }
+        return {predicate, cost, @"compound predicate"};
+    }
+    if (![predicate isMemberOfClass:[NSComparisonPredicate class]]) {
+        // TRUEPREDICATE and FALSEPREDICATE
+        return {predicate, 0, @"constant"};
+    }
+
+    NSComparisonPredicate *compp = (NSComparisonPredicate *)predicate;
+    if (compp.predicateOperatorType == NSCustomSelectorPredicateOperatorType) {
+        return {predicate, 2, @"full-text index"};
+    }
+
+    NSExpression *left = compp.leftExpression, *right = compp.rightExpression;
+    if (is_arithmetic_function_expression(left) || is_arithmetic_function_expression(right)) {
+        return {predicate, 45, @"scan with arithmetic"};
+    }
+    bool leftIsKeyPath = left.expressionType == NSKeyPathExpressionType;
+    bool rightIsKeyPath = right.expressionType == NSKeyPathExpressionType;
+    if (leftIsKeyPath == rightIsKeyPath) {
+        if (leftIsKeyPath) {
+            return {predicate, 40, @"scan comparing properties"};
+        }
+        return {predicate, 200, @"scan with subquery"};
+    }
+
+    NSString *keyPath = leftIsKeyPath ? left.keyPath : right.keyPath;
+    if (key_path_contains_collection_operator(keyPath)) {
+        return {predicate, 100, @"scan with collection operator"};
+    }
+
+    // Find the property, tolerating invalid key paths as they are reported
+    // when the predicate is applied
+    RLMProperty *property;
+    size_t depth = 0;
+    for (NSString *name in [keyPath componentsSeparatedByString:@"."]) {
+        if (property) {
+            if (!property.objectClassName) {
+                return {predicate, 50, @"scan"};
+            }
+            objectSchema = m_schema[property.objectClassName];
+            ++depth;
+        }
+        property = objectSchema[name];
+        if (!property) {
+            return {predicate, 50, @"scan"};
+        }
+    }
+
+    NSPredicateOperatorType operatorType = compp.predicateOperatorType;
+    NSComparisonPredicateOptions options = compp.options;
+    bool insensitive = options & (NSCaseInsensitivePredicateOption | NSDiacriticInsensitivePredicateOption);
+    if (depth == 0) {
+        switch (operatorType) {
+            case NSEqualToPredicateOperatorType:
+            case NSInPredicateOperatorType:
+                if (!insensitive && (property.indexed || property.isPrimary)) {
+                    return {predicate, operatorType == NSInPredicateOperatorType ? 2.0 : 1.0, @"search index"};
+                }
+                break;
+            case NSLessThanPredicateOperatorType:
+            case NSLessThanOrEqualToPredicateOperatorType:
+            case NSGreaterThanPredicateOperatorType:
+            case NSGreaterThanOrEqualToPredicateOperatorType:
+            case NSBetweenPredicateOperatorType:
+                if (property.orderedIndexed && RLMOrderedIndexTable(m_group, objectSchema, property)) {
+                    return {predicate, 3, @"ordered index"};
+                }
+                break;
+            default:
+                break;
+        }
+        if (insensitive && property.caseInsensitiveIndexed
+            && (operatorType == NSEqualToPredicateOperatorType || operatorType == NSBeginsWithPredicateOperatorType)
+            && RLMCaseInsensitiveIndexTable(m_group, objectSchema, property)) {
+            return {predicate, 2, @"case-insensitive index"};
+        }
+    }
+
+    double cost;
+    switch (property.type) {
+        case RLMPropertyTypeString:
+        case RLMPropertyTypeData:
+            switch (operatorType) {
+                case NSBeginsWithPredicateOperatorType:
+                case NSEndsWithPredicateOperatorType:
+                    cost = 30;
+                    break;
+                case NSContainsPredicateOperatorType:
+                    cost = 50;
+                    break;
+                case NSLikePredicateOperatorType:
+                case NSMatchesPredicateOperatorType:
+                    cost = 60;
+                    break;
+                default:
+                    cost = 20;
+                    break;
+            }
+            if (options & NSCaseInsensitivePredicateOption) {
+                cost *= 1.5;
+            }
+            // Diacritic insensitive comparisons convert each value to compare it
+            if (options & NSDiacriticInsensitivePredicateOption) {
+                cost *= 3;
+            }
+            break;
+        case RLMPropertyTypeArray:
+        case RLMPropertyTypeLinkingObjects:
+            cost = 30;
+            break;
+        default:
+            cost = 10;
+            break;
+    }
+    if (depth == 0) {
+        return {predicate, cost, @"scan"};
+    }
+    return {predicate, cost * (1 + depth),
+            [NSString stringWithFormat:@"scan following %zu link%@", depth, depth == 1 ? @"" : @"s"]};
+}
+
+// Apply any composite index which covers the conjunction's comparisons, and
+// order the remaining subpredicates so that the cheapest are evaluated first.
+// The order of subpredicates with equal costs is preserved.
+NSArray<NSPredicate *> *QueryBuilder::plan_conjunction(RLMObjectSchema *objectSchema,
+                                                       NSArray<NSPredicate *> *subpredicates,
+                                                       std::vector<PlannedPredicate>* plan)
+{
+    subpredicates = apply_composite_index(objectSchema, subpredicates, plan);
+    if (subpredicates.count < 2 && !plan) {
+        return subpredicates;
+    }
+
+    std::vector<PlannedPredicate> planned;
+    planned.reserve(subpredicates.count);
+    for (NSPredicate *subp in subpredicates) {
+        planned.push_back(plan_predicate(subp, objectSchema));
+    }
+    std::stable_sort(planned.begin(), planned.end(), [](auto& a, auto& b) { return a.cost < b.cost; });
+
+    NSMutableArray<NSPredicate *> *ordered = [NSMutableArray arrayWithCapacity:planned.size()];
+    for (auto& p : planned) {
+        [ordered addObject:p.predicate];
+    }
+    if (plan) {
+        plan->insert(plan->end(), planned.begin(), planned.end());
+    }
+    return ordered;
+}
 
 void QueryBuilder::apply_predicate(NSPredicate *predicate, RLMObjectSchema *objectSchema)
 {
+    // Only the top level of the predicate is recorded in the plan, which is
+    // either the conditions of an AND predicate or the predicate itself
+    auto plan = std::exchange(m_plan, nullptr);
+    bool isConjunction = [predicate isMemberOfClass:[NSCompoundPredicate class]]
+                      && [(NSCompoundPredicate *)predicate compoundPredicateType] == NSAndPredicateType
+                      && [(NSCompoundPredicate *)predicate subpredicates].count;
+    if (plan && !isConjunction) {
+        plan->push_back(plan_predicate(predicate, objectSchema));
+    }
+
     // Compound predicates.
     if ([predicate isMemberOfClass:[NSCompoundPredicate class]]) {
         NSCompoundPredicate *comp = (NSCompoundPredicate *)predicate;
@@ -1370,9 +2513,9 @@ void QueryBuilder::apply_predicate(NSPredicate *predicate, RLMObjectSchema *obje
         switch ([comp compoundPredicateType]) {
             case NSAndPredicateType:
                 if (comp.subpredicates.count) {
-                    // Add all of the subpredicates.
+                    // Add all of the subpredicates, cheapest first.
                     m_query.group();
-                    for (NSPredicate *subp in comp.subpredicates) {
+                    for (NSPredicate *subp in plan_conjunction(objectSchema, comp.subpredicates, plan)) {
                         apply_predicate(subp, objectSchema);
                     }
                     m_query.end_group();
@@ -1418,6 +2561,15 @@ void QueryBuilder::apply_predicate(NSPredicate *predicate, RLMObjectSchema *obje
                             @"Predicate with ANY modifier must compare a KeyPath with RLMArray with a value");
         }
 
+        if (compp.predicateOperatorType == NSCustomSelectorPredicateOperatorType
+            && compp.customSelector == RLMTextSearchSelector()) {
+            // Predicates created by RLMTextSearchPredicate()
+            RLMPrecondition(exp1Type == NSKeyPathExpressionType && exp2Type == NSConstantValueExpressionType,
+                            @"Invalid predicate", @"Text search must compare a KeyPath with a string of words");
+            apply_text_search_expression(objectSchema, compp.leftExpression.keyPath, compp.rightExpression.constantValue);
+            return;
+        }
+
         if (compp.predicateOperatorType == NSBetweenPredicateOperatorType || compp.predicateOperatorType == NSInPredicateOperatorType) {
             // Inserting an array via %@ gives NSConstantValueExpressionType, but including it directly gives NSAggregateExpressionType
             if (exp1Type == NSKeyPathExpressionType && (exp2Type == NSAggregateExpressionType || exp2Type == NSConstantValueExpressionType)) {
@@ -1443,7 +2595,12 @@ void QueryBuilder::apply_predicate(NSPredicate *predicate, RLMObjectSchema *obje
             }
         }
 
-        if (exp1Type == NSKeyPathExpressionType && exp2Type == NSKeyPathExpressionType) {
+        if (is_arithmetic_function_expression(compp.leftExpression)
+            || is_arithmetic_function_expression(compp.rightExpression)) {
+            // "price * quantity > 100" and the like
+            apply_arithmetic_expression(objectSchema, compp);
+        }
+        else if (exp1Type == NSKeyPathExpressionType && exp2Type == NSKeyPathExpressionType) {
             // both expression are KeyPaths
             apply_column_expression(objectSchema, compp.leftExpression.keyPath, compp.rightExpression.keyPath, compp);
         }
@@ -1479,16 +2636,20 @@ void QueryBuilder::apply_predicate(NSPredicate *predicate, RLMObjectSchema *obje
     }
 }
 
-std::vector<size_t> RLMValidatedColumnIndicesForSort(RLMClassInfo& classInfo, NSString *keyPathString)
+// `verb` and `noun` are used to build error messages, e.g. "sort" and "sorting"
+std::vector<size_t> RLMValidatedColumnIndices(RLMClassInfo& classInfo, NSString *keyPathString,
+                                              NSString *verb, NSString *noun)
 {
-    RLMPrecondition([keyPathString rangeOfString:@"@"].location == NSNotFound, @"Invalid key path for sort",
-                    @"Cannot sort on '%@': sorting on key paths that include collection operators is not supported.",
-                    keyPathString);
+    RLMPrecondition([keyPathString rangeOfString:@"@"].location == NSNotFound,
+                    [@"Invalid key path for " stringByAppendingString:verb],
+                    @"Cannot %@ on '%@': %@ on key paths that include collection operators is not supported.",
+                    verb, keyPathString, noun);
     auto keyPath = key_path_from_string(classInfo.realm.schema, classInfo.rlmObjectSchema, keyPathString);
 
-    RLMPrecondition(!keyPath.containsToManyRelationship, @"Invalid key path for sort",
-                    @"Cannot sort on '%@': sorting on key paths that include a to-many relationship is not supported.",
-                    keyPathString);
+    RLMPrecondition(!keyPath.containsToManyRelationship,
+                    [@"Invalid key path for " stringByAppendingString:verb],
+                    @"Cannot %@ on '%@': %@ on key paths that include a to-many relationship is not supported.",
+                    verb, keyPathString, noun);
 
     switch (keyPath.property.type) {
         case RLMPropertyTypeBool:
@@ -1500,9 +2661,9 @@ std::vector<size_t> RLMValidatedColumnIndicesForSort(RLMClassInfo& classInfo, NS
             break;
 
         default:
-            @throw RLMPredicateException(@"Invalid sort property type",
-                                         @"Cannot sort on key path '%@' on object of type '%s': sorting is only supported on bool, date, double, float, integer, and string properties, but property is of type %@.",
-                                         keyPathString, classInfo.rlmObjectSchema.className, RLMTypeToString(keyPath.property.type));
+            @throw RLMPredicateException([NSString stringWithFormat:@"Invalid %@ property type", verb],
+                                         @"Cannot %@ on key path '%@' on object of type '%s': %@ is only supported on bool, date, double, float, integer, and string properties, but property is of type %@.",
+                                         verb, keyPathString, classInfo.rlmObjectSchema.className, noun, RLMTypeToString(keyPath.property.type));
     }
 
     std::vector<size_t> columnIndices;
@@ -1522,9 +2683,12 @@ std::vector<size_t> RLMValidatedColumnIndicesForSort(RLMClassInfo& classInfo, NS
 } // namespace
 
 realm::Query RLMPredicateToQuery(NSPredicate *predicate, RLMObjectSchema *objectSchema,
-                                 RLMSchema *schema, Group &group)
+                                 RLMSchema *schema, Group &group, bool *canEvaluateConcurrently)
 {
     auto query = get_table(group, objectSchema).where();
+    if (canEvaluateConcurrently) {
+        *canEvaluateConcurrently = true;
+    }
 
     // passing a nil predicate is a no-op
     if (!predicate) {
@@ -1532,7 +2696,11 @@ realm::Query RLMPredicateToQuery(NSPredicate *predicate, RLMObjectSchema *object
     }
 
     @autoreleasepool {
-        QueryBuilder(query, group, schema).apply_predicate(predicate, objectSchema);
+        QueryBuilder builder(query, group, schema);
+        builder.apply_predicate(predicate, objectSchema);
+        if (canEvaluateConcurrently) {
+            *canEvaluateConcurrently = builder.can_evaluate_concurrently();
+        }
     }
 
     // Test the constructed query in core
@@ -1542,6 +2710,40 @@ realm::Query RLMPredicateToQuery(NSPredicate *predicate, RLMObjectSchema *object
     return query;
 }
 
+NSString *RLMExplainPredicate(NSPredicate *predicate, RLMObjectSchema *objectSchema,
+                              RLMSchema *schema, Group &group)
+{
+    Table& table = get_table(group, objectSchema);
+    NSMutableString *explanation = [NSMutableString stringWithFormat:@"Query on '%@' (object count: %zu):\n",
+                                    objectSchema.className, table.size()];
+    if (!predicate) {
+        [explanation appendString:@"  1. all objects: scan\n"];
+        return explanation;
+    }
+
+    std::vector<PlannedPredicate> plan;
+    auto query = table.where();
+    QueryBuilder builder(query, group, schema);
+    builder.set_plan(&plan);
+    builder.apply_predicate(predicate, objectSchema);
+
+    // Run the conditions one at a time in the planned order, each over only
+    // the objects which matched the conditions before it, to report how many
+    // objects each one actually examined and matched
+    TableView matches;
+    for (size_t i = 0; i < plan.size(); ++i) {
+        auto& node = plan[i];
+        size_t examined = i == 0 ? table.size() : matches.size();
+        auto condition = i == 0 ? table.where() : table.where(&matches);
+        QueryBuilder(condition, group, schema).apply_predicate(node.predicate, objectSchema);
+        matches = condition.find_all();
+        [explanation appendFormat:@"  %zu. %@: %@, estimated cost %g, examined %zu, matched %zu\n",
+                                  i + 1, node.predicate.predicateFormat, node.strategy, node.cost,
+                                  examined, matches.size()];
+    }
+    return explanation;
+}
+
 realm::SortDescriptor RLMSortDescriptorFromDescriptors(RLMClassInfo& classInfo, NSArray<RLMSortDescriptor *> *descriptors) {
     std::vector<std::vector<size_t>> columnIndices;
     std::vector<bool> ascending;
@@ -1549,9 +2751,20 @@ realm::SortDescriptor RLMSortDescriptorFromDescriptors(RLMClassInfo& classInfo,
     ascending.reserve(descriptors.count);
 
     for (RLMSortDescriptor *descriptor in descriptors) {
-        columnIndices.push_back(RLMValidatedColumnIndicesForSort(classInfo, descriptor.keyPath));
+        columnIndices.push_back(RLMValidatedColumnIndices(classInfo, descriptor.keyPath, @"sort", @"sorting"));
         ascending.push_back(descriptor.ascending);
     }
 
     return {*classInfo.table(), std::move(columnIndices), std::move(ascending)};
 }
+
+realm::DistinctDescriptor RLMDistinctDescriptorFromKeyPaths(RLMClassInfo& classInfo, NSArray<NSString *> *keyPaths) {
+    std::vector<std::vector<size_t>> columnIndices;
+    columnIndices.reserve(keyPaths.count);
+
+    for (NSString *keyPath in keyPaths) {
+        columnIndices.push_back(RLMValidatedColumnIndices(classInfo, keyPath, @"distinct", @"distinct"));
+    }
+
+    return {*classInfo.table(), std::move(columnIndices)};
+}
@@ -19,7 +19,8 @@
 #import <Foundation/Foundation.h>
 #import "RLMConstants.h"
 
-@class RLMRealmConfiguration, RLMRealm, RLMObject, RLMSchema, RLMMigration, RLMNotificationToken, RLMThreadSafeReference;
+@class RLMRealmConfiguration, RLMRealm, RLMObject, RLMSchema, RLMMigration, RLMNotificationToken, RLMThreadSafeReference,
+    RLMRealmStatistics, RLMStorageStatistics;
 
 /**
  A callback block for opening Realms asynchronously.
@@ -414,6 +415,88 @@ typedef void (^RLMNotificationBlock)(RLMNotification notification, RLMRealm *rea
 */
 - (BOOL)writeCopyToURL:(NSURL *)fileURL encryptionKey:(nullable NSData *)key error:(NSError **)error;
 
+/**
+ Writes a compacted, unencrypted copy of the Realm to the given block in chunks.
+
+ The block is called synchronously on the calling thread with each chunk of the
+ copy in order, and can return `NO` to stop writing the copy, in which case
+ this method returns `NO` with an error whose code is `ECANCELED` in
+ `NSPOSIXErrorDomain`.
+
+ If `maximumBytesPerSecond` is non-zero, writing the copy is paused between
+ chunks as needed so that it does not exceed the given rate, so that a backup
+ running in the background does not compete with other work for I/O bandwidth.
+
+ Note that if this method is called from within a write transaction, the
+ *current* data is written, not the data from the point when the previous write
+ transaction was committed.
+
+ @param block                 The block to pass each chunk of the copy to.
+ @param maximumBytesPerSecond The maximum rate to write the copy at, or 0 for no limit.
+ @param error                 If an error occurs, upon return contains an `NSError` object
+                              that describes the problem. If you are not interested in
+                              possible errors, pass in `NULL`.
+
+ @return `YES` if the entire copy was written, `NO` if an error occurred.
+ */
+- (BOOL)writeCopyWithBlock:(BOOL (^)(NSData *chunk))block
+     maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                     error:(NSError **)error;
+
+/**
+ Writes a compacted, unencrypted copy of the Realm to the given file descriptor,
+ such as a pipe, socket or file opened for writing.
+
+ The file descriptor is not closed. See `writeCopyWithBlock:maximumBytesPerSecond:error:`
+ for details on how the copy is written.
+
+ @param fileDescriptor        The file descriptor to write the copy to.
+ @param maximumBytesPerSecond The maximum rate to write the copy at, or 0 for no limit.
+ @param error                 If an error occurs, upon return contains an `NSError` object
+                              that describes the problem. If you are not interested in
+                              possible errors, pass in `NULL`.
+
+ @return `YES` if the entire copy was written, `NO` if an error occurred.
+ */
+- (BOOL)writeCopyToFileDescriptor:(int)fileDescriptor
+            maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                            error:(NSError **)error;
+
+/**
+ Updates a backup of the Realm at the given local URL, writing only the parts
+ of the backup which have changed since it was last written by this method.
+
+ The backup is a compacted, unencrypted copy of the Realm, and is created if it
+ does not exist. A manifest of the backup's contents is stored next to it, at
+ the backup's path with `.manifest` appended. Each time the backup is updated,
+ the copy is compared with the manifest in 64KB blocks and only the blocks
+ which differ are written. If the manifest is missing or does not match the
+ backup, such as after an interrupted update, the entire copy is written.
+
+ As the copy is compacted, changes which alter the size of data in the Realm
+ can move later parts of the copy, which then have to be written again. Values
+ which are modified in place without changing size only rewrite the blocks
+ containing them.
+
+ If `maximumBytesPerSecond` is non-zero, producing the copy is paused as needed
+ so that it does not exceed the given rate. See
+ `writeCopyWithBlock:maximumBytesPerSecond:error:`.
+
+ @param fileURL               Local URL of the backup to update.
+ @param maximumBytesPerSecond The maximum rate to produce the copy at, or 0 for no limit.
+ @param bytesWritten          If non-NULL, upon return contains the number of bytes
+                              written to the backup.
+ @param error                 If an error occurs, upon return contains an `NSError` object
+                              that describes the problem. If you are not interested in
+                              possible errors, pass in `NULL`.
+
+ @return `YES` if the backup was updated, `NO` if an error occurred.
+ */
+- (BOOL)writeIncrementalCopyToURL:(NSURL *)fileURL
+            maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                     bytesWritten:(nullable NSUInteger *)bytesWritten
+                            error:(NSError **)error;
+
 /**
  Invalidates all `RLMObject`s, `RLMResults`, `RLMLinkingObjects`, and `RLMArray`s managed by the Realm.
 
@@ -436,6 +519,40 @@ typedef void (^RLMNotificationBlock)(RLMNotification notification, RLMRealm *rea
  */
 - (void)invalidate;
 
+#pragma mark - Statistics
+
+/**
+ Returns a snapshot of the runtime statistics for this Realm's file.
+
+ The statistics include the work performed by every `RLMRealm` instance for the
+ file in this process, on all threads. See `RLMRealmStatistics` for details.
+ */
+- (RLMRealmStatistics *)statistics;
+
+/**
+ Registers a block to be called periodically with a snapshot of the runtime
+ statistics for this Realm's file.
+
+ The block is called on a background queue every `interval` seconds until
+ `-stop` is called on the returned token.
+
+ @param block    The block to be called with each snapshot.
+ @param interval The time between calls to the block, in seconds.
+
+ @return A token which must be held for as long as you want the block to be called.
+ */
+- (RLMNotificationToken *)addStatisticsBlock:(void (^)(RLMRealmStatistics *statistics))block
+                                    interval:(NSTimeInterval)interval;
+
+/**
+ Returns a breakdown of the space used in the Realm file by each object class
+ and property, along with the amount of free space in the file.
+
+ This inspects every object in the Realm, so it can take a while for large
+ Realms and should not be called on the main thread in that case.
+ */
+- (RLMStorageStatistics *)storageStatistics;
+
 #pragma mark - Accessing Objects
 
 /**
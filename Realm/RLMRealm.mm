@@ -20,6 +20,8 @@
 
 #import "RLMAnalytics.hpp"
 #import "RLMArray_Private.hpp"
+#import "RLMIndexBuilder_Private.hpp"
+#import "RLMIndexTables_Private.hpp"
 #import "RLMMigration_Private.h"
 #import "RLMObject_Private.h"
 #import "RLMObject_Private.hpp"
@@ -30,8 +32,10 @@
 #import "RLMProperty_Private.h"
 #import "RLMQueryUtil.hpp"
 #import "RLMRealmConfiguration_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 #import "RLMRealmUtil.hpp"
 #import "RLMSchema_Private.hpp"
+#import "RLMStorageStatistics_Private.hpp"
 #import "RLMSyncManager_Private.h"
 #import "RLMSyncUtil_Private.hpp"
 #import "RLMThreadSafeReference_Private.hpp"
@@ -47,6 +51,13 @@
 #include <realm/util/scope_exit.hpp>
 #include <realm/version.hpp>
 
+#include <chrono>
+#include <ostream>
+#include <thread>
+
+#import <CommonCrypto/CommonDigest.h>
+#import <fcntl.h>
+
 #import "sync/sync_session.hpp"
 
 using namespace realm;
@@ -137,6 +148,9 @@ NSData *RLMRealmValidatedEncryptionKey(NSData *key) {
 
 - (instancetype)initPrivate {
     self = [super init];
+    if (self) {
+        _queryConcurrency = 1;
+    }
     return self;
 }
 
@@ -332,7 +346,7 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
 
         // try to reuse existing realm first
         if (cache || dynamic) {
-            if (RLMRealm *realm = RLMGetThreadLocalCachedRealmForPath(config.path)) {
+            if (RLMRealm *realm = RLMGetThreadLocalCachedRealm(configuration.cacheIdentity, config.path)) {
                 auto const& old_config = realm->_realm->config();
                 if (old_config.read_only() != config.read_only()) {
                     @throw RLMException(@"Realm at path '%s' already opened with different read permissions", config.path.c_str());
@@ -356,10 +370,13 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
 
     RLMRealm *realm = [[RLMRealm alloc] initPrivate];
     realm->_dynamic = dynamic;
+    realm->_queryConcurrency = configuration.maximumQueryConcurrency;
+    realm->_slowQueryBlock = configuration.slowQueryBlock;
+    realm->_slowQueryThreshold = configuration.slowQueryThreshold;
 
-    // protects the realm cache and accessors cache
-    static std::mutex& initLock = *new std::mutex();
-    std::lock_guard<std::mutex> lock(initLock);
+    // protects the realm cache for this path; Realms at other paths can be
+    // opened concurrently
+    RLMRealmOpenLock lock(config.path);
 
     try {
         realm->_realm = Realm::get_shared_realm(config);
@@ -368,6 +385,8 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
         RLMRealmTranslateException(error);
         return nil;
     }
+    [configuration performPendingCompaction:*realm->_realm];
+    RLMGetStatisticsCounters(realm);
 
     // if we have a cached realm on another thread we can skip a few steps and
     // just grab its schema
@@ -409,8 +428,13 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
             };
         }
 
+        std::vector<RLMDeferredSearchIndex> deferredIndexes;
         try {
-            realm->_realm->update_schema(schema.objectStoreCopy, config.schema_version,
+            auto objectStoreSchema = schema.objectStoreCopy;
+            if (configuration.buildsIndexesInBackground && !readOnly) {
+                deferredIndexes = RLMDeferSearchIndexes(realm->_realm->read_group(), objectStoreSchema);
+            }
+            realm->_realm->update_schema(std::move(objectStoreSchema), config.schema_version,
                                          std::move(migrationFunction));
         }
         catch (...) {
@@ -423,8 +447,20 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
         RLMRealmCreateAccessors(realm.schema);
 
         if (!readOnly) {
+            try {
+                RLMUpdateIndexTables(realm);
+            }
+            catch (...) {
+                RLMRealmTranslateException(error);
+                return nil;
+            }
+
             // initializing the schema started a read transaction, so end it
             [realm invalidate];
+
+            if (!deferredIndexes.empty()) {
+                RLMBuildSearchIndexesInBackground(configuration, std::move(deferredIndexes));
+            }
         }
     }
 
@@ -522,12 +558,19 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
     configuration.config = _realm->config();
     configuration.dynamic = _dynamic;
     configuration.customSchema = _schema;
+    configuration.maximumQueryConcurrency = _queryConcurrency;
+    configuration.slowQueryBlock = _slowQueryBlock;
+    configuration.slowQueryThreshold = _slowQueryThreshold;
     return configuration;
 }
 
 - (void)beginWriteTransaction {
     try {
+        RLMStatisticsTimer timer;
         _realm->begin_transaction();
+        auto& statistics = RLMGetStatisticsCounters(self);
+        RLMStatisticsCounters::increment(statistics.writeTransactions);
+        RLMStatisticsCounters::increment(statistics.writeLockWaitNanoseconds, timer.stop());
     }
     catch (std::exception &ex) {
         @throw RLMException(ex);
@@ -540,7 +583,9 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
 
 - (BOOL)commitWriteTransaction:(NSError **)outError {
     try {
+        RLMStatisticsTimer timer;
         _realm->commit_transaction();
+        RLMGetStatisticsCounters(self).recordCommit(timer.stop());
         return YES;
     }
     catch (...) {
@@ -558,7 +603,9 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
     }
 
     try {
+        RLMStatisticsTimer timer;
         _realm->commit_transaction();
+        RLMGetStatisticsCounters(self).recordCommit(timer.stop());
         return YES;
     }
     catch (...) {
@@ -669,6 +716,24 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
     return _realm->refresh();
 }
 
+- (RLMRealmStatistics *)statistics {
+    return [RLMRealmStatistics statisticsForRealm:self];
+}
+
+- (RLMNotificationToken *)addStatisticsBlock:(void (^)(RLMRealmStatistics *))block
+                                    interval:(NSTimeInterval)interval {
+    return [RLMRealmStatistics addBlock:block forRealm:self interval:interval];
+}
+
+- (RLMStorageStatistics *)storageStatistics {
+    try {
+        return RLMGetStorageStatistics(self);
+    }
+    catch (std::exception const& e) {
+        @throw RLMException(e);
+    }
+}
+
 - (void)addObject:(__unsafe_unretained RLMObject *const)object {
     RLMAddObjectToRealm(object, self, false);
 }
@@ -814,6 +879,270 @@ REALM_NOINLINE void RLMRealmTranslateException(NSError **error) {
     return NO;
 }
 
+namespace {
+// Passes the data written to it to a block in fixed-size chunks, sleeping
+// between chunks if needed to keep the overall rate under the given limit
+class RLMChunkedStreamBuffer : public std::streambuf {
+public:
+    RLMChunkedStreamBuffer(BOOL (^block)(NSData *), NSUInteger maximumBytesPerSecond)
+    : m_block(block)
+    , m_maximumBytesPerSecond(maximumBytesPerSecond)
+    , m_buffer(new char[chunkSize])
+    , m_start(std::chrono::steady_clock::now())
+    {
+        setp(m_buffer.get(), m_buffer.get() + chunkSize);
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        flush();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        flush();
+        return 0;
+    }
+
+private:
+    static constexpr size_t chunkSize = 256 * 1024;
+
+    BOOL (^m_block)(NSData *);
+    NSUInteger m_maximumBytesPerSecond;
+    std::unique_ptr<char[]> m_buffer;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_bytesWritten = 0;
+
+    void flush() {
+        size_t size = pptr() - pbase();
+        if (size == 0) {
+            return;
+        }
+        setp(m_buffer.get(), m_buffer.get() + chunkSize);
+
+        BOOL shouldContinue;
+        @autoreleasepool {
+            shouldContinue = m_block([NSData dataWithBytes:m_buffer.get() length:size]);
+        }
+        if (!shouldContinue) {
+            throw std::system_error(ECANCELED, std::generic_category());
+        }
+        m_bytesWritten += size;
+
+        if (m_maximumBytesPerSecond) {
+            auto target = m_start + std::chrono::duration<double>(double(m_bytesWritten) / m_maximumBytesPerSecond);
+            std::this_thread::sleep_until(std::chrono::time_point_cast<std::chrono::steady_clock::duration>(target));
+        }
+    }
+};
+} // anonymous namespace
+
+- (BOOL)writeCopyWithBlock:(BOOL (^)(NSData *))block
+     maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                     error:(NSError **)error {
+    [self verifyThread];
+
+    try {
+        RLMChunkedStreamBuffer buffer(block, maximumBytesPerSecond);
+        std::ostream out(&buffer);
+        // rethrow errors from the stream buffer rather than just setting badbit
+        out.exceptions(std::ios::badbit);
+        _realm->read_group().write(out);
+        out.flush();
+        return YES;
+    }
+    catch (...) {
+        __autoreleasing NSError *dummyError;
+        if (!error) {
+            error = &dummyError;
+        }
+        RLMRealmTranslateException(error);
+        return NO;
+    }
+}
+
+- (BOOL)writeCopyToFileDescriptor:(int)fileDescriptor
+            maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                            error:(NSError **)error {
+    return [self writeCopyWithBlock:^BOOL(NSData *chunk) {
+        const char *bytes = static_cast<const char *>(chunk.bytes);
+        size_t remaining = chunk.length;
+        while (remaining > 0) {
+            ssize_t written = write(fileDescriptor, bytes, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category());
+            }
+            bytes += written;
+            remaining -= written;
+        }
+        return YES;
+    } maximumBytesPerSecond:maximumBytesPerSecond error:error];
+}
+
+namespace {
+// Blocks of an incremental backup are compared with the previous backup by
+// their hashes, which are stored in a manifest next to the backup
+constexpr size_t c_backupBlockSize = 64 * 1024;
+
+// Get the block hashes recorded by the manifest of the backup at `path`, or
+// nil if there is no manifest or it doesn't describe the backup's contents
+NSData *RLMReadBackupBlockHashes(NSString *manifestPath, NSString *path) {
+    NSData *data = [NSData dataWithContentsOfFile:manifestPath];
+    if (!data) {
+        return nil;
+    }
+    NSDictionary *manifest = [NSPropertyListSerialization propertyListWithData:data options:0 format:nil error:nil];
+    NSDictionary *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:path error:nil];
+    if (![manifest isKindOfClass:[NSDictionary class]] || !attributes
+        || [manifest[@"blockSize"] unsignedLongLongValue] != c_backupBlockSize
+        || [manifest[@"size"] unsignedLongLongValue] != attributes.fileSize) {
+        return nil;
+    }
+    NSData *hashes = manifest[@"hashes"];
+    return [hashes isKindOfClass:[NSData class]] ? hashes : nil;
+}
+
+// Writes a copy of a Realm over a previous backup, splitting it into fixed-size
+// blocks and writing only the blocks whose hash differs from the previous one
+class RLMIncrementalBackupWriter {
+public:
+    RLMIncrementalBackupWriter(int fd, NSData *previousHashes)
+    : m_fd(fd), m_previousHashes(previousHashes), m_hashes([NSMutableData new]) { }
+
+    void append(NSData *chunk) {
+        auto bytes = static_cast<const char *>(chunk.bytes);
+        size_t size = chunk.length;
+        while (size > 0) {
+            size_t count = std::min(size, c_backupBlockSize - m_block.size());
+            m_block.insert(m_block.end(), bytes, bytes + count);
+            bytes += count;
+            size -= count;
+            if (m_block.size() == c_backupBlockSize) {
+                writeBlock();
+            }
+        }
+    }
+
+    // Write the final partial block and remove anything past the end of the
+    // copy which was left from a larger previous backup
+    void finish() {
+        if (!m_block.empty()) {
+            writeBlock();
+        }
+        if (ftruncate(m_fd, m_offset) != 0 || fsync(m_fd) != 0) {
+            throw std::system_error(errno, std::generic_category());
+        }
+    }
+
+    NSData *hashes() const { return m_hashes; }
+    uint64_t size() const { return m_offset; }
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    int m_fd;
+    NSData *m_previousHashes;
+    NSMutableData *m_hashes;
+    std::vector<char> m_block;
+    uint64_t m_offset = 0;
+    uint64_t m_bytesWritten = 0;
+
+    void writeBlock() {
+        unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256(m_block.data(), static_cast<CC_LONG>(m_block.size()), digest);
+        size_t hashOffset = m_hashes.length;
+        [m_hashes appendBytes:digest length:sizeof(digest)];
+
+        bool unchanged = hashOffset + sizeof(digest) <= m_previousHashes.length
+                      && memcmp(static_cast<const char *>(m_previousHashes.bytes) + hashOffset, digest, sizeof(digest)) == 0;
+        if (!unchanged) {
+            const char *bytes = m_block.data();
+            size_t remaining = m_block.size();
+            off_t offset = m_offset;
+            while (remaining > 0) {
+                ssize_t written = pwrite(m_fd, bytes, remaining, offset);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category());
+                }
+                bytes += written;
+                remaining -= written;
+                offset += written;
+            }
+            m_bytesWritten += m_block.size();
+        }
+        m_offset += m_block.size();
+        m_block.clear();
+    }
+};
+} // anonymous namespace
+
+- (BOOL)writeIncrementalCopyToURL:(NSURL *)fileURL
+            maximumBytesPerSecond:(NSUInteger)maximumBytesPerSecond
+                     bytesWritten:(NSUInteger *)bytesWritten
+                            error:(NSError **)error {
+    NSString *path = fileURL.path;
+    NSString *manifestPath = [path stringByAppendingString:@".manifest"];
+    int fd = -1;
+    auto closeFile = util::make_scope_exit([&]() noexcept {
+        if (fd >= 0) {
+            close(fd);
+        }
+    });
+
+    try {
+        NSData *previousHashes = RLMReadBackupBlockHashes(manifestPath, path);
+        // A backup which is interrupted part way through no longer matches its
+        // manifest, so the manifest is removed until the backup is complete
+        NSFileManager *manager = NSFileManager.defaultManager;
+        if ([manager fileExistsAtPath:manifestPath] && ![manager removeItemAtPath:manifestPath error:error]) {
+            return NO;
+        }
+
+        fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category());
+        }
+        RLMIncrementalBackupWriter writer(fd, previousHashes);
+        auto writerPtr = &writer;
+        if (![self writeCopyWithBlock:^BOOL(NSData *chunk) { writerPtr->append(chunk); return YES; }
+                maximumBytesPerSecond:maximumBytesPerSecond error:error]) {
+            return NO;
+        }
+        writer.finish();
+
+        NSDictionary *manifest = @{@"blockSize": @(c_backupBlockSize),
+                                   @"size": @(writer.size()),
+                                   @"hashes": writer.hashes()};
+        NSData *data = [NSPropertyListSerialization dataWithPropertyList:manifest
+                                                                  format:NSPropertyListBinaryFormat_v1_0
+                                                                 options:0 error:error];
+        if (!data || ![data writeToFile:manifestPath options:NSDataWritingAtomic error:error]) {
+            return NO;
+        }
+        if (bytesWritten) {
+            *bytesWritten = (NSUInteger)writer.bytesWritten();
+        }
+        return YES;
+    }
+    catch (...) {
+        __autoreleasing NSError *dummyError;
+        if (!error) {
+            error = &dummyError;
+        }
+        RLMRealmTranslateException(error);
+        return NO;
+    }
+}
+
 - (void)registerEnumerator:(RLMFastEnumerator *)enumerator {
     if (!_collectionEnumerators) {
         _collectionEnumerators = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory];
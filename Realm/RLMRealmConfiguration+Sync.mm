@@ -33,9 +33,12 @@
 #pragma mark - API
 
 - (void)setSyncConfiguration:(RLMSyncConfiguration *)syncConfiguration {
-    if (self.config.should_compact_on_launch_function) {
+    if (self.shouldCompactOnLaunch) {
         @throw RLMException(@"Cannot set `syncConfiguration` when `shouldCompactOnLaunch` is set.");
     }
+    if (self.maximumFreeSpaceRatio > 0) {
+        @throw RLMException(@"Cannot set `syncConfiguration` when `maximumFreeSpaceRatio` is set.");
+    }
     RLMSyncUser *user = syncConfiguration.user;
     if (user.state == RLMSyncUserStateError) {
         @throw RLMException(@"Cannot set a sync configuration which has an errored-out user.");
@@ -52,6 +55,7 @@
                                                                 [realmURL.absoluteString UTF8String]);
     }
     self.config.in_memory = false;
+    [self updateCacheIdentity];
     self.config.sync_config = std::make_shared<realm::SyncConfig>([syncConfiguration rawConfiguration]);
     self.config.schema_mode = realm::SchemaMode::Additive;
     if (!self.config.encryption_key.empty()) {
@@ -17,6 +17,7 @@
 ////////////////////////////////////////////////////////////////////////////
 
 #import <Foundation/Foundation.h>
+#import <Realm/RLMQueryTiming.h>
 #import <Realm/RLMRealm.h>
 
 NS_ASSUME_NONNULL_BEGIN
@@ -32,6 +33,41 @@ NS_ASSUME_NONNULL_BEGIN
  */
 typedef BOOL (^RLMShouldCompactOnLaunchBlock)(NSUInteger totalBytes, NSUInteger bytesUsed);
 
+/// The state of a compaction triggered by `maximumFreeSpaceRatio`.
+typedef NS_ENUM(NSUInteger, RLMCompactionState) {
+    /// The file's free space exceeded the maximum ratio and compaction is about to begin.
+    RLMCompactionStateStarted,
+    /// The file was compacted.
+    RLMCompactionStateCompleted,
+    /// The file could not be compacted because it was open elsewhere.
+    RLMCompactionStateSkipped,
+};
+
+/**
+ A block called when a compaction triggered by `maximumFreeSpaceRatio` starts and when it
+ completes or is skipped.
+
+ It is passed the state of the compaction, the size of the file (data + free space) at that point
+ and the total bytes used by data in the file.
+ */
+typedef void (^RLMCompactionResultBlock)(RLMCompactionState state, NSUInteger totalBytes, NSUInteger bytesUsed);
+
+/**
+ A block called to report the progress of building the search indexes deferred by
+ `buildsIndexesInBackground`.
+
+ It is passed the number of indexes which have been built so far and the total number of indexes
+ being built. If building an index fails, it is called a final time with the error, and the
+ remaining indexes are deferred again the next time the Realm is opened.
+ */
+typedef void (^RLMIndexBuildProgressBlock)(NSUInteger builtIndexes, NSUInteger totalIndexes,
+                                           NSError * _Nullable error);
+
+/**
+ A block called with the timing of a query which took at least `slowQueryThreshold` to build and run.
+ */
+typedef void (^RLMSlowQueryBlock)(RLMQueryTiming *timing);
+
 /**
  An `RLMRealmConfiguration` instance describes the different options used to
  create an instance of a Realm.
@@ -113,6 +149,97 @@ typedef BOOL (^RLMShouldCompactOnLaunchBlock)(NSUInteger totalBytes, NSUInteger
  */
 @property (nonatomic, copy, nullable) RLMShouldCompactOnLaunchBlock shouldCompactOnLaunch;
 
+/**
+ The maximum fraction of the Realm file which may be free space before the file is compacted,
+ between 0 and 1. A value of 0 disables compaction based on free space, which is the default.
+
+ Unlike `shouldCompactOnLaunch`, which is typically only useful the first time a Realm is opened in
+ a process, this policy is checked each time the Realm file is opened by a new `RLMRealm` instance,
+ such as when a Realm is first used on a new thread. Compaction is only performed when no other
+ `RLMRealm` instances for the file are open in any process, and is skipped otherwise.
+
+ Compaction rewrites the whole file on the thread opening the Realm, which blocks until it
+ finishes, in the same way as `-[RLMRealm compact]`. Files which are always open somewhere are never
+ compacted by this policy.
+
+ May be combined with `shouldCompactOnLaunch`, in which case the file is compacted if either
+ requests it.
+ */
+@property (nonatomic) double maximumFreeSpaceRatio;
+
+/**
+ A block called on the thread opening the Realm to report the start and result of a compaction
+ triggered by `maximumFreeSpaceRatio`.
+ */
+@property (nonatomic, copy, nullable) RLMCompactionResultBlock compactionResultBlock;
+
+/**
+ The maximum number of threads which may be used to evaluate a single query.
+
+ When this is greater than 1, `count`, `minOfProperty:`, `maxOfProperty:`,
+ `sumOfProperty:` and `averageOfProperty:` on an `RLMResults` obtained from
+ `+[RLMObject allObjects]` or `+[RLMObject objectsWhere:]`, or filtered or
+ sorted from one of those, split large tables into ranges of rows which are
+ searched concurrently on background threads. The calling thread waits for the
+ search to complete, so this reduces the time taken by each query at the cost
+ of using more CPU time in total.
+
+ Each background thread opens the Realm file and reads the same version as the
+ calling thread, so this also adds the cost of opening a read transaction per
+ thread to each query.
+
+ Tables with fewer than 100,000 objects, distinct results, and results backed by
+ an `RLMArray` or linking objects property are always searched on the calling
+ thread, as are queries whose results have already been accessed by index and
+ queries made within a write transaction or on a read-only Realm.
+
+ Set to 0 to use one thread per active processor core. The default value of 1
+ searches every table on the calling thread. Changing this property has no
+ effect on `RLMRealm` instances which are already open on the current thread.
+ */
+@property (nonatomic) NSUInteger maximumQueryConcurrency;
+
+/**
+ Whether search indexes which need to be built for existing objects are built in the background.
+
+ Adding a property to `+indexedProperties` normally builds its index while the Realm is being
+ opened, which can take several seconds for classes with millions of objects. When this is `YES`,
+ opening the Realm skips building indexes for properties of classes which already have objects, and
+ they are instead built afterwards on a background queue, one index per write transaction. Queries
+ on those properties examine every object until their index has been built. Primary keys are
+ always indexed while opening.
+
+ This has no effect on read-only Realms.
+ */
+@property (nonatomic) BOOL buildsIndexesInBackground;
+
+/**
+ A block called on a background queue after each search index deferred by
+ `buildsIndexesInBackground` has been built, or if building one fails.
+ */
+@property (nonatomic, copy, nullable) RLMIndexBuildProgressBlock indexBuildProgressBlock;
+
+/**
+ The minimum time, in seconds, which building and running the query of an `RLMResults` must take
+ for it to be reported to `slowQueryBlock`.
+
+ The default value of 0 reports every query.
+ */
+@property (nonatomic) NSTimeInterval slowQueryThreshold;
+
+/**
+ A block called with the timing of each query which takes at least `slowQueryThreshold` to build
+ and run.
+
+ Queries are only timed when this is set. The block is called synchronously on the thread which ran
+ the query, after it has completed. Queries are run when the results are first accessed, and again
+ each time `count` or an aggregate such as `sumOfProperty:` is called on results which have not
+ been accessed by index. Queries re-run in the background to deliver change notifications are not
+ reported. Changing this property has no effect on `RLMRealm` instances which are already open on
+ the current thread.
+ */
+@property (nonatomic, copy, nullable) RLMSlowQueryBlock slowQueryBlock;
+
 /// The classes managed by the Realm.
 @property (nonatomic, copy, nullable) NSArray *objectClasses;
 
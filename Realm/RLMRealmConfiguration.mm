@@ -16,7 +16,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////
 
-#import "RLMRealmConfiguration_Private.h"
+#import "RLMRealmConfiguration_Private.hpp"
 
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMRealm_Private.h"
@@ -27,6 +27,8 @@
 #import "shared_realm.hpp"
 #import "sync/sync_config.hpp"
 
+#import <atomic>
+
 static NSString *const c_RLMRealmConfigurationProperties[] = {
     @"fileURL",
     @"inMemoryIdentifier",
@@ -36,6 +38,13 @@ static NSString *const c_RLMRealmConfigurationProperties[] = {
     @"migrationBlock",
     @"deleteRealmIfMigrationNeeded",
     @"shouldCompactOnLaunch",
+    @"maximumFreeSpaceRatio",
+    @"compactionResultBlock",
+    @"maximumQueryConcurrency",
+    @"buildsIndexesInBackground",
+    @"indexBuildProgressBlock",
+    @"slowQueryThreshold",
+    @"slowQueryBlock",
     @"dynamic",
     @"customSchema",
 };
@@ -53,14 +62,25 @@ NSString *RLMRealmPathForFile(NSString *fileName) {
     return [directory stringByAppendingPathComponent:fileName];
 }
 
+static std::atomic<uint64_t> s_nextCacheIdentity{1};
+
 @implementation RLMRealmConfiguration {
     realm::Realm::Config _config;
+    // The file size and used bytes when `maximumFreeSpaceRatio` last requested
+    // compaction of a Realm opened with this configuration, or 0 if none is
+    // pending
+    NSUInteger _pendingCompactionTotalBytes;
+    NSUInteger _pendingCompactionBytesUsed;
 }
 
 - (realm::Realm::Config&)config {
     return _config;
 }
 
+- (void)updateCacheIdentity {
+    _cacheIdentity = s_nextCacheIdentity.fetch_add(1, std::memory_order_relaxed);
+}
+
 + (instancetype)defaultConfiguration {
     return [[self rawDefaultConfiguration] copy];
 }
@@ -96,6 +116,7 @@ NSString *RLMRealmPathForFile(NSString *fileName) {
         self.fileURL = defaultRealmURL;
         self.schemaVersion = 0;
         self.cache = YES;
+        _maximumQueryConcurrency = 1;
 
         // We have our own caching of RLMRealm instances, so the ObjectStore
         // cache is at best pointless, and may result in broken behavior when
@@ -111,11 +132,22 @@ NSString *RLMRealmPathForFile(NSString *fileName) {
 - (instancetype)copyWithZone:(NSZone *)zone {
     RLMRealmConfiguration *configuration = [[[self class] allocWithZone:zone] init];
     configuration->_config = _config;
+    configuration->_cacheIdentity = _cacheIdentity;
     configuration->_cache = _cache;
     configuration->_dynamic = _dynamic;
     configuration->_migrationBlock = _migrationBlock;
     configuration->_shouldCompactOnLaunch = _shouldCompactOnLaunch;
+    configuration->_maximumFreeSpaceRatio = _maximumFreeSpaceRatio;
+    configuration->_compactionResultBlock = _compactionResultBlock;
+    configuration->_maximumQueryConcurrency = _maximumQueryConcurrency;
+    configuration->_buildsIndexesInBackground = _buildsIndexesInBackground;
+    configuration->_indexBuildProgressBlock = _indexBuildProgressBlock;
+    configuration->_slowQueryThreshold = _slowQueryThreshold;
+    configuration->_slowQueryBlock = _slowQueryBlock;
     configuration->_customSchema = _customSchema;
+    // The compaction function records pending compactions on the configuration which
+    // created it, so each copy needs its own
+    [configuration updateShouldCompactFunction];
     return configuration;
 }
 
@@ -161,6 +193,7 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
 
     RLMNSStringToStdString(_config.path, path);
     _config.in_memory = false;
+    [self updateCacheIdentity];
 }
 
 - (NSString *)inMemoryIdentifier {
@@ -178,6 +211,7 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
 
     RLMNSStringToStdString(_config.path, [NSTemporaryDirectory() stringByAppendingPathComponent:inMemoryIdentifier]);
     _config.in_memory = true;
+    [self updateCacheIdentity];
 }
 
 - (NSData *)encryptionKey {
@@ -211,6 +245,8 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
             @throw RLMException(@"Cannot set `readOnly` when `deleteRealmIfMigrationNeeded` is set.");
         } else if (self.shouldCompactOnLaunch) {
             @throw RLMException(@"Cannot set `readOnly` when `shouldCompactOnLaunch` is set.");
+        } else if (self.maximumFreeSpaceRatio > 0) {
+            @throw RLMException(@"Cannot set `readOnly` when `maximumFreeSpaceRatio` is set.");
         }
         _config.schema_mode = realm::SchemaMode::ReadOnly;
     }
@@ -286,14 +322,85 @@ static void RLMNSStringToStdString(std::string &out, NSString *in) {
         } else if (_config.sync_config) {
             @throw RLMException(@"Cannot set `shouldCompactOnLaunch` when `syncConfiguration` is set.");
         }
-        _config.should_compact_on_launch_function = [=](size_t totalBytes, size_t usedBytes) {
-            return shouldCompactOnLaunch(totalBytes, usedBytes);
-        };
     }
-    else {
+    _shouldCompactOnLaunch = shouldCompactOnLaunch;
+    [self updateShouldCompactFunction];
+}
+
+- (void)setMaximumFreeSpaceRatio:(double)maximumFreeSpaceRatio {
+    if (!(maximumFreeSpaceRatio >= 0 && maximumFreeSpaceRatio <= 1)) {
+        @throw RLMException(@"`maximumFreeSpaceRatio` must be between 0 and 1, but was %g.", maximumFreeSpaceRatio);
+    }
+    if (maximumFreeSpaceRatio > 0) {
+        if (self.readOnly) {
+            @throw RLMException(@"Cannot set `maximumFreeSpaceRatio` when `readOnly` is set.");
+        } else if (_config.sync_config) {
+            @throw RLMException(@"Cannot set `maximumFreeSpaceRatio` when `syncConfiguration` is set.");
+        }
+    }
+    _maximumFreeSpaceRatio = maximumFreeSpaceRatio;
+    [self updateShouldCompactFunction];
+}
+
+- (void)updateShouldCompactFunction {
+    RLMShouldCompactOnLaunchBlock shouldCompactOnLaunch = _shouldCompactOnLaunch;
+    double maximumFreeSpaceRatio = _maximumFreeSpaceRatio;
+    if (!shouldCompactOnLaunch && maximumFreeSpaceRatio == 0) {
         _config.should_compact_on_launch_function = nullptr;
+        return;
+    }
+
+    // Weak as the function is copied into the realm::Realm, which may outlive
+    // this configuration
+    __weak RLMRealmConfiguration *weakSelf = self;
+    _config.should_compact_on_launch_function = [=](size_t totalBytes, size_t usedBytes) {
+        if (shouldCompactOnLaunch && shouldCompactOnLaunch(totalBytes, usedBytes)) {
+            return true;
+        }
+        if (maximumFreeSpaceRatio == 0 || totalBytes <= usedBytes
+            || double(totalBytes - usedBytes) / totalBytes <= maximumFreeSpaceRatio) {
+            return false;
+        }
+        // The compaction is performed once the Realm has been opened, as core
+        // reports whether it succeeded there but not from here
+        if (RLMRealmConfiguration *configuration = weakSelf) {
+            configuration->_pendingCompactionTotalBytes = totalBytes;
+            configuration->_pendingCompactionBytesUsed = usedBytes;
+        }
+        return false;
+    };
+}
+
+- (void)performPendingCompaction:(realm::Realm&)realm {
+    NSUInteger totalBytesBefore = _pendingCompactionTotalBytes;
+    if (totalBytesBefore == 0) {
+        return;
+    }
+    _pendingCompactionTotalBytes = 0;
+    NSUInteger bytesUsed = _pendingCompactionBytesUsed;
+    if (_compactionResultBlock) {
+        _compactionResultBlock(RLMCompactionStateStarted, totalBytesBefore, bytesUsed);
+    }
+
+    // Core declines to compact if the file is open anywhere else, which
+    // includes other RLMRealm instances in this process
+    bool compacted = false;
+    try {
+        compacted = realm.compact();
+    }
+    catch (std::exception const&) {
+    }
+    if (!_compactionResultBlock) {
+        return;
+    }
+    if (compacted) {
+        NSDictionary *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:@(_config.path.c_str())
+                                                                                  error:nil];
+        _compactionResultBlock(RLMCompactionStateCompleted, (NSUInteger)attributes.fileSize, bytesUsed);
+    }
+    else {
+        _compactionResultBlock(RLMCompactionStateSkipped, totalBytesBefore, bytesUsed);
     }
-    _shouldCompactOnLaunch = shouldCompactOnLaunch;
 }
 
 @end
@@ -22,5 +22,17 @@
 @interface RLMRealmConfiguration ()
 - (realm::Realm::Config&)config;
 
+// A process-unique value which changes whenever the path of this configuration
+// is changed and which is preserved by copying. Used as the key for the
+// lock-free per-thread Realm cache.
+@property (nonatomic, readonly) uint64_t cacheIdentity;
+
+// Must be called after modifying `config.path`
+- (void)updateCacheIdentity;
+
+// Must be called after the Realm has been opened with this configuration to
+// perform and report any compaction requested by `maximumFreeSpaceRatio`
+- (void)performPendingCompaction:(realm::Realm&)realm;
+
 @property (nonatomic) realm::SchemaMode schemaMode;
 @end
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+@class RLMRealm, RLMRealmConfiguration;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An `RLMRealmPool` hands out already-opened Realms to blocks running on arbitrary threads, such as
+ blocks submitted to a concurrent dispatch queue.
+
+ `RLMRealm` instances are confined to the thread on which they were created, so the pool keeps one
+ open Realm for each thread which has performed a block with it, until that thread exits. When a
+ block is performed on a thread which already has a pooled Realm, the Realm is advanced to the
+ latest version and passed to the block without having to be opened again. Dispatch queues reuse a
+ small number of worker threads, so after the first few blocks almost all blocks are given a pooled
+ Realm.
+
+ When the block returns, the Realm is invalidated so that the version it read is not kept pinned
+ while the Realm sits in the pool. Objects obtained from the Realm within the block cannot be used
+ after it returns. Realms which were already in use on the thread, such as the one passed to an
+ enclosing block, are not invalidated.
+
+ The pool also keeps a Realm open on the thread which created it, so that opening a Realm on a
+ new thread does not have to read the schema from the file again.
+
+ @warning Pooled Realms are retained by the pool until it is drained or deallocated, or their
+          thread exits. Blocks must not retain the Realm passed to them or any objects obtained
+          from it beyond the duration of the block.
+ */
+@interface RLMRealmPool : NSObject
+
+/**
+ Creates a pool of Realms for the given configuration.
+
+ The Realm is opened once on the calling thread to validate the configuration and perform any
+ required migration.
+
+ @param configuration A configuration object to use when opening the Realms.
+ @param error         If an error occurs, upon return contains an `NSError` object
+                      that describes the problem. If you are not interested in
+                      possible errors, pass in `NULL`.
+
+ @return A pool of Realms, or `nil` if the Realm could not be opened.
+ */
++ (nullable instancetype)poolWithConfiguration:(RLMRealmConfiguration *)configuration
+                                         error:(NSError **)error;
+
+/// The configuration used to open the pooled Realms.
+@property (nonatomic, readonly) RLMRealmConfiguration *configuration;
+
+/// The number of Realms currently held open by the pool, including the one for the creating thread.
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ Performs the given block with a Realm for the current thread.
+
+ The Realm is refreshed to the latest version before the block is called, and invalidated after
+ it returns. If the block begins a write transaction it must commit or cancel it before returning.
+
+ @param block The block to perform.
+ */
+- (void)performWithRealm:(void (^)(RLMRealm *realm))block;
+
+/**
+ Performs the given block with a Realm for the current thread.
+
+ The Realm is refreshed to the latest version before the block is called, and invalidated after
+ it returns. If the block begins a write transaction it must commit or cancel it before returning.
+
+ @param block The block to perform.
+ @param error If the Realm could not be opened, upon return contains an `NSError` object
+              that describes the problem. If you are not interested in
+              possible errors, pass in `NULL`.
+
+ @return Whether the block was performed.
+ */
+- (BOOL)performWithRealm:(void (^)(RLMRealm *realm))block error:(NSError **)error;
+
+/**
+ Releases all pooled Realms other than the one for the thread which created the pool.
+
+ Realms which are in use by a block when the pool is drained remain valid until the block returns.
+ */
+- (void)drain;
+
+#pragma mark - Unavailable Methods
+
+/**
+ `-[RLMRealmPool init]` is not available because an `RLMRealmPool` requires a configuration. Use
+ `+[RLMRealmPool poolWithConfiguration:error:]` instead.
+ */
+- (instancetype)init __attribute__((unavailable("Use +poolWithConfiguration:error:.")));
+
+/**
+ `+[RLMRealmPool new]` is not available because an `RLMRealmPool` requires a configuration. Use
+ `+[RLMRealmPool poolWithConfiguration:error:]` instead.
+ */
++ (instancetype)new __attribute__((unavailable("Use +poolWithConfiguration:error:.")));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMRealmPool.h"
+
+#import "RLMRealm_Private.hpp"
+#import "RLMRealmConfiguration.h"
+#import "RLMUtil.hpp"
+
+#import "shared_realm.hpp"
+
+#import <atomic>
+#import <mutex>
+
+// The Realm opened by a pool on a thread. Slots are stored in the thread's
+// dictionary so that they are released when the thread exits, and the pool
+// only has weak references to them.
+@interface RLMRealmPoolSlot : NSObject
+@property (nonatomic, strong) RLMRealm *realm;
+@end
+
+@implementation RLMRealmPoolSlot
+@end
+
+@implementation RLMRealmPool {
+    std::mutex _mutex;
+    // The slots of the live threads which have performed a block with the
+    // pool. Each slot's Realm is only read or written while holding _mutex.
+    NSHashTable<RLMRealmPoolSlot *> *_slots;
+    // The key of this pool's slot in each thread's dictionary
+    NSString *_threadDictionaryKey;
+    // keeps the schema and coordinator for the path alive while the pool exists
+    RLMRealm *_creatingThreadRealm;
+}
+
++ (instancetype)poolWithConfiguration:(RLMRealmConfiguration *)configuration error:(NSError **)error {
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:error];
+    if (!realm) {
+        return nil;
+    }
+
+    static std::atomic<uint64_t> s_nextPoolID{0};
+    RLMRealmPool *pool = [[self alloc] initPrivate];
+    pool->_configuration = [configuration copy];
+    pool->_creatingThreadRealm = realm;
+    pool->_slots = [NSHashTable weakObjectsHashTable];
+    pool->_threadDictionaryKey = [NSString stringWithFormat:@"io.realm.RLMRealmPool.%llu",
+                                  (unsigned long long)s_nextPoolID++];
+    [pool slotForCurrentThread].realm = realm;
+    return pool;
+}
+
+- (instancetype)initPrivate {
+    return [super init];
+}
+
+- (void)dealloc {
+    // Slots outlive the pool until their thread exits, so release the Realms
+    // now rather than keeping them open
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (RLMRealmPoolSlot *slot in _slots) {
+        slot.realm = nil;
+    }
+}
+
+- (NSUInteger)count {
+    std::lock_guard<std::mutex> lock(_mutex);
+    NSUInteger count = 0;
+    for (RLMRealmPoolSlot *slot in _slots) {
+        count += slot.realm != nil;
+    }
+    return count;
+}
+
+- (RLMRealmPoolSlot *)slotForCurrentThread {
+    NSMutableDictionary *threadDictionary = NSThread.currentThread.threadDictionary;
+    RLMRealmPoolSlot *slot = threadDictionary[_threadDictionaryKey];
+    if (!slot) {
+        slot = [RLMRealmPoolSlot new];
+        threadDictionary[_threadDictionaryKey] = slot;
+        std::lock_guard<std::mutex> lock(_mutex);
+        [_slots addObject:slot];
+    }
+    return slot;
+}
+
+- (RLMRealm *)realmForCurrentThread:(NSError **)error {
+    RLMRealmPoolSlot *slot = [self slotForCurrentThread];
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (RLMRealm *realm = slot.realm) {
+            return realm;
+        }
+    }
+
+    // Opening can take a while (and may wait for another thread opening the
+    // same file), so do it without holding the pool's lock
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:_configuration error:error];
+    if (realm) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot.realm = realm;
+    }
+    return realm;
+}
+
+- (void)performWithRealm:(void (^)(RLMRealm *))block {
+    NSError *error;
+    if (![self performWithRealm:block error:&error]) {
+        @throw RLMException(@"Could not open Realm for pool: %@", error.localizedDescription);
+    }
+}
+
+- (BOOL)performWithRealm:(void (^)(RLMRealm *))block error:(NSError **)error {
+    RLMRealm *realm = [self realmForCurrentThread:error];
+    if (!realm) {
+        return NO;
+    }
+
+    // A Realm which is already reading is in use by other code on this
+    // thread, such as an enclosing block, so it is left as it is afterwards.
+    // A block performed from within another block's write transaction
+    // shares that transaction rather than refreshing.
+    bool wasReading = realm->_realm->is_in_read_transaction();
+    if (!realm.inWriteTransaction) {
+        [realm refresh];
+    }
+    bool wasInWriteTransaction = realm.inWriteTransaction;
+    block(realm);
+    if (!wasInWriteTransaction && realm.inWriteTransaction) {
+        [realm cancelWriteTransaction];
+        @throw RLMException(@"A write transaction was left open by an RLMRealmPool block. "
+                            @"Write transactions must be committed or cancelled before the block returns.");
+    }
+
+    // End the read transaction so that the version the block read does not
+    // stay pinned, which would make the file grow as other threads write
+    if (!wasReading) {
+        [realm invalidate];
+    }
+    return YES;
+}
+
+- (void)drain {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (RLMRealmPoolSlot *slot in _slots) {
+        if (slot.realm != _creatingThreadRealm) {
+            slot.realm = nil;
+        }
+    }
+}
+
+@end
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An `RLMRealmStatistics` is a snapshot of counters describing the work which
+ has been performed on a Realm file by this process.
+
+ The counters cover every `RLMRealm` instance for the file, on all threads,
+ since the file was first opened by the process. Each `RLMRealm` instance
+ records into its own set of counters, which are only combined when a snapshot
+ is taken, so collecting statistics does not add contention between threads.
+
+ Obtain a snapshot with `-[RLMRealm statistics]`, or periodically with
+ `-[RLMRealm addStatisticsBlock:interval:]`.
+
+ The number of bytes written by commits is not included, as the storage engine
+ does not report it. The versions of the data kept in the file are reported by
+ `-[RLMRealm storageStatistics]`.
+ */
+@interface RLMRealmStatistics : NSObject
+
+#pragma mark - Write Transactions
+
+/// The number of write transactions which have been begun.
+@property (nonatomic, readonly) NSUInteger writeTransactionCount;
+
+/// The total time spent waiting to acquire the write lock when beginning write transactions.
+@property (nonatomic, readonly) NSTimeInterval writeLockWaitDuration;
+
+/// The number of write transactions which have been committed.
+@property (nonatomic, readonly) NSUInteger commitCount;
+
+/// The total time spent committing write transactions.
+@property (nonatomic, readonly) NSTimeInterval commitDuration;
+
+/**
+ The number of commits which took less than each of the durations in
+ `commitDurationHistogramBounds`, excluding those counted in earlier buckets.
+
+ The array has one more element than `commitDurationHistogramBounds`, with the
+ final element counting the commits which took longer than the largest bound.
+ */
+@property (nonatomic, readonly) NSArray<NSNumber *> *commitDurationHistogram;
+
+/// The upper bounds, in seconds, of the buckets in `commitDurationHistogram`.
++ (NSArray<NSNumber *> *)commitDurationHistogramBounds;
+
+#pragma mark - Open Realms
+
+/**
+ The number of `RLMRealm` instances currently open for the file in this process.
+
+ This is not the number of versions of the data being read, as several
+ instances can read the same version and instances in other processes are not
+ counted. See `-[RLMStorageStatistics retainedVersionCount]` for that.
+ */
+@property (nonatomic, readonly) NSUInteger openRealmCount;
+
+#pragma mark - Notifications
+
+/// The number of times a collection notification block has been called.
+@property (nonatomic, readonly) NSUInteger collectionNotificationCount;
+
+/// The total time spent in collection notification blocks.
+@property (nonatomic, readonly) NSTimeInterval collectionNotificationDuration;
+
+/// The number of key-value observing change notifications sent to observers of managed objects.
+@property (nonatomic, readonly) NSUInteger KVONotificationCount;
+
+#pragma mark - Objects and Queries
+
+/// The number of managed object accessors which have been created.
+@property (nonatomic, readonly) NSUInteger accessorCount;
+
+/// The number of times an `RLMResults` has run its query.
+@property (nonatomic, readonly) NSUInteger queryCount;
+
+/// The total time spent running the queries counted in `queryCount`.
+@property (nonatomic, readonly) NSTimeInterval queryDuration;
+
+#pragma mark - Unavailable Methods
+
+/**
+ `-[RLMRealmStatistics init]` is not available because statistics can only be
+ obtained from a Realm. Use `-[RLMRealm statistics]` instead.
+ */
+- (instancetype)init __attribute__((unavailable("Use -[RLMRealm statistics].")));
+
+/**
+ `+[RLMRealmStatistics new]` is not available because statistics can only be
+ obtained from a Realm. Use `-[RLMRealm statistics]` instead.
+ */
++ (instancetype)new __attribute__((unavailable("Use -[RLMRealm statistics].")));
+
+@end
+
+NS_ASSUME_NONNULL_END
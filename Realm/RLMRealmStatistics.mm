@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMRealmStatistics_Private.hpp"
+
+#import "RLMCollection_Private.hpp"
+#import "RLMUtil.hpp"
+
+#import "shared_realm.hpp"
+
+#import <algorithm>
+#import <map>
+#import <mutex>
+#import <vector>
+
+// Upper bounds of the commit duration histogram buckets, in nanoseconds
+static const uint64_t s_commitHistogramBounds[RLMStatisticsCounters::histogramBucketCount - 1] = {
+    1000000, 5000000, 10000000, 50000000, 100000000
+};
+
+void RLMStatisticsCounters::recordCommit(uint64_t nanoseconds) {
+    increment(commits);
+    increment(commitNanoseconds, nanoseconds);
+    auto bound = std::upper_bound(std::begin(s_commitHistogramBounds), std::end(s_commitHistogramBounds), nanoseconds);
+    increment(commitHistogram[bound - std::begin(s_commitHistogramBounds)]);
+}
+
+namespace {
+void addCounters(RLMStatisticsCounters& into, RLMStatisticsCounters const& from) {
+    auto add = [](std::atomic<uint64_t>& a, std::atomic<uint64_t> const& b) {
+        RLMStatisticsCounters::increment(a, b.load(std::memory_order_relaxed));
+    };
+    add(into.writeTransactions, from.writeTransactions);
+    add(into.writeLockWaitNanoseconds, from.writeLockWaitNanoseconds);
+    add(into.commits, from.commits);
+    add(into.commitNanoseconds, from.commitNanoseconds);
+    for (size_t i = 0; i < RLMStatisticsCounters::histogramBucketCount; ++i) {
+        add(into.commitHistogram[i], from.commitHistogram[i]);
+    }
+    add(into.collectionNotifications, from.collectionNotifications);
+    add(into.collectionNotificationNanoseconds, from.collectionNotificationNanoseconds);
+    add(into.kvoNotifications, from.kvoNotifications);
+    add(into.accessors, from.accessors);
+    add(into.queries, from.queries);
+    add(into.queryNanoseconds, from.queryNanoseconds);
+}
+
+// The statistics for a single Realm file: the counters of each RLMRealm
+// instance which is currently open for the file, plus the combined counters of
+// all of the instances which have been closed.
+class RLMStatisticsStore : public std::enable_shared_from_this<RLMStatisticsStore> {
+public:
+    static std::shared_ptr<RLMStatisticsStore> forPath(std::string const& path) {
+        static std::mutex& s_storesMutex = *new std::mutex();
+        static auto& s_stores = *new std::map<std::string, std::shared_ptr<RLMStatisticsStore>>;
+
+        std::lock_guard<std::mutex> lock(s_storesMutex);
+        auto& store = s_stores[path];
+        if (!store) {
+            store = std::make_shared<RLMStatisticsStore>();
+        }
+        return store;
+    }
+
+    std::shared_ptr<RLMStatisticsCounters> makeCounters() {
+        auto counters = new RLMStatisticsCounters;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_live.push_back(counters);
+        }
+        auto self = shared_from_this();
+        return std::shared_ptr<RLMStatisticsCounters>(counters, [self](RLMStatisticsCounters *counters) {
+            self->retire(counters);
+        });
+    }
+
+    size_t snapshot(RLMStatisticsCounters& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        addCounters(out, m_retired);
+        for (auto counters : m_live) {
+            addCounters(out, *counters);
+        }
+        return m_live.size();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<RLMStatisticsCounters *> m_live;
+    RLMStatisticsCounters m_retired;
+
+    void retire(RLMStatisticsCounters *counters) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            addCounters(m_retired, *counters);
+            m_live.erase(std::find(m_live.begin(), m_live.end(), counters));
+        }
+        delete counters;
+    }
+};
+
+NSTimeInterval secondsFromNanoseconds(std::atomic<uint64_t> const& nanoseconds) {
+    return nanoseconds.load(std::memory_order_relaxed) / (double)NSEC_PER_SEC;
+}
+
+NSUInteger count(std::atomic<uint64_t> const& counter) {
+    return (NSUInteger)counter.load(std::memory_order_relaxed);
+}
+} // anonymous namespace
+
+std::shared_ptr<RLMStatisticsCounters> RLMCreateStatisticsCounters(RLMRealm *realm) {
+    return RLMStatisticsStore::forPath(realm->_realm->config().path)->makeCounters();
+}
+
+@interface RLMStatisticsNotificationToken : RLMNotificationToken
+- (instancetype)initWithPath:(std::string)path
+                    interval:(NSTimeInterval)interval
+                       block:(void (^)(RLMRealmStatistics *))block;
+@end
+
+@implementation RLMRealmStatistics
+
++ (NSArray<NSNumber *> *)commitDurationHistogramBounds {
+    NSMutableArray *bounds = [NSMutableArray new];
+    for (auto bound : s_commitHistogramBounds) {
+        [bounds addObject:@(bound / (double)NSEC_PER_SEC)];
+    }
+    return bounds;
+}
+
++ (instancetype)statisticsForRealm:(RLMRealm *)realm {
+    return [self statisticsForPath:realm->_realm->config().path];
+}
+
++ (instancetype)statisticsForPath:(std::string const&)path {
+    RLMStatisticsCounters counters;
+    size_t openRealmCount = RLMStatisticsStore::forPath(path)->snapshot(counters);
+
+    RLMRealmStatistics *statistics = [[self alloc] initPrivate];
+    statistics->_writeTransactionCount = count(counters.writeTransactions);
+    statistics->_writeLockWaitDuration = secondsFromNanoseconds(counters.writeLockWaitNanoseconds);
+    statistics->_commitCount = count(counters.commits);
+    statistics->_commitDuration = secondsFromNanoseconds(counters.commitNanoseconds);
+    NSMutableArray *histogram = [NSMutableArray new];
+    for (auto& bucket : counters.commitHistogram) {
+        [histogram addObject:@(count(bucket))];
+    }
+    statistics->_commitDurationHistogram = histogram;
+    statistics->_openRealmCount = openRealmCount;
+    statistics->_collectionNotificationCount = count(counters.collectionNotifications);
+    statistics->_collectionNotificationDuration = secondsFromNanoseconds(counters.collectionNotificationNanoseconds);
+    statistics->_KVONotificationCount = count(counters.kvoNotifications);
+    statistics->_accessorCount = count(counters.accessors);
+    statistics->_queryCount = count(counters.queries);
+    statistics->_queryDuration = secondsFromNanoseconds(counters.queryNanoseconds);
+    return statistics;
+}
+
++ (RLMNotificationToken *)addBlock:(void (^)(RLMRealmStatistics *))block
+                          forRealm:(RLMRealm *)realm
+                          interval:(NSTimeInterval)interval {
+    if (interval <= 0) {
+        @throw RLMException(@"Statistics interval must be greater than zero, but was %f.", interval);
+    }
+    return [[RLMStatisticsNotificationToken alloc] initWithPath:realm->_realm->config().path
+                                                       interval:interval block:block];
+}
+
+- (instancetype)initPrivate {
+    return [super init];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"RLMRealmStatistics {\n"
+            @"\twriteTransactionCount = %zu;\n"
+            @"\twriteLockWaitDuration = %f;\n"
+            @"\tcommitCount = %zu;\n"
+            @"\tcommitDuration = %f;\n"
+            @"\tcommitDurationHistogram = %@;\n"
+            @"\topenRealmCount = %zu;\n"
+            @"\tcollectionNotificationCount = %zu;\n"
+            @"\tcollectionNotificationDuration = %f;\n"
+            @"\tKVONotificationCount = %zu;\n"
+            @"\taccessorCount = %zu;\n"
+            @"\tqueryCount = %zu;\n"
+            @"\tqueryDuration = %f;\n"
+            @"}",
+            (size_t)_writeTransactionCount, _writeLockWaitDuration, (size_t)_commitCount, _commitDuration,
+            [_commitDurationHistogram componentsJoinedByString:@", "], (size_t)_openRealmCount,
+            (size_t)_collectionNotificationCount, _collectionNotificationDuration,
+            (size_t)_KVONotificationCount, (size_t)_accessorCount, (size_t)_queryCount, _queryDuration];
+}
+
+@end
+
+@implementation RLMStatisticsNotificationToken {
+    dispatch_source_t _timer;
+}
+
+- (instancetype)initWithPath:(std::string)path
+                    interval:(NSTimeInterval)interval
+                       block:(void (^)(RLMRealmStatistics *))block {
+    if (self = [super init]) {
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0,
+                                        dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
+        uint64_t nanoseconds = (uint64_t)(interval * NSEC_PER_SEC);
+        dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, nanoseconds), nanoseconds, nanoseconds / 10);
+        dispatch_source_set_event_handler(_timer, ^{
+            block([RLMRealmStatistics statisticsForPath:path]);
+        });
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (RLMRealm *)realm {
+    return nil;
+}
+
+- (void)suppressNextNotification {
+}
+
+- (void)stop {
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+    }
+}
+
+- (void)dealloc {
+    if (_timer) {
+        NSLog(@"RLMNotificationToken released without unregistering a notification. You must hold "
+              @"on to the RLMNotificationToken returned from addStatisticsBlock:interval: and call "
+              @"-[RLMNotificationToken stop] when you no longer wish to receive statistics.");
+        dispatch_source_cancel(_timer);
+    }
+}
+
+@end
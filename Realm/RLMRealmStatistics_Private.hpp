@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMRealmStatistics.h"
+
+#import "RLMRealm_Private.hpp"
+
+#import <atomic>
+#import <chrono>
+#import <memory>
+#import <string>
+
+// The counters for a single RLMRealm instance. RLMRealm is confined to a
+// single thread, so each set of counters only ever has one writer and can be
+// updated with relaxed loads and stores rather than atomic read-modify-writes.
+// The counters are only atomic so that they can be read from other threads
+// when a statistics snapshot is taken.
+struct RLMStatisticsCounters {
+    static constexpr size_t histogramBucketCount = 6;
+
+    std::atomic<uint64_t> writeTransactions{0};
+    std::atomic<uint64_t> writeLockWaitNanoseconds{0};
+    std::atomic<uint64_t> commits{0};
+    std::atomic<uint64_t> commitNanoseconds{0};
+    std::atomic<uint64_t> commitHistogram[histogramBucketCount] = {};
+    std::atomic<uint64_t> collectionNotifications{0};
+    std::atomic<uint64_t> collectionNotificationNanoseconds{0};
+    std::atomic<uint64_t> kvoNotifications{0};
+    std::atomic<uint64_t> accessors{0};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> queryNanoseconds{0};
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value=1) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void recordCommit(uint64_t nanoseconds);
+};
+
+// Creates the counters for the given Realm and registers them with the
+// statistics for the Realm's file
+std::shared_ptr<RLMStatisticsCounters> RLMCreateStatisticsCounters(RLMRealm *realm);
+
+static inline RLMStatisticsCounters& RLMGetStatisticsCounters(__unsafe_unretained RLMRealm *const realm) {
+    if (!realm->_statistics) {
+        realm->_statistics = RLMCreateStatisticsCounters(realm);
+    }
+    return *realm->_statistics;
+}
+
+// Measures the time between construction and calling `stop()`
+class RLMStatisticsTimer {
+public:
+    RLMStatisticsTimer() : m_start(std::chrono::steady_clock::now()) { }
+
+    uint64_t stop() const {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+@interface RLMRealmStatistics ()
++ (instancetype)statisticsForRealm:(RLMRealm *)realm;
++ (instancetype)statisticsForPath:(std::string const&)path;
+
+// Calls the block with a snapshot of the statistics for the Realm's file every
+// `interval` seconds on a background queue until the token is stopped
++ (RLMNotificationToken *)addBlock:(void (^)(RLMRealmStatistics *))block
+                          forRealm:(RLMRealm *)realm
+                          interval:(NSTimeInterval)interval;
+@end
@@ -18,6 +18,7 @@
 
 #import <Foundation/Foundation.h>
 #import <memory>
+#import <mutex>
 #import <string>
 
 @class RLMRealm;
@@ -30,9 +31,31 @@ namespace realm {
 void RLMCacheRealm(std::string const& path, RLMRealm *realm);
 // Get a Realm for the given path which can be used on the current thread
 RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path);
+// Get a Realm for the configuration with the given cache identity and path
+// which can be used on the current thread. Checks a per-thread cache which
+// requires no locking before falling back to the global cache.
+RLMRealm *RLMGetThreadLocalCachedRealm(uint64_t cacheIdentity, std::string const& path);
 // Get a Realm for the given path
 RLMRealm *RLMGetAnyCachedRealmForPath(std::string const& path);
+// Get the number of times the global cache has been searched for a Realm for
+// the current thread, so that tests can check the per-thread cache was used
+uint64_t RLMGetRealmCacheLookupCount();
 // Clear the weak cache of Realms
 void RLMClearRealmCache();
 
+// Serializes opening Realms at a single path while allowing Realms at other
+// paths to be opened concurrently
+class RLMRealmOpenLock {
+public:
+    RLMRealmOpenLock(std::string path);
+    ~RLMRealmOpenLock();
+
+    RLMRealmOpenLock(RLMRealmOpenLock const&) = delete;
+    RLMRealmOpenLock& operator=(RLMRealmOpenLock const&) = delete;
+
+private:
+    std::string m_path;
+    std::shared_ptr<std::mutex> m_mutex;
+};
+
 std::unique_ptr<realm::BindingContext> RLMCreateBindingContext(RLMRealm *realm);
@@ -28,8 +28,10 @@
 
 #import "binding_context.hpp"
 
+#import <atomic>
 #import <map>
 #import <mutex>
+#import <pthread.h>
 #import <sys/event.h>
 #import <sys/stat.h>
 #import <sys/time.h>
@@ -38,6 +40,9 @@
 // Global realm state
 static std::mutex& s_realmCacheMutex = *new std::mutex();
 static std::map<std::string, NSMapTable *>& s_realmsPerPath = *new std::map<std::string, NSMapTable *>();
+static std::atomic<uint64_t> s_realmCacheEpoch{1};
+// Guarded by s_realmCacheMutex
+static uint64_t s_realmCacheLookups = 0;
 
 void RLMCacheRealm(std::string const& path, __unsafe_unretained RLMRealm *const realm) {
     std::lock_guard<std::mutex> lock(s_realmCacheMutex);
@@ -56,12 +61,118 @@ RLMRealm *RLMGetAnyCachedRealmForPath(std::string const& path) {
 
 RLMRealm *RLMGetThreadLocalCachedRealmForPath(std::string const& path) {
     std::lock_guard<std::mutex> lock(s_realmCacheMutex);
+    ++s_realmCacheLookups;
     return [s_realmsPerPath[path] objectForKey:(__bridge id)pthread_self()];
 }
 
+uint64_t RLMGetRealmCacheLookupCount() {
+    std::lock_guard<std::mutex> lock(s_realmCacheMutex);
+    return s_realmCacheLookups;
+}
+
 void RLMClearRealmCache() {
     std::lock_guard<std::mutex> lock(s_realmCacheMutex);
     s_realmsPerPath.clear();
+    // Invalidates every thread's local cache
+    s_realmCacheEpoch.fetch_add(1, std::memory_order_release);
+}
+
+static std::mutex& s_openLocksMutex = *new std::mutex();
+static std::map<std::string, std::weak_ptr<std::mutex>>& s_openLocks = *new std::map<std::string, std::weak_ptr<std::mutex>>();
+
+RLMRealmOpenLock::RLMRealmOpenLock(std::string path) : m_path(std::move(path)) {
+    {
+        std::lock_guard<std::mutex> lock(s_openLocksMutex);
+        auto& weakMutex = s_openLocks[m_path];
+        m_mutex = weakMutex.lock();
+        if (!m_mutex) {
+            weakMutex = m_mutex = std::make_shared<std::mutex>();
+        }
+    }
+    m_mutex->lock();
+}
+
+RLMRealmOpenLock::~RLMRealmOpenLock() {
+    m_mutex->unlock();
+
+    std::lock_guard<std::mutex> lock(s_openLocksMutex);
+    m_mutex.reset();
+    auto it = s_openLocks.find(m_path);
+    if (it != s_openLocks.end() && it->second.expired()) {
+        s_openLocks.erase(it);
+    }
+}
+
+namespace {
+// A small per-thread cache of the Realms most recently looked up on the
+// thread. Entries are keyed on the configuration's cache identity, with the
+// path as a fallback so that configurations which were created separately but
+// refer to the same file can still hit.
+struct RLMThreadLocalRealmCache {
+    struct Entry {
+        uint64_t identity = 0;
+        uint64_t epoch = 0;
+        std::string path;
+        __weak RLMRealm *realm;
+    };
+    static constexpr size_t size = 4;
+    Entry entries[size];
+    size_t next = 0;
+
+    static RLMThreadLocalRealmCache& current() {
+        static pthread_key_t key = [] {
+            pthread_key_t key;
+            pthread_key_create(&key, [](void *cache) {
+                delete static_cast<RLMThreadLocalRealmCache *>(cache);
+            });
+            return key;
+        }();
+
+        auto cache = static_cast<RLMThreadLocalRealmCache *>(pthread_getspecific(key));
+        if (!cache) {
+            cache = new RLMThreadLocalRealmCache;
+            pthread_setspecific(key, cache);
+        }
+        return *cache;
+    }
+
+    RLMRealm *find(uint64_t identity, std::string const& path, uint64_t epoch) const {
+        for (auto& entry : entries) {
+            if (entry.identity == identity && entry.epoch == epoch) {
+                return entry.realm;
+            }
+        }
+        for (auto& entry : entries) {
+            if (entry.epoch == epoch && entry.path == path) {
+                return entry.realm;
+            }
+        }
+        return nil;
+    }
+
+    void insert(uint64_t identity, std::string const& path, uint64_t epoch, RLMRealm *realm) {
+        auto& entry = entries[next];
+        next = (next + 1) % size;
+        entry.identity = identity;
+        entry.epoch = epoch;
+        entry.path = path;
+        entry.realm = realm;
+    }
+};
+} // anonymous namespace
+
+RLMRealm *RLMGetThreadLocalCachedRealm(uint64_t cacheIdentity, std::string const& path) {
+    auto& cache = RLMThreadLocalRealmCache::current();
+    uint64_t epoch = s_realmCacheEpoch.load(std::memory_order_acquire);
+    if (RLMRealm *realm = cache.find(cacheIdentity, path, epoch)) {
+        return realm;
+    }
+
+    RLMRealm *realm = RLMGetThreadLocalCachedRealmForPath(path);
+    if (realm) {
+        cache.insert(cacheIdentity, path, epoch, realm);
+    }
+    return realm;
 }
 
 namespace {
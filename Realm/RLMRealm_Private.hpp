@@ -19,16 +19,26 @@
 #import "RLMRealm_Private.h"
 
 #import "RLMClassInfo.hpp"
+#import "RLMRealmConfiguration.h"
 
 namespace realm {
     class Group;
     class Realm;
 }
+struct RLMStatisticsCounters;
 
 @interface RLMRealm () {
     @public
     std::shared_ptr<realm::Realm> _realm;
     RLMSchemaInfo _info;
+    std::shared_ptr<RLMStatisticsCounters> _statistics;
+    // The maximum number of threads to use when evaluating a query, or 0 for
+    // one per active processor
+    NSUInteger _queryConcurrency;
+    // The block which queries that take at least _slowQueryThreshold seconds
+    // to build and run are reported to, or nil if queries are not timed
+    RLMSlowQueryBlock _slowQueryBlock;
+    NSTimeInterval _slowQueryThreshold;
 }
 
 // FIXME - group should not be exposed
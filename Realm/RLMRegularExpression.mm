@@ -0,0 +1,915 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMRegularExpression_Private.hpp"
+
+#import <realm/query_expression.hpp>
+#import <realm/util/cf_ptr.hpp>
+
+#import <algorithm>
+#import <bitset>
+#import <map>
+#import <unordered_map>
+#import <vector>
+
+using namespace realm;
+
+namespace {
+// Patterns which use more sets of characters than this or compile to more
+// states are matched with NSRegularExpression
+constexpr size_t s_maxSets = 256;
+constexpr size_t s_maxStates = 20000;
+constexpr int s_maxRepeat = 1000;
+// The number of deterministic states cached by each expression before the
+// cache is discarded and built again
+constexpr size_t s_maxCachedStates = 2000;
+
+using SetMask = std::bitset<s_maxSets>;
+
+// Thrown while parsing a pattern which uses syntax that the automaton does not
+// support, or which is invalid and left to NSRegularExpression to report
+struct UnsupportedPattern { };
+
+enum ClassFlag : uint8_t {
+    DigitClass = 1,
+    WordClass = 2,
+    SpaceClass = 4,
+};
+
+// Which of \d, \w and \s match the code point. ICU's classes are defined by
+// Unicode properties which no Foundation character set matches exactly, so
+// the automaton only implements them for ASCII, and values of patterns which
+// use them are matched with NSRegularExpression if they have other characters.
+uint8_t classFlags(uint32_t cp) {
+    REALM_ASSERT_DEBUG(cp < 128);
+    uint8_t flags = 0;
+    if (cp >= '0' && cp <= '9') {
+        flags |= DigitClass | WordClass;
+    }
+    else if ((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || cp == '_') {
+        flags |= WordClass;
+    }
+    else if (cp == ' ' || (cp >= '\t' && cp <= '\r')) {
+        flags |= SpaceClass;
+    }
+    return flags;
+}
+
+struct CodePointSet {
+    // Inclusive ranges of code points
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    // The \d, \w and \s classes in the set, and the \D, \W and \S classes
+    uint8_t classes = 0;
+    uint8_t negatedClasses = 0;
+    bool negated = false;
+
+    bool contains(uint32_t cp) const {
+        bool found = std::any_of(ranges.begin(), ranges.end(), [&](auto& range) {
+            return range.first <= cp && cp <= range.second;
+        });
+        if (!found && (classes || negatedClasses)) {
+            uint8_t flags = classFlags(cp);
+            found = (classes & flags) || (negatedClasses & ~flags);
+        }
+        return found != negated;
+    }
+
+    bool operator<(CodePointSet const& other) const {
+        return std::tie(ranges, classes, negatedClasses, negated)
+             < std::tie(other.ranges, other.classes, other.negatedClasses, other.negated);
+    }
+};
+
+// Add the other cases of the ASCII letters in the set's ranges, so that
+// matching the set ignores case. ICU's case folding of other characters isn't
+// replicated, so case-insensitive patterns with them aren't compiled, and
+// values of other case-insensitive patterns which have characters outside of
+// ASCII, such as U+017F which folds to 's', are matched with NSRegularExpression.
+void addCaseVariants(CodePointSet& set) {
+    auto ranges = set.ranges;
+    for (auto& range : ranges) {
+        for (uint32_t cp = range.first; cp <= range.second && cp < 128; ++cp) {
+            if (isalpha((int)cp)) {
+                uint32_t other = cp ^ 0x20;
+                set.ranges.push_back({other, other});
+            }
+        }
+    }
+
+    std::sort(set.ranges.begin(), set.ranges.end());
+    std::vector<std::pair<uint32_t, uint32_t>> merged;
+    for (auto& range : set.ranges) {
+        if (!merged.empty() && range.first <= merged.back().second + 1) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        }
+        else {
+            merged.push_back(range);
+        }
+    }
+    set.ranges = std::move(merged);
+}
+
+struct Node {
+    enum class Kind { Empty, Literal, Set, Concatenation, Alternation, Repetition };
+    Kind kind = Kind::Empty;
+    uint32_t codePoint = 0;
+    CodePointSet set;
+    std::vector<Node> children;
+    // The bounds of a repetition, with a max of -1 for no limit
+    int min = 0, max = 0;
+};
+
+// Parses the subset of ICU's regular expression syntax which the automaton
+// supports: literals, escapes, `.`, character classes including \d, \w and \s,
+// groups, alternation and quantifiers, with `^` and `$` only at the start and
+// end of the pattern. Lazy quantifiers are treated as greedy ones, as the
+// whole string has to match either way.
+class Parser {
+public:
+    Parser(NSString *pattern) {
+        NSData *data = [pattern dataUsingEncoding:NSUTF32LittleEndianStringEncoding];
+        auto bytes = static_cast<const uint32_t *>(data.bytes);
+        for (size_t i = 0, count = data.length / 4; i < count; ++i) {
+            m_pattern.push_back(CFSwapInt32LittleToHost(bytes[i]));
+        }
+    }
+
+    Node parse() {
+        if (peek('^')) {
+            ++m_pos;
+        }
+        Node root = parseAlternation();
+        if (m_pos != m_pattern.size()) {
+            throw UnsupportedPattern();
+        }
+        return root;
+    }
+
+    // Whether the pattern has any literal characters outside of ASCII
+    bool hasNonASCII() const { return m_hasNonASCII; }
+
+private:
+    std::vector<uint32_t> m_pattern;
+    size_t m_pos = 0;
+    bool m_hasNonASCII = false;
+
+    Node literal(uint32_t codePoint) {
+        Node node;
+        node.kind = Node::Kind::Literal;
+        node.codePoint = codePoint;
+        m_hasNonASCII = m_hasNonASCII || codePoint >= 128;
+        return node;
+    }
+
+    bool atEnd() const { return m_pos == m_pattern.size(); }
+    bool peek(uint32_t c) const { return !atEnd() && m_pattern[m_pos] == c; }
+    uint32_t next() {
+        if (atEnd()) {
+            throw UnsupportedPattern();
+        }
+        return m_pattern[m_pos++];
+    }
+
+    Node parseAlternation() {
+        Node node = parseConcatenation();
+        if (!peek('|')) {
+            return node;
+        }
+        Node alternation;
+        alternation.kind = Node::Kind::Alternation;
+        alternation.children.push_back(std::move(node));
+        while (peek('|')) {
+            ++m_pos;
+            alternation.children.push_back(parseConcatenation());
+        }
+        return alternation;
+    }
+
+    Node parseConcatenation() {
+        Node concatenation;
+        concatenation.kind = Node::Kind::Concatenation;
+        while (!atEnd() && !peek('|') && !peek(')')) {
+            // `$` is only supported at the end of the pattern, where it has
+            // no effect as the whole string has to match
+            if (peek('$') && m_pos + 1 == m_pattern.size()) {
+                ++m_pos;
+                break;
+            }
+            Node atom = parseAtom();
+            concatenation.children.push_back(parseQuantifiers(std::move(atom)));
+        }
+        return concatenation;
+    }
+
+    Node parseAtom() {
+        uint32_t c = next();
+        Node node;
+        switch (c) {
+            case '(':
+                if (peek('?')) {
+                    ++m_pos;
+                    if (next() != ':') {
+                        throw UnsupportedPattern();
+                    }
+                }
+                node = parseAlternation();
+                if (next() != ')') {
+                    throw UnsupportedPattern();
+                }
+                return node;
+            case '[':
+                node.kind = Node::Kind::Set;
+                node.set = parseClass();
+                return node;
+            case '.':
+                // `.` matches anything other than a line terminator
+                node.kind = Node::Kind::Set;
+                node.set.ranges = {{0x0A, 0x0D}, {0x85, 0x85}, {0x2028, 0x2029}};
+                node.set.negated = true;
+                return node;
+            case '\\':
+                return parseEscape();
+            case '^': case '$': case ')': case ']': case '{': case '}':
+            case '*': case '+': case '?': case '|':
+                throw UnsupportedPattern();
+            default:
+                return literal(c);
+        }
+    }
+
+    uint32_t parseHex(size_t digits) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < digits; ++i) {
+            uint32_t c = next();
+            if (!isxdigit(c < 128 ? (int)c : 0)) {
+                throw UnsupportedPattern();
+            }
+            value = value * 16 + (isdigit((int)c) ? c - '0' : (tolower((int)c) - 'a' + 10));
+        }
+        return value;
+    }
+
+    // Parse the escape sequence following a backslash, returning either a
+    // Literal or a Set node
+    Node parseEscape() {
+        uint32_t c = next();
+        Node node;
+        node.kind = Node::Kind::Set;
+        switch (c) {
+            case 'd': node.set.classes = DigitClass; return node;
+            case 'w': node.set.classes = WordClass; return node;
+            case 's': node.set.classes = SpaceClass; return node;
+            case 'D': node.set.negatedClasses = DigitClass; return node;
+            case 'W': node.set.negatedClasses = WordClass; return node;
+            case 'S': node.set.negatedClasses = SpaceClass; return node;
+            default: break;
+        }
+
+        uint32_t codePoint;
+        switch (c) {
+            case 't': codePoint = '\t'; break;
+            case 'n': codePoint = '\n'; break;
+            case 'r': codePoint = '\r'; break;
+            case 'f': codePoint = '\f'; break;
+            case 'u': codePoint = parseHex(4); break;
+            case 'x':
+                if (peek('{')) {
+                    ++m_pos;
+                    size_t start = m_pos;
+                    while (!peek('}')) {
+                        next();
+                    }
+                    size_t digits = m_pos - start;
+                    if (digits == 0 || digits > 6) {
+                        throw UnsupportedPattern();
+                    }
+                    m_pos = start;
+                    codePoint = parseHex(digits);
+                    ++m_pos;
+                }
+                else {
+                    codePoint = parseHex(2);
+                }
+                break;
+            default:
+                // Escaped ASCII punctuation is literal, while other escapes
+                // are either ICU features we don't support or errors
+                if (c >= 128 || isalnum((int)c)) {
+                    throw UnsupportedPattern();
+                }
+                codePoint = c;
+                break;
+        }
+        if (codePoint > 0x10FFFF) {
+            throw UnsupportedPattern();
+        }
+        return literal(codePoint);
+    }
+
+    // Parse a character class after its opening bracket. Nested classes and
+    // set operations are not supported.
+    CodePointSet parseClass() {
+        CodePointSet set;
+        if (peek('^')) {
+            ++m_pos;
+            set.negated = true;
+        }
+        if (peek(']') || peek('-')) {
+            throw UnsupportedPattern();
+        }
+        while (!peek(']')) {
+            auto member = parseClassMember();
+            if (member.kind == Node::Kind::Set) {
+                set.classes |= member.set.classes;
+                set.negatedClasses |= member.set.negatedClasses;
+                continue;
+            }
+            uint32_t first = member.codePoint, last = first;
+            if (peek('-')) {
+                ++m_pos;
+                if (peek(']')) {
+                    throw UnsupportedPattern();
+                }
+                auto end = parseClassMember();
+                if (end.kind != Node::Kind::Literal || end.codePoint < first) {
+                    throw UnsupportedPattern();
+                }
+                last = end.codePoint;
+            }
+            set.ranges.push_back({first, last});
+        }
+        ++m_pos;
+        return set;
+    }
+
+    Node parseClassMember() {
+        uint32_t c = next();
+        switch (c) {
+            case '\\':
+                return parseEscape();
+            case '[': case '&': case '-':
+                throw UnsupportedPattern();
+            default:
+                return literal(c);
+        }
+    }
+
+    int parseCount() {
+        int value = 0;
+        size_t start = m_pos;
+        while (!atEnd() && m_pattern[m_pos] < 128 && isdigit((int)m_pattern[m_pos])) {
+            value = value * 10 + int(m_pattern[m_pos++] - '0');
+            if (value > s_maxRepeat) {
+                throw UnsupportedPattern();
+            }
+        }
+        if (m_pos == start) {
+            throw UnsupportedPattern();
+        }
+        return value;
+    }
+
+    Node parseQuantifiers(Node atom) {
+        while (!atEnd()) {
+            int min, max;
+            switch (m_pattern[m_pos]) {
+                case '*': min = 0; max = -1; ++m_pos; break;
+                case '+': min = 1; max = -1; ++m_pos; break;
+                case '?': min = 0; max = 1; ++m_pos; break;
+                case '{':
+                    ++m_pos;
+                    min = max = parseCount();
+                    if (peek(',')) {
+                        ++m_pos;
+                        max = peek('}') ? -1 : parseCount();
+                    }
+                    if (next() != '}' || (max != -1 && max < min)) {
+                        throw UnsupportedPattern();
+                    }
+                    break;
+                default:
+                    return atom;
+            }
+            // Possessive quantifiers can change whether the string matches
+            if (peek('+')) {
+                throw UnsupportedPattern();
+            }
+            if (peek('?')) {
+                ++m_pos;
+            }
+            Node repetition;
+            repetition.kind = Node::Kind::Repetition;
+            repetition.min = min;
+            repetition.max = max;
+            repetition.children.push_back(std::move(atom));
+            atom = std::move(repetition);
+        }
+        return atom;
+    }
+};
+
+struct State {
+    enum class Kind : uint8_t { Match, Set, Split };
+    Kind kind;
+    // The set of code points which a Set state consumes
+    size_t set = 0;
+    int out = -1, out1 = -1;
+};
+} // anonymous namespace
+
+class RLMRegularExpression {
+public:
+    // The nondeterministic automaton, which matches the string if it can reach
+    // the Match state after consuming all of it
+    std::vector<State> states;
+    int start = 0;
+    std::vector<CodePointSet> sets;
+
+    std::string literalPrefix;
+    bool isLiteral = false;
+
+    // Whether the automaton was built. If not, every value is matched with
+    // `fallback`.
+    bool hasAutomaton = false;
+    // Whether the automaton only matches values exactly as ICU does if they
+    // are ASCII, because the pattern ignores case or uses \d, \w or \s, so
+    // other values are matched with `fallback`
+    bool asciiValuesOnly = false;
+    // Compiled once along with the automaton and shared by every copy of the
+    // query's expression
+    NSRegularExpression *fallback;
+
+    SetMask setsContaining(uint32_t cp) const {
+        SetMask mask;
+        for (size_t i = 0; i < sets.size(); ++i) {
+            mask[i] = sets[i].contains(cp);
+        }
+        return mask;
+    }
+};
+
+namespace {
+class Compiler {
+public:
+    Compiler(RLMRegularExpression& regex, bool caseInsensitive)
+    : m_regex(regex), m_caseInsensitive(caseInsensitive) { }
+
+    void compile(Node const& root) {
+        int match = addState({State::Kind::Match});
+        m_regex.start = compile(root, match);
+    }
+
+private:
+    RLMRegularExpression& m_regex;
+    bool m_caseInsensitive;
+    std::map<CodePointSet, size_t> m_setIndexes;
+
+    int addState(State state) {
+        if (m_regex.states.size() == s_maxStates) {
+            throw UnsupportedPattern();
+        }
+        m_regex.states.push_back(state);
+        return int(m_regex.states.size() - 1);
+    }
+
+    size_t addSet(CodePointSet set) {
+        if (m_caseInsensitive) {
+            addCaseVariants(set);
+        }
+        auto it = m_setIndexes.find(set);
+        if (it != m_setIndexes.end()) {
+            return it->second;
+        }
+        if (m_regex.sets.size() == s_maxSets) {
+            throw UnsupportedPattern();
+        }
+        m_regex.sets.push_back(set);
+        m_setIndexes[set] = m_regex.sets.size() - 1;
+        return m_regex.sets.size() - 1;
+    }
+
+    // Add the states for the node which continue to `next`, and return the
+    // first of them. Building the automaton from the end backwards means
+    // that each state's successors already exist when it is added.
+    int compile(Node const& node, int next) {
+        switch (node.kind) {
+            case Node::Kind::Empty:
+                return next;
+            case Node::Kind::Literal: {
+                CodePointSet set;
+                set.ranges.push_back({node.codePoint, node.codePoint});
+                return addState({State::Kind::Set, addSet(std::move(set)), next});
+            }
+            case Node::Kind::Set:
+                return addState({State::Kind::Set, addSet(node.set), next});
+            case Node::Kind::Concatenation:
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+                    next = compile(*it, next);
+                }
+                return next;
+            case Node::Kind::Alternation: {
+                int first = compile(node.children.back(), next);
+                for (size_t i = node.children.size() - 1; i > 0; --i) {
+                    first = addState({State::Kind::Split, 0, compile(node.children[i - 1], next), first});
+                }
+                return first;
+            }
+            case Node::Kind::Repetition: {
+                Node const& child = node.children.front();
+                int tail = next;
+                if (node.max == -1) {
+                    int loop = addState({State::Kind::Split, 0, -1, next});
+                    // compile() can reallocate the states, so it has to be
+                    // called before indexing them
+                    int body = compile(child, loop);
+                    m_regex.states[loop].out = body;
+                    tail = loop;
+                }
+                else {
+                    for (int i = node.min; i < node.max; ++i) {
+                        tail = addState({State::Kind::Split, 0, compile(child, tail), next});
+                    }
+                }
+                for (int i = 0; i < node.min; ++i) {
+                    tail = compile(child, tail);
+                }
+                return tail;
+            }
+        }
+        REALM_UNREACHABLE();
+    }
+};
+
+// The literal code points at the start of the pattern, and whether they are
+// all of it
+std::vector<uint32_t> literalPrefix(Node const& root, bool& entirePattern) {
+    std::vector<uint32_t> prefix;
+    entirePattern = false;
+    if (root.kind == Node::Kind::Literal) {
+        entirePattern = true;
+        return {root.codePoint};
+    }
+    if (root.kind == Node::Kind::Empty) {
+        entirePattern = true;
+        return prefix;
+    }
+    if (root.kind != Node::Kind::Concatenation) {
+        return prefix;
+    }
+    for (auto& child : root.children) {
+        if (child.kind != Node::Kind::Literal) {
+            return prefix;
+        }
+        prefix.push_back(child.codePoint);
+    }
+    entirePattern = true;
+    return prefix;
+}
+
+std::string utf8(std::vector<uint32_t> const& codePoints) {
+    std::string result;
+    for (uint32_t cp : codePoints) {
+        if (cp < 0x80) {
+            result += char(cp);
+        }
+        else if (cp < 0x800) {
+            result += char(0xC0 | (cp >> 6));
+            result += char(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000) {
+            result += char(0xE0 | (cp >> 12));
+            result += char(0x80 | ((cp >> 6) & 0x3F));
+            result += char(0x80 | (cp & 0x3F));
+        }
+        else {
+            result += char(0xF0 | (cp >> 18));
+            result += char(0x80 | ((cp >> 12) & 0x3F));
+            result += char(0x80 | ((cp >> 6) & 0x3F));
+            result += char(0x80 | (cp & 0x3F));
+        }
+    }
+    return result;
+}
+
+// Decode the code point at `it`, advancing past it. Invalid UTF-8 decodes to
+// the replacement character.
+uint32_t decodeUTF8(const unsigned char *& it, const unsigned char *end) {
+    unsigned char c = *it++;
+    if (c < 0x80) {
+        return c;
+    }
+    int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+    if (extra < 0 || end - it < extra) {
+        return 0xFFFD;
+    }
+    uint32_t cp = c & (0x3F >> extra);
+    for (int i = 0; i < extra; ++i) {
+        if ((*it & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (*it++ & 0x3F);
+    }
+    return cp;
+}
+
+// Matches strings against a regular expression's automaton, building the
+// deterministic automaton as it goes. Each deterministic state is a set of
+// the nondeterministic Set and Match states, and code points which are in the
+// same sets of the pattern are in the same class and share transitions.
+class Matcher {
+public:
+    Matcher(std::shared_ptr<RLMRegularExpression> regex) : m_regex(std::move(regex)) {
+        if (m_regex->hasAutomaton) {
+            for (uint32_t cp = 0; cp < 128; ++cp) {
+                m_asciiClasses[cp] = classFor(m_regex->setsContaining(cp));
+            }
+            reset();
+        }
+    }
+
+    bool matches(StringData value) {
+        if (value.is_null()) {
+            return false;
+        }
+        if (!m_regex->hasAutomaton) {
+            return matchesWithFallback(value);
+        }
+
+        int state = m_start;
+        auto it = reinterpret_cast<const unsigned char *>(value.data());
+        auto end = it + value.size();
+        while (it != end) {
+            if (*it >= 0x80 && m_regex->asciiValuesOnly) {
+                return matchesWithFallback(value);
+            }
+            uint32_t cp = decodeUTF8(it, end);
+            size_t cls = cp < 128 ? m_asciiClasses[cp] : classFor(m_regex->setsContaining(cp));
+            state = transition(state, cls);
+            if (state == m_dead) {
+                return false;
+            }
+        }
+        return m_accepting[state];
+    }
+
+private:
+    std::shared_ptr<RLMRegularExpression> m_regex;
+
+    size_t m_asciiClasses[128];
+    std::unordered_map<SetMask, size_t> m_classes;
+    std::vector<SetMask> m_classMasks;
+
+    std::map<std::vector<int>, int> m_stateIndexes;
+    std::vector<std::vector<int>> m_stateSets;
+    std::vector<std::vector<int>> m_transitions;
+    std::vector<bool> m_accepting;
+    int m_start, m_dead;
+
+    // UTF-16 decoding of the value being matched with the fallback, which
+    // m_fallbackString points at so that no string is created per value
+    std::vector<UniChar> m_fallbackBuffer;
+    util::CFPtr<CFMutableStringRef> m_fallbackString;
+
+    bool matchesWithFallback(StringData value) {
+        m_fallbackBuffer.clear();
+        auto it = reinterpret_cast<const unsigned char *>(value.data());
+        auto end = it + value.size();
+        while (it != end) {
+            uint32_t cp = decodeUTF8(it, end);
+            if (cp < 0x10000) {
+                m_fallbackBuffer.push_back(cp);
+            }
+            else {
+                cp -= 0x10000;
+                m_fallbackBuffer.push_back(0xD800 + (cp >> 10));
+                m_fallbackBuffer.push_back(0xDC00 + (cp & 0x3FF));
+            }
+        }
+        if (!m_fallbackString) {
+            m_fallbackString = util::adoptCF(CFStringCreateMutableWithExternalCharactersNoCopy(kCFAllocatorDefault,
+                                                                                              nullptr, 0, 0,
+                                                                                              kCFAllocatorNull));
+        }
+        CFStringSetExternalCharactersNoCopy(m_fallbackString.get(), m_fallbackBuffer.data(),
+                                            m_fallbackBuffer.size(), m_fallbackBuffer.capacity());
+
+        // Queries run in loops with no autorelease pool of their own
+        @autoreleasepool {
+            NSString *string = (__bridge NSString *)m_fallbackString.get();
+            return [m_regex->fallback rangeOfFirstMatchInString:string options:0
+                                                          range:NSMakeRange(0, m_fallbackBuffer.size())].location != NSNotFound;
+        }
+    }
+
+    size_t classFor(SetMask const& mask) {
+        auto it = m_classes.find(mask);
+        if (it != m_classes.end()) {
+            return it->second;
+        }
+        m_classMasks.push_back(mask);
+        return m_classes[mask] = m_classMasks.size() - 1;
+    }
+
+    void reset() {
+        m_stateIndexes.clear();
+        m_stateSets.clear();
+        m_transitions.clear();
+        m_accepting.clear();
+        m_dead = stateFor({});
+        m_start = stateFor(closure({m_regex->start}));
+    }
+
+    // The Set and Match states reachable from `states` without consuming anything
+    std::vector<int> closure(std::vector<int> const& states) const {
+        std::vector<int> result, stack(states);
+        std::vector<bool> seen(m_regex->states.size());
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+            if (seen[index]) {
+                continue;
+            }
+            seen[index] = true;
+            auto& state = m_regex->states[index];
+            if (state.kind == State::Kind::Split) {
+                stack.push_back(state.out1);
+                stack.push_back(state.out);
+            }
+            else {
+                result.push_back(index);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    int stateFor(std::vector<int> set) {
+        auto it = m_stateIndexes.find(set);
+        if (it != m_stateIndexes.end()) {
+            return it->second;
+        }
+        int index = int(m_stateSets.size());
+        m_accepting.push_back(std::any_of(set.begin(), set.end(), [&](int state) {
+            return m_regex->states[state].kind == State::Kind::Match;
+        }));
+        m_transitions.emplace_back();
+        m_stateIndexes[set] = index;
+        m_stateSets.push_back(std::move(set));
+        return index;
+    }
+
+    int transition(int state, size_t cls) {
+        auto& transitions = m_transitions[state];
+        if (cls < transitions.size() && transitions[cls] != -1) {
+            return transitions[cls];
+        }
+
+        std::vector<int> next;
+        SetMask const& mask = m_classMasks[cls];
+        for (int index : m_stateSets[state]) {
+            auto& nfaState = m_regex->states[index];
+            if (nfaState.kind == State::Kind::Set && mask[nfaState.set]) {
+                next.push_back(nfaState.out);
+            }
+        }
+        next = closure(next);
+
+        if (m_stateSets.size() >= s_maxCachedStates) {
+            reset();
+            return stateFor(std::move(next));
+        }
+        int result = stateFor(std::move(next));
+        // stateFor() may have reallocated m_transitions
+        auto& stateTransitions = m_transitions[state];
+        if (stateTransitions.size() <= cls) {
+            stateTransitions.resize(m_classMasks.size(), -1);
+        }
+        stateTransitions[cls] = result;
+        return result;
+    }
+};
+
+class RegularExpressionExpression : public realm::Expression {
+public:
+    RegularExpressionExpression(std::unique_ptr<Subexpr> column, std::shared_ptr<RLMRegularExpression> regex)
+    : m_column(std::move(column)), m_regex(regex), m_matcher(std::move(regex))
+    {
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        Value<StringData> values;
+        while (start < end) {
+            m_column->evaluate(start, values);
+            if (values.m_from_link_list) {
+                // Every value is from the same row, which matches if any do
+                for (size_t i = 0; i < values.m_values; ++i) {
+                    if (m_matcher.matches(values.m_storage[i])) {
+                        return start;
+                    }
+                }
+                ++start;
+                continue;
+            }
+
+            // Each value is from a row, starting at `start`
+            size_t rows = std::min(values.m_values, end - start);
+            for (size_t i = 0; i < rows; ++i) {
+                if (m_matcher.matches(values.m_storage[i])) {
+                    return start + i;
+                }
+            }
+            start += std::max<size_t>(values.m_values, 1);
+        }
+        return realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_column->set_base_table(table); }
+    void verify_column() const override { m_column->verify_column(); }
+    const Table* get_base_table() const override { return m_column->get_base_table(); }
+
+    void apply_handover_patch(QueryNodeHandoverPatches& patches, Group& group) override
+    {
+        m_column->apply_handover_patch(patches, group);
+    }
+
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        // Each copy builds its own deterministic automaton, as copies may be
+        // used on different threads
+        return std::unique_ptr<Expression>(new RegularExpressionExpression(m_column->clone(patches), m_regex));
+    }
+
+private:
+    std::unique_ptr<Subexpr> m_column;
+    std::shared_ptr<RLMRegularExpression> m_regex;
+    mutable Matcher m_matcher;
+};
+} // anonymous namespace
+
+std::shared_ptr<RLMRegularExpression> RLMCompileRegularExpression(NSString *pattern, bool caseInsensitive,
+                                                                  NSString **error) {
+    auto regex = std::make_shared<RLMRegularExpression>();
+    try {
+        Parser parser(pattern);
+        Node root = parser.parse();
+        bool entirePattern;
+        regex->literalPrefix = utf8(literalPrefix(root, entirePattern));
+        regex->isLiteral = entirePattern;
+        if (!caseInsensitive || !parser.hasNonASCII()) {
+            Compiler(*regex, caseInsensitive).compile(root);
+            regex->hasAutomaton = true;
+            bool usesClasses = std::any_of(regex->sets.begin(), regex->sets.end(), [](auto& set) {
+                return set.classes || set.negatedClasses;
+            });
+            regex->asciiValuesOnly = caseInsensitive || usesClasses;
+            if (!regex->asciiValuesOnly) {
+                return regex;
+            }
+        }
+    }
+    catch (UnsupportedPattern const&) {
+        regex = std::make_shared<RLMRegularExpression>();
+    }
+
+    // Check the pattern on its own first, as wrapping it could hide errors
+    // such as unbalanced parentheses
+    NSRegularExpressionOptions options = caseInsensitive ? NSRegularExpressionCaseInsensitive : 0;
+    NSError *nsError;
+    if (![NSRegularExpression regularExpressionWithPattern:pattern options:options error:&nsError]) {
+        *error = nsError.localizedDescription;
+        return nullptr;
+    }
+    NSString *anchored = [NSString stringWithFormat:@"\\A(?:%@)\\z", pattern];
+    regex->fallback = [NSRegularExpression regularExpressionWithPattern:anchored options:options error:&nsError];
+    if (!regex->fallback) {
+        *error = nsError.localizedDescription;
+        return nullptr;
+    }
+    return regex;
+}
+
+std::string RLMRegularExpressionLiteralPrefix(RLMRegularExpression const& regex, bool *entirePattern) {
+    *entirePattern = regex.isLiteral;
+    return regex.literalPrefix;
+}
+
+std::unique_ptr<realm::Expression> RLMMakeRegularExpressionExpression(std::unique_ptr<realm::Subexpr> column,
+                                                                      std::shared_ptr<RLMRegularExpression> regex) {
+    return std::unique_ptr<Expression>(new RegularExpressionExpression(std::move(column), std::move(regex)));
+}
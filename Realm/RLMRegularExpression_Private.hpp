@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+#import <memory>
+#import <string>
+
+namespace realm {
+    class Expression;
+    class Subexpr;
+}
+
+// Regular expressions for the MATCHES operator are compiled once per query to
+// a nondeterministic automaton over Unicode code points, which is converted to
+// a deterministic automaton lazily while matching so that each character of a
+// value is only looked at once. Values are decoded from UTF-8 as they are
+// matched rather than being converted to NSStrings. Patterns which use ICU
+// features that the automaton does not support, such as backreferences and
+// lookaround, are matched with NSRegularExpression instead. So are values with
+// characters outside of ASCII if the pattern ignores case or uses \d, \w or
+// \s, and case-insensitive patterns with characters outside of ASCII, as the
+// automaton doesn't replicate ICU's Unicode case folding and properties. The
+// NSRegularExpression is also compiled once per query, and those values are
+// decoded into a UTF-16 buffer which is reused for each value.
+class RLMRegularExpression;
+
+// Compile the pattern of a MATCHES comparison, which matches strings which are
+// matched by the pattern in their entirety. Returns nullptr and sets `error`
+// if the pattern is not a valid regular expression.
+std::shared_ptr<RLMRegularExpression> RLMCompileRegularExpression(NSString *pattern, bool caseInsensitive,
+                                                                  NSString **error);
+
+// Get the literal text which every string matched by the regular expression
+// begins with, ignoring the case-insensitive option, and set `entirePattern`
+// to whether the pattern is only that text
+std::string RLMRegularExpressionLiteralPrefix(RLMRegularExpression const& regex, bool *entirePattern);
+
+// Create a query expression which matches the rows where a value of `column`,
+// which must be a Columns<String>, is matched by the regular expression
+std::unique_ptr<realm::Expression> RLMMakeRegularExpressionExpression(std::unique_ptr<realm::Subexpr> column,
+                                                                      std::shared_ptr<RLMRegularExpression> regex);
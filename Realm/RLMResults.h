@@ -187,6 +187,40 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (RLMResults<RLMObjectType> *)sortedResultsUsingDescriptors:(NSArray<RLMSortDescriptor *> *)properties;
 
+/**
+ Returns a distinct `RLMResults` from an existing results collection.
+
+ Objects are considered duplicates if they have equal values for all of the
+ given key paths, and only the first such object is kept. The deduplication is
+ performed by Realm itself, and the returned results are live and will be kept
+ up to date in the same way as any other `RLMResults`.
+
+ @param keyPaths  The key paths to distinct on. Only properties of types
+                  `bool`, `int`, `float`, `double`, `NSString` and `NSDate` are
+                  supported, and key paths may not contain to-many relationships.
+
+ @return    An `RLMResults` with the distinct objects.
+ */
+- (RLMResults<RLMObjectType> *)distinctResultsUsingKeyPaths:(NSArray<NSString *> *)keyPaths;
+
+/**
+ Returns a description of how the query which produced the results is evaluated.
+
+ Conditions combined with `AND` are evaluated in order of their estimated cost
+ rather than the order in which they were written, with conditions which can use
+ an index first. The description lists the conditions in that order, how each is
+ evaluated, its estimated relative cost, and how many objects it examined and
+ matched, followed by the number of results. Each condition examines only the
+ objects matched by the conditions before it.
+
+ The counts are found by running each condition as a separate query, so this
+ takes longer than evaluating the query itself. This is intended for tuning
+ predicates, and the format of the description may change.
+
+ @return    A description of the query plan.
+ */
+- (NSString *)explain;
+
 #pragma mark - Notifications
 
 /**
@@ -251,6 +285,41 @@ NS_ASSUME_NONNULL_BEGIN
                                                          RLMCollectionChange *__nullable change,
                                                          NSError *__nullable error))block __attribute__((warn_unused_result));
 
+/**
+ Registers a block to be called on the given queue each time the results collection changes.
+
+ This is identical to `addNotificationBlock:`, except that the block is called
+ on `queue` rather than on the current thread, so that expensive processing of
+ the changes does not need to be performed on the current thread (for example,
+ the main thread). Unlike `addNotificationBlock:`, this method can be called
+ from threads which do not have a run loop, such as those used by dispatch queues.
+
+ The collection is observed on a background thread, and the change information
+ is computed there. The `results` passed to the block belongs to a Realm opened
+ on whichever thread `queue` is running the block on, and may only be used
+ within the block unless it is passed to another thread with an
+ `RLMThreadSafeReference`. That Realm is not cached, and is closed once the
+ block returns unless something retains it. The collection may reflect a
+ newer version of the Realm than the change information if further write
+ transactions were committed before the block was called.
+
+ You must retain the returned token for as long as you want updates to continue
+ to be sent to the block. To stop receiving updates, call `-stop` on the token.
+ Blocks which have already been dispatched to the queue when the token is
+ stopped will not be called.
+
+ @warning This method cannot be called during a write transaction, or when the
+          containing Realm is read-only.
+
+ @param block The block to be called each time the results collection changes.
+ @param queue The serial queue to call the block on.
+ @return A token which must be held for as long as you want updates to be delivered.
+ */
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMResults<RLMObjectType> *__nullable results,
+                                                         RLMCollectionChange *__nullable change,
+                                                         NSError *__nullable error))block
+                                         queue:(dispatch_queue_t)queue __attribute__((warn_unused_result));
+
 #pragma mark - Aggregating Property Values
 
 /**
@@ -25,9 +25,13 @@
 #import "RLMObjectStore.h"
 #import "RLMObject_Private.hpp"
 #import "RLMObservation.hpp"
+#import "RLMOrderedIndex_Private.hpp"
+#import "RLMParallelQuery.hpp"
 #import "RLMProperty_Private.h"
+#import "RLMQueryTiming_Private.hpp"
 #import "RLMQueryUtil.hpp"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmStatistics_Private.hpp"
 #import "RLMSchema_Private.h"
 #import "RLMThreadSafeReference_Private.hpp"
 #import "RLMUtil.hpp"
@@ -56,6 +60,11 @@ using namespace realm;
     realm::Results _results;
     RLMRealm *_realm;
     RLMClassInfo *_info;
+    // Whether the query covers every row of the table rather than the rows of
+    // a LinkView, the results are not distinct, and the query uses no links or
+    // custom expression nodes, so that it can be evaluated over ranges of rows
+    // independently on several threads
+    bool _partitionable;
 }
 
 - (instancetype)initPrivate {
@@ -63,12 +72,16 @@ using namespace realm;
     return self;
 }
 
-static void assertKeyPathIsNotNested(NSString *keyPath) {
-    if ([keyPath rangeOfString:@"."].location != NSNotFound) {
-        @throw RLMException(@"Nested key paths are not supported yet for KVC collection operators.");
+static void assertKeyPathHasNoCollectionOperators(NSString *keyPath) {
+    if ([keyPath rangeOfString:@"@"].location != NSNotFound) {
+        @throw RLMException(@"Nested key paths containing KVC collection operators are not supported.");
     }
 }
 
+static bool isNestedKeyPath(NSString *keyPath) {
+    return [keyPath rangeOfString:@"."].location != NSNotFound;
+}
+
 [[gnu::noinline]]
 [[noreturn]]
 static void throwError(NSString *aggregateMethod) {
@@ -113,6 +126,60 @@ static auto translateErrors(Function&& f, NSString *aggregateMethod=nil) {
     }
 }
 
+// Report the query to the Realm's slowQueryBlock if building and running it
+// took at least the Realm's threshold
+static void reportQueryTiming(__unsafe_unretained RLMResults *const ar, uint64_t executionNanoseconds,
+                              NSUInteger resultCount) {
+    RLMRealm *realm = ar->_realm;
+    uint64_t nanoseconds = ar->_queryBuildNanoseconds + executionNanoseconds;
+    if (nanoseconds < realm->_slowQueryThreshold * NSEC_PER_SEC) {
+        return;
+    }
+    RLMQueryTiming *timing = [[RLMQueryTiming alloc] initWithClassName:ar->_info->rlmObjectSchema.className
+                                                       predicateFormat:ar->_filterPredicate.predicateFormat
+                                                      buildNanoseconds:ar->_queryBuildNanoseconds
+                                                  executionNanoseconds:executionNanoseconds
+                                                   searchedObjectCount:ar->_info->table()->size()
+                                                           resultCount:resultCount];
+    realm->_slowQueryBlock(timing);
+}
+
+// The number of objects matched by the query which the results just ran, if
+// running it left the results holding a table view. Otherwise finding it would
+// mean running the query again, so it is reported as NSNotFound.
+static NSUInteger knownResultCount(__unsafe_unretained RLMResults *const ar) {
+    return ar->_results.get_mode() == Results::Mode::TableView ? ar->_results.size() : NSNotFound;
+}
+
+// Calls `f` with errors translated as in translateErrors(). If the results
+// have not yet run their query (or `alwaysQueries` is set because `f` runs a
+// separate query), the call is recorded as a query execution in the Realm's
+// statistics. Runs of the results' own query are also reported to the Realm's
+// slowQueryBlock, with the number of results obtained from `f`'s return value
+// by `resultCount`.
+template<typename Function, typename ResultCount>
+static auto measureQuery(__unsafe_unretained RLMResults *const ar, Function&& f, ResultCount&& resultCount,
+                         bool alwaysQueries) {
+    if (!alwaysQueries && ar->_results.get_mode() != Results::Mode::Query) {
+        return translateErrors(f);
+    }
+    RLMStatisticsTimer timer;
+    auto result = translateErrors(f);
+    uint64_t nanoseconds = timer.stop();
+    auto& statistics = RLMGetStatisticsCounters(ar->_realm);
+    RLMStatisticsCounters::increment(statistics.queries);
+    RLMStatisticsCounters::increment(statistics.queryNanoseconds, nanoseconds);
+    if (!alwaysQueries && ar->_realm->_slowQueryBlock) {
+        reportQueryTiming(ar, nanoseconds, resultCount(result));
+    }
+    return result;
+}
+
+template<typename Function>
+static auto measureQuery(__unsafe_unretained RLMResults *const ar, Function&& f, bool alwaysQueries=false) {
+    return measureQuery(ar, f, [=](auto const&) { return knownResultCount(ar); }, alwaysQueries);
+}
+
 + (instancetype)resultsWithObjectInfo:(RLMClassInfo&)info
                               results:(realm::Results)results {
     RLMResults *ar = [[self alloc] initPrivate];
@@ -122,6 +189,13 @@ static auto translateErrors(Function&& f, NSString *aggregateMethod=nil) {
     return ar;
 }
 
++ (instancetype)resultsWithObjectInfo:(RLMClassInfo&)info
+                         tableResults:(realm::Results)results {
+    RLMResults *ar = [self resultsWithObjectInfo:info results:std::move(results)];
+    ar->_partitionable = true;
+    return ar;
+}
+
 + (instancetype)emptyDetachedResults {
     return [[self alloc] initPrivate];
 }
@@ -135,14 +209,51 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     return translateErrors([&] { return !_results.is_valid(); });
 }
 
+// Returns the number of threads to use to evaluate the results' query
+// directly rather than through realm::Results, or 0 if it should not be
+static size_t parallelQueryConcurrency(__unsafe_unretained RLMResults *const ar) {
+    if (!ar->_partitionable) {
+        return 0;
+    }
+    auto mode = ar->_results.get_mode();
+    if (mode != Results::Mode::Query && mode != Results::Mode::Table) {
+        return 0;
+    }
+    // The other threads read from their own transactions on the same version,
+    // which can't see uncommitted changes, and read-only Realms don't have a
+    // transaction to share the version of
+    if (ar->_realm.inWriteTransaction || ar->_realm->_realm->config().read_only()) {
+        return 0;
+    }
+    return RLMParallelQueryConcurrency(ar->_realm->_queryConcurrency, ar->_info->table()->size());
+}
+
 - (NSUInteger)count {
-    return translateErrors([&] { return _results.size(); });
+    return measureQuery(self, [&] {
+        // Counting a table doesn't need a query at all
+        if (_results.get_mode() == Results::Mode::Query) {
+            if (size_t concurrency = parallelQueryConcurrency(self)) {
+                return RLMParallelCount(*_realm->_realm, _results.get_query(), concurrency);
+            }
+        }
+        return _results.size();
+    }, [](size_t count) { return count; }, false);
 }
 
 - (NSString *)objectClassName {
     return RLMStringDataToNSString(_results.get_object_type());
 }
 
+- (NSString *)explain {
+    return translateErrors([&] {
+        if (_results.get_mode() == Results::Mode::Empty) {
+            return @"Result count: 0";
+        }
+        NSString *plan = RLMExplainPredicate(_filterPredicate, _info->rlmObjectSchema, _realm.schema, _realm.group);
+        return [plan stringByAppendingFormat:@"Result count: %zu", _results.size()];
+    });
+}
+
 - (RLMClassInfo *)objectInfo {
     return _info;
 }
@@ -185,14 +296,14 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         return NSNotFound;
     }
 
-    return translateErrors([&] {
+    return measureQuery(self, [&] {
         return RLMConvertNotFound(_results.index_of(RLMPredicateToQuery(predicate, _info->rlmObjectSchema, _realm.schema, _realm.group)));
-    });
+    }, true);
 }
 
 - (id)objectAtIndex:(NSUInteger)index {
     RLMAccessorContext ctx(_realm, *_info);
-    return translateErrors([&] {
+    return measureQuery(self, [&] {
         return _results.get(ctx, index);
     });
 }
@@ -202,7 +313,7 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         return nil;
     }
     RLMAccessorContext ctx(_realm, *_info);
-    return translateErrors([&] {
+    return measureQuery(self, [&] {
         return _results.first(ctx);
     });
 }
@@ -212,7 +323,7 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         return nil;
     }
     RLMAccessorContext ctx(_realm, *_info);
-    return translateErrors([&] {
+    return measureQuery(self, [&] {
         return _results.last(ctx);
     });
 }
@@ -222,7 +333,7 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         return NSNotFound;
     }
     RLMAccessorContext ctx(_realm, *_info);
-    return translateErrors([&] {
+    return measureQuery(self, [&] {
         return RLMConvertNotFound(_results.index_of(ctx, object));
     });
 }
@@ -264,57 +375,114 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
 }
 
 - (NSNumber *)_aggregateForKeyPath:(NSString *)keyPath method:(util::Optional<Mixed> (Results::*)(size_t))method
+                         aggregate:(RLMCollectionAggregate)aggregate
                         methodName:(NSString *)methodName returnNilForEmpty:(BOOL)returnNilForEmpty {
-    assertKeyPathIsNotNested(keyPath);
-    return [self aggregate:keyPath method:method methodName:methodName returnNilForEmpty:returnNilForEmpty];
+    assertKeyPathHasNoCollectionOperators(keyPath);
+    if (!isNestedKeyPath(keyPath)) {
+        return [self aggregate:keyPath method:method aggregate:aggregate
+                    methodName:methodName returnNilForEmpty:returnNilForEmpty];
+    }
+    if (_results.get_mode() == Results::Mode::Empty) {
+        return returnNilForEmpty ? nil : @0;
+    }
+    return translateErrors([&] {
+        return RLMCollectionAggregateForKeyPath(self, keyPath, aggregate, methodName);
+    });
 }
 
 - (NSNumber *)_minForKeyPath:(NSString *)keyPath {
-    return [self _aggregateForKeyPath:keyPath method:&Results::min methodName:@"@min" returnNilForEmpty:YES];
+    return [self _aggregateForKeyPath:keyPath method:&Results::min aggregate:RLMCollectionAggregate::Min
+                           methodName:@"@min" returnNilForEmpty:YES];
 }
 
 - (NSNumber *)_maxForKeyPath:(NSString *)keyPath {
-    return [self _aggregateForKeyPath:keyPath method:&Results::max methodName:@"@max" returnNilForEmpty:YES];
+    return [self _aggregateForKeyPath:keyPath method:&Results::max aggregate:RLMCollectionAggregate::Max
+                           methodName:@"@max" returnNilForEmpty:YES];
 }
 
 - (NSNumber *)_sumForKeyPath:(NSString *)keyPath {
-    return [self _aggregateForKeyPath:keyPath method:&Results::sum methodName:@"@sum" returnNilForEmpty:NO];
+    return [self _aggregateForKeyPath:keyPath method:&Results::sum aggregate:RLMCollectionAggregate::Sum
+                           methodName:@"@sum" returnNilForEmpty:NO];
 }
 
 - (NSNumber *)_avgForKeyPath:(NSString *)keyPath {
-    return [self _aggregateForKeyPath:keyPath method:&Results::average methodName:@"@avg" returnNilForEmpty:YES];
+    return [self _aggregateForKeyPath:keyPath method:&Results::average aggregate:RLMCollectionAggregate::Average
+                           methodName:@"@avg" returnNilForEmpty:YES];
 }
 
 - (NSArray *)_unionOfObjectsForKeyPath:(NSString *)keyPath {
-    assertKeyPathIsNotNested(keyPath);
+    assertKeyPathHasNoCollectionOperators(keyPath);
     return translateErrors([&] {
+        if (isNestedKeyPath(keyPath)) {
+            return RLMCollectionValueForKeyPath(self, keyPath);
+        }
         return RLMCollectionValueForKey(self, keyPath);
     });
 }
 
+// Key paths which core can deduplicate directly; anything else has to go
+// through NSSet
+static bool canDistinctOnKeyPath(RLMClassInfo *info, NSString *keyPath) {
+    if (!info) {
+        return false;
+    }
+
+    RLMObjectSchema *objectSchema = info->rlmObjectSchema;
+    RLMProperty *prop;
+    for (NSString *name in [keyPath componentsSeparatedByString:@"."]) {
+        if (prop) {
+            if (prop.type != RLMPropertyTypeObject) {
+                return false;
+            }
+            objectSchema = info->realm.schema[prop.objectClassName];
+        }
+        prop = objectSchema[name];
+        if (!prop) {
+            return false;
+        }
+    }
+
+    switch (prop.type) {
+        case RLMPropertyTypeBool:
+        case RLMPropertyTypeDate:
+        case RLMPropertyTypeDouble:
+        case RLMPropertyTypeFloat:
+        case RLMPropertyTypeInt:
+        case RLMPropertyTypeString:
+            return true;
+        default:
+            return false;
+    }
+}
+
 - (NSArray *)_distinctUnionOfObjectsForKeyPath:(NSString *)keyPath {
-    return [NSSet setWithArray:[self _unionOfObjectsForKeyPath:keyPath]].allObjects;
+    assertKeyPathHasNoCollectionOperators(keyPath);
+    if (!canDistinctOnKeyPath(_info, keyPath)) {
+        return [NSSet setWithArray:[self _unionOfObjectsForKeyPath:keyPath]].allObjects;
+    }
+    return [[self distinctResultsUsingKeyPaths:@[keyPath]] _unionOfObjectsForKeyPath:keyPath];
 }
 
 - (NSArray *)_unionOfArraysForKeyPath:(NSString *)keyPath {
-    assertKeyPathIsNotNested(keyPath);
+    assertKeyPathHasNoCollectionOperators(keyPath);
     if ([keyPath isEqualToString:@"self"]) {
         @throw RLMException(@"self is not a valid key-path for a KVC array collection operator as 'unionOfArrays'.");
     }
 
     return translateErrors([&] {
-        NSArray *nestedResults = RLMCollectionValueForKey(self, keyPath);
-        NSMutableArray *flatArray = [NSMutableArray arrayWithCapacity:nestedResults.count];
-        for (id<RLMFastEnumerable> array in nestedResults) {
-            NSArray *nsArray = RLMCollectionValueForKey(array, @"self");
-            [flatArray addObjectsFromArray:nsArray];
-        }
-        return flatArray;
+        return RLMCollectionObjectsForKeyPath(self, keyPath, false);
     });
 }
 
-- (NSArray *)_distinctUnionOfArraysForKeyPath:(__unused NSString *)keyPath {
-    return [NSSet setWithArray:[self _unionOfArraysForKeyPath:keyPath]].allObjects;
+- (NSArray *)_distinctUnionOfArraysForKeyPath:(NSString *)keyPath {
+    assertKeyPathHasNoCollectionOperators(keyPath);
+    if ([keyPath isEqualToString:@"self"]) {
+        @throw RLMException(@"self is not a valid key-path for a KVC array collection operator as 'distinctUnionOfArrays'.");
+    }
+
+    return translateErrors([&] {
+        return RLMCollectionObjectsForKeyPath(self, keyPath, true);
+    });
 }
 
 - (RLMResults *)objectsWhere:(NSString *)predicateFormat, ... {
@@ -334,8 +502,18 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
         if (_results.get_mode() == Results::Mode::Empty) {
             return self;
         }
-        auto query = RLMPredicateToQuery(predicate, _info->rlmObjectSchema, _realm.schema, _realm.group);
-        return [RLMResults resultsWithObjectInfo:*_info results:_results.filter(std::move(query))];
+        RLMStatisticsTimer timer;
+        bool canEvaluateConcurrently;
+        auto query = RLMPredicateToQuery(predicate, _info->rlmObjectSchema, _realm.schema, _realm.group,
+                                         &canEvaluateConcurrently);
+        uint64_t buildNanoseconds = timer.stop();
+        RLMResults *results = [RLMResults resultsWithObjectInfo:*_info results:_results.filter(std::move(query))];
+        results->_partitionable = _partitionable && canEvaluateConcurrently;
+        results->_queryBuildNanoseconds = _queryBuildNanoseconds + buildNanoseconds;
+        results->_filterPredicate = _filterPredicate
+                                  ? [NSCompoundPredicate andPredicateWithSubpredicates:@[_filterPredicate, predicate]]
+                                  : predicate;
+        return results;
     });
 }
 
@@ -356,7 +534,42 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
             return self;
         }
 
-        return [RLMResults resultsWithObjectInfo:*_info results:_results.sort(RLMSortDescriptorFromDescriptors(*_info, properties))];
+        // Sorting results which cover the whole table on a property with an
+        // ordered index reads the objects in the index's order rather than
+        // sorting them. The index is a link list, so the sorted results are
+        // not partitionable.
+        if (_partitionable) {
+            if (auto sorted = RLMSortedResultsFromOrderedIndex(*_info, _results, properties)) {
+                RLMResults *results = [RLMResults resultsWithObjectInfo:*_info results:std::move(*sorted)];
+                results->_filterPredicate = _filterPredicate;
+                results->_queryBuildNanoseconds = _queryBuildNanoseconds;
+                return results;
+            }
+        }
+
+        RLMResults *results = [RLMResults resultsWithObjectInfo:*_info
+                                                        results:_results.sort(RLMSortDescriptorFromDescriptors(*_info, properties))];
+        results->_partitionable = _partitionable;
+        results->_filterPredicate = _filterPredicate;
+        results->_queryBuildNanoseconds = _queryBuildNanoseconds;
+        return results;
+    });
+}
+
+- (RLMResults *)distinctResultsUsingKeyPaths:(NSArray<NSString *> *)keyPaths {
+    if (keyPaths.count == 0) {
+        return self;
+    }
+    return translateErrors([&] {
+        if (_results.get_mode() == Results::Mode::Empty) {
+            return self;
+        }
+
+        RLMResults *results = [RLMResults resultsWithObjectInfo:*_info
+                                                        results:_results.distinct(RLMDistinctDescriptorFromKeyPaths(*_info, keyPaths))];
+        results->_filterPredicate = _filterPredicate;
+        results->_queryBuildNanoseconds = _queryBuildNanoseconds;
+        return results;
     });
 }
 
@@ -365,12 +578,22 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
 }
 
 - (id)aggregate:(NSString *)property method:(util::Optional<Mixed> (Results::*)(size_t))method
+      aggregate:(RLMCollectionAggregate)aggregate
      methodName:(NSString *)methodName returnNilForEmpty:(BOOL)returnNilForEmpty {
     if (_results.get_mode() == Results::Mode::Empty) {
         return returnNilForEmpty ? nil : @0;
     }
     size_t column = _info->tableColumn(property);
-    auto value = translateErrors([&] { return (_results.*method)(column); }, methodName);
+    auto value = measureQuery(self, [&] {
+        return translateErrors([&] {
+            if (size_t concurrency = parallelQueryConcurrency(self)) {
+                if (RLMCanAggregateInParallel(*_info->table(), column, aggregate)) {
+                    return RLMParallelAggregate(*_realm->_realm, _results.get_query(), column, aggregate, concurrency);
+                }
+            }
+            return (_results.*method)(column);
+        }, methodName);
+    });
     if (!value) {
         return nil;
     }
@@ -378,19 +601,23 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
 }
 
 - (id)minOfProperty:(NSString *)property {
-    return [self aggregate:property method:&Results::min methodName:@"minOfProperty" returnNilForEmpty:YES];
+    return [self aggregate:property method:&Results::min aggregate:RLMCollectionAggregate::Min
+                methodName:@"minOfProperty" returnNilForEmpty:YES];
 }
 
 - (id)maxOfProperty:(NSString *)property {
-    return [self aggregate:property method:&Results::max methodName:@"maxOfProperty" returnNilForEmpty:YES];
+    return [self aggregate:property method:&Results::max aggregate:RLMCollectionAggregate::Max
+                methodName:@"maxOfProperty" returnNilForEmpty:YES];
 }
 
 - (id)sumOfProperty:(NSString *)property {
-    return [self aggregate:property method:&Results::sum methodName:@"sumOfProperty" returnNilForEmpty:NO];
+    return [self aggregate:property method:&Results::sum aggregate:RLMCollectionAggregate::Sum
+                methodName:@"sumOfProperty" returnNilForEmpty:NO];
 }
 
 - (id)averageOfProperty:(NSString *)property {
-    return [self aggregate:property method:&Results::average methodName:@"averageOfProperty" returnNilForEmpty:YES];
+    return [self aggregate:property method:&Results::average aggregate:RLMCollectionAggregate::Average
+                methodName:@"averageOfProperty" returnNilForEmpty:YES];
 }
 
 - (void)deleteObjectsFromRealm {
@@ -414,7 +641,7 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
 }
 
 - (realm::TableView)tableView {
-    return translateErrors([&] { return _results.get_tableview(); });
+    return measureQuery(self, [&] { return _results.get_tableview(); });
 }
 
 // The compiler complains about the method's argument type not matching due to
@@ -427,6 +654,11 @@ static inline void RLMResultsValidateInWriteTransaction(__unsafe_unretained RLMR
     [_realm verifyNotificationsAreSupported];
     return RLMAddNotificationBlock(self, _results, block, true);
 }
+
+- (RLMNotificationToken *)addNotificationBlock:(void (^)(RLMResults *, RLMCollectionChange *, NSError *))block
+                                         queue:(dispatch_queue_t)queue {
+    return RLMAddNotificationBlockOnQueue(self, block, queue);
+}
 #pragma clang diagnostic pop
 
 - (BOOL)isAttached
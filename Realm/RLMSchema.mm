@@ -327,15 +327,19 @@ static void RLMRegisterClassLocalNames(Class *classes, NSUInteger count) {
 }
 
 - (Schema)objectStoreCopy {
-    if (_objectStoreSchema.size() == 0) {
-        std::vector<realm::ObjectSchema> schema;
-        schema.reserve(_objectSchemaByName.count);
-        [_objectSchemaByName enumerateKeysAndObjectsUsingBlock:[&](NSString *, RLMObjectSchema *objectSchema, BOOL *) {
-            schema.push_back(objectSchema.objectStoreCopy);
-        }];
-        _objectStoreSchema = std::move(schema);
+    // The shared schema may be used to open Realms at different paths on
+    // multiple threads at once
+    @synchronized(self) {
+        if (_objectStoreSchema.size() == 0) {
+            std::vector<realm::ObjectSchema> schema;
+            schema.reserve(_objectSchemaByName.count);
+            [_objectSchemaByName enumerateKeysAndObjectsUsingBlock:[&](NSString *, RLMObjectSchema *objectSchema, BOOL *) {
+                schema.push_back(objectSchema.objectStoreCopy);
+            }];
+            _objectStoreSchema = std::move(schema);
+        }
+        return _objectStoreSchema;
     }
-    return _objectStoreSchema;
 }
 
 @end
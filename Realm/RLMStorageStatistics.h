@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The space used in a Realm file by the values of a single property.
+ */
+@interface RLMPropertyStorageStatistics : NSObject
+
+/// The name of the property.
+@property (nonatomic, readonly) NSString *name;
+
+/// The number of bytes used to store the property's values.
+@property (nonatomic, readonly) NSUInteger valueBytes;
+
+/// The number of bytes used by the property's search index, or 0 if it is not indexed.
+@property (nonatomic, readonly) NSUInteger indexBytes;
+
+/**
+ The number of bytes used by the table of distinct values for a string property
+ which Realm has optimized by storing each distinct string only once, or 0 if
+ the property is not stored that way.
+ */
+@property (nonatomic, readonly) NSUInteger enumerationBytes;
+
+/// The total number of bytes used by the property.
+@property (nonatomic, readonly) NSUInteger totalBytes;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("RLMPropertyStorageStatistics cannot be created directly")));
+
+@end
+
+/**
+ The space used in a Realm file by the objects of a single class.
+ */
+@interface RLMObjectStorageStatistics : NSObject
+
+/// The name of the class.
+@property (nonatomic, readonly) NSString *className;
+
+/// The number of objects of the class.
+@property (nonatomic, readonly) NSUInteger objectCount;
+
+/// The space used by each persisted property of the class, in schema order.
+@property (nonatomic, readonly) NSArray<RLMPropertyStorageStatistics *> *properties;
+
+/// The total number of bytes used by all of the class's properties.
+@property (nonatomic, readonly) NSUInteger totalBytes;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("RLMObjectStorageStatistics cannot be created directly")));
+
+@end
+
+/**
+ A breakdown of the space used in a Realm file, obtained with
+ `-[RLMRealm storageStatistics]`.
+
+ The statistics describe the version of the data which the Realm is currently
+ reading.
+ */
+@interface RLMStorageStatistics : NSObject
+
+/// The size of the Realm file, in bytes.
+@property (nonatomic, readonly) NSUInteger fileSize;
+
+/**
+ The number of bytes in the Realm file which are not used by the current
+ version of the data.
+
+ This includes both space which can be reused by the next write transaction,
+ and space which is still used by older versions of the data because they
+ are being read by a Realm on another thread or in another process.
+ */
+@property (nonatomic, readonly) NSUInteger freeBytes;
+
+/// The number of the version of the data which the Realm is currently reading.
+@property (nonatomic, readonly) uint64_t currentVersion;
+
+/**
+ The number of versions of the data kept in the file, from the oldest version
+ which was being read by a Realm on any thread or in any process when the
+ latest version was committed, through the latest version.
+
+ The space used only by versions older than the oldest retained version is
+ reused by later commits. A large count means that a Realm which is not being
+ refreshed is keeping old data in the file.
+ */
+@property (nonatomic, readonly) uint64_t retainedVersionCount;
+
+/**
+ The number of the oldest version of the data kept in the file, which is the
+ oldest version that was being read by any Realm when the latest version was
+ committed.
+ */
+@property (nonatomic, readonly) uint64_t oldestRetainedVersion;
+
+/// The space used by each object class in the Realm's schema.
+@property (nonatomic, readonly) NSArray<RLMObjectStorageStatistics *> *objectClasses;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("RLMStorageStatistics cannot be created directly")));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMStorageStatistics_Private.hpp"
+
+#import "RLMObjectSchema_Private.h"
+#import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema.h"
+
+#import "shared_realm.hpp"
+
+#import <realm/array.hpp>
+#import <realm/column_string_enum.hpp>
+#import <realm/group_shared.hpp>
+#import <realm/index_string.hpp>
+#import <realm/table.hpp>
+
+#import <algorithm>
+
+using namespace realm;
+
+namespace {
+bool isRef(int64_t value) {
+    return value != 0 && (value & 1) == 0;
+}
+
+// The total size of the array at `ref` and every array it refers to,
+// which for a column covers the entire B+tree and any subtables or link lists
+size_t subtreeBytes(Allocator& alloc, ref_type ref) {
+    if (!ref) {
+        return 0;
+    }
+    const char *header = alloc.translate(ref);
+    size_t bytes = Array::get_byte_size_from_header(header);
+    if (Array::get_hasrefs_from_header(header)) {
+        size_t size = Array::get_size_from_header(header);
+        for (size_t i = 0; i < size; ++i) {
+            int64_t value = Array::get(header, i);
+            if (isRef(value)) {
+                bytes += subtreeBytes(alloc, ref_type(value));
+            }
+        }
+    }
+    return bytes;
+}
+} // anonymous namespace
+
+@interface RLMPropertyStorageStatistics ()
+- (instancetype)initWithName:(NSString *)name
+                  valueBytes:(size_t)valueBytes
+                  indexBytes:(size_t)indexBytes
+            enumerationBytes:(size_t)enumerationBytes;
+@end
+
+@implementation RLMPropertyStorageStatistics
+- (instancetype)initWithName:(NSString *)name
+                  valueBytes:(size_t)valueBytes
+                  indexBytes:(size_t)indexBytes
+            enumerationBytes:(size_t)enumerationBytes {
+    if (self = [super init]) {
+        _name = name;
+        _valueBytes = valueBytes;
+        _indexBytes = indexBytes;
+        _enumerationBytes = enumerationBytes;
+    }
+    return self;
+}
+
+- (NSUInteger)totalBytes {
+    return _valueBytes + _indexBytes + _enumerationBytes;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@: %zu bytes (values: %zu, index: %zu, enumeration: %zu)",
+            _name, (size_t)self.totalBytes, (size_t)_valueBytes, (size_t)_indexBytes, (size_t)_enumerationBytes];
+}
+@end
+
+@interface RLMObjectStorageStatistics ()
+- (instancetype)initWithClassName:(NSString *)className
+                      objectCount:(size_t)objectCount
+                       properties:(NSArray<RLMPropertyStorageStatistics *> *)properties;
+@end
+
+@implementation RLMObjectStorageStatistics
+- (instancetype)initWithClassName:(NSString *)className
+                      objectCount:(size_t)objectCount
+                       properties:(NSArray<RLMPropertyStorageStatistics *> *)properties {
+    if (self = [super init]) {
+        _className = className;
+        _objectCount = objectCount;
+        _properties = properties;
+    }
+    return self;
+}
+
+- (NSUInteger)totalBytes {
+    return [[_properties valueForKeyPath:@"@sum.totalBytes"] unsignedIntegerValue];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@: %zu objects, %zu bytes {\n\t%@\n}",
+            _className, (size_t)_objectCount, (size_t)self.totalBytes,
+            [[_properties valueForKey:@"description"] componentsJoinedByString:@"\n\t"]];
+}
+@end
+
+@interface RLMStorageStatistics ()
+- (instancetype)initPrivate;
+@end
+
+@implementation RLMStorageStatistics
+- (instancetype)initPrivate {
+    return [super init];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"RLMStorageStatistics {\n"
+            @"\tfileSize = %zu;\n"
+            @"\tfreeBytes = %zu;\n"
+            @"\tcurrentVersion = %llu;\n"
+            @"\tretainedVersionCount = %llu;\n"
+            @"\toldestRetainedVersion = %llu;\n"
+            @"\tobjectClasses = %@;\n"
+            @"}",
+            (size_t)_fileSize, (size_t)_freeBytes, _currentVersion, _retainedVersionCount,
+            _oldestRetainedVersion, _objectClasses];
+}
+
+RLMStorageStatistics *RLMGetStorageStatistics(RLMRealm *realm) {
+    // Ensure that there is a read transaction to report on
+    [realm group];
+    RLMStorageStatistics *statistics = [[RLMStorageStatistics alloc] initPrivate];
+
+    SharedGroup& sharedGroup = _impl::RealmFriend::get_shared_group(*realm->_realm);
+    size_t freeBytes = 0, usedBytes = 0;
+    sharedGroup.get_stats(freeBytes, usedBytes);
+    statistics->_fileSize = freeBytes + usedBytes;
+    statistics->_freeBytes = freeBytes;
+    statistics->_currentVersion = sharedGroup.get_version_of_current_transaction().version;
+    // Core records the number of versions in the file when committing, as the
+    // span from the oldest version being read to the version committed
+    uint64_t latestVersion = sharedGroup.get_version_of_latest_snapshot();
+    uint64_t versionCount = std::max<uint64_t>(sharedGroup.get_number_of_versions(), 1);
+    statistics->_retainedVersionCount = versionCount;
+    statistics->_oldestRetainedVersion = latestVersion + 1 - std::min(versionCount, latestVersion);
+
+    NSMutableArray *objectClasses = [NSMutableArray new];
+    for (RLMObjectSchema *objectSchema in realm.schema.objectSchema) {
+        RLMClassInfo& info = realm->_info[objectSchema.className];
+        Table *table = info.table();
+        NSMutableArray *properties = [NSMutableArray new];
+        for (RLMProperty *property in objectSchema.properties) {
+            size_t valueBytes = 0, indexBytes = 0, enumerationBytes = 0;
+            if (table) {
+                Allocator& alloc = table->get_alloc();
+                ColumnBase& column = table->get_column_base(info.tableColumn(property));
+                valueBytes = subtreeBytes(alloc, column.get_ref());
+                if (StringIndex *index = column.get_search_index()) {
+                    indexBytes = subtreeBytes(alloc, index->get_ref());
+                }
+                if (auto enumColumn = dynamic_cast<StringEnumColumn *>(&column)) {
+                    enumerationBytes = subtreeBytes(alloc, enumColumn->get_keys().get_ref());
+                }
+            }
+            [properties addObject:[[RLMPropertyStorageStatistics alloc] initWithName:property.name
+                                                                          valueBytes:valueBytes
+                                                                          indexBytes:indexBytes
+                                                                    enumerationBytes:enumerationBytes]];
+        }
+        [objectClasses addObject:[[RLMObjectStorageStatistics alloc] initWithClassName:objectSchema.className
+                                                                            objectCount:table ? table->size() : 0
+                                                                             properties:properties]];
+    }
+    statistics->_objectClasses = objectClasses;
+    return statistics;
+}
+@end
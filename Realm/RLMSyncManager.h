@@ -56,6 +56,70 @@ NS_ASSUME_NONNULL_BEGIN
 /// pertains to a specific session, that session will also be passed into the block.
 typedef void(^RLMSyncErrorReportingBlock)(NSError *, RLMSyncSession * _Nullable);
 
+/**
+ A destination for sync log messages.
+
+ Log messages are written to the sinks on a background thread rather than on the
+ thread performing the sync work, so implementations do not need to be fast, but
+ must not assume they are called on any particular thread.
+ */
+@protocol RLMSyncLogSink <NSObject>
+
+/// Record a single log message which was logged at the given level.
+- (void)logMessage:(NSString *)message level:(RLMSyncLogLevel)level;
+
+@end
+
+/// A log sink which passes each log message to a block.
+@interface RLMSyncBlockLogSink : NSObject <RLMSyncLogSink>
+
+/// Create a log sink which calls the given block with each log message.
+- (instancetype)initWithBlock:(void (^)(RLMSyncLogLevel level, NSString *message))block;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("Use -initWithBlock:")));
+
+@end
+
+/// A log sink which appends each log message, prefixed by a timestamp and its level, to a file.
+@interface RLMSyncFileLogSink : NSObject <RLMSyncLogSink>
+
+/**
+ Create a log sink which appends log messages to the file at the given URL,
+ creating the file if it does not already exist.
+
+ @param fileURL The local URL of the file to append to.
+ @param error   If the file could not be opened, upon return contains an `NSError`
+                object that describes the problem. If you are not interested in
+                possible errors, pass in `NULL`.
+ */
+- (nullable instancetype)initWithURL:(NSURL *)fileURL error:(NSError **)error;
+
+/// The URL of the file which log messages are appended to.
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("Use -initWithURL:error:")));
+
+@end
+
+/// A log sink which keeps the most recent log messages in memory.
+@interface RLMSyncMemoryLogSink : NSObject <RLMSyncLogSink>
+
+/// Create a log sink which retains at most `capacity` of the most recent log messages.
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/// The retained log messages, oldest first.
+@property (nonatomic, readonly) NSArray<NSString *> *messages;
+
+/// Discard all retained log messages.
+- (void)removeAllMessages;
+
+/// :nodoc:
+- (instancetype)init __attribute__((unavailable("Use -initWithCapacity:")));
+
+@end
+
 /**
  A singleton manager which serves as a central point for sync-related configuration.
  */
@@ -97,13 +161,32 @@ typedef void(^RLMSyncErrorReportingBlock)(NSError *, RLMSyncSession * _Nullable)
  The logging threshold which newly opened synced Realms will use. Defaults to
  `RLMSyncLogLevelInfo`.
 
- Logging strings are output to Apple System Logger.
+ Logging strings are output to `logSinks`, or to Apple System Logger if there are no log sinks.
+ Messages below the threshold are discarded before they are formatted.
 
  @warning This property must be set before any synced Realms are opened. Setting it after
           opening any synced Realm will do nothing.
  */
 @property (nonatomic) RLMSyncLogLevel logLevel;
 
+/**
+ The destinations which sync log messages are written to. Defaults to an empty
+ array, in which case log messages are output to Apple System Logger.
+
+ Log messages are queued in a fixed-size buffer by the thread which logs them,
+ and are written to the sinks asynchronously on a background thread. If
+ messages are logged faster than the sinks can consume them, the excess
+ messages are discarded and a message reporting how many were discarded is
+ written in their place.
+ */
+@property (nonatomic, copy) NSArray<id<RLMSyncLogSink>> *logSinks;
+
+/**
+ Block until all sync log messages which have been queued so far have been
+ written to the log sinks.
+ */
+- (void)flushLogs;
+
 /// The sole instance of the singleton.
 + (instancetype)sharedManager NS_REFINED_FOR_SWIFT;
 
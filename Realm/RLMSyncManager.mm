@@ -29,6 +29,9 @@
 #import "sync/sync_manager.hpp"
 #import "sync/sync_session.hpp"
 
+#import <atomic>
+#import <mutex>
+
 using namespace realm;
 using Level = realm::util::Logger::Level;
 
@@ -64,9 +67,157 @@ RLMSyncLogLevel logLevelForLevel(Level logLevel) {
     REALM_UNREACHABLE();    // Unrecognized log level.
 }
 
+// A fixed-size queue of log messages which any number of threads can log into
+// without taking a lock, and which is drained by a single background queue.
+// Messages have already been formatted by the logger, but converting them to
+// NSStrings and writing them out is deferred to the background queue.
+class SyncLogQueue {
+public:
+    SyncLogQueue()
+    : m_cells(new Cell[s_capacity])
+    , m_queue(dispatch_queue_create("io.realm.sync.log", DISPATCH_QUEUE_SERIAL))
+    {
+        for (size_t i = 0; i < s_capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void push(Level level, std::string message) {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &m_cells[pos & s_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                // The queue is full, so drop the message rather than blocking
+                // the thread doing the sync work
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                schedule_drain();
+                return;
+            }
+            else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->level = level;
+        cell->message = std::move(message);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        schedule_drain();
+    }
+
+    NSArray<id<RLMSyncLogSink>> *sinks() {
+        std::lock_guard<std::mutex> lock(m_sinks_mutex);
+        return m_sinks;
+    }
+
+    void set_sinks(NSArray<id<RLMSyncLogSink>> *sinks) {
+        std::lock_guard<std::mutex> lock(m_sinks_mutex);
+        m_sinks = sinks;
+    }
+
+    void flush() {
+        dispatch_sync_f(m_queue, this, &perform_drain);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Level level;
+        std::string message;
+    };
+
+    static const size_t s_capacity = 4096;
+    static const size_t s_mask = s_capacity - 1;
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::atomic<size_t> m_enqueue_pos{0};
+    size_t m_dequeue_pos = 0; // only accessed on m_queue
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<bool> m_drain_scheduled{false};
+    dispatch_queue_t m_queue;
+
+    std::mutex m_sinks_mutex;
+    NSArray<id<RLMSyncLogSink>> *m_sinks = @[];
+
+    void schedule_drain() {
+        // Uses the function variant of dispatch_async so that logging a
+        // message does not need to allocate a block
+        if (!m_drain_scheduled.exchange(true)) {
+            dispatch_async_f(m_queue, this, &perform_drain);
+        }
+    }
+
+    static void perform_drain(void *context) {
+        @autoreleasepool {
+            static_cast<SyncLogQueue *>(context)->drain();
+        }
+    }
+
+    void drain() {
+        // Clear the flag before draining so that a message pushed after we
+        // stop looking schedules another drain
+        m_drain_scheduled.store(false);
+        NSArray<id<RLMSyncLogSink>> *sinks = this->sinks();
+        while (true) {
+            Cell& cell = m_cells[m_dequeue_pos & s_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != m_dequeue_pos + 1) {
+                break;
+            }
+            Level level = cell.level;
+            NSString *message = RLMStringDataToNSString(cell.message);
+            cell.message.clear();
+            cell.sequence.store(m_dequeue_pos + s_capacity, std::memory_order_release);
+            ++m_dequeue_pos;
+            write(sinks, logLevelForLevel(level), message);
+        }
+        if (size_t dropped = m_dropped.exchange(0)) {
+            write(sinks, RLMSyncLogLevelWarn,
+                  [NSString stringWithFormat:@"%zu log messages were discarded because the log queue was full.", dropped]);
+        }
+    }
+
+    static void write(NSArray<id<RLMSyncLogSink>> *sinks, RLMSyncLogLevel level, NSString *message) {
+        if (sinks.count == 0) {
+            NSLog(@"Sync: %@", message);
+            return;
+        }
+        for (id<RLMSyncLogSink> sink in sinks) {
+            [sink logMessage:message level:level];
+        }
+    }
+};
+
+SyncLogQueue& syncLogQueue() {
+    static auto queue = new SyncLogQueue;
+    return *queue;
+}
+
+NSString *nameForLogLevel(RLMSyncLogLevel level) {
+    switch (level) {
+        case RLMSyncLogLevelOff:    return @"off";
+        case RLMSyncLogLevelFatal:  return @"fatal";
+        case RLMSyncLogLevelError:  return @"error";
+        case RLMSyncLogLevelWarn:   return @"warn";
+        case RLMSyncLogLevelInfo:   return @"info";
+        case RLMSyncLogLevelDetail: return @"detail";
+        case RLMSyncLogLevelDebug:  return @"debug";
+        case RLMSyncLogLevelTrace:  return @"trace";
+        case RLMSyncLogLevelAll:    return @"all";
+    }
+    REALM_UNREACHABLE();    // Unrecognized log level.
+}
+
+// The base Logger checks the level threshold before formatting a message, so
+// do_log() is only called for messages which will actually be written
 struct CocoaSyncLogger : public realm::util::RootLogger {
-    void do_log(Level, std::string message) override {
-        NSLog(@"Sync: %@", RLMStringDataToNSString(message));
+    void do_log(Level level, std::string message) override {
+        syncLogQueue().push(level, std::move(message));
     }
 };
 
@@ -80,6 +231,99 @@ struct CocoaSyncLoggerFactory : public realm::SyncLoggerFactory {
 
 } // anonymous namespace
 
+@implementation RLMSyncBlockLogSink {
+    void (^_block)(RLMSyncLogLevel, NSString *);
+}
+
+- (instancetype)initWithBlock:(void (^)(RLMSyncLogLevel, NSString *))block {
+    if (self = [super init]) {
+        _block = block;
+    }
+    return self;
+}
+
+- (void)logMessage:(NSString *)message level:(RLMSyncLogLevel)level {
+    _block(level, message);
+}
+
+@end
+
+@implementation RLMSyncFileLogSink {
+    NSFileHandle *_fileHandle;
+    NSDateFormatter *_dateFormatter;
+}
+
+- (instancetype)initWithURL:(NSURL *)fileURL error:(NSError **)error {
+    if (self = [super init]) {
+        NSString *path = fileURL.path;
+        if (![NSFileManager.defaultManager fileExistsAtPath:path]
+            && ![NSData.data writeToURL:fileURL options:0 error:error]) {
+            return nil;
+        }
+        _fileHandle = [NSFileHandle fileHandleForWritingToURL:fileURL error:error];
+        if (!_fileHandle) {
+            return nil;
+        }
+        [_fileHandle seekToEndOfFile];
+        _fileURL = fileURL;
+        _dateFormatter = [NSDateFormatter new];
+        _dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _dateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+    }
+    return self;
+}
+
+- (void)logMessage:(NSString *)message level:(RLMSyncLogLevel)level {
+    NSString *line = [NSString stringWithFormat:@"%@ %@: %@\n",
+                      [_dateFormatter stringFromDate:[NSDate date]], nameForLogLevel(level), message];
+    [_fileHandle writeData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (void)dealloc {
+    [_fileHandle closeFile];
+}
+
+@end
+
+@implementation RLMSyncMemoryLogSink {
+    NSUInteger _capacity;
+    NSMutableArray<NSString *> *_messages;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    if (self = [super init]) {
+        _capacity = capacity;
+        _messages = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (void)logMessage:(NSString *)message level:(__unused RLMSyncLogLevel)level {
+    @synchronized (self) {
+        if (_capacity == 0) {
+            return;
+        }
+        if (_messages.count == _capacity) {
+            [_messages removeObjectAtIndex:0];
+        }
+        [_messages addObject:message];
+    }
+}
+
+- (NSArray<NSString *> *)messages {
+    @synchronized (self) {
+        return [_messages copy];
+    }
+}
+
+- (void)removeAllMessages {
+    @synchronized (self) {
+        [_messages removeAllObjects];
+    }
+}
+
+@end
+
 @interface RLMSyncManager ()
 - (instancetype)initWithCustomRootDirectory:(nullable NSURL *)rootDirectory NS_DESIGNATED_INITIALIZER;
 
@@ -152,6 +396,18 @@ static dispatch_once_t s_onceToken;
     realm::SyncManager::shared().set_log_level(levelForSyncLogLevel(logLevel));
 }
 
+- (NSArray<id<RLMSyncLogSink>> *)logSinks {
+    return syncLogQueue().sinks();
+}
+
+- (void)setLogSinks:(NSArray<id<RLMSyncLogSink>> *)logSinks {
+    syncLogQueue().set_sinks([logSinks copy] ?: @[]);
+}
+
+- (void)flushLogs {
+    syncLogQueue().flush();
+}
+
 #pragma mark - Private API
 
 - (void)_fireError:(NSError *)error {
@@ -154,6 +154,33 @@ NS_ASSUME_NONNULL_BEGIN
                                                                          block:(RLMProgressNotificationBlock)block
 NS_REFINED_FOR_SWIFT;
 
+/**
+ Register a progress notification block which is called at most once per
+ `minimumInterval` and only after at least `minimumByteDelta` more bytes have
+ been transferred.
+
+ Progress updates which arrive while a notification is pending are coalesced,
+ and the block is always passed the most recent progress information. The first
+ update, and an update reporting that all transferrable bytes have been
+ transferred, are delivered regardless of `minimumByteDelta`, although they are
+ still subject to `minimumInterval`.
+
+ This is otherwise identical to `addProgressNotificationForDirection:mode:block:`.
+
+ @param direction        The transfer direction (upload or download) to track in this progress notification block.
+ @param mode             The desired behavior of this progress notification block.
+ @param minimumInterval  The minimum time between calls to the block, in seconds.
+ @param minimumByteDelta The minimum change in transferred bytes between calls to the block.
+ @param block            The block to invoke when notifications are available.
+
+ @return A token which must be held for as long as you want notifications to be delivered.
+ */
+- (nullable RLMProgressNotificationToken *)addProgressNotificationForDirection:(RLMSyncProgressDirection)direction
+                                                                          mode:(RLMSyncProgress)mode
+                                                               minimumInterval:(NSTimeInterval)minimumInterval
+                                                              minimumByteDelta:(NSUInteger)minimumByteDelta
+                                                                         block:(RLMProgressNotificationBlock)block;
+
 @end
 
 NS_ASSUME_NONNULL_END
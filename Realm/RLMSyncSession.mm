@@ -21,13 +21,100 @@
 #import "RLMSyncConfiguration_Private.hpp"
 #import "RLMSyncUser_Private.hpp"
 #import "RLMSyncUtil_Private.hpp"
+#import "RLMUtil.hpp"
 #import "sync/sync_session.hpp"
 
+#import <atomic>
+#import <chrono>
+#import <mutex>
+
 using namespace realm;
 
+namespace {
+uint64_t nanosecondsSinceEpoch() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The state shared between the sync worker thread, which records the most
+// recent progress, and the notifications queue, which delivers it. Recording
+// progress does not allocate, and only schedules a delivery if one is not
+// already pending and the thresholds have been met.
+struct CoalescedProgress {
+    CoalescedProgress(uint64_t minimumInterval, uint64_t minimumByteDelta)
+    : minimumInterval(minimumInterval), minimumByteDelta(minimumByteDelta) { }
+
+    const uint64_t minimumInterval;
+    const uint64_t minimumByteDelta;
+
+    // The two byte counts are only meaningful together, so they are read and
+    // written as a pair under the lock rather than as separate atomics
+    std::mutex mutex;
+    uint64_t transferred = 0;
+    uint64_t transferrable = 0;
+
+    // Set by the token when it is stopped. Checked on the notifications queue
+    // so that deliveries which were already scheduled are dropped.
+    std::atomic<bool> stopped{false};
+    std::atomic<bool> pending{false};
+    std::atomic<bool> hasDelivered{false};
+    std::atomic<uint64_t> lastDeliveredTransferred{0};
+    std::atomic<uint64_t> lastDeliveryTime{0};
+
+    // Returns the delay in nanoseconds before a delivery should be performed,
+    // or -1 if no delivery should be scheduled
+    int64_t record(uint64_t newTransferred, uint64_t newTransferrable) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            transferred = newTransferred;
+            transferrable = newTransferrable;
+        }
+
+        bool complete = newTransferred >= newTransferrable;
+        if (hasDelivered.load() && !complete) {
+            uint64_t last = lastDeliveredTransferred.load();
+            uint64_t delta = newTransferred > last ? newTransferred - last : last - newTransferred;
+            if (delta < minimumByteDelta) {
+                return -1;
+            }
+        }
+        if (pending.exchange(true)) {
+            // The pending delivery will pick up the values we just stored
+            return -1;
+        }
+
+        if (!hasDelivered.load()) {
+            return 0;
+        }
+        uint64_t nextAllowed = lastDeliveryTime.load() + minimumInterval;
+        uint64_t now = nanosecondsSinceEpoch();
+        return nextAllowed > now ? int64_t(nextAllowed - now) : 0;
+    }
+
+    void deliver(RLMProgressNotificationBlock block) {
+        // Clear the flag before reading so that any update which arrives after
+        // the read schedules another delivery
+        pending.store(false);
+        if (stopped.load()) {
+            return;
+        }
+        uint64_t currentTransferred, currentTransferrable;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentTransferred = transferred;
+            currentTransferrable = transferrable;
+        }
+        lastDeliveredTransferred.store(currentTransferred);
+        lastDeliveryTime.store(nanosecondsSinceEpoch());
+        hasDelivered.store(true);
+        block((NSUInteger)currentTransferred, (NSUInteger)currentTransferrable);
+    }
+};
+} // anonymous namespace
+
 @interface RLMProgressNotificationToken() {
     uint64_t _token;
     std::weak_ptr<SyncSession> _session;
+    std::shared_ptr<CoalescedProgress> _progress;
 }
 @end
 
@@ -39,6 +126,9 @@ using namespace realm;
 }
 
 - (void)stop {
+    if (_progress) {
+        _progress->stopped.store(true);
+    }
     if (auto session = _session.lock()) {
         session->unregister_progress_notifier(_token);
         _session.reset();
@@ -68,6 +158,15 @@ using namespace realm;
     return nil;
 }
 
+- (nullable instancetype)initWithTokenValue:(uint64_t)token
+                                    session:(std::shared_ptr<SyncSession>)session
+                                   progress:(std::shared_ptr<CoalescedProgress>)progress {
+    if ((self = [self initWithTokenValue:token session:std::move(session)])) {
+        _progress = std::move(progress);
+    }
+    return self;
+}
+
 @end
 
 @interface RLMSyncSession ()
@@ -188,4 +287,48 @@ using namespace realm;
     return nil;
 }
 
+- (RLMProgressNotificationToken *)addProgressNotificationForDirection:(RLMSyncProgressDirection)direction
+                                                                 mode:(RLMSyncProgress)mode
+                                                      minimumInterval:(NSTimeInterval)minimumInterval
+                                                     minimumByteDelta:(NSUInteger)minimumByteDelta
+                                                                block:(RLMProgressNotificationBlock)block {
+    if (minimumInterval < 0) {
+        @throw RLMException(@"Minimum interval must not be negative, but was %f.", minimumInterval);
+    }
+    if (minimumInterval == 0 && minimumByteDelta == 0) {
+        return [self addProgressNotificationForDirection:direction mode:mode block:block];
+    }
+
+    if (auto session = _session.lock()) {
+        if (session->state() == SyncSession::PublicState::Error) {
+            return nil;
+        }
+        dispatch_queue_t queue = RLMSyncSession.notificationsQueue;
+        auto notifier_direction = (direction == RLMSyncProgressDirectionUpload
+                                   ? SyncSession::NotifierType::upload
+                                   : SyncSession::NotifierType::download);
+        bool is_streaming = (mode == RLMSyncProgressReportIndefinitely);
+
+        auto progress = std::make_shared<CoalescedProgress>((uint64_t)(minimumInterval * NSEC_PER_SEC),
+                                                            minimumByteDelta);
+        // Created once up front so that scheduling a delivery does not need to
+        // allocate a new block
+        dispatch_block_t deliver = ^{
+            progress->deliver(block);
+        };
+        uint64_t token = session->register_progress_notifier([=](uint64_t transferred, uint64_t transferrable) {
+            int64_t delay = progress->record(transferred, transferrable);
+            if (delay == 0) {
+                dispatch_async(queue, deliver);
+            }
+            else if (delay > 0) {
+                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), queue, deliver);
+            }
+        }, notifier_direction, is_streaming);
+        return [[RLMProgressNotificationToken alloc] initWithTokenValue:token session:std::move(session)
+                                                               progress:std::move(progress)];
+    }
+    return nil;
+}
+
 @end
@@ -29,7 +29,45 @@ class SyncUser;
 
 @class RLMSyncUser;
 
-@interface RLMSyncSessionRefreshHandle ()
+NS_ASSUME_NONNULL_BEGIN
+
+/// An object whose access token can be refreshed by an `RLMSyncSessionRefreshScheduler`.
+@protocol RLMSyncSessionRefreshable <NSObject>
+/// Begin refreshing the access token, calling `completion` on any thread once finished.
+- (void)refreshWithCompletion:(dispatch_block_t)completion;
+@end
+
+/**
+ Schedules access token refreshes for all of a single user's sessions on a background queue.
+
+ Refreshes which become due within `coalescingInterval` of each other are performed from a
+ single timer wakeup rather than each having their own timer, and at most
+ `maximumConcurrentRefreshes` requests are in flight at once so that many tokens expiring
+ together do not produce a burst of simultaneous requests.
+
+ Each session's refresh is still its own request, as the authentication server's refresh endpoint
+ only accepts a single path per request. Combining them into one round-trip needs a batch
+ endpoint on the server.
+ */
+@interface RLMSyncSessionRefreshScheduler : NSObject
+
+- (instancetype)initWithMaximumConcurrentRefreshes:(NSUInteger)maximumConcurrentRefreshes
+                                coalescingInterval:(NSTimeInterval)coalescingInterval;
+
+/// Schedule a refresh for the given object at `date`, replacing any previously scheduled refresh.
+/// Objects are held weakly, and pending refreshes for deallocated objects are dropped.
+- (void)scheduleRefresh:(id<RLMSyncSessionRefreshable>)refreshable atDate:(NSDate *)date;
+/// Refresh the given object immediately, replacing any previously scheduled refresh. Unlike
+/// scheduled refreshes this is not subject to `maximumConcurrentRefreshes`, as it is used for the
+/// initial token fetch which a session cannot start syncing without.
+- (void)refreshNow:(id<RLMSyncSessionRefreshable>)refreshable;
+- (void)cancelRefresh:(id<RLMSyncSessionRefreshable>)refreshable;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+@interface RLMSyncSessionRefreshHandle () <RLMSyncSessionRefreshable>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -32,6 +32,12 @@ using namespace realm;
 
 namespace {
 
+// How long before a token expires it is refreshed. The refresh timer's leeway
+// must be well below this so that a late wakeup does not let the token expire.
+constexpr NSTimeInterval refreshBuffer = 10;
+constexpr NSTimeInterval refreshTimerLeeway = 1;
+static_assert(refreshTimerLeeway < refreshBuffer, "timer leeway must be smaller than the refresh buffer");
+
 void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::string& path) {
     if (auto strong_user = user.lock()) {
         std::static_pointer_cast<CocoaSyncUserContext>(strong_user->binding_context())->unregister_refresh_handle(path);
@@ -40,15 +46,143 @@ void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::str
 
 }
 
+@implementation RLMSyncSessionRefreshScheduler {
+    NSUInteger _maximumConcurrentRefreshes;
+    NSTimeInterval _coalescingInterval;
+
+    // All of the following are only accessed on _queue
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    // Refreshable -> NSDate for refreshes which are not yet due
+    NSMapTable *_pending;
+    // Refreshables which are due, in the order they became due
+    NSPointerArray *_ready;
+    NSUInteger _inFlight;
+}
+
+- (instancetype)initWithMaximumConcurrentRefreshes:(NSUInteger)maximumConcurrentRefreshes
+                                coalescingInterval:(NSTimeInterval)coalescingInterval {
+    if (self = [super init]) {
+        _maximumConcurrentRefreshes = MAX(maximumConcurrentRefreshes, 1U);
+        _coalescingInterval = coalescingInterval;
+        _queue = dispatch_queue_create("io.realm.sync.refresh", DISPATCH_QUEUE_SERIAL);
+        _pending = [NSMapTable weakToStrongObjectsMapTable];
+        _ready = [NSPointerArray weakObjectsPointerArray];
+
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak RLMSyncSessionRefreshScheduler *weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf timerFired];
+        });
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_timer);
+}
+
+- (void)scheduleRefresh:(id<RLMSyncSessionRefreshable>)refreshable atDate:(NSDate *)date {
+    dispatch_async(_queue, ^{
+        [self removeRefreshable:refreshable];
+        [_pending setObject:date forKey:refreshable];
+        [self updateTimer];
+    });
+}
+
+- (void)refreshNow:(id<RLMSyncSessionRefreshable>)refreshable {
+    dispatch_async(_queue, ^{
+        [self removeRefreshable:refreshable];
+        [self updateTimer];
+        [refreshable refreshWithCompletion:^{}];
+    });
+}
+
+- (void)cancelRefresh:(id<RLMSyncSessionRefreshable>)refreshable {
+    dispatch_async(_queue, ^{
+        [self removeRefreshable:refreshable];
+        [self updateTimer];
+    });
+}
+
+- (void)removeRefreshable:(id<RLMSyncSessionRefreshable>)refreshable {
+    [_pending removeObjectForKey:refreshable];
+    for (NSUInteger i = 0; i < _ready.count; ++i) {
+        if ([_ready pointerAtIndex:i] == (__bridge void *)refreshable) {
+            [_ready removePointerAtIndex:i];
+            break;
+        }
+    }
+}
+
+- (void)updateTimer {
+    NSDate *earliest = nil;
+    for (NSDate *date in _pending.objectEnumerator) {
+        if (!earliest || [date compare:earliest] == NSOrderedAscending) {
+            earliest = date;
+        }
+    }
+    if (!earliest) {
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+
+    NSTimeInterval delay = MAX(earliest.timeIntervalSinceNow, 0.0);
+    // Refreshes are coalesced by performing ones which are nearly due early in
+    // timerFired, so the timer itself only gets a small leeway: firing late
+    // by the coalescing interval could outlast the token's refresh buffer
+    dispatch_source_set_timer(_timer, dispatch_walltime(nullptr, (int64_t)(delay * NSEC_PER_SEC)),
+                              DISPATCH_TIME_FOREVER, (uint64_t)(refreshTimerLeeway * NSEC_PER_SEC));
+}
+
+- (void)timerFired {
+    // Perform every refresh which will become due within the coalescing
+    // interval now rather than waking up again for each of them
+    NSDate *cutoff = [NSDate dateWithTimeIntervalSinceNow:_coalescingInterval];
+    NSMutableArray *due = [NSMutableArray new];
+    for (id<RLMSyncSessionRefreshable> refreshable in _pending.keyEnumerator) {
+        if ([[_pending objectForKey:refreshable] compare:cutoff] != NSOrderedDescending) {
+            [due addObject:refreshable];
+        }
+    }
+    for (id<RLMSyncSessionRefreshable> refreshable in due) {
+        [_pending removeObjectForKey:refreshable];
+        [_ready addPointer:(__bridge void *)refreshable];
+    }
+    [self updateTimer];
+    [self startReadyRefreshes];
+}
+
+- (void)startReadyRefreshes {
+    while (_inFlight < _maximumConcurrentRefreshes && _ready.count > 0) {
+        id<RLMSyncSessionRefreshable> refreshable = (__bridge id)[_ready pointerAtIndex:0];
+        [_ready removePointerAtIndex:0];
+        if (!refreshable) {
+            continue;
+        }
+
+        ++_inFlight;
+        [refreshable refreshWithCompletion:^{
+            dispatch_async(_queue, ^{
+                --_inFlight;
+                [self startReadyRefreshes];
+            });
+        }];
+    }
+}
+
+@end
+
 @interface RLMSyncSessionRefreshHandle () {
     std::weak_ptr<SyncUser> _user;
     std::string _path;
     std::weak_ptr<SyncSession> _session;
     std::shared_ptr<SyncSession> _strongSession;
+    RLMSyncSessionRefreshScheduler *_scheduler;
 }
 
-@property (nonatomic) NSTimer *timer;
-
 @property (nonatomic) NSURL *realmURL;
 @property (nonatomic) NSURL *authServerURL;
 @property (nonatomic, copy) RLMSyncBasicErrorReportingBlock completionBlock;
@@ -74,51 +208,34 @@ void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::str
         _strongSession = std::move(session);
         _session = _strongSession;
         _user = user;
-        // Immediately fire off the network request.
-        [self _timerFired:nil];
+        _scheduler = std::static_pointer_cast<CocoaSyncUserContext>(user->binding_context())->refresh_scheduler();
+        // Fire off the network request immediately; the session can't sync until it has a token.
+        [_scheduler refreshNow:self];
         return self;
     }
     return nil;
 }
 
-- (void)dealloc {
-    [self.timer invalidate];
-}
-
 - (void)invalidate {
     _strongSession = nullptr;
-    [self.timer invalidate];
+    [_scheduler cancelRefresh:self];
 }
 
 + (NSDate *)fireDateForTokenExpirationDate:(NSDate *)date nowDate:(NSDate *)nowDate {
-    static const NSTimeInterval refreshBuffer = 10;
     NSDate *fireDate = [date dateByAddingTimeInterval:-refreshBuffer];
     // Only fire times in the future are valid.
     return ([fireDate compare:nowDate] == NSOrderedDescending ? fireDate : nil);
 }
 
 - (void)scheduleRefreshTimer:(NSDate *)dateWhenTokenExpires {
-    // Schedule the timer on the main queue.
-    // It's very likely that this method will be run on a side thread, for example
-    // on the thread that runs `NSURLSession`'s completion blocks. We can't be
-    // guaranteed that there's an existing runloop on those threads, and we don't want
-    // to create and start a new one if one doesn't already exist.
-    dispatch_async(dispatch_get_main_queue(), ^{
-        [self.timer invalidate];
-        NSDate *fireDate = [RLMSyncSessionRefreshHandle fireDateForTokenExpirationDate:dateWhenTokenExpires
-                                                                               nowDate:[NSDate date]];
-        if (!fireDate) {
-            unregisterRefreshHandle(_user, _path);
-            return;
-        }
-        self.timer = [[NSTimer alloc] initWithFireDate:fireDate
-                                              interval:0
-                                                target:self
-                                              selector:@selector(_timerFired:)
-                                              userInfo:nil
-                                               repeats:NO];
-        [[NSRunLoop currentRunLoop] addTimer:self.timer forMode:NSDefaultRunLoopMode];
-    });
+    NSDate *fireDate = [RLMSyncSessionRefreshHandle fireDateForTokenExpirationDate:dateWhenTokenExpires
+                                                                           nowDate:[NSDate date]];
+    if (!fireDate) {
+        [_scheduler cancelRefresh:self];
+        unregisterRefreshHandle(_user, _path);
+        return;
+    }
+    [_scheduler scheduleRefresh:self atDate:fireDate];
 }
 
 /// Handler for network requests whose responses successfully parse into an auth response model.
@@ -221,7 +338,7 @@ void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::str
         }
         // Otherwise, malformed JSON
         unregisterRefreshHandle(_user, _path);
-        [self.timer invalidate];
+        [_scheduler cancelRefresh:self];
         if (self.completionBlock) {
             self.completionBlock(error);
         }
@@ -233,14 +350,14 @@ void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::str
     }
 }
 
-- (void)_timerFired:(__unused NSTimer *)timer {
+- (void)refreshWithCompletion:(dispatch_block_t)completion {
     RLMServerToken refreshToken = nil;
     if (auto user = _user.lock()) {
         refreshToken = @(user->refresh_token().c_str());
     }
     if (!refreshToken) {
         unregisterRefreshHandle(_user, _path);
-        [self.timer invalidate];
+        completion();
         return;
     }
 
@@ -254,6 +371,7 @@ void unregisterRefreshHandle(const std::weak_ptr<SyncUser>& user, const std::str
     __weak RLMSyncSessionRefreshHandle *weakSelf = self;
     RLMSyncCompletionBlock handler = ^(NSError *error, NSDictionary *json) {
         [weakSelf _onRefreshCompletionWithError:error json:json];
+        completion();
     };
     [RLMNetworkClient postRequestToEndpoint:RLMServerEndpointAuth
                                      server:self.authServerURL
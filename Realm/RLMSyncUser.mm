@@ -98,6 +98,16 @@ void CocoaSyncUserContext::invalidate_all_handles()
     m_refresh_handles.clear();
 }
 
+RLMSyncSessionRefreshScheduler *CocoaSyncUserContext::refresh_scheduler()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_refresh_scheduler) {
+        m_refresh_scheduler = [[RLMSyncSessionRefreshScheduler alloc] initWithMaximumConcurrentRefreshes:4
+                                                                                      coalescingInterval:30];
+    }
+    return m_refresh_scheduler;
+}
+
 PermissionChangeCallback RLMWrapPermissionStatusCallback(RLMPermissionStatusBlock callback) {
     return [callback](std::exception_ptr ptr) {
         if (ptr) {
@@ -25,7 +25,7 @@
 #import "sync/sync_user.hpp"
 #import "sync/impl/sync_metadata.hpp"
 
-@class RLMSyncConfiguration, RLMSyncSessionRefreshHandle;
+@class RLMSyncConfiguration, RLMSyncSessionRefreshHandle, RLMSyncSessionRefreshScheduler;
 
 using namespace realm;
 
@@ -39,6 +39,9 @@ public:
     void unregister_refresh_handle(const std::string& path);
     void invalidate_all_handles();
 
+    // The scheduler used by all of this user's refresh handles
+    RLMSyncSessionRefreshScheduler *refresh_scheduler();
+
 private:
     /**
      A map of paths to 'refresh handles'.
@@ -48,6 +51,7 @@ private:
      paths (e.g. `/~/path/to/realm`).
      */
     std::unordered_map<std::string, RLMSyncSessionRefreshHandle *> m_refresh_handles;
+    RLMSyncSessionRefreshScheduler * _Nullable m_refresh_scheduler;
 
     std::mutex m_mutex;
 };
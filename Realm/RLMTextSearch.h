@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Creates a predicate which matches objects whose value for a full-text indexed
+ string property contains the words in `searchText`.
+
+ The search text is a list of words separated by whitespace. An object matches
+ if the property contains all of the words, and words may be separated by `OR`
+ to match objects which contain either of the words on each side of it. `AND`
+ binds more tightly than `OR`, so `"meeting notes OR agenda"` matches objects
+ containing both "meeting" and "notes", or containing "agenda". A word ending
+ in `*` matches any word beginning with it, so `"meet*"` matches "meet",
+ "meeting" and "meetings".
+
+ Words are split on the same boundaries as the text being searched, and are
+ compared case and diacritic insensitively. An empty search matches nothing.
+
+ The predicate can be combined with other predicates using `NSCompoundPredicate`
+ or `-[RLMResults objectsWithPredicate:]`. When used to query a Realm, the
+ property must be listed in the object's `+[RLMObject fullTextIndexedProperties]`
+ and cannot be on a linked object. The predicate can also be evaluated against
+ other objects, such as with `-[NSArray filteredArrayUsingPredicate:]`, in
+ which case the text is split into words each time it is evaluated.
+
+ @param property   The name of the property to search.
+ @param searchText The words to search for.
+
+ @return A predicate which matches objects containing the words.
+ */
+FOUNDATION_EXTERN NSPredicate *RLMTextSearchPredicate(NSString *property, NSString *searchText);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,480 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMTextSearch_Private.hpp"
+
+#import "RLMClassInfo.hpp"
+#import "RLMIndexTables_Private.hpp"
+#import "RLMObjectSchema_Private.hpp"
+#import "RLMProperty_Private.h"
+#import "RLMRealm_Private.hpp"
+#import "RLMSchema_Private.h"
+#import "RLMUtil.hpp"
+
+#import "object_store.hpp"
+#import "shared_realm.hpp"
+
+#import <realm/group.hpp>
+#import <realm/link_view.hpp>
+#import <realm/query_engine.hpp>
+#import <realm/query_expression.hpp>
+#import <realm/table.hpp>
+#import <realm/table_view.hpp>
+
+#import <algorithm>
+#import <functional>
+#import <set>
+#import <unordered_map>
+#import <vector>
+
+using namespace realm;
+
+namespace {
+constexpr size_t s_wordColumn = 0;
+constexpr size_t s_objectsColumn = 1;
+constexpr char s_indexTablePrefix[] = "fts_";
+
+struct SearchTerm {
+    std::string word;
+    bool prefix;
+};
+
+// The words of a search, as an OR of ANDs
+using SearchQuery = std::vector<std::vector<SearchTerm>>;
+
+// Split text into words normalized for comparison, in the order they appear
+std::vector<std::string> tokenize(NSString *text) {
+    std::vector<std::string> words;
+    auto wordsPtr = &words;
+    @autoreleasepool {
+        // Word boundaries are found without using the current locale so that
+        // the same text is always split into the same words
+        [text enumerateSubstringsInRange:NSMakeRange(0, text.length)
+                                 options:NSStringEnumerationByWords
+                              usingBlock:^(NSString *word, __unused NSRange substringRange,
+                                           __unused NSRange enclosingRange, __unused BOOL *stop) {
+            word = [word stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch
+                                             locale:nil];
+            wordsPtr->push_back(word.UTF8String);
+        }];
+    }
+    return words;
+}
+
+// The distinct words in text, sorted
+std::vector<std::string> indexedWords(NSString *text) {
+    auto words = tokenize(text);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+// Check if the words, which must be sorted, match the search
+bool matchesSearch(std::vector<std::string> const& words, SearchQuery const& query) {
+    auto contains = [&](SearchTerm const& term) {
+        auto it = std::lower_bound(words.begin(), words.end(), term.word);
+        if (it == words.end()) {
+            return false;
+        }
+        return term.prefix ? it->compare(0, term.word.size(), term.word) == 0 : *it == term.word;
+    };
+    return std::any_of(query.begin(), query.end(), [&](std::vector<SearchTerm> const& terms) {
+        return std::all_of(terms.begin(), terms.end(), contains);
+    });
+}
+
+SearchQuery parseSearchText(NSString *searchText) {
+    SearchQuery query(1);
+    NSCharacterSet *whitespace = NSCharacterSet.whitespaceAndNewlineCharacterSet;
+    for (NSString *component in [searchText componentsSeparatedByCharactersInSet:whitespace]) {
+        if ([component isEqualToString:@"OR"]) {
+            if (!query.back().empty()) {
+                query.emplace_back();
+            }
+            continue;
+        }
+
+        bool prefix = [component hasSuffix:@"*"];
+        auto words = tokenize(component);
+        for (size_t i = 0; i < words.size(); ++i) {
+            // A single component such as "e-mail" may contain several words,
+            // and only the last of them is a prefix
+            query.back().push_back({std::move(words[i]), prefix && i + 1 == words.size()});
+        }
+    }
+    if (query.back().empty()) {
+        query.pop_back();
+    }
+    return query;
+}
+
+std::string indexTableName(RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return RLMIndexTableName(s_indexTablePrefix, objectSchema, property);
+}
+
+// The position in the word's link list, which is sorted by row index, at which
+// the row is or would be inserted
+size_t linkPosition(LinkView const& links, size_t row) {
+    size_t low = 0, high = links.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (links.get_target_row(mid) < row) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void addWord(Table& index, std::string const& word, size_t row) {
+    size_t wordRow = index.find_first_string(s_wordColumn, word);
+    if (wordRow == realm::not_found) {
+        wordRow = index.add_empty_row();
+        index.set_string(s_wordColumn, wordRow, word);
+    }
+    auto links = index.get_linklist(s_objectsColumn, wordRow);
+    links->insert(linkPosition(*links, row), row);
+}
+
+void removeWord(LinkView& links, size_t row) {
+    size_t link = linkPosition(links, row);
+    if (link == links.size() || links.get_target_row(link) != row) {
+        // Deleting an object moves the last object into its place, which
+        // leaves the moved object's links out of order, so it may have to be
+        // found without the binary search
+        link = links.find(row);
+    }
+    if (link != realm::not_found) {
+        links.remove(link);
+    }
+}
+
+// Replace the words recorded in the index for the row with `words`, which
+// must be sorted and distinct
+void setWords(Table& index, Table& objects, size_t row, std::vector<std::string> const& words) {
+    // The words currently recorded for the row are the ones whose link lists
+    // link to it
+    std::vector<size_t> oldWordRows;
+    size_t count = objects.get_backlink_count(row, index, s_objectsColumn);
+    oldWordRows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        oldWordRows.push_back(objects.get_backlink(row, index, s_objectsColumn, i));
+    }
+
+    std::vector<bool> alreadyIndexed(words.size());
+    std::vector<size_t> emptyWordRows;
+    for (size_t wordRow : oldWordRows) {
+        std::string word(index.get_string(s_wordColumn, wordRow));
+        auto it = std::lower_bound(words.begin(), words.end(), word);
+        if (it != words.end() && *it == word) {
+            alreadyIndexed[it - words.begin()] = true;
+            continue;
+        }
+
+        auto links = index.get_linklist(s_objectsColumn, wordRow);
+        removeWord(*links, row);
+        if (links->is_empty()) {
+            emptyWordRows.push_back(wordRow);
+        }
+    }
+
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (!alreadyIndexed[i]) {
+            addWord(index, words[i], row);
+        }
+    }
+
+    // Removing a row moves the last row into its place, so remove them from
+    // the end first so that none of the others are moved
+    std::sort(emptyWordRows.begin(), emptyWordRows.end(), std::greater<size_t>());
+    for (size_t wordRow : emptyWordRows) {
+        index.move_last_over(wordRow);
+    }
+}
+
+void createIndexTable(Group& group, std::string const& name, Table& objects, size_t column) {
+    TableRef index = group.add_table(name);
+    index->add_column(type_String, "word");
+    index->add_search_index(s_wordColumn);
+    index->add_column_link(type_LinkList, "objects", objects);
+
+    // Gather the objects containing each word before writing anything so
+    // that each word's row only has to be found once. The objects are
+    // gathered in order, so each word's link list starts out sorted.
+    std::unordered_map<std::string, std::vector<size_t>> objectsForWord;
+    for (size_t row = 0, size = objects.size(); row < size; ++row) {
+        StringData value = objects.get_string(column, row);
+        if (value.is_null()) {
+            continue;
+        }
+        for (auto& word : indexedWords(RLMStringDataToNSString(value))) {
+            objectsForWord[word].push_back(row);
+        }
+    }
+
+    size_t wordRow = index->add_empty_row(objectsForWord.size());
+    for (auto& pair : objectsForWord) {
+        index->set_string(s_wordColumn, wordRow, pair.first);
+        auto links = index->get_linklist(s_objectsColumn, wordRow);
+        for (size_t row : pair.second) {
+            links->add(row);
+        }
+        ++wordRow;
+    }
+}
+
+// The changes to the Realm's index tables needed to match its schema
+struct IndexTableChanges {
+    struct Creation {
+        std::string name;
+        RLMObjectSchema *objectSchema;
+        RLMProperty *property;
+    };
+    std::vector<Creation> create;
+    std::vector<std::string> remove;
+
+    bool empty() const { return create.empty() && remove.empty(); }
+};
+
+IndexTableChanges indexTableChanges(RLMRealm *realm) {
+    Group& group = realm.group;
+    IndexTableChanges changes;
+
+    std::set<std::string> expected;
+    for (RLMObjectSchema *objectSchema in realm.schema.objectSchema) {
+        for (RLMProperty *property in objectSchema.properties) {
+            if (!property.fullTextIndexed) {
+                continue;
+            }
+            auto name = indexTableName(objectSchema, property);
+            if (!group.has_table(name)) {
+                changes.create.push_back({name, objectSchema, property});
+            }
+            expected.insert(std::move(name));
+        }
+    }
+
+    for (size_t i = 0, size = group.size(); i < size; ++i) {
+        std::string name(group.get_table_name(i));
+        if (name.compare(0, strlen(s_indexTablePrefix), s_indexTablePrefix) != 0 || expected.count(name)) {
+            continue;
+        }
+        // Only remove the indexes of classes in this Realm's schema, as the
+        // indexes of other classes may still be used by Realms opened with a
+        // different set of classes
+        auto objectTable = group.get_table(i)->get_link_target(s_objectsColumn);
+        auto objectType = ObjectStore::object_type_for_table_name(objectTable->get_name());
+        if ([realm.schema schemaForClassName:RLMStringDataToNSString(objectType)]) {
+            changes.remove.push_back(std::move(name));
+        }
+    }
+    return changes;
+}
+
+class TextSearchExpression : public realm::Expression {
+public:
+    TextSearchExpression(const Table& table, size_t column, std::string indexName,
+                         std::string coverageName, SearchQuery query)
+    : m_table(&table), m_column(column), m_index_name(std::move(indexName))
+    , m_coverage_name(std::move(coverageName)), m_query(std::move(query))
+    {
+    }
+
+    double init() override
+    {
+        m_rows.clear();
+        Group* group = m_table->get_parent_group();
+        TableRef index = group ? group->get_table(m_index_name) : TableRef();
+        // Without an index which has every object in it, the text of each
+        // object has to be searched instead
+        m_scan = !index || !RLMIndexTablesCoverAllRows(*m_table, m_coverage_name);
+        if (m_scan) {
+            return 50.0;
+        }
+
+        for (auto& terms : m_query) {
+            auto rows = rows_containing_all(*index, terms);
+            std::vector<size_t> combined;
+            combined.reserve(m_rows.size() + rows.size());
+            std::set_union(m_rows.begin(), m_rows.end(), rows.begin(), rows.end(), std::back_inserter(combined));
+            m_rows = std::move(combined);
+        }
+        return 50.0;
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_scan) {
+            for (size_t row = start; row < end; ++row) {
+                StringData value = m_table->get_string(m_column, row);
+                if (!value.is_null() && matchesSearch(indexedWords(RLMStringDataToNSString(value)), m_query)) {
+                    return row;
+                }
+            }
+            return realm::not_found;
+        }
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), start);
+        return it != m_rows.end() && *it < end ? *it : realm::not_found;
+    }
+
+    void set_base_table(const Table* table) override { m_table = table; }
+    void verify_column() const override { REALM_ASSERT(m_table); }
+    const Table* get_base_table() const override { return m_table; }
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new TextSearchExpression(*this));
+    }
+
+private:
+    const Table* m_table;
+    size_t m_column;
+    std::string m_index_name;
+    std::string m_coverage_name;
+    SearchQuery m_query;
+
+    // The matching rows, sorted, when using the index
+    std::vector<size_t> m_rows;
+    bool m_scan = false;
+
+    static std::vector<size_t> rows_containing_all(Table& index, std::vector<SearchTerm> const& terms)
+    {
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            auto termRows = rows_containing(index, terms[i]);
+            if (i == 0) {
+                rows = std::move(termRows);
+            }
+            else {
+                std::vector<size_t> intersection;
+                std::set_intersection(rows.begin(), rows.end(), termRows.begin(), termRows.end(),
+                                      std::back_inserter(intersection));
+                rows = std::move(intersection);
+            }
+            if (rows.empty()) {
+                break;
+            }
+        }
+        return rows;
+    }
+
+    static std::vector<size_t> rows_containing(Table& index, SearchTerm const& term)
+    {
+        std::vector<size_t> rows;
+        auto add_rows = [&](size_t wordRow) {
+            auto links = index.get_linklist(s_objectsColumn, wordRow);
+            for (size_t i = 0, size = links->size(); i < size; ++i) {
+                rows.push_back(links->get(i).get_index());
+            }
+        };
+
+        if (term.prefix) {
+            TableView words = index.where().begins_with(s_wordColumn, term.word).find_all();
+            for (size_t i = 0; i < words.size(); ++i) {
+                add_rows(words.get_source_ndx(i));
+            }
+        }
+        else {
+            size_t wordRow = index.find_first_string(s_wordColumn, term.word);
+            if (wordRow != realm::not_found) {
+                add_rows(wordRow);
+            }
+        }
+
+        // An object can contain several words with the same prefix
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        return rows;
+    }
+};
+} // anonymous namespace
+
+@interface NSString (RLMTextSearch)
+- (BOOL)rlm_matchesText:(NSString *)searchText;
+@end
+
+@implementation NSString (RLMTextSearch)
+// Evaluates a text search without an index, for predicates created by
+// RLMTextSearchPredicate() which are not used to query a Realm
+- (BOOL)rlm_matchesText:(NSString *)searchText {
+    if (![searchText isKindOfClass:[NSString class]]) {
+        return NO;
+    }
+
+    return matchesSearch(indexedWords(self), parseSearchText(searchText));
+}
+@end
+
+NSPredicate *RLMTextSearchPredicate(NSString *property, NSString *searchText) {
+    return [NSComparisonPredicate predicateWithLeftExpression:[NSExpression expressionForKeyPath:property]
+                                              rightExpression:[NSExpression expressionForConstantValue:searchText]
+                                               customSelector:RLMTextSearchSelector()];
+}
+
+SEL RLMTextSearchSelector() {
+    return @selector(rlm_matchesText:);
+}
+
+realm::Table *RLMFullTextIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return group.get_table(indexTableName(objectSchema, property)).get();
+}
+
+bool RLMFullTextIndexTablesNeedUpdate(RLMRealm *realm) {
+    return !indexTableChanges(realm).empty();
+}
+
+void RLMUpdateFullTextIndexTables(RLMRealm *realm) {
+    auto changes = indexTableChanges(realm);
+    Group& group = realm.group;
+    for (auto& name : changes.remove) {
+        group.remove_table(name);
+    }
+    for (auto& creation : changes.create) {
+        auto& objects = *ObjectStore::table_for_object_type(group, creation.objectSchema.objectName.UTF8String);
+        createIndexTable(group, creation.name, objects,
+                         objects.get_column_index(creation.property.name.UTF8String));
+    }
+}
+
+void RLMUpdateFullTextIndexes(RLMClassInfo& info, size_t row) {
+    for (auto& pair : info.fullTextIndexTables()) {
+        if (!pair.second) {
+            continue;
+        }
+        Table& objects = *info.table();
+        setWords(*pair.second, objects, row,
+                 indexedWords(RLMStringDataToNSString(objects.get_string(pair.first, row))));
+    }
+}
+
+void RLMUpdateFullTextIndex(RLMClassInfo& info, size_t column, size_t row, NSString *value) {
+    if (Table *index = info.fullTextIndexTable(column)) {
+        setWords(*index, *info.table(), row, indexedWords(value));
+    }
+}
+
+std::unique_ptr<realm::Expression> RLMMakeTextSearchExpression(realm::Table& table,
+                                                               RLMObjectSchema *objectSchema,
+                                                               RLMProperty *property,
+                                                               NSString *searchText) {
+    return std::unique_ptr<Expression>(new TextSearchExpression(table, table.get_column_index(property.name.UTF8String),
+                                                                indexTableName(objectSchema, property),
+                                                                RLMIndexCoverageTableName(objectSchema),
+                                                                parseSearchText(searchText)));
+}
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#import "RLMTextSearch.h"
+
+#import <memory>
+#import <string>
+
+namespace realm {
+    class Expression;
+    class Group;
+    class Table;
+}
+class RLMClassInfo;
+@class RLMObjectSchema, RLMProperty, RLMRealm;
+
+// Full-text indexes are stored in a table for each indexed property which has
+// a row for each distinct word in the property's values. Each row has the
+// word and a link list containing the objects whose value contains the word,
+// kept sorted by row index so that an object can be found in it quickly.
+// Core keeps the link lists up to date when objects are deleted, so the index
+// only needs to be updated when an object is created or the property is set.
+
+// The selector used by the predicates created by RLMTextSearchPredicate()
+SEL RLMTextSearchSelector();
+
+// Get the table storing the full-text index for the property, or nullptr if
+// it has not been created
+realm::Table *RLMFullTextIndexTable(realm::Group& group, RLMObjectSchema *objectSchema, RLMProperty *property);
+
+// Check if RLMUpdateFullTextIndexTables() has anything to do
+bool RLMFullTextIndexTablesNeedUpdate(RLMRealm *realm);
+
+// Create and populate the tables for any full-text indexed properties in the
+// Realm's schema which do not have one, and remove the tables for properties
+// which are no longer full-text indexed. Must be called within a write
+// transaction.
+void RLMUpdateFullTextIndexTables(RLMRealm *realm);
+
+// Update the full-text indexes of all of the properties of the object in the
+// given row after it has been created or updated from a value
+void RLMUpdateFullTextIndexes(RLMClassInfo& info, size_t row);
+
+// Update the full-text index of the column, if it has one, after the value in
+// the given row has been set
+void RLMUpdateFullTextIndex(RLMClassInfo& info, size_t column, size_t row, NSString *value);
+
+// Create a query expression which matches the rows of `table` whose value for
+// the full-text indexed property contains the words in `searchText`
+std::unique_ptr<realm::Expression> RLMMakeTextSearchExpression(realm::Table& table,
+                                                               RLMObjectSchema *objectSchema,
+                                                               RLMProperty *property,
+                                                               NSString *searchText);
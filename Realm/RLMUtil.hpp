@@ -26,6 +26,8 @@
 #import <realm/timestamp.hpp>
 #import <realm/util/file.hpp>
 
+#import <string>
+
 namespace realm {
     class Mixed;
 }
@@ -168,6 +170,16 @@ static inline NSUInteger RLMConvertNotFound(size_t index) {
 
 id RLMMixedToObjc(realm::Mixed const& value);
 
+// Get the name of the table used to store an index for the property which
+// Realm does not support natively, such as a full-text index. Index tables of
+// each kind share a prefix, followed by a hash of the class and property names
+// as table names are limited to 63 bytes.
+std::string RLMIndexTableName(const char *prefix, RLMObjectSchema *objectSchema, RLMProperty *property);
+std::string RLMIndexTableName(const char *prefix, RLMObjectSchema *objectSchema, NSArray<NSString *> *propertyNames);
+
+// Check if the table name is one produced by RLMIndexTableName()
+bool RLMIsIndexTableName(realm::StringData name);
+
 // For unit testing purposes, allow an Objective-C class named FakeObject to also be used
 // as the base class of managed objects. This allows for testing invalid schemas.
 void RLMSetTreatFakeObjectAsRLMObject(BOOL flag);
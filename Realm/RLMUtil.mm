@@ -383,6 +383,47 @@ id RLMMixedToObjc(realm::Mixed const& mixed) {
     }
 }
 
+std::string RLMIndexTableName(const char *prefix, RLMObjectSchema *objectSchema, RLMProperty *property) {
+    return RLMIndexTableName(prefix, objectSchema, @[property.name]);
+}
+
+std::string RLMIndexTableName(const char *prefix, RLMObjectSchema *objectSchema, NSArray<NSString *> *propertyNames) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&](NSString *str) {
+        for (const char *c = str.UTF8String; *c; ++c) {
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+        }
+        hash = hash * 1099511628211ULL;
+    };
+    add(objectSchema.objectName);
+    for (NSString *propertyName in propertyNames) {
+        add(propertyName);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%s%016llx", prefix, (unsigned long long)hash);
+    return name;
+}
+
+bool RLMIsIndexTableName(realm::StringData name) {
+    // A three letter prefix and underscore followed by the 16 digit hash
+    if (name.size() != 20 || name[3] != '_') {
+        return false;
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        if (name[i] < 'a' || name[i] > 'z') {
+            return false;
+        }
+    }
+    for (size_t i = 4; i < name.size(); ++i) {
+        if (!isxdigit(name[i]) || isupper(name[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 NSString *RLMDefaultDirectoryForBundleIdentifier(NSString *bundleIdentifier) {
 #if TARGET_OS_TV
     (void)bundleIdentifier;
@@ -24,11 +24,15 @@
 #import <Realm/RLMObjectSchema.h>
 #import <Realm/RLMPlatform.h>
 #import <Realm/RLMProperty.h>
+#import <Realm/RLMQueryTiming.h>
 #import <Realm/RLMRealm.h>
 #import <Realm/RLMRealmConfiguration.h>
 #import <Realm/RLMRealmConfiguration+Sync.h>
+#import <Realm/RLMRealmPool.h>
+#import <Realm/RLMRealmStatistics.h>
 #import <Realm/RLMResults.h>
 #import <Realm/RLMSchema.h>
+#import <Realm/RLMStorageStatistics.h>
 #import <Realm/RLMSyncConfiguration.h>
 #import <Realm/RLMSyncCredentials.h>
 #import <Realm/RLMSyncManager.h>
@@ -41,4 +45,5 @@
 #import <Realm/RLMSyncSession.h>
 #import <Realm/RLMSyncUser.h>
 #import <Realm/RLMSyncUtil.h>
+#import <Realm/RLMTextSearch.h>
 #import <Realm/NSError+RLMSync.h>
@@ -20,6 +20,7 @@
 
 #import "RLMRealmConfiguration_Private.hpp"
 #import "RLMRealm_Private.hpp"
+#import "RLMRealmUtil.hpp"
 
 #import "impl/realm_coordinator.hpp"
 
@@ -911,6 +912,50 @@
     }];
 }
 
+- (void)testNotificationsAreDeliveredOnQueue {
+    dispatch_queue_t queue = dispatch_queue_create("test queue", DISPATCH_QUEUE_SERIAL);
+    static char queueKey;
+    dispatch_queue_set_specific(queue, &queueKey, &queueKey, nullptr);
+
+    std::string path = RLMRealm.defaultRealm.configuration.fileURL.path.UTF8String;
+    __block XCTestExpectation *expectation = [self expectationWithDescription:@"initial"];
+    auto token = [IntObject.allObjects addNotificationBlock:^(RLMResults *results, RLMCollectionChange *change, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertTrue(dispatch_get_specific(&queueKey) == &queueKey);
+        XCTAssertFalse(NSThread.isMainThread);
+        // The Realm the results were delivered in must not be left cached on
+        // the dispatch worker thread
+        XCTAssertNil(RLMGetThreadLocalCachedRealmForPath(path));
+        if (change) {
+            XCTAssertEqual(results.count, 1U);
+            XCTAssertEqualObjects(change.insertions, @[@0]);
+        }
+        else {
+            XCTAssertEqual(results.count, 0U);
+        }
+        [expectation fulfill];
+    } queue:queue];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+
+    expectation = [self expectationWithDescription:@"change"];
+    [self createObject:1];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+
+    [token stop];
+    // Changes made after the token is stopped must not be delivered
+    [self createObject:2];
+    dispatch_sync(queue, ^{});
+}
+
+- (void)testQueueNotificationsNotSupportedInWriteTransactions {
+    dispatch_queue_t queue = dispatch_queue_create("test queue", DISPATCH_QUEUE_SERIAL);
+    [RLMRealm.defaultRealm transactionWithBlock:^{
+        XCTAssertThrows([IntObject.allObjects addNotificationBlock:^(RLMResults *results, RLMCollectionChange *change, NSError *error) {
+            XCTFail(@"should not be called");
+        } queue:queue]);
+    }];
+}
+
 - (void)testTransactionsAfterDeletingLinkView {
     RLMRealm *realm = [RLMRealm defaultRealm];
     [realm beginWriteTransaction];
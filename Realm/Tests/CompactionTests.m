@@ -185,4 +185,82 @@ NSUInteger count = 1000;
                                       @"Cannot set `readOnly` when `shouldCompactOnLaunch` is set.");
 }
 
+- (void)testCompactWhenFreeSpaceRatioExceeded {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.fileURL = RLMTestRealmURL();
+    configuration.maximumFreeSpaceRatio = 0.01;
+    NSMutableArray *states = [NSMutableArray new];
+    configuration.compactionResultBlock = ^(RLMCompactionState state, NSUInteger totalBytes, NSUInteger usedBytes) {
+        [states addObject:@(state)];
+        XCTAssertTrue((usedBytes < totalBytes) && (usedBytes > expectedUsedBytesBeforeMin));
+        if (state == RLMCompactionStateStarted) {
+            XCTAssertEqual(totalBytes, expectedTotalBytesBefore);
+        }
+        else {
+            XCTAssertLessThan(totalBytes, expectedTotalBytesBefore);
+        }
+    };
+
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqualObjects(states, (@[@(RLMCompactionStateStarted), @(RLMCompactionStateCompleted)]));
+    XCTAssertLessThan([self fileSize:configuration.fileURL], expectedTotalBytesBefore);
+
+    // Validate that the file still contains what it should
+    XCTAssertEqual([[StringObject allObjectsInRealm:realm] count], count + 2);
+    XCTAssertEqualObjects(@"A", [[StringObject allObjectsInRealm:realm].firstObject stringCol]);
+    XCTAssertEqualObjects(@"B", [[StringObject allObjectsInRealm:realm].lastObject stringCol]);
+}
+
+- (void)testNoCompactWhenFreeSpaceRatioNotExceeded {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.fileURL = RLMTestRealmURL();
+    configuration.maximumFreeSpaceRatio = 1;
+    configuration.compactionResultBlock = ^(__unused RLMCompactionState state, __unused NSUInteger totalBytes, __unused NSUInteger usedBytes) {
+        XCTFail(@"Compaction should not have been attempted");
+    };
+
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+    XCTAssertEqual([self fileSize:configuration.fileURL], expectedTotalBytesBefore);
+    XCTAssertEqual([[StringObject allObjectsInRealm:realm] count], count + 2);
+}
+
+- (void)testFreeSpaceRatioCompactSkippedWhileRealmIsOpen {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.fileURL = RLMTestRealmURL();
+    __unused RLMRealm *firstRealm = [RLMRealm realmWithConfiguration:configuration error:nil];
+
+    configuration.maximumFreeSpaceRatio = 0.01;
+    NSMutableArray *states = [NSMutableArray new];
+    configuration.compactionResultBlock = ^(RLMCompactionState state, NSUInteger totalBytes, __unused NSUInteger usedBytes) {
+        [states addObject:@(state)];
+        XCTAssertEqual(totalBytes, expectedTotalBytesBefore);
+    };
+
+    // Open on a different thread so that the cached Realm isn't reused
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:configuration error:nil];
+        XCTAssertEqual([[StringObject allObjectsInRealm:realm] count], count + 2);
+    }];
+    XCTAssertEqualObjects(states, (@[@(RLMCompactionStateStarted), @(RLMCompactionStateSkipped)]));
+    XCTAssertEqual([self fileSize:configuration.fileURL], expectedTotalBytesBefore);
+}
+
+- (void)testMaximumFreeSpaceRatioValidation {
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    RLMAssertThrowsWithReasonMatching(configuration.maximumFreeSpaceRatio = -0.5,
+                                      @"`maximumFreeSpaceRatio` must be between 0 and 1, but was -0.5.");
+    RLMAssertThrowsWithReasonMatching(configuration.maximumFreeSpaceRatio = 1.5,
+                                      @"`maximumFreeSpaceRatio` must be between 0 and 1, but was 1.5.");
+
+    configuration.readOnly = YES;
+    RLMAssertThrowsWithReasonMatching(configuration.maximumFreeSpaceRatio = 0.5,
+                                      @"Cannot set `maximumFreeSpaceRatio` when `readOnly` is set.");
+    XCTAssertNoThrow(configuration.maximumFreeSpaceRatio = 0);
+
+    configuration.readOnly = NO;
+    configuration.maximumFreeSpaceRatio = 0.5;
+    RLMAssertThrowsWithReasonMatching(configuration.readOnly = YES,
+                                      @"Cannot set `readOnly` when `maximumFreeSpaceRatio` is set.");
+}
+
 @end
@@ -567,6 +567,55 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertTrue(info.table()->has_search_index(info.tableColumn(objectSchema.properties[0].name)));
 }
 
+- (void)testBuildIndexesInBackground {
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:StringObject.class];
+    [self createTestRealmWithSchema:@[objectSchema] block:^(RLMRealm *realm) {
+        for (int i = 0; i < 100; ++i) {
+            [StringObject createInRealm:realm withValue:@[@(i).stringValue]];
+        }
+    }];
+
+    [objectSchema.properties[0] setIndexed:YES];
+    RLMRealmConfiguration *config = [self config];
+    config.customSchema = [self schemaWithObjects:@[objectSchema]];
+    config.buildsIndexesInBackground = YES;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"index built"];
+    config.indexBuildProgressBlock = ^(NSUInteger builtIndexes, NSUInteger totalIndexes, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(1U, builtIndexes);
+        XCTAssertEqual(1U, totalIndexes);
+        [expectation fulfill];
+    };
+
+    // The Realm is opened without the index, and queries scan the table
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    auto& info = realm->_info[@"StringObject"];
+    XCTAssertEqual(1U, [StringObject objectsInRealm:realm where:@"stringCol = '50'"].count);
+
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [realm refresh];
+    XCTAssertTrue(info.table()->has_search_index(info.tableColumn(objectSchema.properties[0].name)));
+    XCTAssertEqual(1U, [StringObject objectsInRealm:realm where:@"stringCol = '50'"].count);
+}
+
+- (void)testIndexesForEmptyTablesAreNotBuiltInBackground {
+    RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:StringObject.class];
+    [self createTestRealmWithSchema:@[objectSchema] block:^(RLMRealm *) { }];
+
+    [objectSchema.properties[0] setIndexed:YES];
+    RLMRealmConfiguration *config = [self config];
+    config.customSchema = [self schemaWithObjects:@[objectSchema]];
+    config.buildsIndexesInBackground = YES;
+    config.indexBuildProgressBlock = ^(__unused NSUInteger builtIndexes, __unused NSUInteger totalIndexes,
+                                       __unused NSError *error) {
+        XCTFail(@"No indexes should be built in the background");
+    };
+
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    auto& info = realm->_info[@"StringObject"];
+    XCTAssertTrue(info.table()->has_search_index(info.tableColumn(objectSchema.properties[0].name)));
+}
+
 - (void)testRearrangeProperties {
     // create object in default realm
     [RLMRealm.defaultRealm transactionWithBlock:^{
@@ -711,6 +760,32 @@ RLM_ARRAY_TYPE(MigrationObject);
     XCTAssertEqual(0U, [StringObject allObjectsInRealm:realm].count);
 }
 
+- (void)testRemovingFullTextIndexedClass {
+    RLMProperty *prop = [[RLMProperty alloc] initWithName:@"text"
+                                                     type:RLMPropertyTypeString
+                                          objectClassName:nil
+                                   linkOriginPropertyName:nil
+                                                  indexed:NO
+                                                 optional:YES];
+    prop.fullTextIndexed = YES;
+    RLMObjectSchema *objectSchema = [[RLMObjectSchema alloc] initWithClassName:@"DeletedClass" objectClass:RLMObject.class properties:@[prop]];
+    [self createTestRealmWithSchema:@[objectSchema, [RLMObjectSchema schemaForObjectClass:FullTextIndexedObject.class]]
+                              block:^(RLMRealm *realm) {
+        [realm createObject:@"DeletedClass" withValue:@[@"quick brown fox"]];
+        [realm createObject:FullTextIndexedObject.className withValue:@[@"quick brown fox", @0]];
+    }];
+
+    RLMRealm *realm = [self migrateTestRealmWithBlock:^(RLMMigration *migration, uint64_t) {
+        XCTAssertTrue([migration deleteDataForClassName:@"DeletedClass"]);
+        XCTAssertTrue([migration deleteDataForClassName:FullTextIndexedObject.className]);
+        [migration createObject:FullTextIndexedObject.className withValue:@[@"lazy dog", @1]];
+    }];
+
+    XCTAssertFalse(ObjectStore::table_for_object_type(realm.group, "DeletedClass"));
+    XCTAssertEqual(0U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"fox")].count);
+    XCTAssertEqual(1U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"dog")].count);
+}
+
 - (void)testAddingPropertyAtEnd {
     // create schema to migrate from with single string column
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:MigrationObject.class];
@@ -923,6 +923,54 @@ static void ExpectChange(id self, NSArray *deletions, NSArray *insertions, NSArr
     [token stop];
 }
 
+- (void)testNotificationsAreDeliveredOnQueue {
+    dispatch_queue_t queue = dispatch_queue_create("test queue", DISPATCH_QUEUE_SERIAL);
+    static char queueKey;
+    dispatch_queue_set_specific(queue, &queueKey, &queueKey, NULL);
+
+    __block bool changed = false;
+    __block XCTestExpectation *expectation = nil;
+    RLMNotificationToken *token = [_obj addNotificationBlock:^(BOOL deleted, NSArray<RLMPropertyChange *> *changes, NSError *error) {
+        XCTAssertTrue(dispatch_get_specific(&queueKey) == &queueKey);
+        XCTAssertNil(error);
+        if (deleted) {
+            XCTAssertNil(changes);
+            [expectation fulfill];
+            return;
+        }
+        XCTAssertEqual(changes.count, 1U);
+        XCTAssertEqualObjects(changes[0].name, @"intCol");
+        XCTAssertEqual([changes[0].value intValue], [changes[0].previousValue intValue] + 1);
+        changed = true;
+    } queue:queue];
+
+    // The object is only observed once the worker thread has picked up the
+    // registration, so keep changing it until a change is delivered
+    RLMRealm *realm = _obj.realm;
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2.0];
+    while (true) {
+        [realm transactionWithBlock:^{
+            _obj.intCol++;
+        }];
+        dispatch_sync(queue, ^{});
+        if (changed || timeout.timeIntervalSinceNow < 0) {
+            break;
+        }
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    // Wait for any changes still in flight before deleting
+    [NSThread sleepForTimeInterval:0.1];
+    dispatch_sync(queue, ^{});
+    XCTAssertTrue(changed);
+
+    expectation = [self expectationWithDescription:@"delete"];
+    [realm transactionWithBlock:^{
+        [realm deleteObject:_obj];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [token stop];
+}
+
 - (void)testChangeAllPropertyTypes {
     __block NSUInteger i = 0;
     __block XCTestExpectation *expectation = nil;
@@ -146,6 +146,20 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
     }];
 }
 
+- (void)testParallelCountWhereQuery {
+    [self getStringObjects:50];
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.fileURL = RLMTestRealmURL();
+    config.maximumQueryConcurrency = 0;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    [self measureBlock:^{
+        for (int i = 0; i < 50; ++i) {
+            RLMResults *array = [StringObject objectsInRealm:realm where:@"stringCol = 'a'"];
+            [array count];
+        }
+    }];
+}
+
 - (void)testCountWhereTableView {
     RLMRealm *realm = [self getStringObjects:50];
     [self measureBlock:^{
@@ -220,6 +234,28 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
     }];
 }
 
+- (void)testEnumerateAndAccessAllDynamic {
+    RLMRealm *realm = [self getStringObjects:5];
+
+    [self measureBlock:^{
+        for (StringObject *so in [StringObject allObjectsInRealm:realm]) {
+            (void)so[@"stringCol"];
+        }
+    }];
+}
+
+- (void)testEnumerateAndMutateAllDynamic {
+    RLMRealm *realm = [self getStringObjects:5];
+
+    [self measureBlock:^{
+        [realm beginWriteTransaction];
+        for (StringObject *so in [StringObject allObjectsInRealm:realm]) {
+            so[@"stringCol"] = @"c";
+        }
+        [realm commitWriteTransaction];
+    }];
+}
+
 - (void)testEnumerateAndMutateAll {
     RLMRealm *realm = [self getStringObjects:5];
 
@@ -372,6 +408,22 @@ static RLMRealm *s_smallRealm, *s_mediumRealm, *s_largeRealm;
     [realm configuration];
 }
 
+- (void)testRealmCreationCachedOnCurrentThread {
+    RLMRealm *realm = [RLMRealm defaultRealm]; // ensure a cached realm on this thread
+    RLMRealm *testPathRealm = [self realmWithTestPath];
+
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; ++i) {
+            @autoreleasepool {
+                [RLMRealm defaultRealm];
+                [self realmWithTestPath];
+            }
+        }
+    }];
+    [realm configuration];
+    [testPathRealm configuration];
+}
+
 - (void)testRealmCreationUncached {
     [self measureBlock:^{
         for (int i = 0; i < 50; ++i) {
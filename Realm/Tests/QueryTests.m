@@ -305,11 +305,9 @@
 
 - (void)testStringUnsupportedOperations
 {
-    XCTAssertThrows([StringObject objectsWhere:@"stringCol MATCHES 'abc'"]);
     XCTAssertThrows([StringObject objectsWhere:@"stringCol BETWEEN {'a', 'b'}"]);
     XCTAssertThrows([StringObject objectsWhere:@"stringCol < 'abc'"]);
 
-    XCTAssertThrows([AllTypesObject objectsWhere:@"objectCol.stringCol MATCHES 'abc'"]);
     XCTAssertThrows([AllTypesObject objectsWhere:@"objectCol.stringCol BETWEEN {'a', 'b'}"]);
     XCTAssertThrows([AllTypesObject objectsWhere:@"objectCol.stringCol < 'abc'"]);
 }
@@ -2680,6 +2678,561 @@ struct NullTestData {
     [self testClass:[AllOptionalTypes class] withNormalCount:0U notCount:1U where:@"date IN %@", @[[NSDate dateWithTimeIntervalSince1970:1]]];
 }
 
+- (void)testINPredicateWithManyValues
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; ++i) {
+        NSString *str = [NSString stringWithFormat:@"%d", i];
+        NSDate *date = [NSDate dateWithTimeIntervalSince1970:i];
+        [AllOptionalTypes createInRealm:realm withValue:@[@(i % 2 == 0), @(i), @(i), @(i), str, NSNull.null, date]];
+        [IndexedStringObject createInRealm:realm withValue:@[str]];
+    }
+    [AllOptionalTypes createInRealm:realm withValue:@[NSNull.null, NSNull.null, NSNull.null, NSNull.null,
+                                                      NSNull.null, NSNull.null, NSNull.null]];
+    [IndexedStringObject createInRealm:realm withValue:@[NSNull.null]];
+    [realm commitWriteTransaction];
+
+    NSMutableArray *numbers = [NSMutableArray new];
+    NSMutableArray *strings = [NSMutableArray new];
+    NSMutableArray *dates = [NSMutableArray new];
+    for (int i = 0; i < 200; i += 2) {
+        [numbers addObject:@(i)];
+        [strings addObject:[NSString stringWithFormat:@"%d", i]];
+        [dates addObject:[NSDate dateWithTimeIntervalSince1970:i]];
+    }
+
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"intObj IN %@", numbers];
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"floatObj IN %@", numbers];
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"doubleObj IN %@", numbers];
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"string IN %@", strings];
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"date IN %@", dates];
+    [self testClass:[IndexedStringObject class] withNormalCount:50U notCount:51U where:@"stringCol IN %@", strings];
+
+    // Duplicate values only match each object once
+    [self testClass:[AllOptionalTypes class] withNormalCount:50U notCount:51U where:@"intObj IN %@",
+     [numbers arrayByAddingObjectsFromArray:numbers]];
+
+    // Null
+    NSArray *numbersAndNull = [numbers arrayByAddingObject:NSNull.null];
+    NSArray *stringsAndNull = [strings arrayByAddingObject:NSNull.null];
+    [self testClass:[AllOptionalTypes class] withNormalCount:51U notCount:50U where:@"intObj IN %@", numbersAndNull];
+    [self testClass:[AllOptionalTypes class] withNormalCount:51U notCount:50U where:@"doubleObj IN %@", numbersAndNull];
+    [self testClass:[AllOptionalTypes class] withNormalCount:51U notCount:50U where:@"string IN %@", stringsAndNull];
+    [self testClass:[AllOptionalTypes class] withNormalCount:51U notCount:50U where:@"date IN %@",
+     [dates arrayByAddingObject:NSNull.null]];
+    [self testClass:[IndexedStringObject class] withNormalCount:51U notCount:50U where:@"stringCol IN %@", stringsAndNull];
+
+    // NaN never matches
+    [self testClass:[AllOptionalTypes class] withNormalCount:1U notCount:100U where:@"doubleObj IN %@", @[@(NAN), @1]];
+
+    // Combined with other conditions
+    RLMAssertCount(AllOptionalTypes, 25U, @"intObj IN %@ AND intObj < 50", numbers);
+    RLMAssertCount(AllOptionalTypes, 75U, @"intObj IN %@ OR intObj < 50", numbers);
+    RLMAssertCount(IndexedStringObject, 5U, @"stringCol IN %@ AND stringCol BEGINSWITH '1'", stringsAndNull);
+
+    // Case insensitive
+    [self testClass:[AllOptionalTypes class] withNormalCount:2U notCount:99U where:@"string IN[c] %@", @[@"1", @"2"]];
+}
+
+- (void)testTextSearch
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    [FullTextIndexedObject createInRealm:realm withValue:@[@"Meeting notes for Tuesday", @1]];
+    [FullTextIndexedObject createInRealm:realm withValue:@[@"The agenda for the next MEETING", @2]];
+    [FullTextIndexedObject createInRealm:realm withValue:@[@"Café opening hours", @3]];
+    [FullTextIndexedObject createInRealm:realm withValue:@[NSNull.null, @4]];
+    [realm commitWriteTransaction];
+
+    RLMResults *(^search)(NSString *) = ^(NSString *text) {
+        return [self evaluate:[FullTextIndexedObject objectsWithPredicate:RLMTextSearchPredicate(@"text", text)]];
+    };
+
+    // Words are matched case and diacritic insensitively
+    XCTAssertEqual(2U, search(@"meeting").count);
+    XCTAssertEqual(1U, search(@"cafe").count);
+    XCTAssertEqual(0U, search(@"meet").count);
+    XCTAssertEqual(0U, search(@"").count);
+
+    // AND, OR and prefixes
+    XCTAssertEqualObjects((@[@1]), [search(@"meeting notes") valueForKey:@"intCol"]);
+    XCTAssertEqual(0U, search(@"meeting hours").count);
+    XCTAssertEqual(3U, search(@"meeting OR hours").count);
+    XCTAssertEqual(2U, search(@"meeting notes OR opening").count);
+    XCTAssertEqual(2U, search(@"meet*").count);
+    XCTAssertEqual(1U, search(@"meet* tue*").count);
+
+    // Combined with other predicates
+    NSPredicate *predicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[RLMTextSearchPredicate(@"text", @"meeting"),
+                                                                                  [NSPredicate predicateWithFormat:@"intCol > 1"]]];
+    XCTAssertEqual(1U, [self evaluate:[FullTextIndexedObject objectsWithPredicate:predicate]].count);
+    predicate = [NSCompoundPredicate notPredicateWithSubpredicate:RLMTextSearchPredicate(@"text", @"meeting")];
+    XCTAssertEqual(2U, [self evaluate:[FullTextIndexedObject objectsWithPredicate:predicate]].count);
+
+    // The index is updated when the property is set and objects are deleted
+    FullTextIndexedObject *obj = [FullTextIndexedObject objectsWhere:@"intCol = 3"].firstObject;
+    [realm beginWriteTransaction];
+    obj.text = @"Meeting rescheduled";
+    [realm deleteObject:[FullTextIndexedObject objectsWhere:@"intCol = 1"].firstObject];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(2U, search(@"meeting").count);
+    XCTAssertEqual(0U, search(@"cafe").count);
+    XCTAssertEqual(0U, search(@"notes").count);
+    XCTAssertEqual(1U, search(@"rescheduled").count);
+
+    // The predicate can also be evaluated without a Realm
+    NSArray *objects = [[FullTextIndexedObject allObjects] valueForKey:@"self"];
+    XCTAssertEqual(2U, [objects filteredArrayUsingPredicate:RLMTextSearchPredicate(@"text", @"meet*")].count);
+}
+
+- (void)testTextSearchRequiresFullTextIndex
+{
+    RLMAssertThrowsWithReasonMatching([StringObject objectsWithPredicate:RLMTextSearchPredicate(@"stringCol", @"a")],
+                                      @"must be included in '\\+fullTextIndexedProperties'");
+    RLMAssertThrowsWithReasonMatching([FullTextIndexedObject objectsWithPredicate:RLMTextSearchPredicate(@"text", (NSString *)@1)],
+                                      @"requires a string of words");
+}
+
+- (void)testOrderedIndex
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 100; i++) {
+        int value = (i * 37) % 100;
+        [OrderedIndexedObject createInRealm:realm withValue:@[@(value), @(value / 10.0),
+                                                              [NSDate dateWithTimeIntervalSince1970:value],
+                                                              [NSString stringWithFormat:@"%02d", value]]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *(^query)(NSString *) = ^(NSString *format) {
+        return [self evaluate:[OrderedIndexedObject objectsWhere:format]];
+    };
+    void (^assertSorted)(RLMResults *, NSString *, BOOL) = ^(RLMResults *results, NSString *keyPath, BOOL ascending) {
+        NSArray *values = [results valueForKey:keyPath];
+        NSArray *sorted = [values sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"self" ascending:ascending]]];
+        XCTAssertEqualObjects(sorted, values);
+    };
+
+    // Range queries
+    XCTAssertEqual(10U, query(@"intCol < 10").count);
+    XCTAssertEqual(11U, query(@"intCol <= 10").count);
+    XCTAssertEqual(10U, query(@"10 > intCol").count);
+    XCTAssertEqual(89U, query(@"intCol > 10").count);
+    XCTAssertEqual(5U, query(@"intCol BETWEEN {20, 24}").count);
+    XCTAssertEqual(4U, query(@"doubleCol >= 9.6").count);
+    XCTAssertEqual(3U, query(@"dateCol > %@", [NSDate dateWithTimeIntervalSince1970:96]).count);
+    XCTAssertEqual(2U, query(@"intCol > 5 AND intCol < 8").count);
+    XCTAssertEqual(11U, query(@"intCol < 10 OR intCol == 50").count);
+    XCTAssertEqual(90U, query(@"NOT intCol < 10").count);
+    XCTAssertEqual(0U, query(@"intCol > 200").count);
+
+    // Sorting
+    assertSorted([OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"intCol" ascending:YES], @"intCol", YES);
+    assertSorted([OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"dateCol" ascending:NO], @"dateCol", NO);
+    assertSorted([OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"stringCol" ascending:YES], @"stringCol", YES);
+    RLMResults *filtered = [[OrderedIndexedObject objectsWhere:@"intCol >= 50"] sortedResultsUsingKeyPath:@"doubleCol" ascending:NO];
+    XCTAssertEqual(50U, filtered.count);
+    XCTAssertEqualObjects(@99, [filtered.firstObject valueForKey:@"intCol"]);
+    assertSorted(filtered, @"doubleCol", NO);
+
+    // The index is updated when the property is set and objects are deleted
+    RLMResults *sorted = [OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"intCol" ascending:YES];
+    OrderedIndexedObject *first = sorted.firstObject, *last = sorted.lastObject;
+    [realm beginWriteTransaction];
+    first.intCol = 1000;
+    last.intCol = -5;
+    [realm deleteObjects:[OrderedIndexedObject objectsWhere:@"intCol BETWEEN {40, 49}"]];
+    [OrderedIndexedObject createInRealm:realm withValue:@[@45, @4.5, NSDate.date, @"45"]];
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(91U, sorted.count);
+    assertSorted(sorted, @"intCol", YES);
+    assertSorted([OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"intCol" ascending:NO], @"intCol", NO);
+    XCTAssertEqualObjects(@-5, [sorted.firstObject valueForKey:@"intCol"]);
+    XCTAssertEqualObjects(@1000, [sorted.lastObject valueForKey:@"intCol"]);
+    XCTAssertEqual(1U, query(@"intCol BETWEEN {40, 49}").count);
+    XCTAssertEqual(1U, query(@"intCol > 100").count);
+    XCTAssertEqual(2U, query(@"intCol < 2").count);
+}
+
+- (void)testOrderedIndexSortKeepsOrderOfEqualValues
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; i++) {
+        [OrderedIndexedObject createInRealm:realm withValue:@[@(i % 2), @(i), NSDate.date,
+                                                              [NSString stringWithFormat:@"%d", i]]];
+    }
+    [realm commitWriteTransaction];
+
+    NSArray *ascending = [[OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"intCol" ascending:YES]
+                          valueForKey:@"doubleCol"];
+    NSArray *descending = [[OrderedIndexedObject.allObjects sortedResultsUsingKeyPath:@"intCol" ascending:NO]
+                           valueForKey:@"doubleCol"];
+    XCTAssertEqualObjects((@[@0, @2, @4, @6, @8, @1, @3, @5, @7, @9]), ascending);
+    XCTAssertEqualObjects((@[@1, @3, @5, @7, @9, @0, @2, @4, @6, @8]), descending);
+}
+
+- (void)testCompositeIndex
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    PrimaryStringObject *conversation1 = [PrimaryStringObject createInRealm:realm withValue:@[@"a", @1]];
+    PrimaryStringObject *conversation2 = [PrimaryStringObject createInRealm:realm withValue:@[@"b", @2]];
+    for (int i = 0; i < 100; i++) {
+        [CompositeIndexedObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"user%d", i % 4],
+                                                                [NSDate dateWithTimeIntervalSince1970:i],
+                                                                i % 3 ? conversation1 : conversation2,
+                                                                @(i % 2 == 0)]];
+    }
+    PrimaryStringObject *unlinked = [PrimaryStringObject createInRealm:realm withValue:@[@"c", @3]];
+    [realm commitWriteTransaction];
+
+    RLMResults *(^query)(NSString *, ...) = ^(NSString *format, ...) {
+        va_list args;
+        va_start(args, format);
+        RLMResults *results = [CompositeIndexedObject objectsWhere:format args:args];
+        va_end(args);
+        return [self evaluate:results];
+    };
+    NSDate *date50 = [NSDate dateWithTimeIntervalSince1970:50];
+    NSDate *date60 = [NSDate dateWithTimeIntervalSince1970:60];
+
+    // Equality on the leading property with a comparison on the last one
+    XCTAssertEqual(12U, query(@"userId == 'user1' AND createdAt > %@", date50).count);
+    XCTAssertEqual(12U, query(@"%@ < createdAt AND userId == 'user2'", date50).count);
+    XCTAssertEqual(13U, query(@"userId == 'user0' AND createdAt <= %@", date50).count);
+    XCTAssertEqual(1U, query(@"userId == 'user2' AND createdAt == %@", date50).count);
+    XCTAssertEqual(3U, query(@"userId == 'user0' AND createdAt BETWEEN %@", @[date50, date60]).count);
+    XCTAssertEqual(2U, query(@"userId == 'user0' AND createdAt > %@ AND createdAt < %@", date50, date60).count);
+    XCTAssertEqual(0U, query(@"userId == 'user9' AND createdAt > %@", date50).count);
+
+    // Links to objects with a primary key
+    XCTAssertEqual(17U, query(@"conversation == %@ AND unread == true", conversation2).count);
+    XCTAssertEqual(33U, query(@"unread == false AND conversation == %@", conversation1).count);
+    XCTAssertEqual(0U, query(@"conversation == %@ AND unread == true", unlinked).count);
+    XCTAssertEqual(67U, query(@"conversation == %@ OR unread == true", conversation2).count);
+
+    // Subpredicates not covered by an index are still applied
+    XCTAssertEqual(5U, query(@"conversation == %@ AND unread == true AND userId == 'user0' AND createdAt < %@",
+                             conversation2, date50).count);
+    XCTAssertEqual(12U, query(@"userId == 'user1' AND (createdAt > %@ AND unread == false)", date50).count);
+    XCTAssertEqual(0U, query(@"userId == 'user1' AND createdAt > %@ AND unread == true", date50).count);
+
+    // The indexes are updated when objects are modified or deleted
+    RLMResults *unread = [CompositeIndexedObject objectsWhere:@"conversation == %@ AND unread == true", conversation2];
+    CompositeIndexedObject *read = [CompositeIndexedObject objectsWhere:@"userId == 'user0'"].firstObject;
+    CompositeIndexedObject *moved = [CompositeIndexedObject objectsWhere:@"userId == 'user2'"].firstObject;
+    [realm beginWriteTransaction];
+    read.unread = false;
+    moved.conversation = conversation2;
+    moved.createdAt = [NSDate dateWithTimeIntervalSince1970:1000];
+    [realm deleteObjects:[CompositeIndexedObject objectsWhere:@"userId == 'user3'"]];
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(17U, [self evaluate:unread].count);
+    XCTAssertEqual((NSUInteger)NSNotFound, [unread indexOfObject:read]);
+    XCTAssertNotEqual((NSUInteger)NSNotFound, [unread indexOfObject:moved]);
+    XCTAssertEqual(1U, query(@"userId == 'user2' AND createdAt > %@", [NSDate dateWithTimeIntervalSince1970:999]).count);
+    XCTAssertEqual(0U, query(@"userId == 'user3' AND createdAt > %@", date50).count);
+
+    // Deleting a linked object nullifies the links in the index along with
+    // the links of the objects
+    [realm beginWriteTransaction];
+    [realm deleteObject:conversation2];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(32U, query(@"conversation == %@ AND unread == true", conversation1).count);
+    XCTAssertEqual(32U, [[CompositeIndexedObject objectsWhere:@"conversation == %@", conversation1]
+                         objectsWhere:@"unread == true"].count);
+}
+
+- (void)testCompositeIndexIsUpdatedBySettingLinksDynamically
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    PrimaryStringObject *conversation1 = [PrimaryStringObject createInRealm:realm withValue:@[@"a", @1]];
+    PrimaryStringObject *conversation2 = [PrimaryStringObject createInRealm:realm withValue:@[@"b", @2]];
+    CompositeIndexedObject *obj = [CompositeIndexedObject createInRealm:realm withValue:@[@"user", NSDate.date,
+                                                                                          conversation1, @YES]];
+    [realm commitWriteTransaction];
+
+    RLMResults *(^unread)(PrimaryStringObject *) = ^(PrimaryStringObject *conversation) {
+        return [self evaluate:[CompositeIndexedObject objectsWhere:@"conversation == %@ AND unread == true", conversation]];
+    };
+    XCTAssertEqual(1U, unread(conversation1).count);
+    XCTAssertEqual(0U, unread(conversation2).count);
+
+    [realm beginWriteTransaction];
+    obj[@"conversation"] = conversation2;
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, unread(conversation1).count);
+    XCTAssertEqual(1U, unread(conversation2).count);
+
+    [realm beginWriteTransaction];
+    obj[@"conversation"] = nil;
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, unread(conversation2).count);
+}
+
+- (void)testCaseInsensitiveIndex
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"Alice", @1]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"alice", @2]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"ALICE Smith", @3]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"Álice", @4]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"Bob", @5]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[NSNull.null, @6]];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"Al", @7]];
+    for (int i = 0; i < 20; ++i) {
+        [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[[NSString stringWithFormat:@"Other %d", i], @(100 + i)]];
+    }
+    [realm commitWriteTransaction];
+
+    NSUInteger (^count)(NSString *) = ^(NSString *format) {
+        return [self evaluate:[CaseInsensitiveIndexedObject objectsWhere:format]].count;
+    };
+
+    // The index only narrows down the candidates, so diacritics still have
+    // to match unless the predicate is also diacritic insensitive
+    XCTAssertEqual(2U, count(@"name ==[c] 'alice'"));
+    XCTAssertEqual(3U, count(@"name ==[cd] 'alice'"));
+    XCTAssertEqual(2U, count(@"name ==[d] 'Alice'"));
+    XCTAssertEqual(2U, count(@"'ALICE' ==[c] name"));
+    XCTAssertEqual(4U, count(@"name BEGINSWITH[c] 'al'"));
+    XCTAssertEqual(5U, count(@"name BEGINSWITH[cd] 'al'"));
+    XCTAssertEqual(0U, count(@"name ==[c] 'zed'"));
+    XCTAssertEqual(1U, count(@"name ==[c] 'alice' AND intCol > 1"));
+    XCTAssertEqual(25U, count(@"NOT (name ==[c] 'alice')"));
+    XCTAssertEqual(23U, count(@"NOT (name BEGINSWITH[c] 'al')"));
+    XCTAssertEqual(20U, count(@"name BEGINSWITH[c] 'OTHER'"));
+
+    // The index is updated when the property is set and objects are deleted
+    [realm beginWriteTransaction];
+    [CaseInsensitiveIndexedObject objectsWhere:@"intCol = 2"].firstObject.name = @"Bob";
+    [CaseInsensitiveIndexedObject objectsWhere:@"intCol = 7"].firstObject.name = nil;
+    [realm deleteObject:[CaseInsensitiveIndexedObject objectsWhere:@"intCol = 1"].firstObject];
+    [realm commitWriteTransaction];
+    XCTAssertEqual(0U, count(@"name ==[c] 'alice'"));
+    XCTAssertEqual(1U, count(@"name ==[cd] 'alice'"));
+    XCTAssertEqual(2U, count(@"name ==[c] 'BOB'"));
+    XCTAssertEqual(1U, count(@"name BEGINSWITH[c] 'al'"));
+}
+
+- (void)testAndConditionsAreEvaluatedCheapestFirst
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [PrimaryStringObject createInRealm:realm withValue:@[@(i).stringValue, @(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [self evaluate:[PrimaryStringObject objectsWhere:@"stringCol CONTAINS[cd] '5' AND intCol > 2 AND stringCol == '5'"]];
+    XCTAssertEqual(1U, results.count);
+    XCTAssertEqualObjects([results explain],
+                          @"Query on 'PrimaryStringObject' (object count: 10):\n"
+                          @"  1. stringCol == \"5\": search index, estimated cost 1, examined 10, matched 1\n"
+                          @"  2. intCol > 2: scan, estimated cost 10, examined 1, matched 1\n"
+                          @"  3. stringCol CONTAINS[cd] \"5\": scan, estimated cost 225, examined 1, matched 1\n"
+                          @"Result count: 1");
+
+    // Each condition examines only the objects matched by the ones before it
+    results = [self evaluate:[PrimaryStringObject objectsWhere:@"stringCol CONTAINS[cd] '7' AND intCol >= 3"]];
+    XCTAssertEqualObjects([results explain],
+                          @"Query on 'PrimaryStringObject' (object count: 10):\n"
+                          @"  1. intCol >= 3: scan, estimated cost 10, examined 10, matched 7\n"
+                          @"  2. stringCol CONTAINS[cd] \"7\": scan, estimated cost 225, examined 7, matched 1\n"
+                          @"Result count: 1");
+
+    // Filtering results combines the predicates
+    results = [[PrimaryStringObject objectsWhere:@"intCol > 2"] objectsWhere:@"stringCol == '5'"];
+    XCTAssertEqualObjects([[self evaluate:results] explain],
+                          @"Query on 'PrimaryStringObject' (object count: 10):\n"
+                          @"  1. stringCol == \"5\": search index, estimated cost 1, examined 10, matched 1\n"
+                          @"  2. intCol > 2: scan, estimated cost 10, examined 1, matched 1\n"
+                          @"Result count: 1");
+
+    // Sorting keeps the predicate, and unfiltered results examine every object
+    results = [[PrimaryStringObject objectsWhere:@"intCol < 3 OR intCol > 8"] sortedResultsUsingKeyPath:@"intCol" ascending:NO];
+    XCTAssertEqualObjects([[self evaluate:results] explain],
+                          @"Query on 'PrimaryStringObject' (object count: 10):\n"
+                          @"  1. intCol < 3 OR intCol > 8: compound predicate, estimated cost 20, examined 10, matched 4\n"
+                          @"Result count: 4");
+    XCTAssertEqualObjects([[PrimaryStringObject allObjects] explain],
+                          @"Query on 'PrimaryStringObject' (object count: 10):\n"
+                          @"  1. all objects: scan\n"
+                          @"Result count: 10");
+}
+
+- (void)testArithmeticExpressions
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [AggregateObject createInRealm:realm withValue:@[@(i), @(i * 1.5f), @(10 - i), @NO,
+                                                         [NSDate dateWithTimeIntervalSince1970:i * 1000]]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMAssertCount(AggregateObject, 4U, @"intCol * 2 > 10");
+    RLMAssertCount(AggregateObject, 4U, @"20 < intCol * 4");
+    RLMAssertCount(AggregateObject, 10U, @"intCol + doubleCol == 10");
+    RLMAssertCount(AggregateObject, 5U, @"doubleCol - intCol > 0");
+    RLMAssertCount(AggregateObject, 10U, @"floatCol * 2 == intCol * 3");
+    RLMAssertCount(AggregateObject, 5U, @"(intCol + 1) * (doubleCol - 1) > 20");
+
+    // Division is not integer division, and dividing by zero gives infinity
+    RLMAssertCount(AggregateObject, 1U, @"intCol / 2 == 2.5");
+    RLMAssertCount(AggregateObject, 6U, @"doubleCol / intCol >= 1");
+
+    // Dates are seconds since 1970
+    NSDate *epoch = [NSDate dateWithTimeIntervalSince1970:0];
+    RLMAssertCount(AggregateObject, 5U, @"dateCol - %@ >= 5000", epoch);
+    RLMAssertCount(AggregateObject, 3U, @"dateCol + 2000 < %@", [NSDate dateWithTimeIntervalSince1970:5000]);
+
+    NSExpression *intCol = [NSExpression expressionForKeyPath:@"intCol"];
+    NSExpression *modulus = [NSExpression expressionForFunction:@"modulus:by:"
+                                                      arguments:@[intCol, [NSExpression expressionForConstantValue:@3]]];
+    NSPredicate *predicate = [NSComparisonPredicate predicateWithLeftExpression:modulus
+                                                                rightExpression:[NSExpression expressionForConstantValue:@0]
+                                                                       modifier:NSDirectPredicateModifier
+                                                                           type:NSEqualToPredicateOperatorType
+                                                                        options:0];
+    XCTAssertEqual(4U, [self evaluate:[AggregateObject objectsWithPredicate:predicate]].count);
+
+    NSExpression *abs = [NSExpression expressionForFunction:@"abs:"
+                                                  arguments:@[[NSExpression expressionWithFormat:@"doubleCol - 5"]]];
+    predicate = [NSComparisonPredicate predicateWithLeftExpression:abs
+                                                   rightExpression:[NSExpression expressionForConstantValue:@1]
+                                                          modifier:NSDirectPredicateModifier
+                                                              type:NSLessThanOrEqualToPredicateOperatorType
+                                                           options:0];
+    XCTAssertEqual(3U, [self evaluate:[AggregateObject objectsWithPredicate:predicate]].count);
+
+    RLMAssertThrowsWithReasonMatching([AggregateObject objectsWhere:@"boolCol + 1 > 0"],
+                                      @"Arithmetic is only supported on numeric and date properties, but 'boolCol'");
+    RLMAssertThrowsWithReasonMatching([AggregateObject objectsWhere:@"intCol + 1 == nil"],
+                                      @"Arithmetic expressions cannot be used with nil");
+    RLMAssertThrowsWithReasonMatching([AggregateObject objectsWhere:@"intCol + 'a' == 1"],
+                                      @"Arithmetic is only supported on numbers and dates");
+}
+
+- (void)testArithmeticExpressionsSaturateAtIntegerLimits
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (NSNumber *value in @[@(INT64_MIN), @(INT64_MIN + 1), @-1, @1, @(INT64_MAX)]) {
+        [AllIntSizesObject createInRealm:realm withValue:@[@0, @0, value]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMAssertCount(AllIntSizesObject, 1U, @"int64 + 1 == %@", @(INT64_MAX));
+    RLMAssertCount(AllIntSizesObject, 2U, @"int64 + -1 == %@", @(INT64_MIN));
+    RLMAssertCount(AllIntSizesObject, 2U, @"int64 - 1 == %@", @(INT64_MIN));
+    RLMAssertCount(AllIntSizesObject, 1U, @"int64 - -1 == %@", @(INT64_MAX));
+    RLMAssertCount(AllIntSizesObject, 1U, @"int64 * 2 == %@", @(INT64_MAX));
+    RLMAssertCount(AllIntSizesObject, 2U, @"int64 * -2 == %@", @(INT64_MAX));
+    RLMAssertCount(AllIntSizesObject, 2U, @"int64 * 2 == %@", @(INT64_MIN));
+    RLMAssertCount(AllIntSizesObject, 2U, @"int64 * -1 == %@", @(INT64_MAX));
+
+    NSExpression *abs = [NSExpression expressionForFunction:@"abs:"
+                                                  arguments:@[[NSExpression expressionForKeyPath:@"int64"]]];
+    NSPredicate *predicate = [NSComparisonPredicate predicateWithLeftExpression:abs
+                                                                rightExpression:[NSExpression expressionForConstantValue:@(INT64_MAX)]
+                                                                       modifier:NSDirectPredicateModifier
+                                                                           type:NSEqualToPredicateOperatorType
+                                                                        options:0];
+    XCTAssertEqual(3U, [self evaluate:[AllIntSizesObject objectsWithPredicate:predicate]].count);
+}
+
+- (void)testRegularExpressions
+{
+    RLMRealm *realm = [self realm];
+
+    [realm beginWriteTransaction];
+    for (NSString *value in @[@"abc", @"ABC", @"abcabc", @"a.c", @"a1c", @"a22c", @"xyz", @"", @"ünïcödé", @"line\nbreak"]) {
+        StringObject *so = [StringObject createInRealm:realm withValue:@[value]];
+        [LinkStringObject createInRealm:realm withValue:@[so]];
+    }
+    [realm commitWriteTransaction];
+
+    // The whole value has to match
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES 'abc'");
+    RLMAssertCount(StringObject, 0U, @"stringCol MATCHES 'ab'");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES %@", @"a\\.c");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES ''");
+
+    RLMAssertCount(StringObject, 3U, @"stringCol MATCHES 'a.c'");
+    RLMAssertCount(StringObject, 2U, @"stringCol MATCHES %@", @"a\\d+c");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES %@", @"a\\d{2}c");
+    RLMAssertCount(StringObject, 2U, @"stringCol MATCHES '(abc)+'");
+    RLMAssertCount(StringObject, 3U, @"stringCol MATCHES '^(abc|xyz|a[0-9]c)$'");
+    RLMAssertCount(StringObject, 7U, @"stringCol MATCHES '[^x].*'");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES '.*cöd.*'");
+    RLMAssertCount(StringObject, 7U, @"stringCol MATCHES %@", @"\\w+");
+    RLMAssertCount(StringObject, 0U, @"stringCol MATCHES 'line.break'");
+    RLMAssertCount(StringObject, 9U, @"NOT stringCol MATCHES 'abc'");
+
+    RLMAssertCount(StringObject, 2U, @"stringCol MATCHES[c] 'abc'");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES[c] 'ÜNÏ.*'");
+    RLMAssertThrowsWithReasonMatching([StringObject objectsWhere:@"stringCol MATCHES[d] 'abc'"],
+                                      @"not supported with diacritic-insensitive modifier");
+
+    // Features which are matched with NSRegularExpression
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES %@", @"(abc)\\1");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES[c] 'ünïcödÉ'");
+    RLMAssertCount(StringObject, 3U, @"stringCol MATCHES '(?!abc)a.*c'");
+
+    RLMAssertThrowsWithReasonMatching([StringObject objectsWhere:@"stringCol MATCHES '(abc'"],
+                                      @"not a valid regular expression");
+
+    RLMAssertCount(LinkStringObject, 2U, @"objectCol.stringCol MATCHES %@", @"a\\d+c");
+    RLMAssertCount(LinkStringObject, 2U, @"objectCol.stringCol MATCHES[c] 'abc'");
+
+    // Values outside of ASCII follow ICU's case folding and classes
+    [realm beginWriteTransaction];
+    for (NSString *value in @[@"\u017F", @"\u212A", @"\u0663"]) {
+        [StringObject createInRealm:realm withValue:@[value]];
+    }
+    [realm commitWriteTransaction];
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES[c] 's'");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES[c] 'k'");
+    RLMAssertCount(StringObject, 1U, @"stringCol MATCHES %@", @"\\d");
+
+    // Characters outside of the BMP are a single character when matched with
+    // NSRegularExpression
+    [realm beginWriteTransaction];
+    [StringObject createInRealm:realm withValue:@[@"x\U0001F600z"]];
+    [realm commitWriteTransaction];
+    RLMAssertCount(StringObject, 2U, @"stringCol MATCHES[c] 'X.Z'");
+    RLMAssertCount(StringObject, 0U, @"stringCol MATCHES[c] 'X..Z'");
+
+    // Patterns with a literal prefix use the case-insensitive index
+    [realm beginWriteTransaction];
+    for (NSString *name in @[@"John", @"joan", @"Jöhn", @"Johnny", @"Ann"]) {
+        [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[name, @0]];
+    }
+    [realm commitWriteTransaction];
+    RLMAssertCount(CaseInsensitiveIndexedObject, 2U, @"name MATCHES[c] 'jo.n'");
+    RLMAssertCount(CaseInsensitiveIndexedObject, 1U, @"name MATCHES 'Jo.n'");
+    RLMAssertCount(CaseInsensitiveIndexedObject, 2U, @"name MATCHES 'John.*'");
+    RLMAssertCount(CaseInsensitiveIndexedObject, 2U, @"NOT name MATCHES[c] 'jo.*'");
+}
+
 @end
 
 @interface AsyncQueryTests : QueryTests
@@ -88,6 +88,23 @@
 @property NSString *stringCol;
 @end
 
+@interface FullTextIndexedObject : RLMObject
+@property NSString *text;
+@property int intCol;
+@end
+
+@interface OrderedIndexedObject : RLMObject
+@property int intCol;
+@property double doubleCol;
+@property NSDate *dateCol;
+@property NSString *stringCol;
+@end
+
+@interface CaseInsensitiveIndexedObject : RLMObject
+@property NSString *name;
+@property int intCol;
+@end
+
 RLM_ARRAY_TYPE(StringObject)
 RLM_ARRAY_TYPE(IntObject)
 
@@ -303,6 +320,13 @@ RLM_ARRAY_TYPE(AggregateObject)
 @property int intCol;
 @end
 
+@interface CompositeIndexedObject : RLMObject
+@property NSString *userId;
+@property NSDate *createdAt;
+@property PrimaryStringObject *conversation;
+@property bool unread;
+@end
+
 @interface PrimaryNullableStringObject : RLMObject
 @property NSString *stringCol;
 @property int intCol;
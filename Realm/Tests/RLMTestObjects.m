@@ -57,6 +57,24 @@
 }
 @end
 
+@implementation FullTextIndexedObject
++ (NSArray *)fullTextIndexedProperties {
+    return @[@"text"];
+}
+@end
+
+@implementation OrderedIndexedObject
++ (NSArray *)orderedIndexedProperties {
+    return @[@"intCol", @"doubleCol", @"dateCol", @"stringCol"];
+}
+@end
+
+@implementation CaseInsensitiveIndexedObject
++ (NSArray *)caseInsensitiveIndexedProperties {
+    return @[@"name"];
+}
+@end
+
 @implementation LinkStringObject
 @end
 
@@ -215,6 +233,12 @@
 }
 @end
 
+@implementation CompositeIndexedObject
++ (NSArray *)compositeIndexes {
+    return @[@[@"userId", @"createdAt"], @[@"conversation", @"unread"]];
+}
+@end
+
 @implementation PrimaryNullableStringObject
 + (NSString *)primaryKey {
     return @"stringCol";
@@ -323,6 +347,10 @@
 + (Class)objectUtilClass:(BOOL)isSwift { return RLMObjectUtilClass(isSwift); }
 + (NSArray *)ignoredProperties { return nil; }
 + (NSArray *)indexedProperties { return nil; }
++ (NSArray *)fullTextIndexedProperties { return nil; }
++ (NSArray *)orderedIndexedProperties { return nil; }
++ (NSArray *)compositeIndexes { return nil; }
++ (NSArray *)caseInsensitiveIndexedProperties { return nil; }
 + (NSString *)primaryKey { return nil; }
 + (NSArray *)requiredProperties { return nil; }
 + (NSDictionary *)linkingObjectsProperties { return nil; }
@@ -18,8 +18,10 @@
 
 #import "RLMTestCase.h"
 
+#import "RLMIndexTables_Private.hpp"
 #import "RLMObjectSchema_Private.hpp"
 #import "RLMRealmConfiguration_Private.hpp"
+#import "RLMRealm_Private.hpp"
 #import "RLMRealm_Dynamic.h"
 #import "RLMSchema_Private.h"
 #import "RLMRealmUtil.hpp"
@@ -29,6 +31,9 @@
 #import <sys/resource.h>
 #import <thread>
 
+#import "object_store.hpp"
+
+#import <realm/table.hpp>
 #import <realm/util/file.hpp>
 
 @interface RLMRealm ()
@@ -372,6 +377,26 @@
     assertNoCachedRealm();
 }
 
+- (void)testOpeningRealmAtDifferentPathDuringMigration {
+    @autoreleasepool {
+        [self realmWithTestPath];
+    }
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.fileURL = RLMTestRealmURL();
+    config.schemaVersion = 1;
+    __block bool migrationCalled = false;
+    config.migrationBlock = ^(__unused RLMMigration *migration, __unused uint64_t oldSchemaVersion) {
+        migrationCalled = true;
+        // Would deadlock if opening a Realm took a lock shared by all paths
+        [self dispatchAsyncAndWait:^{
+            XCTAssertNoThrow([RLMRealm defaultRealm]);
+        }];
+    };
+    XCTAssertNoThrow([RLMRealm realmWithConfiguration:config error:nil]);
+    XCTAssertTrue(migrationCalled);
+}
+
 #pragma mark - Adding and Removing Objects
 
 - (void)testRealmAddAndRemoveObjects {
@@ -1491,6 +1516,115 @@
     }];
 }
 
+#pragma mark - Realm Pools
+
+- (void)testRealmPoolReusesRealmOnSameThread {
+    @autoreleasepool {
+        RLMRealmPool *pool = [RLMRealmPool poolWithConfiguration:[RLMRealmConfiguration defaultConfiguration] error:nil];
+        XCTAssertNotNil(pool);
+        XCTAssertEqual(pool.count, 1U);
+
+        __block RLMRealm *first, *second;
+        std::thread([&] {
+            [pool performWithRealm:^(RLMRealm *realm) { first = realm; }];
+            [pool performWithRealm:^(RLMRealm *realm) { second = realm; }];
+        }).join();
+        XCTAssertEqual(first, second);
+        // The thread's Realm is released when the thread exits
+        XCTAssertEqual(pool.count, 1U);
+
+        [pool performWithRealm:^(RLMRealm *realm) {
+            XCTAssertEqual(realm, RLMRealm.defaultRealm);
+        }];
+        XCTAssertEqual(pool.count, 1U);
+        first = second = nil;
+    }
+}
+
+- (void)testRealmPoolDrain {
+    @autoreleasepool {
+        RLMRealmPool *pool = [RLMRealmPool poolWithConfiguration:[RLMRealmConfiguration defaultConfiguration] error:nil];
+        dispatch_semaphore_t performed = dispatch_semaphore_create(0);
+        dispatch_semaphore_t drained = dispatch_semaphore_create(0);
+        std::thread thread([&] {
+            [pool performWithRealm:^(RLMRealm *) { }];
+            dispatch_semaphore_signal(performed);
+            dispatch_semaphore_wait(drained, DISPATCH_TIME_FOREVER);
+        });
+        dispatch_semaphore_wait(performed, DISPATCH_TIME_FOREVER);
+        XCTAssertEqual(pool.count, 2U);
+
+        [pool drain];
+        XCTAssertEqual(pool.count, 1U);
+        dispatch_semaphore_signal(drained);
+        thread.join();
+    }
+}
+
+- (void)testRealmPoolInvalidatesAfterBlock {
+    @autoreleasepool {
+        RLMRealmPool *pool = [RLMRealmPool poolWithConfiguration:[RLMRealmConfiguration defaultConfiguration] error:nil];
+        [self dispatchAsyncAndWait:^{
+            __block IntObject *object;
+            [pool performWithRealm:^(RLMRealm *realm) {
+                [realm transactionWithBlock:^{
+                    object = [IntObject createInRealm:realm withValue:@[@1]];
+                }];
+                [pool performWithRealm:^(RLMRealm *) {
+                    // Nested blocks leave the enclosing block's read transaction alone
+                    XCTAssertFalse(object.invalidated);
+                }];
+                XCTAssertFalse(object.invalidated);
+            }];
+            XCTAssertTrue(object.invalidated);
+        }];
+    }
+}
+
+- (void)testRealmPoolRefreshesBeforeBlock {
+    @autoreleasepool {
+        RLMRealmPool *pool = [RLMRealmPool poolWithConfiguration:[RLMRealmConfiguration defaultConfiguration] error:nil];
+        [self dispatchAsyncAndWait:^{
+            [pool performWithRealm:^(RLMRealm *realm) {
+                XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+            }];
+        }];
+
+        RLMRealm *realm = RLMRealm.defaultRealm;
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@1]];
+        }];
+
+        [self dispatchAsyncAndWait:^{
+            [pool performWithRealm:^(RLMRealm *realm) {
+                XCTAssertEqual(1U, [IntObject allObjectsInRealm:realm].count);
+            }];
+        }];
+    }
+}
+
+- (void)testRealmPoolCancelsWriteTransactionLeftOpen {
+    @autoreleasepool {
+        RLMRealmPool *pool = [RLMRealmPool poolWithConfiguration:[RLMRealmConfiguration defaultConfiguration] error:nil];
+        RLMAssertThrowsWithReasonMatching([pool performWithRealm:^(RLMRealm *realm) {
+            [realm beginWriteTransaction];
+            [IntObject createInRealm:realm withValue:@[@1]];
+        }], @"write transaction was left open");
+        [pool performWithRealm:^(RLMRealm *realm) {
+            XCTAssertFalse(realm.inWriteTransaction);
+            XCTAssertEqual(0U, [IntObject allObjectsInRealm:realm].count);
+        }];
+    }
+}
+
+- (void)testRealmPoolWithInvalidConfiguration {
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.readOnly = true;
+    NSError *error;
+    XCTAssertNil([RLMRealmPool poolWithConfiguration:config error:&error]);
+    XCTAssertEqual(error.code, RLMErrorFileNotFound);
+}
+
 #pragma mark - In-memory Realms
 
 - (void)testInMemoryRealm {
@@ -1685,6 +1819,319 @@
     }];
 }
 
+- (void)testWriteCopyWithBlock
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@0]];
+    }];
+
+    NSMutableData *data = [NSMutableData new];
+    NSError *writeError;
+    XCTAssertTrue([realm writeCopyWithBlock:^BOOL(NSData *chunk) {
+        [data appendData:chunk];
+        return YES;
+    } maximumBytesPerSecond:0 error:&writeError]);
+    XCTAssertNil(writeError);
+    XCTAssertGreaterThan(data.length, 0U);
+
+    [data writeToURL:RLMTestRealmURL() atomically:NO];
+    RLMRealm *copy = [self realmWithTestPath];
+    XCTAssertEqual(1U, [IntObject allObjectsInRealm:copy].count);
+}
+
+- (void)testWriteCopyWithBlockCancelled
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    NSError *writeError;
+    XCTAssertFalse([realm writeCopyWithBlock:^BOOL(NSData *) { return NO; }
+                       maximumBytesPerSecond:0 error:&writeError]);
+    XCTAssertEqualObjects(writeError.domain, NSPOSIXErrorDomain);
+    XCTAssertEqual(writeError.code, ECANCELED);
+}
+
+- (void)testWriteCopyWithBlockIsThrottled
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 1000; ++i) {
+            [StringObject createInRealm:realm withValue:@[NSUUID.UUID.UUIDString]];
+        }
+    }];
+
+    __block NSUInteger size = 0;
+    [realm writeCopyWithBlock:^BOOL(NSData *chunk) { size += chunk.length; return YES; }
+        maximumBytesPerSecond:0 error:nil];
+
+    // Limit the rate so that writing the copy should take about a quarter second
+    NSDate *start = [NSDate date];
+    XCTAssertTrue([realm writeCopyWithBlock:^BOOL(NSData *) { return YES; }
+                      maximumBytesPerSecond:size * 4 error:nil]);
+    XCTAssertGreaterThan(-start.timeIntervalSinceNow, 0.2);
+}
+
+- (void)testWriteCopyToFileDescriptor
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@0]];
+    }];
+
+    int fd = open(RLMTestRealmURL().path.UTF8String, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    XCTAssertNotEqual(-1, fd);
+    NSError *writeError;
+    XCTAssertTrue([realm writeCopyToFileDescriptor:fd maximumBytesPerSecond:0 error:&writeError]);
+    XCTAssertNil(writeError);
+    close(fd);
+
+    RLMRealm *copy = [self realmWithTestPath];
+    XCTAssertEqual(1U, [IntObject allObjectsInRealm:copy].count);
+}
+
+- (void)testWriteIncrementalCopy
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 100000; ++i) {
+            [IntObject createInRealm:realm withValue:@[@(i + 100000)]];
+        }
+    }];
+    NSData *(^fullCopy)(void) = ^{
+        NSMutableData *data = [NSMutableData new];
+        [realm writeCopyWithBlock:^BOOL(NSData *chunk) { [data appendData:chunk]; return YES; }
+            maximumBytesPerSecond:0 error:nil];
+        return data;
+    };
+
+    NSURL *backupURL = RLMTestRealmURL();
+    NSString *manifestPath = [backupURL.path stringByAppendingString:@".manifest"];
+    NSUInteger bytesWritten;
+    NSError *writeError;
+    XCTAssertTrue([realm writeIncrementalCopyToURL:backupURL maximumBytesPerSecond:0
+                                      bytesWritten:&bytesWritten error:&writeError]);
+    XCTAssertNil(writeError);
+    NSData *copy = fullCopy();
+    XCTAssertGreaterThan(copy.length, 4U * 64 * 1024);
+    XCTAssertEqual(bytesWritten, copy.length);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:backupURL], copy);
+    XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:manifestPath]);
+
+    // Nothing has changed, so nothing is written
+    XCTAssertTrue([realm writeIncrementalCopyToURL:backupURL maximumBytesPerSecond:0
+                                      bytesWritten:&bytesWritten error:nil]);
+    XCTAssertEqual(bytesWritten, 0U);
+
+    // Changing a value in place only rewrites the blocks around it
+    [realm transactionWithBlock:^{
+        [[IntObject allObjectsInRealm:realm].firstObject setIntCol:100001];
+    }];
+    XCTAssertTrue([realm writeIncrementalCopyToURL:backupURL maximumBytesPerSecond:0
+                                      bytesWritten:&bytesWritten error:nil]);
+    copy = fullCopy();
+    XCTAssertGreaterThan(bytesWritten, 0U);
+    XCTAssertLessThan(bytesWritten, copy.length / 2);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:backupURL], copy);
+
+    // Removing objects shrinks the backup
+    [realm transactionWithBlock:^{
+        [realm deleteObjects:[IntObject objectsInRealm:realm where:@"intCol > 150000"]];
+    }];
+    XCTAssertTrue([realm writeIncrementalCopyToURL:backupURL maximumBytesPerSecond:0
+                                      bytesWritten:nil error:nil]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:backupURL], fullCopy());
+
+    // Without a manifest the backup can't be trusted, so all of it is written
+    [NSFileManager.defaultManager removeItemAtPath:manifestPath error:nil];
+    XCTAssertTrue([realm writeIncrementalCopyToURL:backupURL maximumBytesPerSecond:0
+                                      bytesWritten:&bytesWritten error:nil]);
+    XCTAssertEqual(bytesWritten, fullCopy().length);
+
+    RLMRealm *backup = [self realmWithTestPath];
+    XCTAssertEqual(50001U, [IntObject allObjectsInRealm:backup].count);
+}
+
+- (void)testWriteCopyToInvalidFileDescriptor
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    NSError *writeError;
+    XCTAssertFalse([realm writeCopyToFileDescriptor:-1 maximumBytesPerSecond:0 error:&writeError]);
+    XCTAssertEqualObjects(writeError.domain, NSPOSIXErrorDomain);
+    XCTAssertEqual(writeError.code, EBADF);
+}
+
+#pragma mark - Statistics
+
+- (void)testStatisticsCountWriteTransactionsAndCommits {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    RLMRealmStatistics *before = realm.statistics;
+    XCTAssertGreaterThanOrEqual(before.openRealmCount, 1U);
+
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@1]];
+    }];
+    [realm beginWriteTransaction];
+    [realm cancelWriteTransaction];
+
+    RLMRealmStatistics *after = realm.statistics;
+    XCTAssertEqual(after.writeTransactionCount - before.writeTransactionCount, 2U);
+    XCTAssertEqual(after.commitCount - before.commitCount, 1U);
+    XCTAssertGreaterThan(after.commitDuration, before.commitDuration);
+    XCTAssertGreaterThanOrEqual(after.writeLockWaitDuration, before.writeLockWaitDuration);
+
+    XCTAssertEqual(after.commitDurationHistogram.count, RLMRealmStatistics.commitDurationHistogramBounds.count + 1);
+    NSUInteger histogramTotal = [[after.commitDurationHistogram valueForKeyPath:@"@sum.self"] unsignedIntegerValue];
+    XCTAssertEqual(histogramTotal, after.commitCount);
+}
+
+- (void)testStatisticsAggregateRealmsOnAllThreads {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    NSUInteger commitsBefore = realm.statistics.commitCount;
+    NSUInteger openBefore = realm.statistics.openRealmCount;
+
+    [self dispatchAsyncAndWait:^{
+        @autoreleasepool {
+            RLMRealm *realm = [RLMRealm defaultRealm];
+            XCTAssertEqual(realm.statistics.openRealmCount, openBefore + 1);
+            [realm transactionWithBlock:^{
+                [IntObject createInRealm:realm withValue:@[@1]];
+            }];
+        }
+    }];
+
+    XCTAssertEqual(realm.statistics.commitCount, commitsBefore + 1);
+    XCTAssertEqual(realm.statistics.openRealmCount, openBefore);
+}
+
+- (void)testStatisticsCountAccessorsAndQueries {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [IntObject createInRealm:realm withValue:@[@1]];
+        [IntObject createInRealm:realm withValue:@[@2]];
+    }];
+
+    RLMRealmStatistics *before = realm.statistics;
+    RLMResults *results = [IntObject objectsInRealm:realm where:@"intCol > 0"];
+    XCTAssertEqual(results.count, 2U);
+    for (__unused IntObject *obj in results) {
+    }
+    RLMRealmStatistics *after = realm.statistics;
+    XCTAssertGreaterThanOrEqual(after.queryCount - before.queryCount, 1U);
+    XCTAssertGreaterThanOrEqual(after.accessorCount - before.accessorCount, 2U);
+}
+
+- (void)testStatisticsCountCollectionNotifications {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    NSUInteger before = realm.statistics.collectionNotificationCount;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@""];
+    RLMNotificationToken *token = [IntObject.allObjects addNotificationBlock:^(__unused RLMResults *results,
+                                                                               __unused RLMCollectionChange *change,
+                                                                               __unused NSError *error) {
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [token stop];
+
+    XCTAssertEqual(realm.statistics.collectionNotificationCount, before + 1);
+}
+
+- (void)testStatisticsBlockIsCalledPeriodically {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    XCTestExpectation *expectation = [self expectationWithDescription:@""];
+    __block int calls = 0;
+    RLMNotificationToken *token = [realm addStatisticsBlock:^(RLMRealmStatistics *statistics) {
+        XCTAssertNotNil(statistics);
+        if (++calls == 2) {
+            [expectation fulfill];
+        }
+    } interval:0.05];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    [token stop];
+
+    RLMAssertThrowsWithReasonMatching([realm addStatisticsBlock:^(__unused RLMRealmStatistics *statistics) {}
+                                                       interval:0],
+                                      @"must be greater than zero");
+}
+
+- (void)testStorageStatistics {
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.objectClasses = @[StringObject.class, IndexedStringObject.class];
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    [realm transactionWithBlock:^{
+        for (int i = 0; i < 1000; ++i) {
+            NSString *value = [NSString stringWithFormat:@"value %d", i];
+            [StringObject createInRealm:realm withValue:@[value]];
+            [IndexedStringObject createInRealm:realm withValue:@[value]];
+        }
+    }];
+
+    RLMStorageStatistics *statistics = realm.storageStatistics;
+    XCTAssertGreaterThan(statistics.fileSize, 0U);
+    XCTAssertGreaterThan(statistics.currentVersion, 0U);
+    XCTAssertEqual(statistics.objectClasses.count, 2U);
+
+    NSUInteger classBytes = 0;
+    for (RLMObjectStorageStatistics *objectClass in statistics.objectClasses) {
+        XCTAssertEqual(objectClass.objectCount, 1000U);
+        XCTAssertEqual(objectClass.properties.count, 1U);
+        RLMPropertyStorageStatistics *property = objectClass.properties.firstObject;
+        XCTAssertEqualObjects(property.name, @"stringCol");
+        XCTAssertGreaterThan(property.valueBytes, 0U);
+        XCTAssertEqual(property.totalBytes, property.valueBytes + property.indexBytes + property.enumerationBytes);
+        XCTAssertEqual(objectClass.totalBytes, property.totalBytes);
+        if ([objectClass.className isEqualToString:@"IndexedStringObject"]) {
+            XCTAssertGreaterThan(property.indexBytes, 0U);
+        }
+        else {
+            XCTAssertEqual(property.indexBytes, 0U);
+        }
+        classBytes += objectClass.totalBytes;
+    }
+    XCTAssertLessThan(classBytes + statistics.freeBytes, statistics.fileSize);
+
+    // Deleting the objects frees the space they used
+    NSUInteger freeBytes = statistics.freeBytes;
+    [realm transactionWithBlock:^{
+        [realm deleteAllObjects];
+    }];
+    statistics = realm.storageStatistics;
+    XCTAssertGreaterThan(statistics.freeBytes, freeBytes);
+    for (RLMObjectStorageStatistics *objectClass in statistics.objectClasses) {
+        XCTAssertEqual(objectClass.objectCount, 0U);
+    }
+}
+
+- (void)testStorageStatisticsReportVersionsKeptByReaders {
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{}];
+    RLMStorageStatistics *statistics = realm.storageStatistics;
+    XCTAssertEqual(statistics.oldestRetainedVersion + statistics.retainedVersionCount - 1, statistics.currentVersion);
+
+    // An instance which isn't refreshed keeps the version it is reading
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.cache = false;
+    RLMRealm *reader = [RLMRealm realmWithConfiguration:config error:nil];
+    reader.autorefresh = NO;
+    uint64_t readVersion = reader.storageStatistics.currentVersion;
+
+    for (int i = 0; i < 3; ++i) {
+        [realm transactionWithBlock:^{
+            [IntObject createInRealm:realm withValue:@[@(i)]];
+        }];
+    }
+    statistics = realm.storageStatistics;
+    XCTAssertEqual(statistics.currentVersion, readVersion + 3);
+    XCTAssertLessThanOrEqual(statistics.oldestRetainedVersion, readVersion);
+    XCTAssertGreaterThanOrEqual(statistics.retainedVersionCount, 4U);
+
+    // Once it advances, the next commit no longer keeps the old versions
+    [reader refresh];
+    [realm transactionWithBlock:^{}];
+    statistics = realm.storageStatistics;
+    XCTAssertEqual(statistics.oldestRetainedVersion, statistics.currentVersion - statistics.retainedVersionCount + 1);
+    XCTAssertGreaterThan(statistics.oldestRetainedVersion, readVersion);
+}
+
 #pragma mark - Assorted tests
 
 - (void)testCoreDebug {
@@ -1839,6 +2286,180 @@
     XCTAssertThrows([RLMRealm performMigrationForConfiguration:configuration error:nil]);
 }
 
+- (void)testIndexTablesAreRebuiltForObjectsMissingFromThem {
+    @autoreleasepool {
+        RLMRealm *realm = [self realmWithTestPath];
+        [realm beginWriteTransaction];
+        [FullTextIndexedObject createInRealm:realm withValue:@[@"quick brown fox", @1]];
+
+        // Add an object without going through the binding, as sync does
+        auto table = ObjectStore::table_for_object_type(realm.group, "FullTextIndexedObject");
+        size_t row = table->add_empty_row();
+        table->set_string(table->get_column_index("text"), row, "lazy brown dog");
+        [realm commitWriteTransaction];
+
+        RLMObjectSchema *objectSchema = realm.schema[FullTextIndexedObject.className];
+        XCTAssertFalse(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+        XCTAssertEqual(2U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"brown")].count);
+        XCTAssertEqual(1U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"dog")].count);
+    }
+
+    // Reopening the Realm adds the object to the index
+    RLMRealm *realm = [self realmWithTestPath];
+    RLMObjectSchema *objectSchema = realm.schema[FullTextIndexedObject.className];
+    auto table = ObjectStore::table_for_object_type(realm.group, "FullTextIndexedObject");
+    XCTAssertTrue(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+    XCTAssertEqual(2U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"brown")].count);
+    XCTAssertEqual(1U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"dog")].count);
+}
+
+// Rebuild the index tables of the class from a second, uncached instance by
+// adding an object which is missing from them
+template<typename Fn>
+static void rebuildIndexTablesFromAnotherInstance(RLMRealm *realm, const char *className, Fn&& setValues) {
+    RLMRealmConfiguration *config = [realm.configuration copy];
+    config.cache = false;
+    @autoreleasepool {
+        RLMRealm *other = [RLMRealm realmWithConfiguration:config error:nil];
+        [other beginWriteTransaction];
+        auto table = ObjectStore::table_for_object_type(other.group, className);
+        setValues(*table, table->add_empty_row());
+        [other commitWriteTransaction];
+        RLMUpdateIndexTables(other);
+    }
+}
+
+- (void)testIndexTablesRebuiltByAnotherInstanceAreUsedAfterRefresh {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [FullTextIndexedObject createInRealm:realm withValue:@[@"quick brown fox", @1]];
+    }];
+
+    rebuildIndexTablesFromAnotherInstance(realm, "FullTextIndexedObject", [](realm::Table& table, size_t row) {
+        table.set_string(table.get_column_index("text"), row, "lazy brown dog");
+    });
+
+    // The first instance has to use the rebuilt tables for both maintaining
+    // the index and querying it
+    [realm refresh];
+    [realm transactionWithBlock:^{
+        [FullTextIndexedObject createInRealm:realm withValue:@[@"brown cat", @2]];
+    }];
+    RLMObjectSchema *objectSchema = realm.schema[FullTextIndexedObject.className];
+    auto table = ObjectStore::table_for_object_type(realm.group, "FullTextIndexedObject");
+    XCTAssertTrue(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+    XCTAssertEqual(3U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"brown")].count);
+    XCTAssertEqual(1U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"cat")].count);
+    XCTAssertEqual(1U, [FullTextIndexedObject objectsInRealm:realm withPredicate:RLMTextSearchPredicate(@"text", @"dog")].count);
+}
+
+- (void)testOrderedIndexRebuiltByAnotherInstanceIsUsedAfterRefresh {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm transactionWithBlock:^{
+        [OrderedIndexedObject createInRealm:realm withValue:@[@3, @0, NSDate.date, @"c"]];
+    }];
+
+    rebuildIndexTablesFromAnotherInstance(realm, "OrderedIndexedObject", [](realm::Table& table, size_t row) {
+        table.set_int(table.get_column_index("intCol"), row, 2);
+        table.set_timestamp(table.get_column_index("dateCol"), row, realm::Timestamp(0, 0));
+        table.set_string(table.get_column_index("stringCol"), row, "b");
+    });
+
+    [realm refresh];
+    [realm transactionWithBlock:^{
+        [OrderedIndexedObject createInRealm:realm withValue:@[@1, @0, NSDate.date, @"a"]];
+    }];
+    RLMObjectSchema *objectSchema = realm.schema[OrderedIndexedObject.className];
+    auto table = ObjectStore::table_for_object_type(realm.group, "OrderedIndexedObject");
+    XCTAssertTrue(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+
+    RLMResults *sorted = [[OrderedIndexedObject allObjectsInRealm:realm] sortedResultsUsingKeyPath:@"intCol" ascending:YES];
+    XCTAssertEqualObjects([sorted valueForKey:@"intCol"], (@[@1, @2, @3]));
+    XCTAssertEqual(2U, [OrderedIndexedObject objectsInRealm:realm where:@"intCol > 1"].count);
+}
+
+- (void)testCompositeIndexRebuiltByAnotherInstanceIsUsedAfterRefresh {
+    RLMRealm *realm = [self realmWithTestPath];
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:100];
+    [realm transactionWithBlock:^{
+        [CompositeIndexedObject createInRealm:realm withValue:@[@"user", date, NSNull.null, @NO]];
+    }];
+
+    rebuildIndexTablesFromAnotherInstance(realm, "CompositeIndexedObject", [](realm::Table& table, size_t row) {
+        table.set_string(table.get_column_index("userId"), row, "user");
+        table.set_timestamp(table.get_column_index("createdAt"), row, realm::Timestamp(200, 0));
+    });
+
+    [realm refresh];
+    [realm transactionWithBlock:^{
+        [CompositeIndexedObject createInRealm:realm withValue:@[@"user", [date dateByAddingTimeInterval:200],
+                                                                 NSNull.null, @NO]];
+        [CompositeIndexedObject createInRealm:realm withValue:@[@"other", date, NSNull.null, @NO]];
+    }];
+    RLMObjectSchema *objectSchema = realm.schema[CompositeIndexedObject.className];
+    auto table = ObjectStore::table_for_object_type(realm.group, "CompositeIndexedObject");
+    XCTAssertTrue(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+    XCTAssertEqual(3U, [CompositeIndexedObject objectsInRealm:realm where:@"userId == 'user' AND createdAt >= %@", date].count);
+    XCTAssertEqual(2U, [CompositeIndexedObject objectsInRealm:realm where:@"userId == 'user' AND createdAt > %@", date].count);
+    XCTAssertEqual(1U, [CompositeIndexedObject objectsInRealm:realm where:@"userId == 'other'"].count);
+}
+
+- (void)testCaseInsensitiveIndexRebuiltByAnotherInstanceIsUsedAfterRefresh {
+    RLMRealm *realm = [self realmWithTestPath];
+    __block CaseInsensitiveIndexedObject *obj;
+    [realm transactionWithBlock:^{
+        obj = [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"Alice", @1]];
+    }];
+
+    rebuildIndexTablesFromAnotherInstance(realm, "CaseInsensitiveIndexedObject", [](realm::Table& table, size_t row) {
+        table.set_string(table.get_column_index("name"), row, "Bob");
+    });
+
+    // Both setting a property of an existing object and creating an object
+    // have to update the rebuilt index
+    [realm refresh];
+    [realm transactionWithBlock:^{
+        obj.name = @"Carol";
+        [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"alice", @2]];
+    }];
+    RLMObjectSchema *objectSchema = realm.schema[CaseInsensitiveIndexedObject.className];
+    auto table = ObjectStore::table_for_object_type(realm.group, "CaseInsensitiveIndexedObject");
+    XCTAssertTrue(RLMIndexTablesCoverAllRows(*table, RLMIndexCoverageTableName(objectSchema)));
+    XCTAssertEqual(1U, [CaseInsensitiveIndexedObject objectsInRealm:realm where:@"name ==[c] 'ALICE'"].count);
+    XCTAssertEqual(1U, [CaseInsensitiveIndexedObject objectsInRealm:realm where:@"name BEGINSWITH[c] 'car'"].count);
+    XCTAssertEqual(1U, [CaseInsensitiveIndexedObject objectsInRealm:realm where:@"name ==[c] 'bob'"].count);
+}
+
+- (void)testRepeatedOpensWithSameConfigurationUseThreadLocalCache {
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    // The second open finds the Realm in the global cache and adds it to the
+    // thread's cache
+    XCTAssertEqual(realm, [RLMRealm realmWithConfiguration:config error:nil]);
+
+    uint64_t lookups = RLMGetRealmCacheLookupCount();
+    for (int i = 0; i < 10; ++i) {
+        XCTAssertEqual(realm, [RLMRealm realmWithConfiguration:config error:nil]);
+        XCTAssertEqual(realm, [RLMRealm realmWithConfiguration:[config copy] error:nil]);
+    }
+    XCTAssertEqual(lookups, RLMGetRealmCacheLookupCount());
+}
+
+- (void)testRegularExpressionsDoNotUseIncompleteCaseInsensitiveIndex {
+    RLMRealm *realm = [self realmWithTestPath];
+    [realm beginWriteTransaction];
+    [CaseInsensitiveIndexedObject createInRealm:realm withValue:@[@"John", @0]];
+
+    // Add an object without going through the binding, as sync does
+    auto table = ObjectStore::table_for_object_type(realm.group, "CaseInsensitiveIndexedObject");
+    size_t row = table->add_empty_row();
+    table->set_string(table->get_column_index("name"), row, "Joan");
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual(2U, [CaseInsensitiveIndexedObject objectsInRealm:realm where:@"name MATCHES[c] 'jo.n'"].count);
+    XCTAssertEqual(1U, [CaseInsensitiveIndexedObject objectsInRealm:realm where:@"name MATCHES 'Joa.*'"].count);
+}
+
 - (void)testNotificationPipeBufferOverfull {
     RLMRealm *realm = [self inMemoryRealmWithIdentifier:@"test"];
     // pipes have a 8 KB buffer on OS X, so verify we don't block after 8192 commits
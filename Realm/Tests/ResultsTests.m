@@ -350,6 +350,139 @@
     RLMAssertThrowsWithReasonMatching([allArray maxOfProperty:@"boolCol"], @"max.*bool");
 }
 
+- (void)testParallelQueryAggregates
+{
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.maximumQueryConcurrency = 4;
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    XCTAssertEqual(realm.configuration.maximumQueryConcurrency, 4U);
+
+    // Enough objects for the table to be searched in parallel
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 101000; ++i) {
+        [AggregateObject createInRealm:realm withValue:@[@(i % 1000), @(i % 10), @(i * 0.5), @(i % 2 == 1),
+                                                         [NSDate dateWithTimeIntervalSince1970:i]]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *odd = [AggregateObject objectsInRealm:realm where:@"boolCol == YES"];
+    XCTAssertEqual(odd.count, 50500U);
+    XCTAssertEqual([odd sumOfProperty:@"intCol"].integerValue, 25250000);
+    XCTAssertEqual([odd minOfProperty:@"intCol"].intValue, 1);
+    XCTAssertEqual([odd maxOfProperty:@"intCol"].intValue, 999);
+    XCTAssertEqualWithAccuracy([odd averageOfProperty:@"intCol"].doubleValue, 500.0, 0.001);
+    XCTAssertEqualWithAccuracy([odd sumOfProperty:@"floatCol"].doubleValue, 252500.0, 0.1);
+    XCTAssertEqual([odd minOfProperty:@"floatCol"].floatValue, 1.0f);
+    XCTAssertEqual([odd maxOfProperty:@"floatCol"].floatValue, 9.0f);
+    XCTAssertEqualWithAccuracy([odd averageOfProperty:@"floatCol"].doubleValue, 5.0, 0.001);
+    XCTAssertEqualWithAccuracy([odd sumOfProperty:@"doubleCol"].doubleValue, 1275125000.0, 0.1);
+    XCTAssertEqual([odd minOfProperty:@"doubleCol"].doubleValue, 0.5);
+    XCTAssertEqual([odd maxOfProperty:@"doubleCol"].doubleValue, 50499.5);
+    XCTAssertEqualObjects([odd minOfProperty:@"dateCol"], [NSDate dateWithTimeIntervalSince1970:1]);
+    XCTAssertEqualObjects([odd maxOfProperty:@"dateCol"], [NSDate dateWithTimeIntervalSince1970:100999]);
+
+    // Sorting doesn't change the results of the parallel search
+    RLMResults *sorted = [odd sortedResultsUsingKeyPath:@"intCol" ascending:NO];
+    XCTAssertEqual(sorted.count, 50500U);
+    XCTAssertEqual([sorted sumOfProperty:@"intCol"].integerValue, 25250000);
+
+    RLMResults *none = [AggregateObject objectsInRealm:realm where:@"intCol < 0"];
+    XCTAssertEqual(none.count, 0U);
+    XCTAssertEqual([none sumOfProperty:@"intCol"].intValue, 0);
+    XCTAssertNil([none minOfProperty:@"intCol"]);
+    XCTAssertNil([none maxOfProperty:@"dateCol"]);
+    XCTAssertNil([none averageOfProperty:@"doubleCol"]);
+
+    RLMAssertThrowsWithReasonMatching([odd sumOfProperty:@"dateCol"], @"sumOfProperty is not supported for date property 'dateCol'");
+
+    // Every thread searches the calling thread's version rather than the latest
+    [self dispatchAsyncAndWait:^{
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+        [realm transactionWithBlock:^{
+            [AggregateObject createInRealm:realm withValue:@[@1, @1, @0.5, @YES, NSDate.date]];
+        }];
+    }];
+    XCTAssertEqual(odd.count, 50500U);
+    XCTAssertEqual([odd sumOfProperty:@"intCol"].integerValue, 25250000);
+    [realm refresh];
+    XCTAssertEqual(odd.count, 50501U);
+    XCTAssertEqual([odd sumOfProperty:@"intCol"].integerValue, 25250001);
+
+    // Uncommitted changes can't be seen by other threads, so queries within a
+    // write transaction are evaluated on the calling thread
+    [realm beginWriteTransaction];
+    [AggregateObject createInRealm:realm withValue:@[@1, @1, @0.5, @YES, NSDate.date]];
+    XCTAssertEqual(odd.count, 50502U);
+    XCTAssertEqual([odd sumOfProperty:@"intCol"].integerValue, 25250002);
+    [realm cancelWriteTransaction];
+    XCTAssertEqual(odd.count, 50501U);
+
+    // Queries using custom expression nodes are evaluated on the calling thread
+    RLMResults *in = [AggregateObject objectsInRealm:realm where:@"intCol IN %@", @[@1, @2]];
+    XCTAssertEqual(in.count, 202U);
+    XCTAssertEqual([in sumOfProperty:@"intCol"].integerValue, 303);
+}
+
+- (void)testSlowQueryBlock
+{
+    NSMutableArray<RLMQueryTiming *> *timings = [NSMutableArray new];
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.slowQueryBlock = ^(RLMQueryTiming *timing) {
+        [timings addObject:timing];
+    };
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    XCTAssertNotNil(realm.configuration.slowQueryBlock);
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    RLMResults *results = [[IntObject objectsInRealm:realm where:@"intCol > 2"] objectsWhere:@"intCol < 8"];
+    XCTAssertEqual(results.count, 5U);
+    XCTAssertEqual(timings.count, 1U);
+    RLMQueryTiming *timing = timings.firstObject;
+    XCTAssertEqualObjects(timing.className, @"IntObject");
+    XCTAssertEqualObjects(timing.predicateFormat, @"intCol > 2 AND intCol < 8");
+    XCTAssertGreaterThan(timing.buildDuration, 0);
+    XCTAssertGreaterThan(timing.executionDuration, 0);
+    XCTAssertEqual(timing.searchedObjectCount, 10U);
+    XCTAssertEqual(timing.resultCount, 5U);
+
+    // Reading the results runs the query once, after which it isn't re-run
+    XCTAssertEqual([results[0] intCol], 3);
+    XCTAssertEqual([results[1] intCol], 4);
+    XCTAssertEqual(timings.count, 2U);
+    XCTAssertEqual(timings.lastObject.resultCount, 5U);
+    XCTAssertEqual([results sumOfProperty:@"intCol"].intValue, 25);
+    XCTAssertEqual(timings.count, 2U);
+
+    XCTAssertEqual([IntObject allObjectsInRealm:realm].count, 10U);
+    XCTAssertEqual(timings.count, 2U);
+}
+
+- (void)testSlowQueryThreshold
+{
+    __block NSUInteger reported = 0;
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.slowQueryThreshold = 60;
+    config.slowQueryBlock = ^(__unused RLMQueryTiming *timing) {
+        ++reported;
+    };
+    RLMRealm *realm = [RLMRealm realmWithConfiguration:config error:nil];
+    XCTAssertEqual(realm.configuration.slowQueryThreshold, 60);
+
+    [realm beginWriteTransaction];
+    for (int i = 0; i < 10; ++i) {
+        [IntObject createInRealm:realm withValue:@[@(i)]];
+    }
+    [realm commitWriteTransaction];
+
+    XCTAssertEqual([IntObject objectsInRealm:realm where:@"intCol > 2"].count, 7U);
+    XCTAssertEqual(reported, 0U);
+}
+
 - (void)testValueForCollectionOperationKeyPath
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -385,12 +518,38 @@
     XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@unionOfObjects.name"],
                           (@[@"InspiringNames LLC", @"ABC AG", @"ABC AG"]));
     XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@distinctUnionOfObjects.name"],
-                          (@[@"ABC AG", @"InspiringNames LLC"]));
+                          (@[@"InspiringNames LLC", @"ABC AG"]));
+    XCTAssertEqual([[allCompanies valueForKeyPath:@"@distinctUnionOfObjects.self"] count], 3U);
     XCTAssertEqualObjects([allCompanies valueForKeyPath:@"employees.@unionOfArrays.name"],
                           (@[@"Joe", @"John", @"Jill", @"A", @"B", @"C", @"A"]));
     XCTAssertEqualObjects([[allCompanies valueForKeyPath:@"employees.@distinctUnionOfArrays.name"] sortedArrayUsingSelector:@selector(compare:)],
                           (@[@"A", @"B", @"C", @"Jill", @"Joe", @"John"]));
 
+    // nested key paths
+    XCTAssertEqual([[allCompanies valueForKeyPath:@"@min.employees.age"] intValue], 20);
+    XCTAssertEqual([[allCompanies valueForKeyPath:@"@max.employees.age"] intValue], 40);
+    XCTAssertEqual([[allCompanies valueForKeyPath:@"@sum.employees.age"] integerValue], 206);
+    XCTAssertEqualWithAccuracy([[allCompanies valueForKeyPath:@"@avg.employees.age"] doubleValue], 29.43, 0.1f);
+    XCTAssertEqualObjects([allCompanies valueForKeyPath:@"@unionOfObjects.employees.name"],
+                          (@[@[@"Joe", @"John", @"Jill"], @[@"A", @"B", @"C"], @[@"A"]]));
+    XCTAssertEqual([[allCompanies valueForKeyPath:@"@distinctUnionOfObjects.employees.name"] count], 3U);
+    XCTAssertEqualObjects([[allCompanies valueForKeyPath:@"@unionOfArrays.employees"] valueForKey:@"name"],
+                          (@[@"Joe", @"John", @"Jill", @"A", @"B", @"C", @"A"]));
+
+    // nested key paths give the same results as on an NSArray
+    NSMutableArray *companies = [NSMutableArray new];
+    for (CompanyObject *company in allCompanies) {
+        [companies addObject:company];
+    }
+    for (NSString *keyPath in @[@"@unionOfObjects.employees.name", @"@unionOfObjects.employees.age"]) {
+        XCTAssertEqualObjects([allCompanies valueForKeyPath:keyPath], [companies valueForKeyPath:keyPath]);
+    }
+    XCTAssertEqual([[[allCompanies objectsWhere:@"name = 'ABC AG'"] valueForKeyPath:@"@sum.employees.age"] integerValue], 111);
+    RLMAssertThrowsWithReasonMatching([allCompanies valueForKeyPath:@"@sum.employees.name"],
+                                      @"@sum is not supported for string property 'employees.name'");
+    RLMAssertThrowsWithReasonMatching([allCompanies valueForKeyPath:@"@unionOfArrays.name"],
+                                      @"'name'.*is not a link");
+
     // invalid key paths
     RLMAssertThrowsWithReasonMatching([allCompanies valueForKeyPath:@"@invalid.name"],
                                       @"Unsupported KVC collection operator found in key path '@invalid.name'");
@@ -571,6 +730,37 @@
     XCTAssertEqual(40, [(EmployeeObject *)sortedName[0] age]);
 }
 
+- (void)testDistinctResults
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+
+    [realm beginWriteTransaction];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"A", @"age": @20, @"hired": @YES}];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"B", @"age": @20, @"hired": @NO}];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"A", @"age": @30, @"hired": @YES}];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"A", @"age": @20, @"hired": @NO}];
+    [realm commitWriteTransaction];
+
+    RLMResults *all = [EmployeeObject allObjects];
+    XCTAssertEqualObjects([[all distinctResultsUsingKeyPaths:@[@"name"]] valueForKey:@"name"], (@[@"A", @"B"]));
+    XCTAssertEqualObjects([[all distinctResultsUsingKeyPaths:@[@"age"]] valueForKey:@"age"], (@[@20, @30]));
+    XCTAssertEqual(3U, [all distinctResultsUsingKeyPaths:@[@"name", @"age"]].count);
+    XCTAssertEqual(4U, [all distinctResultsUsingKeyPaths:@[]].count);
+
+    // Distinct results are live
+    RLMResults *distinctNames = [[all objectsWhere:@"hired = YES"] distinctResultsUsingKeyPaths:@[@"name"]];
+    XCTAssertEqual(1U, distinctNames.count);
+    [realm beginWriteTransaction];
+    [EmployeeObject createInRealm:realm withValue:@{@"name": @"C", @"age": @40, @"hired": @YES}];
+    [realm commitWriteTransaction];
+    XCTAssertEqualObjects([distinctNames valueForKey:@"name"], (@[@"A", @"C"]));
+
+    RLMAssertThrowsWithReasonMatching([all distinctResultsUsingKeyPaths:@[@"foo"]], @"foo.*EmployeeObject");
+    RLMAssertThrowsWithReasonMatching([all distinctResultsUsingKeyPaths:@[@"@count"]], @"collection operators");
+    RLMAssertThrowsWithReasonMatching([[CompanyObject allObjects] distinctResultsUsingKeyPaths:@[@"employees.name"]],
+                                      @"to-many relationship");
+}
+
 - (void)testRerunningSortedQuery {
     RLMRealm *realm = [RLMRealm defaultRealm];
 
@@ -835,6 +1025,7 @@ static vm_size_t get_resident_size() {
     XCTAssertNoThrow([results objectsWithPredicate:[NSPredicate predicateWithFormat:@"intCol = 0"]]);
     XCTAssertNoThrow([results sortedResultsUsingKeyPath:@"intCol" ascending:YES]);
     XCTAssertNoThrow([results sortedResultsUsingDescriptors:@[[RLMSortDescriptor sortDescriptorWithKeyPath:@"intCol" ascending:YES]]]);
+    XCTAssertNoThrow([results distinctResultsUsingKeyPaths:@[@"intCol"]]);
     XCTAssertNoThrow([results minOfProperty:@"intCol"]);
     XCTAssertNoThrow([results maxOfProperty:@"intCol"]);
     XCTAssertNoThrow([results sumOfProperty:@"intCol"]);
@@ -854,6 +1045,7 @@ static vm_size_t get_resident_size() {
         XCTAssertThrows([results objectsWithPredicate:[NSPredicate predicateWithFormat:@"intCol = 0"]]);
         XCTAssertThrows([results sortedResultsUsingKeyPath:@"intCol" ascending:YES]);
         XCTAssertThrows([results sortedResultsUsingDescriptors:@[[RLMSortDescriptor sortDescriptorWithKeyPath:@"intCol" ascending:YES]]]);
+        XCTAssertThrows([results distinctResultsUsingKeyPaths:@[@"intCol"]]);
         XCTAssertThrows([results minOfProperty:@"intCol"]);
         XCTAssertThrows([results maxOfProperty:@"intCol"]);
         XCTAssertThrows([results sumOfProperty:@"intCol"]);
@@ -113,6 +113,73 @@ RLM_ARRAY_TYPE(SchemaTestClassSecondChild)
 @end
 
 
+@interface NonStringFullTextIndexedProperty : FakeObject
+@property int intCol;
+@end
+@implementation NonStringFullTextIndexedProperty
++ (NSArray *)fullTextIndexedProperties {
+    return @[@"intCol"];
+}
+@end
+
+@interface MissingFullTextIndexedProperty : FakeObject
+@property NSString *stringCol;
+@end
+@implementation MissingFullTextIndexedProperty
++ (NSArray *)fullTextIndexedProperties {
+    return @[@"text"];
+}
+@end
+
+@interface BoolOrderedIndexedProperty : FakeObject
+@property bool boolCol;
+@end
+@implementation BoolOrderedIndexedProperty
++ (NSArray *)orderedIndexedProperties {
+    return @[@"boolCol"];
+}
+@end
+
+@interface MissingOrderedIndexedProperty : FakeObject
+@property int intCol;
+@end
+@implementation MissingOrderedIndexedProperty
++ (NSArray *)orderedIndexedProperties {
+    return @[@"date"];
+}
+@end
+
+@interface InvalidCompositeIndexes : FakeObject
+@property int intCol;
+@property double doubleCol;
+@property NSData *dataCol;
+@property IntObject *objectCol;
+@end
+@implementation InvalidCompositeIndexes
+static NSArray *s_invalidCompositeIndexes;
++ (NSArray *)compositeIndexes {
+    return s_invalidCompositeIndexes;
+}
+@end
+
+@interface NonStringCaseInsensitiveIndexedProperty : FakeObject
+@property int intCol;
+@end
+@implementation NonStringCaseInsensitiveIndexedProperty
++ (NSArray *)caseInsensitiveIndexedProperties {
+    return @[@"intCol"];
+}
+@end
+
+@interface MissingCaseInsensitiveIndexedProperty : FakeObject
+@property NSString *stringCol;
+@end
+@implementation MissingCaseInsensitiveIndexedProperty
++ (NSArray *)caseInsensitiveIndexedProperties {
+    return @[@"name"];
+}
+@end
+
 @interface InvalidPrimaryKeyType : FakeObject
 @property double primaryKey;
 @end
@@ -592,6 +659,45 @@ RLM_ARRAY_TYPE(NotARealClass)
     XCTAssertThrows([RLMObjectSchema schemaForObjectClass:InvalidPrimaryKeyType.class]);
 }
 
+- (void)testClassWithInvalidFullTextIndexedProperty {
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:NonStringFullTextIndexedProperty.class],
+                                      @"'intCol' cannot be full-text indexed .* not a 'string' property");
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:MissingFullTextIndexedProperty.class],
+                                      @"Full-text indexed property 'text' does not exist");
+}
+
+- (void)testClassWithInvalidOrderedIndexedProperty {
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:BoolOrderedIndexedProperty.class],
+                                      @"'boolCol' cannot have an ordered index .* 'bool' property");
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:MissingOrderedIndexedProperty.class],
+                                      @"Ordered indexed property 'date' does not exist");
+}
+
+- (void)testClassWithInvalidCompositeIndex {
+    auto assertThrows = ^(NSArray *indexes, NSString *reason) {
+        s_invalidCompositeIndexes = indexes;
+        RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:InvalidCompositeIndexes.class], reason);
+    };
+    assertThrows(@[@[@"intCol"]], @"Composite index \\(intCol\\) .* must have at least two properties");
+    assertThrows(@[@[@"intCol", @"intCol"]], @"lists a property more than once");
+    assertThrows(@[@[@"intCol", @"missing"]], @"Composite indexed property 'missing' does not exist");
+    assertThrows(@[@[@"dataCol", @"intCol"]], @"'dataCol' cannot be part of a composite index .* 'data' property");
+    assertThrows(@[@[@"doubleCol", @"intCol"]], @"'doubleCol' can only be the last property of a composite index");
+    assertThrows(@[@[@"intCol", @"objectCol"]], @"'objectCol' cannot be the last property of a composite index");
+
+    s_invalidCompositeIndexes = @[@[@"objectCol", @"intCol", @"doubleCol"]];
+    XCTAssertEqualObjects(s_invalidCompositeIndexes,
+                          [RLMObjectSchema schemaForObjectClass:InvalidCompositeIndexes.class].compositeIndexes);
+    s_invalidCompositeIndexes = nil;
+}
+
+- (void)testClassWithInvalidCaseInsensitiveIndexedProperty {
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:NonStringCaseInsensitiveIndexedProperty.class],
+                                      @"'intCol' cannot have a case-insensitive index .* not a 'string' property");
+    RLMAssertThrowsWithReasonMatching([RLMObjectSchema schemaForObjectClass:MissingCaseInsensitiveIndexedProperty.class],
+                                      @"Case-insensitive indexed property 'name' does not exist");
+}
+
 - (void)testClassWithUnindexableProperty {
     RLMObjectSchema *objectSchema = [RLMObjectSchema schemaForObjectClass:UnindexableProperty.class];
     RLMSchema *schema = [[RLMSchema alloc] init];
@@ -174,6 +174,55 @@ open class Object: RLMObjectBase, ThreadConfined {
      */
     @objc open class func indexedProperties() -> [String] { return [] }
 
+    /**
+     Returns an array of property names for string properties which should have a full-text index.
+
+     A full-text index records which objects contain each word in the property's value, which allows querying for
+     objects containing words or word prefixes with a predicate created by `RLMTextSearchPredicate()` without
+     examining every object.
+
+     - returns: An array of property names.
+     */
+    @objc open class func fullTextIndexedProperties() -> [String] { return [] }
+
+    /**
+     Returns an array of property names for properties which should have an ordered index.
+
+     An ordered index keeps the objects sorted by the property's value, which allows `<`, `<=`, `>`, `>=` and
+     `BETWEEN` queries on the property to find the matching objects without examining every object, and allows
+     sorting on the property without sorting every object.
+
+     Only `Int`, `Float`, `Double`, `Date` and `String` properties are supported.
+
+     - returns: An array of property names.
+     */
+    @objc open class func orderedIndexedProperties() -> [String] { return [] }
+
+    /**
+     Returns an array of composite indexes, each of which is an array of the names of two or more properties.
+
+     A composite index groups the objects by the values of all but the last of its properties, and keeps each group
+     sorted by the value of the last property. Queries which combine `==` comparisons on the leading properties with
+     `AND`, optionally along with a comparison on the last property, find the matching objects using the index.
+
+     `Int`, `Bool`, `Date`, `String` and `Object` properties can be the leading properties of an index, and `Int`,
+     `Bool`, `Float`, `Double`, `Date` and `String` properties can be its last property. A comparison with an object
+     can only use the index if the object's type has a primary key.
+
+     - returns: An array of composite indexes.
+     */
+    @objc open class func compositeIndexes() -> [[String]] { return [] }
+
+    /**
+     Returns an array of property names for string properties which should have a case-insensitive index.
+
+     A case-insensitive index allows `==[c]` and `BEGINSWITH[c]` queries on the property, along with the `[d]` and
+     `[cd]` variants of them, to find the matching objects without examining every object.
+
+     - returns: An array of property names.
+     */
+    @objc open class func caseInsensitiveIndexedProperties() -> [String] { return [] }
+
     // MARK: Key-Value Coding & Subscripting
 
     /// Returns or sets the value of the property with the given name.
@@ -406,6 +455,34 @@ public class ObjectUtil: NSObject {
         return nil
     }
 
+    @objc private class func fullTextIndexedPropertiesForClass(_ type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.fullTextIndexedProperties() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func orderedIndexedPropertiesForClass(_ type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.orderedIndexedProperties() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func compositeIndexesForClass(_ type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.compositeIndexes() as NSArray?
+        }
+        return nil
+    }
+
+    @objc private class func caseInsensitiveIndexedPropertiesForClass(_ type: AnyClass) -> NSArray? {
+        if let type = type as? Object.Type {
+            return type.caseInsensitiveIndexedProperties() as NSArray?
+        }
+        return nil
+    }
+
     @objc private class func linkingObjectsPropertiesForClass(_ type: AnyClass) -> NSDictionary? {
         // Not used for Swift. getLinkingObjectsProperties(_:) is used instead.
         return nil